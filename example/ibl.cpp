@@ -8,18 +8,22 @@
 #include <imgui.h>
 #include <memory>
 #include <spdlog/spdlog.h>
+#include <vector>
 #include "glex/common.h"
 #include "glex/context.h"
 #include "glex/framebuffer.h"
+#include "glex/gl_state_cache.h"
 #include "glex/image.h"
+#include "glex/instance_buffer.h"
 #include "glex/mesh.h"
 #include "glex/program.h"
 #include "glex/texture.h"
 
 class IBL : Context {
-    std::unique_ptr<Program> simple_program_, pbr_program_, spherical_map_program_, skybox_program_,
+    std::unique_ptr<Program> simple_program_, pbr_program_, pbr_ibl_program_, spherical_map_program_, skybox_program_,
             diffuse_irradiance_program_, prefiltered_program_, brdf_lookup_program_;
     std::shared_ptr<Mesh> cube_mesh_, plain_mesh_, sphere_mesh_;
+    std::unique_ptr<InstanceBuffer> sphere_instances_;
     std::unique_ptr<Texture> hdr_map_;
     std::shared_ptr<Texture> brdf_lookup_map_;
     std::shared_ptr<CubeTexture> hdr_cube_map_, diffuse_irradiance_map_, prefiltered_map_;
@@ -33,11 +37,7 @@ class IBL : Context {
     static constexpr Material DEFAULT_MATERIAL = {glm::vec3{1.0f}, 0.5f, 0.5f, 0.1f};
     Material material_ = DEFAULT_MATERIAL;
 
-    struct Light {
-        glm::vec3 position;
-        glm::vec3 color;
-    };
-    std::vector<Light> lights_;
+    std::vector<PointLight> lights_;
 
     bool use_ibl_{true};
 
@@ -61,30 +61,74 @@ std::unique_ptr<Context> Context::create() {
 
 bool IBL::init() {
     // Enable depth test and cull face.
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_MULTISAMPLE);
-    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    GLStateCache::enable(GL_DEPTH_TEST);
+    GLStateCache::enable(GL_MULTISAMPLE);
+    GLStateCache::enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
     // Create meshes.
     cube_mesh_ = Mesh::create_cube();
     plain_mesh_ = Mesh::create_plain();
     sphere_mesh_ = Mesh::create_sphere();
 
-    // Load programs.
-    simple_program_ = Program::create("./shader/simple.vs", "./shader/simple.fs");
-    pbr_program_ = Program::create("./shader/pbr.vs", "./shader/pbr_with_ibl.fs");
-    spherical_map_program_ = Program::create("./shader/spherical_map.vs", "./shader/spherical_map.fs");
-    skybox_program_ = Program::create("./shader/skybox_hdr.vs", "./shader/skybox_hdr.fs");
-    diffuse_irradiance_program_ = Program::create("./shader/skybox_hdr.vs", "./shader/diffuse_irradiance.fs");
-    prefiltered_program_ = Program::create("./shader/skybox_hdr.vs", "./shader/prefiltered_light.fs");
-    brdf_lookup_program_ = Program::create("./shader/brdf_lookup.vs", "./shader/brdf_lookup.fs");
+    // Lay out a grid of spheres, whose metallic increases upwards and roughness to the right.
+    const int sphere_count = 7;
+    const float offset = 1.2f;
+    std::vector<InstanceData> spheres;
+    spheres.reserve(sphere_count * sphere_count);
+    for (size_t j = 0; j < sphere_count; ++j) {
+        const float y = (static_cast<float>(j) - static_cast<float>(sphere_count - 1) * 0.5f) * offset;
+        for (size_t i = 0; i < sphere_count; ++i) {
+            const float x = (static_cast<float>(i) - static_cast<float>(sphere_count - 1) * 0.5f) * offset;
+            spheres.push_back({
+                    .model_transform = glm::translate(glm::mat4{1.0f}, glm::vec3{x, y, 0.0f}),
+                    .params = {
+                            static_cast<float>(j + 1) / static_cast<float>(sphere_count),
+                            static_cast<float>(i + 1) / static_cast<float>(sphere_count), 0.0f, 0.0f
+                    },
+            });
+        }
+    }
+    sphere_instances_ = InstanceBuffer::create(spheres);
+    if (!sphere_instances_) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+
+    // Load programs. Submit all of them before checking any result so that the driver can compile them in parallel.
+    auto pending_simple = Program::create_async("./shader/simple.vs", "./shader/simple.fs");
+    // The PBR program is specialized for the number of lights, with and without IBL, and draws the spheres instanced.
+    const auto pbr_defines = ShaderDefines{}.set("MAX_LIGHTS", 4).set("INSTANCED");
+    const auto pbr_ibl_defines = ShaderDefines(pbr_defines).set("USE_IBL");
+    auto pending_pbr = Program::create_async("./shader/pbr.vs", "./shader/pbr_with_ibl.fs", pbr_defines);
+    auto pending_pbr_ibl = Program::create_async("./shader/pbr.vs", "./shader/pbr_with_ibl.fs", pbr_ibl_defines);
+    auto pending_spherical_map = Program::create_async("./shader/spherical_map.vs", "./shader/spherical_map.fs");
+    auto pending_skybox = Program::create_async("./shader/skybox_hdr.vs", "./shader/skybox_hdr.fs");
+    auto pending_diffuse_irradiance = Program::create_async("./shader/skybox_hdr.vs", "./shader/diffuse_irradiance.fs");
+    auto pending_prefiltered = Program::create_async("./shader/skybox_hdr.vs", "./shader/prefiltered_light.fs");
+    auto pending_brdf_lookup = Program::create_async("./shader/brdf_lookup.vs", "./shader/brdf_lookup.fs");
+    simple_program_ = pending_simple.get();
+    pbr_program_ = pending_pbr.get();
+    pbr_ibl_program_ = pending_pbr_ibl.get();
+    spherical_map_program_ = pending_spherical_map.get();
+    skybox_program_ = pending_skybox.get();
+    diffuse_irradiance_program_ = pending_diffuse_irradiance.get();
+    prefiltered_program_ = pending_prefiltered.get();
+    brdf_lookup_program_ = pending_brdf_lookup.get();
 
-    if (!simple_program_ || !pbr_program_ || !spherical_map_program_ || !skybox_program_ ||
+    if (!simple_program_ || !pbr_program_ || !pbr_ibl_program_ || !spherical_map_program_ || !skybox_program_ ||
         !diffuse_irradiance_program_ || !prefiltered_program_ || !brdf_lookup_program_) {
         SPDLOG_ERROR("Failed to initialize context");
         return false;
     }
 
+    // Share camera and light data between programs.
+    if (!init_uniform_blocks()) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+    bind_uniform_blocks(*pbr_program_);
+    bind_uniform_blocks(*pbr_ibl_program_);
+
     lights_.emplace_back(glm::vec3{5.0f, 5.0f, 6.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
     lights_.emplace_back(glm::vec3{-4.0f, 5.0f, 7.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
     lights_.emplace_back(glm::vec3{-4.0f, -6.0f, 8.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
@@ -102,13 +146,13 @@ bool IBL::init() {
     };
 
     // Generate HDR cube map from equirectangular map.
-    hdr_map_ = Texture::create(*Image::load("./image/Alexs_Apt_2k.hdr"));
+    hdr_map_ = Texture::create(*Image::load("./image/Alexs_Apt_2k.hdr"), {.immutable = true});
     hdr_cube_map_ = CubeTexture::create(1024, 1024, GL_RGB16F, GL_FLOAT);
     spherical_map_program_->use();
-    hdr_map_->bind();
+    hdr_map_->bind_to_unit(0);
     spherical_map_program_->set_uniform("tex", 0);
     auto cube_framebuffer = CubeFrameBuffer::create(hdr_cube_map_);
-    glViewport(0, 0, 1024, 1024);
+    GLStateCache::set_viewport(0, 0, 1024, 1024);
     for (size_t i = 0; i < 6; ++i) {
         cube_framebuffer->bind(i);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -118,36 +162,38 @@ bool IBL::init() {
     hdr_cube_map_->generate_mipmap();
 
     // Generate diffuse irradiance map from cube map.
-    diffuse_irradiance_map_ = CubeTexture::create(64, 64, GL_RGB16F, GL_FLOAT);
+    diffuse_irradiance_map_ = CubeTexture::create(64, 64, GL_RGB16F, GL_FLOAT, {.immutable = true});
     diffuse_irradiance_program_->use();
-    hdr_cube_map_->bind();
+    hdr_cube_map_->bind_to_unit(0);
     diffuse_irradiance_program_->set_uniform("cubeMap", 0);
     diffuse_irradiance_program_->set_uniform("projection", projection);
     cube_framebuffer = CubeFrameBuffer::create(diffuse_irradiance_map_);
-    glViewport(0, 0, 64, 64);
-    glDepthFunc(GL_LEQUAL);
+    GLStateCache::set_viewport(0, 0, 64, 64);
+    GLStateCache::set_depth_func(GL_LEQUAL);
     for (size_t i = 0; i < 6; ++i) {
         cube_framebuffer->bind(i);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         diffuse_irradiance_program_->set_uniform("view", views[i]);
         cube_mesh_->draw(*diffuse_irradiance_program_);
     }
-    glDepthFunc(GL_LESS);
+    GLStateCache::set_depth_func(GL_LESS);
 
     // Generate prefiltered map.
     uint32_t max_mip_levels = 5;
-    prefiltered_map_ = CubeTexture::create(128, 128, GL_RGB16F, GL_FLOAT);
+    // Allocate exactly the levels rendered below.
+    prefiltered_map_ =
+            CubeTexture::create(128, 128, GL_RGB16F, GL_FLOAT, {.immutable = true, .mip_levels = max_mip_levels});
     prefiltered_map_->generate_mipmap();
     prefiltered_program_->use();
     prefiltered_program_->set_uniform("projection", projection);
-    hdr_cube_map_->bind();
+    hdr_cube_map_->bind_to_unit(0);
     prefiltered_program_->set_uniform("cubeMap", 0);
-    glDepthFunc(GL_LEQUAL);
+    GLStateCache::set_depth_func(GL_LEQUAL);
     for (uint32_t mip = 0; mip < max_mip_levels; ++mip) {
         const auto framebuffer = CubeFrameBuffer::create(prefiltered_map_, mip);
         const uint32_t mip_width = 128 >> mip;
         const uint32_t mip_height = 128 >> mip;
-        glViewport(0, 0, mip_width, mip_height);
+        GLStateCache::set_viewport(0, 0, mip_width, mip_height);
         const float roughness = static_cast<float>(mip) / static_cast<float>(max_mip_levels - 1);
         prefiltered_program_->set_uniform("roughness", roughness);
         for (size_t i = 0; i < 6; ++i) {
@@ -157,13 +203,13 @@ bool IBL::init() {
             cube_mesh_->draw(*prefiltered_program_);
         }
     }
-    glDepthFunc(GL_LESS);
+    GLStateCache::set_depth_func(GL_LESS);
 
     // Generate BRDF lookup table map.
-    brdf_lookup_map_ = Texture::create(512, 512, GL_RG16F, GL_FLOAT);
+    brdf_lookup_map_ = Texture::create(512, 512, GL_RG16F, GL_FLOAT, {.immutable = true});
     const auto lookup_framebuffer = FrameBuffer::create({brdf_lookup_map_});
     lookup_framebuffer->bind();
-    glViewport(0, 0, 512, 512);
+    GLStateCache::set_viewport(0, 0, 512, 512);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     brdf_lookup_program_->use();
     brdf_lookup_program_->set_uniform("transform", glm::scale(glm::mat4{1.0f}, glm::vec3{2.0f, -2.0, 2.0f}));
@@ -171,9 +217,9 @@ bool IBL::init() {
 
     // Restore to default framebuffer.
     FrameBuffer::bind_to_default();
-    glViewport(0, 0, width_, height_);
+    GLStateCache::set_viewport(0, 0, width_, height_);
 
-    glEnable(GL_CULL_FACE);
+    GLStateCache::enable(GL_CULL_FACE);
 
     return true;
 }
@@ -195,17 +241,19 @@ void IBL::render() {
     // due to the z-value distortion introduced by the projection transform.
     const auto projection = glm::perspective(glm::radians(45.0f), aspect_ratio_, 0.01f, 150.0f);
     const auto view = glm::lookAt(camera_pos_, camera_pos_ + camera_front_, camera_up_);
+    upload_camera_block(view, projection);
+    upload_lights_block(lights_);
 
     skybox_program_->use();
     skybox_program_->set_uniform("projection", projection);
     skybox_program_->set_uniform("view", view);
-    hdr_cube_map_->bind();
+    hdr_cube_map_->bind_to_unit(0);
     skybox_program_->set_uniform("cubeMap", 0);
-    glDisable(GL_CULL_FACE);
-    glDepthFunc(GL_LEQUAL);
+    GLStateCache::disable(GL_CULL_FACE);
+    GLStateCache::set_depth_func(GL_LEQUAL);
     cube_mesh_->draw(*skybox_program_);
-    glEnable(GL_CULL_FACE);
-    glDepthFunc(GL_LESS);
+    GLStateCache::enable(GL_CULL_FACE);
+    GLStateCache::set_depth_func(GL_LESS);
 
     /*
     spherical_map_program_->use();
@@ -221,26 +269,14 @@ void IBL::render() {
     */
 
 
-    const auto &pbr = *pbr_program_;
+    const auto &pbr = use_ibl_ ? *pbr_ibl_program_ : *pbr_program_;
     pbr.use();
-    for (size_t i = 0; i < lights_.size(); ++i) {
-        const auto pos_name = std::format("lights[{}].position", i);
-        const auto color_name = std::format("lights[{}].color", i);
-        pbr.set_uniform(pos_name, lights_[i].position);
-        pbr.set_uniform(color_name, lights_[i].color);
-    }
-    pbr.set_uniform("viewPos", camera_pos_);
-    glActiveTexture(GL_TEXTURE0);
-    diffuse_irradiance_map_->bind();
-    glActiveTexture(GL_TEXTURE1);
-    prefiltered_map_->bind();
-    glActiveTexture(GL_TEXTURE2);
-    brdf_lookup_map_->bind();
-    glActiveTexture(GL_TEXTURE0);
+    diffuse_irradiance_map_->bind_to_unit(0);
+    prefiltered_map_->bind_to_unit(1);
+    brdf_lookup_map_->bind_to_unit(2);
     pbr.set_uniform("irradianceMap", 0);
     pbr.set_uniform("prefilteredMap", 1);
     pbr.set_uniform("brdfLookupTable", 2);
-    pbr.set_uniform("useIBL", use_ibl_);
     pbr.set_uniform("material.albedo", material_.albedo);
     pbr.set_uniform("material.ao", material_.ao);
     draw_scene(view, projection, pbr);
@@ -248,21 +284,8 @@ void IBL::render() {
 
 void IBL::draw_scene(const glm::mat4 &view, const glm::mat4 &projection, const Program &program) {
     program.use();
-    const int sphere_count = 7;
-    const float offset = 1.2f;
-    for (size_t j = 0; j < sphere_count; ++j) {
-        const float y = (static_cast<float>(j) - static_cast<float>(sphere_count - 1) * 0.5f) * offset;
-        for (size_t i = 0; i < sphere_count; ++i) {
-            const float x = (static_cast<float>(i) - static_cast<float>(sphere_count - 1) * 0.5f) * offset;
-            const auto model_transform = glm::translate(glm::mat4{1.0f}, glm::vec3{x, y, 0.0f});
-            const auto transform = projection * view * model_transform;
-            program.set_uniform("modelTransform", model_transform);
-            program.set_uniform("transform", transform);
-            program.set_uniform("material.roughness", static_cast<float>(i + 1) / static_cast<float>(sphere_count));
-            program.set_uniform("material.metallic", static_cast<float>(j + 1) / static_cast<float>(sphere_count));
-            sphere_mesh_->draw(program);
-        }
-    }
+    // The metallic and roughness of each sphere come from its instance.
+    sphere_mesh_->draw_instanced(program, *sphere_instances_);
 }
 
 void IBL::draw_ui() {
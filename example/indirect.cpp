@@ -0,0 +1,610 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/trigonometric.hpp>
+#include <imgui.h>
+#include <memory>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <vector>
+#include "glex/common.h"
+#include "glex/context.h"
+#include "glex/gl_state_cache.h"
+#include "glex/indirect_draw_list.h"
+#include "glex/meshlet.h"
+#include "glex/model.h"
+#include "glex/resource_cache.h"
+#include "glex/tangents.h"
+#include "glex/thread_pool.h"
+
+namespace {
+
+    /// Backpacks along each side of the grid.
+    constexpr int GRID_SIDE{10};
+    constexpr int MAX_MODEL_COUNT{GRID_SIDE * GRID_SIDE * GRID_SIDE};
+    /// Distance between the centers of neighboring backpacks.
+    constexpr float SPACING{4.0f};
+    /// Levels of detail of each mesh of the backpack, including the full mesh.
+    constexpr size_t MODEL_LOD_COUNT{4};
+
+    enum class Submission : int {
+        /// `Model::draw` per backpack, with a draw call per mesh.
+        ModelDraw,
+        /// `glMultiDrawElementsIndirect` per material.
+        MultiDrawIndirect,
+        /// The indirect commands submitted one by one, as on OpenGL 3.3.
+        IndirectFallback,
+    };
+
+    /// Segments of the sphere generated to benchmark tangent generation, about two million triangles.
+    constexpr size_t TANGENT_BENCHMARK_SEGMENTS{1024};
+
+    /// Copies of the quad of the tangent check, enough triangles to split them over several tasks.
+    constexpr size_t TANGENT_CHECK_QUADS{32768};
+    /// The largest difference from the expected tangent the check accepts.
+    constexpr float TANGENT_CHECK_EPSILON{1.0e-4f};
+
+    /// Timings of tangent generation in milliseconds.
+    struct TangentBenchmark {
+        size_t triangle_count{0};
+        /// The per-corner loop `Mesh::create` used before `generate_tangents`.
+        float serial_ms{0.0f};
+        /// `generate_tangents` on the calling thread only.
+        float single_thread_ms{0.0f};
+        /// `generate_tangents` on the default thread pool.
+        float parallel_ms{0.0f};
+    };
+
+    /// The largest difference of each way to generate tangents from the known tangent of a quad.
+    struct TangentCheck {
+        float serial_error{0.0f};
+        float single_thread_error{0.0f};
+        float parallel_error{0.0f};
+        bool passed{false};
+    };
+
+    /// Generates the tangents of copies of a tilted quad, whose `u` axis is its tangent, with the per-corner loop,
+    /// with `generate_tangents` on one thread, and on the default thread pool, and compares them with that tangent.
+    TangentCheck check_tangents() {
+        const glm::vec3 u_axis{2.0f, 0.0f, 1.0f};
+        const glm::vec3 v_axis{0.0f, 1.0f, 0.0f};
+        const auto normal = glm::normalize(glm::cross(u_axis, v_axis));
+        const auto expected = glm::normalize(u_axis);
+        constexpr std::array<glm::vec2, 4> QUAD_UVS{{{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}}};
+        std::vector<Vertex> quads;
+        std::vector<uint32_t> indices;
+        quads.reserve(TANGENT_CHECK_QUADS * QUAD_UVS.size());
+        indices.reserve(TANGENT_CHECK_QUADS * 6);
+        for (size_t quad = 0; quad < TANGENT_CHECK_QUADS; ++quad) {
+            const auto first = static_cast<uint32_t>(quads.size());
+            for (const auto &uv : QUAD_UVS) {
+                quads.emplace_back(uv.x * u_axis + uv.y * v_axis, normal, uv);
+            }
+            indices.insert(indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+        }
+
+        const auto max_error = [&](const auto &generate) {
+            auto vertices = quads;
+            generate(vertices);
+            float error = 0.0f;
+            for (const auto &vertex : vertices) {
+                error = std::max(error, glm::length(vertex.tangent - expected));
+            }
+            return error;
+        };
+        TangentCheck result;
+        result.serial_error = max_error([&](std::vector<Vertex> &vertices) {
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                auto &[pos1, norm1, uv1, tan1] = vertices[indices[i]];
+                auto &[pos2, norm2, uv2, tan2] = vertices[indices[i + 1]];
+                auto &[pos3, norm3, uv3, tan3] = vertices[indices[i + 2]];
+                tan1 += Vertex::compute_tangent(pos1, pos2, pos3, uv1, uv2, uv3);
+                tan2 += Vertex::compute_tangent(pos2, pos1, pos3, uv2, uv1, uv3);
+                tan3 += Vertex::compute_tangent(pos3, pos1, pos2, uv3, uv1, uv2);
+            }
+            for (auto &vertex : vertices) {
+                vertex.tangent = glm::normalize(vertex.tangent);
+            }
+        });
+        result.single_thread_error = max_error([&](std::vector<Vertex> &vertices) {
+            generate_tangents(vertices, indices, {.max_threads = 1});
+        });
+        result.parallel_error = max_error([&](std::vector<Vertex> &vertices) { generate_tangents(vertices, indices); });
+        result.passed = std::max({result.serial_error, result.single_thread_error, result.parallel_error}) <=
+                        TANGENT_CHECK_EPSILON;
+        if (!result.passed) {
+            SPDLOG_ERROR(
+                    "Tangent check failed: serial {:.2e}, SIMD {:.2e}, SIMD on the pool {:.2e}", result.serial_error,
+                    result.single_thread_error, result.parallel_error
+            );
+        }
+        return result;
+    }
+
+    /// Times tangent generation on a UV sphere with `segments` latitude and longitude segments.
+    TangentBenchmark benchmark_tangents(const size_t segments) {
+        std::vector<Vertex> sphere;
+        std::vector<uint32_t> indices;
+        sphere.reserve((segments + 1) * (segments + 1));
+        for (size_t i = 0; i <= segments; ++i) {
+            const auto v = static_cast<float>(i) / static_cast<float>(segments);
+            const auto phi = (v - 0.5f) * glm::pi<float>();
+            for (size_t j = 0; j <= segments; ++j) {
+                const auto u = static_cast<float>(j) / static_cast<float>(segments);
+                const auto theta = u * glm::pi<float>() * 2.0f;
+                const auto point = glm::vec3{
+                        std::cos(phi) * std::cos(theta), std::sin(phi), -std::cos(phi) * std::sin(theta)
+                };
+                sphere.emplace_back(point, point, glm::vec2{u, v});
+            }
+        }
+        indices.reserve(segments * segments * 6);
+        for (size_t i = 0; i < segments; ++i) {
+            for (size_t j = 0; j < segments; ++j) {
+                const auto corner = static_cast<uint32_t>(i * (segments + 1) + j);
+                const auto above = corner + static_cast<uint32_t>(segments + 1);
+                indices.insert(indices.end(), {corner, corner + 1, above + 1, corner, above + 1, above});
+            }
+        }
+
+        const auto time_ms = [&](const auto &generate) {
+            auto vertices = sphere;
+            const auto start = std::chrono::steady_clock::now();
+            generate(vertices);
+            const auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<float, std::milli>(end - start).count();
+        };
+        TangentBenchmark result{.triangle_count = indices.size() / 3};
+        result.serial_ms = time_ms([&](std::vector<Vertex> &vertices) {
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                auto &[pos1, norm1, uv1, tan1] = vertices[indices[i]];
+                auto &[pos2, norm2, uv2, tan2] = vertices[indices[i + 1]];
+                auto &[pos3, norm3, uv3, tan3] = vertices[indices[i + 2]];
+                tan1 += Vertex::compute_tangent(pos1, pos2, pos3, uv1, uv2, uv3);
+                tan2 += Vertex::compute_tangent(pos2, pos1, pos3, uv2, uv1, uv3);
+                tan3 += Vertex::compute_tangent(pos3, pos1, pos2, uv3, uv1, uv2);
+            }
+            for (auto &vertex : vertices) {
+                vertex.tangent = glm::normalize(vertex.tangent);
+            }
+        });
+        result.single_thread_ms = time_ms([&](std::vector<Vertex> &vertices) {
+            generate_tangents(vertices, indices, {.max_threads = 1});
+        });
+        result.parallel_ms = time_ms([&](std::vector<Vertex> &vertices) { generate_tangents(vertices, indices); });
+        SPDLOG_INFO(
+                "Tangents of {} triangles: serial {:.1f} ms, SIMD {:.1f} ms, SIMD on {} threads {:.1f} ms",
+                result.triangle_count, result.serial_ms, result.single_thread_ms,
+                ThreadPool::get_default().get_thread_count() + 1, result.parallel_ms
+        );
+        return result;
+    }
+
+} // namespace
+
+/// Draws up to 1000 backpack models to compare the CPU submission time of `Model::draw` with `IndirectDrawList`, the
+/// float vertex format with the packed one, and a depth prepass over interleaved vertices with one over split
+/// positions. Levels of detail can be selected by distance, meshlets culled with `Model::draw`, and tangent generation
+/// is benchmarked on demand.
+class IndirectTest : Context {
+    /// Programs by vertex format
+    std::array<std::unique_ptr<Program>, 2> model_programs_, model_indirect_programs_;
+    std::array<std::unique_ptr<Program>, 2> depth_programs_, depth_indirect_programs_;
+    std::shared_ptr<Model> backpack_model_;
+    std::unique_ptr<IndirectDrawList> draw_list_;
+
+    std::vector<PointLight> lights_;
+    std::vector<glm::mat4> model_transforms_;
+
+    ///@{
+    /// Scene options
+    int model_count_{MAX_MODEL_COUNT};
+    int submission_{static_cast<int>(Submission::MultiDrawIndirect)};
+    int vertex_format_{static_cast<int>(VertexFormat::Float)};
+    bool depth_prepass_{false};
+    bool split_positions_{false};
+    bool use_lods_{false};
+    LodView lod_view_{};
+    bool use_meshlets_{false};
+    ///@}
+
+    /// The level of detail of each mesh of each backpack, selected once per frame so that both passes draw the same
+    /// triangles.
+    std::vector<std::vector<uint32_t>> model_lods_;
+    size_t triangle_count_{0};
+    MeshletCullStats meshlet_stats_{};
+
+    ///@{
+    /// Timings of the last frame in milliseconds. The GPU time is read one frame late from alternating queries, and
+    /// only once it is available, so reading it never waits for the GPU.
+    float submit_ms_{0.0f};
+    float gpu_ms_{0.0f};
+    size_t draw_calls_{0};
+    std::array<uint32_t, 2> time_queries_{};
+    size_t frame_index_{0};
+    ///@}
+
+    TangentBenchmark tangent_benchmark_;
+    std::optional<TangentCheck> tangent_check_;
+
+public:
+    ~IndirectTest() override;
+
+    bool init() override;
+    void render() override;
+    void draw_ui() override;
+    void draw_scene(const glm::mat4 &view, const glm::mat4 &projection, const Program &program) override;
+    void reshape(int width, int height) override;
+
+private:
+    /// Fills the depth buffer with every backpack, so that the color pass shades each pixel once.
+    void draw_depth_prepass();
+
+    /// Loads the backpack in `vertex_format_` and `split_positions_`, lays out `model_count_` of them in a cube and
+    /// rebuilds the draw list.
+    bool update_models();
+
+    /// Selects the levels of detail of the backpacks for the camera, and rebuilds the draw list if any changed.
+    void update_lods();
+
+    /// @returns `true` if the backpacks are drawn by meshlets, which only `Model::draw` submits.
+    [[nodiscard]]
+    bool is_meshlet_culling() const {
+        return use_meshlets_ && submission_ == static_cast<int>(Submission::ModelDraw);
+    }
+
+    /// Adds every backpack to the draw list at its current levels of detail and uploads it.
+    bool rebuild_draw_list();
+};
+
+std::unique_ptr<Context> Context::create() {
+    auto context = std::unique_ptr<Context>{reinterpret_cast<Context *>(new IndirectTest{})};
+    if (!context->init()) {
+        SPDLOG_ERROR("Failed to create context");
+        return nullptr;
+    }
+    SPDLOG_INFO("Context has been created");
+    return std::move(context);
+}
+
+IndirectTest::~IndirectTest() {
+    glDeleteQueries(static_cast<GLsizei>(time_queries_.size()), time_queries_.data());
+}
+
+bool IndirectTest::init() {
+    // Load programs. All variants share the shaders; the indirect ones read the transforms from the draw list, and the
+    // quantized ones read packed vertices.
+    const auto float_defines = ShaderDefines{};
+    const auto packed_defines = ShaderDefines{}.set("QUANTIZED");
+    auto pending_model = Program::create_async("./shader/model.vs", "./shader/model.fs", float_defines);
+    auto pending_model_packed = Program::create_async("./shader/model.vs", "./shader/model.fs", packed_defines);
+    auto pending_model_indirect = Program::create_async(
+            "./shader/model.vs", "./shader/model.fs", ShaderDefines(float_defines).set("DRAW_INDIRECT")
+    );
+    auto pending_model_indirect_packed = Program::create_async(
+            "./shader/model.vs", "./shader/model.fs", ShaderDefines(packed_defines).set("DRAW_INDIRECT")
+    );
+    auto pending_depth = Program::create_async("./shader/depth.vs", "./shader/depth.fs", float_defines);
+    auto pending_depth_packed = Program::create_async("./shader/depth.vs", "./shader/depth.fs", packed_defines);
+    auto pending_depth_indirect = Program::create_async(
+            "./shader/depth.vs", "./shader/depth.fs", ShaderDefines(float_defines).set("DRAW_INDIRECT")
+    );
+    auto pending_depth_indirect_packed = Program::create_async(
+            "./shader/depth.vs", "./shader/depth.fs", ShaderDefines(packed_defines).set("DRAW_INDIRECT")
+    );
+
+    // Load model while the driver compiles the shaders.
+    draw_list_ = IndirectDrawList::create();
+    if (!draw_list_ || !update_models()) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+
+    model_programs_ = {pending_model.get(), pending_model_packed.get()};
+    model_indirect_programs_ = {pending_model_indirect.get(), pending_model_indirect_packed.get()};
+    depth_programs_ = {pending_depth.get(), pending_depth_packed.get()};
+    depth_indirect_programs_ = {pending_depth_indirect.get(), pending_depth_indirect_packed.get()};
+
+    if (std::ranges::any_of(model_programs_, std::logical_not{}) ||
+        std::ranges::any_of(model_indirect_programs_, std::logical_not{}) ||
+        std::ranges::any_of(depth_programs_, std::logical_not{}) ||
+        std::ranges::any_of(depth_indirect_programs_, std::logical_not{})) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+
+    // Share camera and light data between programs.
+    if (!init_uniform_blocks()) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+    for (size_t i = 0; i < model_programs_.size(); ++i) {
+        bind_uniform_blocks(*model_programs_[i]);
+        bind_uniform_blocks(*model_indirect_programs_[i]);
+        bind_uniform_blocks(*depth_programs_[i]);
+        bind_uniform_blocks(*depth_indirect_programs_[i]);
+    }
+
+    glGenQueries(static_cast<GLsizei>(time_queries_.size()), time_queries_.data());
+
+    constexpr float extent = GRID_SIDE * SPACING;
+    lights_.emplace_back(glm::vec3{extent, extent, extent}, glm::vec3{2000.0f});
+    lights_.emplace_back(glm::vec3{-extent, extent, extent}, glm::vec3{2000.0f});
+    lights_.emplace_back(glm::vec3{-extent, -extent, extent}, glm::vec3{2000.0f});
+    lights_.emplace_back(glm::vec3{extent, -extent, extent}, glm::vec3{2000.0f});
+
+    camera_pos_ = glm::vec3{0.0f, 0.0f, extent};
+
+    // Enable depth test and cull face.
+    GLStateCache::enable(GL_DEPTH_TEST);
+    GLStateCache::enable(GL_CULL_FACE);
+
+    return true;
+}
+
+void IndirectTest::render() {
+    // Clear color buffer with `glClearColor` and depth buffer with 1.0.
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Dear ImGui UI
+    draw_ui();
+
+    // Calculate camera front direction.
+    camera_front_ = glm::rotate(glm::mat4{1.0f}, glm::radians(camera_yaw_), glm::vec3{0.0f, 1.0f, 0.0f}) *
+                    glm::rotate(glm::mat4{1.0f}, glm::radians(camera_pitch_), glm::vec3{1.0f, 0.0f, 0.0f}) *
+                    glm::vec4{0.0f, 0.0f, -1.0f, 0.0f};
+
+    const auto fovy = glm::radians(45.0f);
+    const auto projection = glm::perspective(fovy, aspect_ratio_, 0.1f, 500.0f);
+    const auto view = glm::lookAt(camera_pos_, camera_pos_ + camera_front_, camera_up_);
+    upload_camera_block(view, projection);
+    upload_lights_block(lights_);
+    lod_view_.camera_pos = camera_pos_;
+    lod_view_.projection_scale = LodView::get_projection_scale(fovy, static_cast<float>(height_));
+
+    // Read the GPU time of the frame that used the other query.
+    const auto previous_query = time_queries_[(frame_index_ + 1) % time_queries_.size()];
+    int32_t available = GL_FALSE;
+    if (frame_index_ > 0) {
+        glGetQueryObjectiv(previous_query, GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+    if (available) {
+        uint64_t elapsed_ns = 0;
+        glGetQueryObjectui64v(previous_query, GL_QUERY_RESULT, &elapsed_ns);
+        gpu_ms_ = static_cast<float>(elapsed_ns) / 1.0e6f;
+    }
+
+    const auto submit_start = std::chrono::steady_clock::now();
+    glBeginQuery(GL_TIME_ELAPSED, time_queries_[frame_index_ % time_queries_.size()]);
+    update_lods();
+    draw_calls_ = 0;
+    if (depth_prepass_) {
+        draw_depth_prepass();
+        // The color pass only shades the fragments that passed the prepass, without writing depth again.
+        GLStateCache::set_depth_func(GL_LEQUAL);
+        GLStateCache::set_depth_mask(false);
+    }
+    const auto &programs = submission_ == static_cast<int>(Submission::ModelDraw) ? model_programs_
+                                                                                   : model_indirect_programs_;
+    const auto &program = *programs[vertex_format_];
+    draw_scene(view, projection, program);
+    GLStateCache::set_depth_func(GL_LESS);
+    GLStateCache::set_depth_mask(true);
+    glEndQuery(GL_TIME_ELAPSED);
+    const auto submit_end = std::chrono::steady_clock::now();
+
+    submit_ms_ = std::chrono::duration<float, std::milli>(submit_end - submit_start).count();
+    ++frame_index_;
+}
+
+void IndirectTest::draw_scene(const glm::mat4 &view, const glm::mat4 &projection, const Program &program) {
+    program.use();
+    switch (static_cast<Submission>(submission_)) {
+    case Submission::ModelDraw:
+        if (is_meshlet_culling()) {
+            meshlet_stats_ = {};
+            for (const auto &transform : model_transforms_) {
+                backpack_model_->draw_meshlets(program, transform, projection * view, camera_pos_, meshlet_stats_);
+            }
+            triangle_count_ = meshlet_stats_.visible_triangle_count;
+            draw_calls_ += model_transforms_.size() * backpack_model_->get_mesh_count();
+            break;
+        }
+        for (size_t i = 0; i < model_transforms_.size(); ++i) {
+            if (use_lods_) {
+                // Selecting again with the levels of this frame as the current ones keeps them.
+                backpack_model_->draw(program, model_transforms_[i], lod_view_, model_lods_[i]);
+                continue;
+            }
+            program.set_uniform("modelTransform", model_transforms_[i]);
+            backpack_model_->draw(program);
+        }
+        draw_calls_ += model_transforms_.size() * backpack_model_->get_mesh_count();
+        break;
+    case Submission::MultiDrawIndirect: draw_calls_ += draw_list_->draw(program); break;
+    case Submission::IndirectFallback: draw_calls_ += draw_list_->draw(program, false); break;
+    }
+}
+
+void IndirectTest::draw_depth_prepass() {
+    const auto &programs = submission_ == static_cast<int>(Submission::ModelDraw) ? depth_programs_
+                                                                                   : depth_indirect_programs_;
+    const auto &program = *programs[vertex_format_];
+    program.use();
+    GLStateCache::set_color_mask(false, false, false, false);
+    switch (static_cast<Submission>(submission_)) {
+    case Submission::ModelDraw:
+        for (size_t i = 0; i < model_transforms_.size(); ++i) {
+            program.set_uniform("modelTransform", model_transforms_[i]);
+            backpack_model_->draw_depth(program, model_lods_[i]);
+        }
+        draw_calls_ += model_transforms_.size() * backpack_model_->get_mesh_count();
+        break;
+    case Submission::MultiDrawIndirect: draw_calls_ += draw_list_->draw_depth(program); break;
+    case Submission::IndirectFallback: draw_calls_ += draw_list_->draw_depth(program, false); break;
+    }
+    GLStateCache::set_color_mask(true, true, true, true);
+}
+
+bool IndirectTest::update_models() {
+    // Meshlets are always built, since they only reorder the triangles and switching culling must not reload.
+    backpack_model_ = ResourceCache::get_model(
+            "./model/backpack/backpack.obj",
+            {
+                    .pooled = true,
+                    .format = static_cast<VertexFormat>(vertex_format_),
+                    .split_positions = split_positions_,
+                    .lod_count = MODEL_LOD_COUNT,
+                    .meshlets = true,
+            }
+    );
+    if (!backpack_model_) {
+        return false;
+    }
+    const float center = static_cast<float>(GRID_SIDE - 1) * 0.5f;
+    model_transforms_.resize(model_count_);
+    model_lods_.assign(model_count_, std::vector<uint32_t>(backpack_model_->get_mesh_count(), 0));
+    for (int i = 0; i < model_count_; ++i) {
+        const auto x = static_cast<float>(i % GRID_SIDE);
+        const auto y = static_cast<float>(i / GRID_SIDE % GRID_SIDE);
+        const auto z = static_cast<float>(i / (GRID_SIDE * GRID_SIDE));
+        model_transforms_[i] = glm::translate(glm::mat4{1.0f}, (glm::vec3{x, y, z} - center) * SPACING);
+    }
+    return rebuild_draw_list();
+}
+
+void IndirectTest::update_lods() {
+    bool changed = false;
+    triangle_count_ = 0;
+    // Meshlets cover the full meshes only, so the depth prepass must draw them too.
+    const auto select_lods = use_lods_ && !is_meshlet_culling();
+    for (size_t i = 0; i < model_transforms_.size(); ++i) {
+        for (size_t j = 0; j < backpack_model_->get_mesh_count(); ++j) {
+            const auto &mesh = *backpack_model_->get_mesh(j);
+            auto &lod = model_lods_[i][j];
+            const auto selected = select_lods ? mesh.select_lod(model_transforms_[i], lod_view_, lod) : 0;
+            changed = changed || selected != lod;
+            lod = static_cast<uint32_t>(selected);
+            triangle_count_ += mesh.get_lod(lod).index_count / 3;
+        }
+    }
+    // The indirect commands hold the index ranges, so they must be rebuilt to switch levels.
+    if (changed) {
+        rebuild_draw_list();
+    }
+}
+
+bool IndirectTest::rebuild_draw_list() {
+    draw_list_->clear();
+    for (size_t i = 0; i < model_transforms_.size(); ++i) {
+        draw_list_->add(*backpack_model_, model_transforms_[i], model_lods_[i]);
+    }
+    return draw_list_->upload();
+}
+
+void IndirectTest::draw_ui() {
+    // ImGui Components.
+    if (ImGui::Begin("UI")) {
+        if (ImGui::CollapsingHeader("Camera", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::DragFloat3("Position", glm::value_ptr(camera_pos_), 0.1f);
+            ImGui::DragFloat("Yaw", &camera_yaw_, 0.5f);
+            ImGui::DragFloat("Pitch", &camera_pitch_, 0.5f, -89.0f, 89.0f);
+        }
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Scene", ImGuiTreeNodeFlags_DefaultOpen)) {
+            if (ImGui::SliderInt("Backpacks", &model_count_, 1, MAX_MODEL_COUNT)) {
+                update_models();
+            }
+            const char *submission_names[] = {"Model::draw", "Multi-draw indirect", "Indirect fallback"};
+            ImGui::Combo("Submission", &submission_, submission_names, 3);
+            const char *vertex_format_names[] = {"Float", "Packed"};
+            if (ImGui::Combo("Vertex format", &vertex_format_, vertex_format_names, 2)) {
+                update_models();
+            }
+            ImGui::Checkbox("Depth prepass", &depth_prepass_);
+            if (ImGui::Checkbox("Split positions", &split_positions_)) {
+                update_models();
+            }
+            ImGui::Checkbox("Select LODs", &use_lods_);
+            ImGui::SliderFloat("Max screen error (px)", &lod_view_.max_screen_error, 0.1f, 16.0f);
+            ImGui::SliderFloat("LOD hysteresis", &lod_view_.hysteresis, 0.0f, 0.5f);
+            ImGui::Checkbox("Meshlet culling (Model::draw)", &use_meshlets_);
+            if (!IndirectDrawList::is_multi_draw_supported()) {
+                ImGui::Text("Multi-draw indirect is not supported, the fallback is used");
+            }
+        }
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Stats", ImGuiTreeNodeFlags_DefaultOpen)) {
+            const auto &io = ImGui::GetIO();
+            ImGui::Text("Frame: %.2f ms (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+            ImGui::Text("Meshes: %zu", draw_list_->get_draw_count());
+            const auto vertex_bytes = backpack_model_->get_vertex_bytes();
+            ImGui::Text(
+                    "Vertex data: %zu KB per model, %zu bytes/vertex", vertex_bytes / 1024,
+                    Mesh::get_vertex_stride(backpack_model_->get_vertex_format())
+            );
+            // Both passes touch every vertex once, so this is the vertex data fetched before post-transform caching.
+            const auto depth_vertex_bytes = depth_prepass_ ? backpack_model_->get_depth_vertex_bytes() : 0;
+            ImGui::Text(
+                    "Vertex data drawn: %.1f MB (depth prepass: %.1f MB)",
+                    static_cast<float>((vertex_bytes + depth_vertex_bytes) * model_count_) / 1.0e6f,
+                    static_cast<float>(depth_vertex_bytes * model_count_) / 1.0e6f
+            );
+            ImGui::Text("Triangles: %zu", triangle_count_);
+            if (is_meshlet_culling()) {
+                ImGui::Text(
+                        "Meshlets: %zu, frustum culled %zu, back-face culled %zu", meshlet_stats_.meshlet_count,
+                        meshlet_stats_.frustum_culled, meshlet_stats_.backface_culled
+                );
+                ImGui::Text(
+                        "Meshlet triangles: %zu of %zu", meshlet_stats_.visible_triangle_count,
+                        meshlet_stats_.triangle_count
+                );
+            }
+            ImGui::Text("Materials: %zu", draw_list_->get_batch_count());
+            ImGui::Text("Draw calls: %zu", draw_calls_);
+            ImGui::Text("CPU submit: %.3f ms", submit_ms_);
+            ImGui::Text("GPU: %.3f ms", gpu_ms_);
+        }
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Tangent Generation")) {
+            if (ImGui::Button("Benchmark")) {
+                tangent_check_ = check_tangents();
+                tangent_benchmark_ = benchmark_tangents(TANGENT_BENCHMARK_SEGMENTS);
+            }
+            if (tangent_check_) {
+                const auto &[serial_error, single_thread_error, parallel_error, passed] = *tangent_check_;
+                const auto max_error = std::max({serial_error, single_thread_error, parallel_error});
+                ImGui::Text("Quad check: %s (max error %.1e)", passed ? "passed" : "FAILED", max_error);
+            }
+            if (tangent_benchmark_.triangle_count > 0) {
+                ImGui::Text("Triangles: %zu", tangent_benchmark_.triangle_count);
+                ImGui::Text("Serial: %.1f ms", tangent_benchmark_.serial_ms);
+                ImGui::Text("SIMD, 1 thread: %.1f ms", tangent_benchmark_.single_thread_ms);
+                ImGui::Text("SIMD, thread pool: %.1f ms", tangent_benchmark_.parallel_ms);
+            }
+        }
+        ImGui::Separator();
+        if (ImGui::Button("Reset")) {
+            camera_pos_ = glm::vec3{0.0f, 0.0f, GRID_SIDE * SPACING};
+            camera_yaw_ = CAMERA_YAW;
+            camera_pitch_ = CAMERA_PITCH;
+        }
+    }
+    ImGui::End();
+}
+
+void IndirectTest::reshape(const int width, const int height) {
+    width_ = width;
+    height_ = height;
+    aspect_ratio_ = static_cast<float>(width) / static_cast<float>(height);
+}
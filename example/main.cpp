@@ -1,3 +1,4 @@
+#include <chrono>
 #include <imgui.h>
 #include <spdlog/spdlog.h>
 // glad/glad.h must be included before including GLFW/glfw3.h.
@@ -6,6 +7,10 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include "glex/context.h"
+#include "glex/gl_state_cache.h"
+#include "glex/mesh_lod_cache.h"
+#include "glex/program_binary_cache.h"
+#include "glex/resource_cache.h"
 
 void on_frame_buffer_size_changed(GLFWwindow *window, int width, int height);
 void on_key_event(GLFWwindow *window, int key, int scancode, int action, int mods);
@@ -60,13 +65,25 @@ int main() {
     ImGui_ImplOpenGL3_CreateDeviceObjects();
     SPDLOG_INFO("ImGui context loaded");
 
+    // Linked programs are cached on disk, so the next launch skips compiling and linking shaders.
+    ProgramBinaryCache::set_directory("./.cache/program_binary");
+    // Likewise, meshes are simplified into levels of detail only on the first launch.
+    MeshLodCache::set_directory("./.cache/mesh_lod");
+
     // `Context::create()` will load shaders, compile shaders, and link a pipeline program.
+    const auto init_begin = std::chrono::steady_clock::now();
     auto context = Context::create();
     if (!context) {
         SPDLOG_ERROR("Failed to create context object");
         glfwTerminate();
         return -1;
     }
+    const std::chrono::duration<double, std::milli> init_time = std::chrono::steady_clock::now() - init_begin;
+    SPDLOG_INFO(
+            "Context initialized in {:.1f} ms (program binary cache: {} hits, {} misses)", init_time.count(),
+            ProgramBinaryCache::get_hit_count(), ProgramBinaryCache::get_miss_count()
+    );
+    ResourceCache::log_stats();
 
     // Set user pointer
     glfwSetWindowUserPointer(window, context.get());
@@ -96,6 +113,8 @@ int main() {
 
         ImGui::Render(); // Gether draw data.
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData()); // Render draw data.
+        // The ImGui backend changes GL state behind the state cache.
+        GLStateCache::invalidate();
 
         glfwSwapBuffers(window);
     }
@@ -119,7 +138,7 @@ void on_frame_buffer_size_changed(GLFWwindow *window, const int width, const int
     const auto context = static_cast<Context *>(glfwGetWindowUserPointer(window));
     context->reshape(width, height);
     // Set position and size of OpenGL viewport.
-    glViewport(0, 0, width, height);
+    GLStateCache::set_viewport(0, 0, width, height);
 }
 
 void on_key_event(GLFWwindow *window, const int key, const int scancode, const int action, const int mods) {
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstddef>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
@@ -7,8 +8,10 @@
 #include <imgui.h>
 #include <memory>
 #include <spdlog/spdlog.h>
+#include <vector>
 #include "glex/common.h"
 #include "glex/context.h"
+#include "glex/gl_state_cache.h"
 #include "glex/mesh.h"
 
 namespace {
@@ -28,12 +31,7 @@ private:
     std::unique_ptr<Program> simple_program_, pbr_program_;
     std::shared_ptr<Mesh> cube_mesh_, plain_mesh_, sphere_mesh_;
 
-    struct Light {
-        glm::vec3 position;
-        glm::vec3 color;
-    };
-
-    std::vector<Light> lights_;
+    std::vector<PointLight> lights_;
 
     struct Material {
         glm::vec3 albedo;
@@ -44,6 +42,15 @@ private:
     static constexpr Material MATERIAL{glm::vec3{1.0f}, 0.5f, 0.5f, 0.1f};
     Material material_ = MATERIAL;
 
+    static constexpr int SPHERE_COUNT = 7;
+    static constexpr size_t SPHERE_LOD_COUNT = 4;
+
+    /// Level of detail selection, and the level each sphere was drawn at last frame.
+    bool use_lods_{true};
+    LodView lod_view_{};
+    std::vector<size_t> sphere_lods_ = std::vector<size_t>(SPHERE_COUNT * SPHERE_COUNT, 0);
+    size_t triangle_count_{0};
+
 public:
     bool init();
     void render();
@@ -66,7 +73,7 @@ bool PBR::init() {
     // Create meshes.
     cube_mesh_ = Mesh::create_cube();
     plain_mesh_ = Mesh::create_plain();
-    sphere_mesh_ = Mesh::create_sphere();
+    sphere_mesh_ = Mesh::create_sphere(16, 32, {.lod_count = SPHERE_LOD_COUNT});
 
     // Load programs.
     simple_program_ = Program::create("./shader/simple.vs", "./shader/simple.fs");
@@ -77,14 +84,21 @@ bool PBR::init() {
         return false;
     }
 
+    // Share camera and light data between programs.
+    if (!init_uniform_blocks()) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+    bind_uniform_blocks(*pbr_program_);
+
     lights_.emplace_back(glm::vec3{5.0f, 5.0f, 6.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
     lights_.emplace_back(glm::vec3{-4.0f, 5.0f, 7.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
     lights_.emplace_back(glm::vec3{-4.0f, -6.0f, 8.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
     lights_.emplace_back(glm::vec3{5.0f, -6.0f, 9.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
 
     // Enable depth test and cull face.
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    GLStateCache::enable(GL_DEPTH_TEST);
+    GLStateCache::enable(GL_CULL_FACE);
 
     return true;
 }
@@ -104,18 +118,16 @@ void PBR::render() {
     // Projection and view matrix
     // When the `Near` value is too small, inaccurate depth test, known as "z-fighting", arise on far objects,
     // due to the z-value distortion introduced by the projection transform.
-    const auto projection = glm::perspective(glm::radians(45.0f), aspect_ratio_, 0.01f, 150.0f);
+    const auto fovy = glm::radians(45.0f);
+    const auto projection = glm::perspective(fovy, aspect_ratio_, 0.01f, 150.0f);
     const auto view = glm::lookAt(camera_pos_, camera_pos_ + camera_front_, camera_up_);
+    upload_camera_block(view, projection);
+    upload_lights_block(lights_);
+    lod_view_.camera_pos = camera_pos_;
+    lod_view_.projection_scale = LodView::get_projection_scale(fovy, static_cast<float>(height_));
 
     const auto &program = *pbr_program_;
     program.use();
-    for (size_t i = 0; i < lights_.size(); ++i) {
-        const auto pos_name = std::format("lights[{}].position", i);
-        const auto color_name = std::format("lights[{}].color", i);
-        program.set_uniform(pos_name, lights_[i].position);
-        program.set_uniform(color_name, lights_[i].color);
-    }
-    program.set_uniform("viewPos", camera_pos_);
     program.set_uniform("material.albedo", material_.albedo);
     program.set_uniform("material.ao", material_.ao);
     draw_scene(view, projection, program);
@@ -123,19 +135,22 @@ void PBR::render() {
 
 void PBR::draw_scene(const glm::mat4 &view, const glm::mat4 &projection, const Program &program) {
     program.use();
-    const int sphere_count = 7;
+    const int sphere_count = SPHERE_COUNT;
     const float offset = 1.2f;
+    triangle_count_ = 0;
     for (size_t j = 0; j < sphere_count; ++j) {
         const float y = (static_cast<float>(j) - static_cast<float>(sphere_count - 1) * 0.5f) * offset;
         for (size_t i = 0; i < sphere_count; ++i) {
             const float x = (static_cast<float>(i) - static_cast<float>(sphere_count - 1) * 0.5f) * offset;
             const auto model_transform = glm::translate(glm::mat4{1.0f}, glm::vec3{x, y, 0.0f});
-            const auto transform = projection * view * model_transform;
             program.set_uniform("modelTransform", model_transform);
-            program.set_uniform("transform", transform);
             program.set_uniform("material.roughness", static_cast<float>(i + 1) / static_cast<float>(sphere_count));
             program.set_uniform("material.metallic", static_cast<float>(j + 1) / static_cast<float>(sphere_count));
-            sphere_mesh_->draw(program);
+            // Far spheres drop to coarser levels, with hysteresis against switching back and forth every frame.
+            auto &lod = sphere_lods_[j * sphere_count + i];
+            lod = use_lods_ ? sphere_mesh_->select_lod(model_transform, lod_view_, lod) : 0;
+            sphere_mesh_->draw(program, lod);
+            triangle_count_ += sphere_mesh_->get_lod(lod).index_count / 3;
         }
     }
 }
@@ -163,6 +178,21 @@ void PBR::draw_ui() {
             ImGui::SliderFloat("Material AO", &material_.ao, 0.0f, 1.0f);
         }
         ImGui::Separator();
+        if (ImGui::CollapsingHeader("Level of detail", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::Checkbox("Select LODs", &use_lods_);
+            ImGui::SliderFloat("Max screen error (px)", &lod_view_.max_screen_error, 0.1f, 16.0f);
+            ImGui::SliderFloat("Hysteresis", &lod_view_.hysteresis, 0.0f, 0.5f);
+            for (size_t i = 0; i < sphere_mesh_->get_lod_count(); ++i) {
+                const auto &lod = sphere_mesh_->get_lod(i);
+                const auto sphere_count = std::ranges::count(sphere_lods_, i);
+                ImGui::Text(
+                        "LOD %zu: %u triangles, error %.4f, %td spheres", i, lod.index_count / 3, lod.error,
+                        sphere_count
+                );
+            }
+            ImGui::Text("Triangles drawn: %zu", triangle_count_);
+        }
+        ImGui::Separator();
         if (ImGui::Button("Reset")) {
             camera_pos_ = CAMERA_POS;
             camera_yaw_ = CAMERA_YAW;
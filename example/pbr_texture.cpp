@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstddef>
+#include <future>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/geometric.hpp>
@@ -7,10 +11,18 @@
 #include <imgui.h>
 #include <memory>
 #include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+#include <vector>
 #include "glex/common.h"
 #include "glex/context.h"
+#include "glex/gl_state_cache.h"
 #include "glex/image.h"
+#include "glex/instance_buffer.h"
 #include "glex/mesh.h"
+#include "glex/sampler.h"
+#include "glex/texture_uploader.h"
+#include "glex/thread_pool.h"
 
 namespace {
 
@@ -22,26 +34,79 @@ namespace {
         std::shared_ptr<Mesh> mesh;
     };
 
+    /// Copies of the maps decoded per run of the decode benchmark, so that more threads than maps have work.
+    constexpr size_t DECODE_BENCHMARK_COPIES{4};
+
+    /// Throughput of `Image::load_many` with a number of decoding threads.
+    struct DecodeBenchmark {
+        size_t thread_count{0};
+        size_t image_count{0};
+        double milliseconds{0.0};
+        double megabytes_per_second{0.0};
+    };
+
+    /// Decodes the images on a pool of its own with the given number of threads.
+    DecodeBenchmark benchmark_decode(const std::vector<std::string> &filepaths, const size_t thread_count) {
+        const auto pool = ThreadPool::create(thread_count);
+        const auto begin = std::chrono::steady_clock::now();
+        const auto images = Image::load_many(filepaths, {.flip_vertical = false, .pool = pool.get()});
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        size_t total_bytes = 0;
+        for (const auto &image : images) {
+            if (image) {
+                total_bytes += image->get_byte_size();
+            }
+        }
+        const auto megabytes = static_cast<double>(total_bytes) / (1024.0 * 1024.0);
+        return {
+                .thread_count = thread_count,
+                .image_count = images.size(),
+                .milliseconds = elapsed.count() * 1000.0,
+                .megabytes_per_second = megabytes / std::max(elapsed.count(), 1e-9),
+        };
+    }
+
 } // namespace
 
 class PBRTexture : Context {
     std::unique_ptr<Program> simple_program_, pbr_program_;
     std::shared_ptr<Mesh> cube_mesh_, plain_mesh_, sphere_mesh_;
+    std::unique_ptr<InstanceBuffer> sphere_instances_;
 
     struct Material {
-        std::unique_ptr<Texture> albedo;
-        std::unique_ptr<Texture> normal;
-        std::unique_ptr<Texture> metallic;
-        std::unique_ptr<Texture> roughness;
+        std::shared_ptr<Texture> albedo;
+        std::shared_ptr<Texture> normal;
+        std::shared_ptr<Texture> metallic;
+        std::shared_ptr<Texture> roughness;
         float ao;
     };
     Material material_;
 
-    struct Light {
-        glm::vec3 position;
-        glm::vec3 color;
+    /// Image files of the maps, in the order of `MATERIAL_MAPS`.
+    static constexpr std::array MAP_FILES{
+            "./image/rusted_iron/rustediron2_basecolor.png",
+            "./image/rusted_iron/rustediron2_normal.png",
+            "./image/rusted_iron/rustediron2_metallic.png",
+            "./image/rusted_iron/rustediron2_roughness.png",
     };
-    std::vector<Light> lights;
+    static constexpr std::array MATERIAL_MAPS{
+            &Material::albedo,
+            &Material::normal,
+            &Material::metallic,
+            &Material::roughness,
+    };
+
+    ///@{
+    /// Maps reloaded while rendering. They replace the current maps once all of them are resident.
+    std::unique_ptr<TextureUploader> texture_uploader_;
+    std::array<std::future<std::unique_ptr<Image>>, MAP_FILES.size()> decoding_maps_;
+    std::array<std::shared_ptr<Texture>, MAP_FILES.size()> uploading_maps_;
+    ///@}
+
+    /// Decode throughput for each thread count of the last benchmark run
+    std::vector<DecodeBenchmark> decode_benchmarks_;
+
+    std::vector<PointLight> lights;
 
 public:
     bool init();
@@ -49,6 +114,14 @@ public:
     void draw_ui();
     void draw_scene(const glm::mat4 &view, const glm::mat4 &projection, const Program &program);
     void reshape(int width, int height);
+    void reload_maps();
+    void update_maps();
+    void run_decode_benchmark();
+
+    /// The maps have immutable storage and share one sampler.
+    static TextureOptions get_map_options() {
+        return {.immutable = true, .sampler = Sampler::create_shared()};
+    }
 };
 
 std::unique_ptr<Context> Context::create() {
@@ -67,28 +140,61 @@ bool PBRTexture::init() {
     plain_mesh_ = Mesh::create_plain();
     sphere_mesh_ = Mesh::create_sphere();
 
-    material_.albedo = Texture::create(*Image::load("./image/rusted_iron/rustediron2_basecolor.png", false));
-    material_.normal = Texture::create(*Image::load("./image/rusted_iron/rustediron2_normal.png", false));
-    material_.metallic = Texture::create(*Image::load("./image/rusted_iron/rustediron2_metallic.png", false));
-    material_.roughness = Texture::create(*Image::load("./image/rusted_iron/rustediron2_roughness.png", false));
+    // Lay out a grid of spheres.
+    const int sphere_count = 7;
+    const float offset = 1.2f;
+    std::vector<InstanceData> spheres;
+    spheres.reserve(sphere_count * sphere_count);
+    for (size_t j = 0; j < sphere_count; ++j) {
+        const float y = (static_cast<float>(j) - static_cast<float>(sphere_count - 1) * 0.5f) * offset;
+        for (size_t i = 0; i < sphere_count; ++i) {
+            const float x = (static_cast<float>(i) - static_cast<float>(sphere_count - 1) * 0.5f) * offset;
+            spheres.push_back({.model_transform = glm::translate(glm::mat4{1.0f}, glm::vec3{x, y, 0.0f})});
+        }
+    }
+    sphere_instances_ = InstanceBuffer::create(spheres);
+    if (!sphere_instances_) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+
+    // Decode the maps in parallel, and stream them to the GPU over the first frames.
+    texture_uploader_ = TextureUploader::create();
+    if (!texture_uploader_) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+    auto images = Image::load_many({MAP_FILES.begin(), MAP_FILES.end()}, {.flip_vertical = false});
+    for (size_t i = 0; i < MAP_FILES.size(); ++i) {
+        material_.*MATERIAL_MAPS[i] = texture_uploader_->upload(std::move(images[i]), get_map_options());
+    }
 
     // Load programs.
     simple_program_ = Program::create("./shader/simple.vs", "./shader/simple.fs");
-    pbr_program_ = Program::create("./shader/pbr_texture.vs", "./shader/pbr_texture.fs");
+    pbr_program_ = Program::create(
+            "./shader/pbr_texture.vs", "./shader/pbr_texture.fs", ShaderDefines{}.set("INSTANCED")
+    );
 
     if (!simple_program_ || !pbr_program_) {
         SPDLOG_ERROR("Failed to initialize context");
         return false;
     }
 
+    // Share camera and light data between programs.
+    if (!init_uniform_blocks()) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+    bind_uniform_blocks(*pbr_program_);
+
     lights.emplace_back(glm::vec3{5.0f, 5.0f, 6.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
     lights.emplace_back(glm::vec3{-4.0f, 5.0f, 7.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
     lights.emplace_back(glm::vec3{-4.0f, -6.0f, 8.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
     lights.emplace_back(glm::vec3{5.0f, -6.0f, 9.0f}, glm::vec3{40.0f, 40.0f, 40.0f});
 
     // Enable depth test and cull face.
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    GLStateCache::enable(GL_DEPTH_TEST);
+    GLStateCache::enable(GL_CULL_FACE);
 
     return true;
 }
@@ -100,6 +206,10 @@ void PBRTexture::render() {
     // Dear ImGui UI
     draw_ui();
 
+    // Copy the next rows of the streamed maps within the upload budget.
+    update_maps();
+    texture_uploader_->update();
+
     // Calculate camera front direction.
     camera_front_ = glm::rotate(glm::mat4{1.0f}, glm::radians(camera_yaw_), glm::vec3{0.0f, 1.0f, 0.0f}) *
                     glm::rotate(glm::mat4{1.0f}, glm::radians(camera_pitch_), glm::vec3{1.0f, 0.0f, 0.0f}) *
@@ -110,24 +220,15 @@ void PBRTexture::render() {
     // due to the z-value distortion introduced by the projection transform.
     const auto projection = glm::perspective(glm::radians(45.0f), aspect_ratio_, 0.01f, 150.0f);
     const auto view = glm::lookAt(camera_pos_, camera_pos_ + camera_front_, camera_up_);
+    upload_camera_block(view, projection);
+    upload_lights_block(lights);
 
     const auto &program = *pbr_program_;
     program.use();
-    for (size_t i = 0; i < lights.size(); ++i) {
-        const auto pos_name = std::format("lights[{}].position", i);
-        const auto color_name = std::format("lights[{}].color", i);
-        program.set_uniform(pos_name, lights[i].position);
-        program.set_uniform(color_name, lights[i].color);
-    }
-    program.set_uniform("viewPos", camera_pos_);
-    glActiveTexture(GL_TEXTURE0);
-    material_.albedo->bind();
-    glActiveTexture(GL_TEXTURE1);
-    material_.normal->bind();
-    glActiveTexture(GL_TEXTURE2);
-    material_.metallic->bind();
-    glActiveTexture(GL_TEXTURE3);
-    material_.roughness->bind();
+    material_.albedo->bind_to_unit(0);
+    material_.normal->bind_to_unit(1);
+    material_.metallic->bind_to_unit(2);
+    material_.roughness->bind_to_unit(3);
     program.set_uniform("material.albedo", 0);
     program.set_uniform("material.normal", 1);
     program.set_uniform("material.metallic", 2);
@@ -138,19 +239,7 @@ void PBRTexture::render() {
 
 void PBRTexture::draw_scene(const glm::mat4 &view, const glm::mat4 &projection, const Program &program) {
     program.use();
-    const int sphere_count = 7;
-    const float offset = 1.2f;
-    for (size_t j = 0; j < sphere_count; ++j) {
-        const float y = (static_cast<float>(j) - static_cast<float>(sphere_count - 1) * 0.5f) * offset;
-        for (size_t i = 0; i < sphere_count; ++i) {
-            const float x = (static_cast<float>(i) - static_cast<float>(sphere_count - 1) * 0.5f) * offset;
-            const auto model_transform = glm::translate(glm::mat4{1.0f}, glm::vec3{x, y, 0.0f});
-            const auto transform = projection * view * model_transform;
-            program.set_uniform("modelTransform", model_transform);
-            program.set_uniform("transform", transform);
-            sphere_mesh_->draw(program);
-        }
-    }
+    sphere_mesh_->draw_instanced(program, *sphere_instances_);
 }
 
 void PBRTexture::draw_ui() {
@@ -173,6 +262,26 @@ void PBRTexture::draw_ui() {
             ImGui::SliderFloat("Material AO", &material_.ao, 0.0f, 1.0f);
         }
         ImGui::Separator();
+        if (ImGui::CollapsingHeader("Streaming", ImGuiTreeNodeFlags_DefaultOpen)) {
+            const auto &stats = texture_uploader_->get_stats();
+            ImGui::Text("Pending textures: %zu", stats.pending_textures);
+            ImGui::Text("Uploaded this frame: %.1f KB", static_cast<float>(stats.bytes_last_frame) / 1024.0f);
+            ImGui::Text("Uploaded total: %.1f MB", static_cast<float>(stats.bytes_total) / (1024.0f * 1024.0f));
+            ImGui::Text("Resident textures: %zu", stats.resident_textures);
+            if (ImGui::Button("Reload maps")) {
+                reload_maps();
+            }
+            if (ImGui::Button("Benchmark decoding")) {
+                run_decode_benchmark();
+            }
+            for (const auto &benchmark : decode_benchmarks_) {
+                ImGui::Text(
+                        "%zu threads: %zu images in %.1f ms, %.1f MB/s", benchmark.thread_count, benchmark.image_count,
+                        benchmark.milliseconds, benchmark.megabytes_per_second
+                );
+            }
+        }
+        ImGui::Separator();
         if (ImGui::Button("Reset")) {
             camera_pos_ = CAMERA_POS;
             camera_yaw_ = CAMERA_YAW;
@@ -187,3 +296,49 @@ void PBRTexture::reshape(const int width, const int height) {
     height_ = height;
     aspect_ratio_ = static_cast<float>(width) / static_cast<float>(height);
 }
+
+void PBRTexture::reload_maps() {
+    for (size_t i = 0; i < MAP_FILES.size(); ++i) {
+        if (!decoding_maps_[i].valid()) {
+            decoding_maps_[i] = ThreadPool::get_default().submit([filepath = std::string{MAP_FILES[i]}] {
+                return Image::load(filepath, false);
+            });
+        }
+    }
+}
+
+void PBRTexture::update_maps() {
+    bool complete = true;
+    for (size_t i = 0; i < MAP_FILES.size(); ++i) {
+        auto &decoding = decoding_maps_[i];
+        if (decoding.valid() && decoding.wait_for(std::chrono::seconds{0}) == std::future_status::ready) {
+            uploading_maps_[i] = texture_uploader_->upload(decoding.get(), get_map_options());
+            if (!uploading_maps_[i]) {
+                // Keep the previous map of the slot, so that the other maps still swap in.
+                SPDLOG_ERROR("Failed to reload map \"{}\"", MAP_FILES[i]);
+                uploading_maps_[i] = material_.*MATERIAL_MAPS[i];
+            }
+        }
+        complete = complete && !decoding.valid() && uploading_maps_[i] && uploading_maps_[i]->is_resident();
+    }
+    if (complete) {
+        // Swap all maps at once, so that the placeholders are never visible.
+        for (size_t i = 0; i < MAP_FILES.size(); ++i) {
+            material_.*MATERIAL_MAPS[i] = std::move(uploading_maps_[i]);
+        }
+    }
+}
+
+void PBRTexture::run_decode_benchmark() {
+    std::vector<std::string> filepaths;
+    for (size_t copy = 0; copy < DECODE_BENCHMARK_COPIES; ++copy) {
+        filepaths.insert(filepaths.end(), MAP_FILES.begin(), MAP_FILES.end());
+    }
+    // Double the threads up to the hardware threads, which always get a run of their own.
+    const size_t hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    decode_benchmarks_.clear();
+    for (size_t thread_count = 1; thread_count < hardware_threads; thread_count *= 2) {
+        decode_benchmarks_.push_back(benchmark_decode(filepaths, thread_count));
+    }
+    decode_benchmarks_.push_back(benchmark_decode(filepaths, hardware_threads));
+}
@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <format>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
@@ -9,12 +13,20 @@
 #include <memory>
 #include <random>
 #include <spdlog/spdlog.h>
+#include <vector>
 #include "glex/common.h"
 #include "glex/context.h"
 #include "glex/framebuffer.h"
+#include "glex/frustum.h"
+#include "glex/geometry_pool.h"
+#include "glex/gl_state_cache.h"
 #include "glex/image.h"
 #include "glex/mesh.h"
 #include "glex/model.h"
+#include "glex/occlusion_buffer.h"
+#include "glex/occlusion_query.h"
+#include "glex/render_queue.h"
+#include "glex/resource_cache.h"
 #include "glex/texture.h"
 
 struct Object {
@@ -27,33 +39,138 @@ struct Object {
     bool outline;
 };
 
+namespace {
+
+    /// Far plane of the camera, which also bounds the depth buckets of the render queue.
+    constexpr float CAMERA_FAR{100.0f};
+
+    /// Spheres generated to benchmark frustum culling.
+    constexpr size_t CULLING_BENCHMARK_OBJECTS{100000};
+    /// Runs of each culling routine, to average out the timer resolution.
+    constexpr size_t CULLING_BENCHMARK_RUNS{20};
+
+    /// Timings of frustum culling in milliseconds per run.
+    struct CullingBenchmark {
+        size_t object_count{0};
+        size_t visible_count{0};
+        /// `Frustum::intersects` per sphere.
+        float scalar_ms{0.0f};
+        /// `BoundingSphereSet::cull`.
+        float simd_ms{0.0f};
+    };
+
+    /// Times culling randomly placed spheres around the origin against the frustum.
+    CullingBenchmark benchmark_culling(const Frustum &frustum, const size_t object_count) {
+        std::mt19937 gen{42};
+        std::uniform_real_distribution<float> dis_pos{-50.0f, 50.0f};
+        std::uniform_real_distribution<float> dis_radius{0.1f, 2.0f};
+        std::vector<BoundingSphere> spheres;
+        spheres.reserve(object_count);
+        BoundingSphereSet sphere_set;
+        sphere_set.reserve(object_count);
+        for (size_t i = 0; i < object_count; ++i) {
+            spheres.push_back({.center = {dis_pos(gen), dis_pos(gen), dis_pos(gen)}, .radius = dis_radius(gen)});
+            sphere_set.add(spheres.back(), glm::mat4{1.0f});
+        }
+        std::vector<uint32_t> visible;
+        visible.reserve(object_count);
+        const auto time_ms = [&](const auto &cull) {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t run = 0; run < CULLING_BENCHMARK_RUNS; ++run) {
+                cull();
+            }
+            const auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<float, std::milli>(end - start).count() / CULLING_BENCHMARK_RUNS;
+        };
+        CullingBenchmark result{.object_count = object_count};
+        result.scalar_ms = time_ms([&] {
+            visible.clear();
+            for (size_t i = 0; i < spheres.size(); ++i) {
+                if (frustum.intersects(spheres[i])) {
+                    visible.push_back(static_cast<uint32_t>(i));
+                }
+            }
+        });
+        result.simd_ms = time_ms([&] { sphere_set.cull(frustum, visible); });
+        result.visible_count = visible.size();
+        SPDLOG_INFO(
+                "Frustum culling of {} spheres, {} visible: scalar {:.3f} ms, SIMD {:.3f} ms", result.object_count,
+                result.visible_count, result.scalar_ms, result.simd_ms
+        );
+        return result;
+    }
+
+} // namespace
+
 class SSAO : Context {
-    std::unique_ptr<Program> simple_program_, deferred_geo_program_, deferred_light_program_, ssao_program_,
-            blur_program_;
+    std::unique_ptr<Program> simple_program_, deferred_geo_program_, deferred_light_program_,
+            deferred_light_ssao_program_, ssao_program_, blur_program_;
     std::unique_ptr<FrameBuffer> geo_framebuffer_, ssao_framebuffer_, blur_framebuffer_;
 
-    std::unique_ptr<Model> backpack_model_;
+    std::shared_ptr<Model> backpack_model_;
+    /// Pool of the model meshes, kept for its stats.
+    std::shared_ptr<GeometryPool> geometry_pool_;
     std::unique_ptr<Texture> ssao_noise_texture_;
     std::shared_ptr<Mesh> cube_mesh_, plain_mesh_;
     std::shared_ptr<Material> floor_material_, cube_material1_, cube_material2_;
 
-    struct DeferLight {
-        glm::vec3 position;
-        glm::vec3 color;
-    };
-    std::vector<DeferLight> deferred_lights{32};
+    std::vector<PointLight> deferred_lights{32};
+    UniformHandle ssao_samples_handle_;
 
     std::vector<glm::vec3> ssao_samples{16};
     float ssao_radius{1.0f};
     float ssao_power{1.0f};
     bool use_ssao{false};
 
+    GLStateCache::Stats state_stats_{};
+
+    ///@{
+    /// Frustum culling of the objects of `draw_scene`, against the frustum of the last call.
+    bool frustum_culling_{true};
+    Frustum frustum_{};
+    BoundingSphereSet object_spheres_;
+    std::vector<uint32_t> visible_objects_;
+    FrustumCullStats cull_stats_{};
+    CullingBenchmark culling_benchmark_;
+    ///@}
+
+    ///@{
+    /// Occlusion culling of the objects left by frustum culling, with the cubes as occluders.
+    bool occlusion_culling_{true};
+    std::unique_ptr<OcclusionBuffer> occlusion_buffer_;
+    OcclusionCullStats occlusion_stats_{};
+    float occlusion_ms_{0.0f};
+    /// The level of the occlusion buffer shown in its debug view.
+    int occlusion_view_level_{0};
+    std::unique_ptr<Texture> occlusion_view_texture_;
+    std::vector<uint32_t> occlusion_view_pixels_;
+    ///@}
+
+    ///@{
+    /// Occlusion queries on the GPU for the objects left by the culling on the CPU.
+    bool occlusion_queries_enabled_{false};
+    std::unique_ptr<OcclusionQueryPool> occlusion_queries_;
+    OcclusionQueryStats occlusion_query_stats_{};
+    ///@}
+
+    ///@{
+    /// Draws of `draw_scene` when occlusion queries are off, sorted by state unless disabled.
+    bool sort_draws_{true};
+    RenderQueue render_queue_;
+    float sort_ms_{0.0f};
+    ///@}
+
 public:
     bool init();
     void render();
     void draw_ui();
     void draw_scene(const glm::mat4 &view, const glm::mat4 &projection, const Program &program);
     void reshape(int width, int height);
+
+private:
+    /// Uploads a level of the occlusion buffer to `occlusion_view_texture_`, scaled up to the size of the buffer. The
+    /// nearest depth is white and the empty texels are black.
+    void update_occlusion_view(size_t level);
 };
 
 std::unique_ptr<Context> Context::create() {
@@ -71,41 +188,71 @@ bool SSAO::init() {
     cube_mesh_ = Mesh::create_cube();
     plain_mesh_ = Mesh::create_plain();
 
-    // Load model.
-    backpack_model_ = Model::load("./model/backpack/backpack.obj");
-
-    // Load programs.
-    simple_program_ = Program::create("./shader/simple.vs", "./shader/simple.fs");
-    deferred_geo_program_ = Program::create("./shader/defer_geo.vs", "./shader/defer_geo.fs");
-    deferred_light_program_ = Program::create("./shader/defer_light.vs", "./shader/defer_light.fs");
-    ssao_program_ = Program::create("./shader/ssao.vs", "./shader/ssao.fs");
-    blur_program_ = Program::create("./shader/blur_5x5.vs", "./shader/blur_5x5.fs");
+    // Load programs. Submit all of them before checking any result so that the driver can compile them in parallel.
+    auto pending_simple = Program::create_async("./shader/simple.vs", "./shader/simple.fs");
+    auto pending_deferred_geo = Program::create_async("./shader/defer_geo.vs", "./shader/defer_geo.fs");
+    // The lighting pass is specialized for the number of lights, with and without SSAO.
+    const auto light_defines = ShaderDefines{}.set("MAX_LIGHTS", static_cast<int>(deferred_lights.size()));
+    const auto light_ssao_defines = ShaderDefines(light_defines).set("USE_SSAO");
+    const auto ssao_defines = ShaderDefines{}.set("KERNEL_SIZE", static_cast<int>(ssao_samples.size()));
+    auto pending_deferred_light =
+            Program::create_async("./shader/defer_light.vs", "./shader/defer_light.fs", light_defines);
+    auto pending_deferred_light_ssao =
+            Program::create_async("./shader/defer_light.vs", "./shader/defer_light.fs", light_ssao_defines);
+    auto pending_ssao = Program::create_async("./shader/ssao.vs", "./shader/ssao.fs", ssao_defines);
+    auto pending_blur = Program::create_async("./shader/blur_5x5.vs", "./shader/blur_5x5.fs");
+
+    // Load model while the driver compiles the shaders.
+    backpack_model_ = ResourceCache::get_model("./model/backpack/backpack.obj", {.pooled = true});
+    geometry_pool_ = Mesh::get_geometry_pool();
+
+    simple_program_ = pending_simple.get();
+    deferred_geo_program_ = pending_deferred_geo.get();
+    deferred_light_program_ = pending_deferred_light.get();
+    deferred_light_ssao_program_ = pending_deferred_light_ssao.get();
+    ssao_program_ = pending_ssao.get();
+    blur_program_ = pending_blur.get();
+
+    if (!simple_program_ || !deferred_geo_program_ || !deferred_light_program_ || !deferred_light_ssao_program_ ||
+        !ssao_program_ || !blur_program_) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
 
-    if (!simple_program_ || !deferred_geo_program_ || !deferred_light_program_ || !ssao_program_ || !blur_program_) {
+    // Share camera and light data between programs.
+    if (!init_uniform_blocks()) {
         SPDLOG_ERROR("Failed to initialize context");
         return false;
     }
+    for (const auto &program :
+         {deferred_geo_program_.get(), deferred_light_program_.get(), deferred_light_ssao_program_.get(),
+          ssao_program_.get()}) {
+        bind_uniform_blocks(*program);
+    }
+
+    // Resolve uniform arrays updated every frame.
+    ssao_samples_handle_ = ssao_program_->get_uniform_handle("samples");
 
     // Create dark gray single color texture.
     auto dark_gray_image = Image::create(512, 512);
     dark_gray_image->set_single_color_image({0.2f, 0.2f, 0.2f, 1.0f});
-    std::shared_ptr dark_gray_texture = Texture::create(*dark_gray_image);
+    const auto dark_gray_texture = ResourceCache::get_texture(*dark_gray_image);
     // Create gray single color texture.
     auto gray_image = Image::create(512, 512);
     gray_image->set_single_color_image({0.5f, 0.5f, 0.5f, 1.0f});
-    std::shared_ptr gray_texture = Texture::create(*gray_image);
+    const auto gray_texture = ResourceCache::get_texture(*gray_image);
 
     // Create plain material.
-    std::shared_ptr plain_diffuse = Texture::create(*Image::load("./image/marble.jpg"));
+    const auto plain_diffuse = ResourceCache::get_texture("./image/marble.jpg");
     floor_material_ = std::make_shared<Material>(plain_diffuse, gray_texture, 8.0f);
 
     // Create cube1 material.
-    std::shared_ptr cube_diffuse1 = Texture::create(*Image::load("./image/container.jpg"));
+    const auto cube_diffuse1 = ResourceCache::get_texture("./image/container.jpg");
     cube_material1_ = std::make_shared<Material>(cube_diffuse1, dark_gray_texture, 16.0f);
 
     // Create cube2 material.
-    std::shared_ptr cube_diffuse2 = Texture::create(*Image::load("./image/container2.png"));
-    std::shared_ptr cube_specular2 = Texture::create(*Image::load("./image/container2_specular.png"));
+    const auto cube_diffuse2 = ResourceCache::get_texture("./image/container2.png");
+    const auto cube_specular2 = ResourceCache::get_texture("./image/container2_specular.png");
     cube_material2_ = std::make_shared<Material>(cube_diffuse2, cube_specular2, 64.0f);
 
     std::random_device rd;
@@ -133,6 +280,17 @@ bool SSAO::init() {
     ssao_noise_texture_->set_wrap(GL_REPEAT, GL_REPEAT);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 4, 4, GL_RGB, GL_FLOAT, ssao_noise.data());
 
+    occlusion_buffer_ = OcclusionBuffer::create();
+    occlusion_queries_ = OcclusionQueryPool::create();
+    if (!occlusion_buffer_ || !occlusion_queries_) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+    occlusion_view_texture_ =
+            Texture::create(occlusion_buffer_->get_width(), occlusion_buffer_->get_height(), GL_RGBA);
+    occlusion_view_texture_->bind();
+    occlusion_view_texture_->set_filter(GL_NEAREST, GL_NEAREST);
+
     for (size_t i = 0; i < ssao_samples.size(); ++i) {
         auto sample = glm::vec3{dis_neg_one_to_one(gen), dis_neg_one_to_one(gen), dis_zero_to_one(gen)};
         sample = glm::normalize(sample) * dis_zero_to_one(gen);
@@ -144,8 +302,8 @@ bool SSAO::init() {
     }
 
     // Enable depth test and cull face.
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    GLStateCache::enable(GL_DEPTH_TEST);
+    GLStateCache::enable(GL_CULL_FACE);
 
     // Set clear color.
     glClearColor(0.0f, 0.1f, 0.2f, 0.0f);
@@ -164,6 +322,10 @@ static glm::mat4 get_view_transform(const glm::vec3 &position, const glm::vec3 &
 }
 
 void SSAO::render() {
+    // Keep the state changes of the previous frame for the UI.
+    state_stats_ = GLStateCache::get_stats();
+    GLStateCache::reset_stats();
+
     // Clear color buffer with `glClearColor` and depth buffer with 1.0.
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
@@ -178,91 +340,77 @@ void SSAO::render() {
     // Projection and view matrix
     // When the `Near` value is too small, inaccurate depth test, known as "z-fighting", arise on far objects,
     // due to the z-value distortion introduced by the projection transform.
-    const auto projection = glm::perspective(glm::radians(45.0f), aspect_ratio_, 0.1f, 100.0f);
+    const auto projection = glm::perspective(glm::radians(45.0f), aspect_ratio_, 0.1f, CAMERA_FAR);
     const auto view = glm::lookAt(camera_pos_, camera_pos_ + camera_front_, camera_up_);
+    upload_camera_block(view, projection);
+    upload_lights_block(deferred_lights);
 
     // Render first path.
     geo_framebuffer_->bind();
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glViewport(0, 0, width_, height_);
+    GLStateCache::set_viewport(0, 0, width_, height_);
     draw_scene(view, projection, *deferred_geo_program_);
 
-    // SSAO path.
-    ssao_framebuffer_->bind();
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glViewport(0, 0, width_, height_);
-    ssao_program_->use();
-    glActiveTexture(GL_TEXTURE0);
-    geo_framebuffer_->get_color_attachment(0)->bind();
-    glActiveTexture(GL_TEXTURE1);
-    geo_framebuffer_->get_color_attachment(1)->bind();
-    glActiveTexture(GL_TEXTURE2);
-    ssao_noise_texture_->bind();
-    glActiveTexture(GL_TEXTURE0);
-    ssao_program_->set_uniform("gPosition", 0);
-    ssao_program_->set_uniform("gNormal", 1);
-    ssao_program_->set_uniform("texNoise", 2);
-    const auto noise_scale = glm::vec2{
-            static_cast<float>(width_) / static_cast<float>(ssao_noise_texture_->get_width()),
-            static_cast<float>(height_) / static_cast<float>(ssao_noise_texture_->get_height()),
-    };
-    ssao_program_->set_uniform("noiseScale", noise_scale);
-    ssao_program_->set_uniform("radius", ssao_radius);
-    ssao_program_->set_uniform("power", ssao_power);
-    for (size_t i = 0; i < ssao_samples.size(); ++i) {
-        auto sample_name = std::format("samples[{}]", i);
-        ssao_program_->set_uniform(sample_name, ssao_samples[i]);
+    // SSAO is skipped entirely when the lighting pass does not use it.
+    if (use_ssao) {
+        // SSAO path.
+        ssao_framebuffer_->bind();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        GLStateCache::set_viewport(0, 0, width_, height_);
+        ssao_program_->use();
+        geo_framebuffer_->get_color_attachment(0)->bind_to_unit(0);
+        geo_framebuffer_->get_color_attachment(1)->bind_to_unit(1);
+        ssao_noise_texture_->bind_to_unit(2);
+        ssao_program_->set_uniform("gPosition", 0);
+        ssao_program_->set_uniform("gNormal", 1);
+        ssao_program_->set_uniform("texNoise", 2);
+        const auto noise_scale = glm::vec2{
+                static_cast<float>(width_) / static_cast<float>(ssao_noise_texture_->get_width()),
+                static_cast<float>(height_) / static_cast<float>(ssao_noise_texture_->get_height()),
+        };
+        ssao_program_->set_uniform("noiseScale", noise_scale);
+        ssao_program_->set_uniform("radius", ssao_radius);
+        ssao_program_->set_uniform("power", ssao_power);
+        ssao_program_->set_uniform(ssao_samples_handle_, ssao_samples);
+        ssao_program_->set_uniform("transform", glm::scale(glm::mat4{1.0f}, glm::vec3{2.0f}));
+        plain_mesh_->draw(*ssao_program_);
+
+        // Blur SSAO result.
+        blur_framebuffer_->bind();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        GLStateCache::set_viewport(0, 0, width_, height_);
+        blur_program_->use();
+        ssao_framebuffer_->get_color_attachment()->bind_to_unit(0);
+        blur_program_->set_uniform("tex", 0);
+        blur_program_->set_uniform("transform", glm::scale(glm::mat4{1.0f}, glm::vec3{2.0f}));
+        plain_mesh_->draw(*blur_program_);
     }
-    ssao_program_->set_uniform("transform", glm::scale(glm::mat4{1.0f}, glm::vec3{2.0f}));
-    ssao_program_->set_uniform("view", view);
-    ssao_program_->set_uniform("projection", projection);
-    plain_mesh_->draw(*ssao_program_);
-
-    // Blur SSAO result.
-    blur_framebuffer_->bind();
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glViewport(0, 0, width_, height_);
-    blur_program_->use();
-    glActiveTexture(GL_TEXTURE0);
-    ssao_framebuffer_->get_color_attachment()->bind();
-    blur_program_->set_uniform("tex", 0);
-    blur_program_->set_uniform("transform", glm::scale(glm::mat4{1.0f}, glm::vec3{2.0f}));
-    plain_mesh_->draw(*blur_program_);
 
     // Set to default framebuffer.
     FrameBuffer::bind_to_default();
-    glViewport(0, 0, width_, height_);
+    GLStateCache::set_viewport(0, 0, width_, height_);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
     // Render last path.
-    deferred_light_program_->use();
+    const auto &deferred_light_program = use_ssao ? *deferred_light_ssao_program_ : *deferred_light_program_;
+    deferred_light_program.use();
     for (size_t i = 0; i < 3; ++i) {
-        glActiveTexture(GL_TEXTURE0 + i);
-        geo_framebuffer_->get_color_attachment(i)->bind();
+        geo_framebuffer_->get_color_attachment(i)->bind_to_unit(i);
     }
-    glActiveTexture(GL_TEXTURE3);
-    blur_framebuffer_->get_color_attachment()->bind();
-    glActiveTexture(GL_TEXTURE0);
-    deferred_light_program_->set_uniform("gPosition", 0);
-    deferred_light_program_->set_uniform("gNormal", 1);
-    deferred_light_program_->set_uniform("gAlbedoSpec", 2);
-    deferred_light_program_->set_uniform("ssao", 3);
-    deferred_light_program_->set_uniform("useSsao", use_ssao);
-    for (size_t i = 0; i < deferred_lights.size(); ++i) {
-        auto pos_name = std::format("lights[{}].position", i);
-        auto color_name = std::format("lights[{}].color", i);
-        deferred_light_program_->set_uniform(pos_name, deferred_lights[i].position);
-        deferred_light_program_->set_uniform(color_name, deferred_lights[i].color);
-    }
-    deferred_light_program_->set_uniform("transform", glm::scale(glm::mat4{1.0f}, glm::vec3{2.0f}));
-    plain_mesh_->draw(*deferred_light_program_);
+    blur_framebuffer_->get_color_attachment()->bind_to_unit(3);
+    deferred_light_program.set_uniform("gPosition", 0);
+    deferred_light_program.set_uniform("gNormal", 1);
+    deferred_light_program.set_uniform("gAlbedoSpec", 2);
+    deferred_light_program.set_uniform("ssao", 3);
+    deferred_light_program.set_uniform("transform", glm::scale(glm::mat4{1.0f}, glm::vec3{2.0f}));
+    plain_mesh_->draw(deferred_light_program);
 
     // Copy depth buffer to the default framebuffer.
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, geo_framebuffer_->get());
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    GLStateCache::bind_framebuffer(GL_READ_FRAMEBUFFER, geo_framebuffer_->get());
+    GLStateCache::bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0);
     glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, 0);
 
     // Draw cube for indicating light positions.
     simple_program_->use();
@@ -283,25 +431,104 @@ void SSAO::draw_scene(const glm::mat4 &view, const glm::mat4 &projection, const
             {{3.0f, 1.75f, -2.0f}, {1.5f, 1.5f, 1.5f}, {0.0f, 1.0f, 0.0f}, 50.0f, cube_mesh_, cube_material2_, false},
     };
 
-    program.use();
+    constexpr size_t cube_count = std::size(cubes);
+    std::array<glm::mat4, cube_count + 1> transforms;
+    for (size_t i = 0; i < cube_count; ++i) {
+        const auto &[pos, scale, rot_dir, angle, mesh, material, outline] = cubes[i];
+        transforms[i] = glm::translate(glm::mat4{1.0f}, pos) * glm::scale(glm::mat4{1.0f}, scale) *
+                        glm::rotate(glm::mat4{1.0f}, glm::radians(angle), rot_dir);
+    }
+    transforms[cube_count] = glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 0.55f, 0.0f}) *
+                             glm::rotate(glm::mat4{1.0f}, glm::radians(-90.0f), glm::vec3{1.0f, 0.0f, 0.0f}) *
+                             glm::scale(glm::mat4{1.0f}, glm::vec3{0.5f});
+
+    // The backpack is the last object.
+    object_spheres_.clear();
+    for (size_t i = 0; i < cube_count; ++i) {
+        object_spheres_.add(cubes[i].mesh->get_bounding_sphere(), transforms[i]);
+    }
+    object_spheres_.add(backpack_model_->get_bounding_sphere(), transforms[cube_count]);
+    frustum_ = Frustum::from_matrix(projection * view);
+    cull_stats_ = {};
+    if (frustum_culling_) {
+        object_spheres_.cull(frustum_, visible_objects_, &cull_stats_);
+    } else {
+        visible_objects_.resize(object_spheres_.size());
+        for (size_t i = 0; i < visible_objects_.size(); ++i) {
+            visible_objects_[i] = static_cast<uint32_t>(i);
+        }
+        cull_stats_.visible_count = visible_objects_.size();
+    }
 
-    for (const auto &[pos, scale, rot_dir, angle, mesh, material, outline] : cubes) {
-        auto model_transform = glm::translate(glm::mat4{1.0f}, pos) * glm::scale(glm::mat4{1.0f}, scale) *
-                               glm::rotate(glm::mat4{1.0f}, glm::radians(angle), rot_dir);
-        auto transform = projection * view * model_transform;
-        program.set_uniform("transform", transform);
-        program.set_uniform("modelTransform", model_transform);
-        material->set_to_program(program);
-        mesh->draw(program);
+    const auto get_bounding_box = [&](const uint32_t i) -> const BoundingBox & {
+        return i == cube_count ? backpack_model_->get_bounding_box() : cubes[i].mesh->get_bounding_box();
+    };
+
+    // The cubes fill their boxes, so they occlude as boxes. Each is tested too, in case another hides it.
+    occlusion_stats_ = {};
+    if (occlusion_culling_) {
+        const auto start = std::chrono::steady_clock::now();
+        occlusion_buffer_->begin(projection * view);
+        for (size_t i = 0; i < cube_count; ++i) {
+            occlusion_buffer_->add_occluder(cubes[i].mesh->get_bounding_box(), transforms[i]);
+        }
+        occlusion_buffer_->rasterize();
+        std::erase_if(visible_objects_, [&](const uint32_t i) {
+            return !occlusion_buffer_->is_visible(get_bounding_box(i), transforms[i], &occlusion_stats_);
+        });
+        const auto end = std::chrono::steady_clock::now();
+        occlusion_ms_ = std::chrono::duration<float, std::milli>(end - start).count();
     }
 
-    auto model_transform = glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 0.55f, 0.0f}) *
-                           glm::rotate(glm::mat4{1.0f}, glm::radians(-90.0f), glm::vec3{1.0f, 0.0f, 0.0f}) *
-                           glm::scale(glm::mat4{1.0f}, glm::vec3{0.5f});
-    auto transform = projection * view * model_transform;
-    program.set_uniform("transform", transform);
-    program.set_uniform("modelTransform", model_transform);
-    backpack_model_->draw(program);
+    // Without occlusion queries, the objects go through the render queue, which groups them by program, material and
+    // mesh, front to back.
+    if (!occlusion_queries_enabled_) {
+        occlusion_query_stats_ = {};
+        render_queue_.begin(view, CAMERA_FAR);
+        for (const auto i : visible_objects_) {
+            if (i == cube_count) {
+                render_queue_.submit(0, program, *backpack_model_, transforms[i]);
+            } else {
+                render_queue_.submit(0, program, *cubes[i].mesh, cubes[i].material.get(), transforms[i]);
+            }
+        }
+        const auto start = std::chrono::steady_clock::now();
+        if (sort_draws_) {
+            render_queue_.sort();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        sort_ms_ = std::chrono::duration<float, std::milli>(end - start).count();
+        render_queue_.execute();
+        return;
+    }
+
+    const auto draw_object = [&](const uint32_t i) {
+        program.set_uniform("modelTransform", transforms[i]);
+        if (i == cube_count) {
+            backpack_model_->draw(program);
+            return;
+        }
+        cubes[i].material->set_to_program(program);
+        cubes[i].mesh->draw(program);
+    };
+
+    program.use();
+
+    // Draw what was visible, test the boxes of what was occluded against it, and draw the latter behind the results.
+    occlusion_queries_->begin_frame(projection * view, transforms.size());
+    for (const auto i : visible_objects_) {
+        occlusion_queries_->draw_visible(i, [&] { draw_object(i); });
+    }
+    occlusion_queries_->begin_tests();
+    for (const auto i : visible_objects_) {
+        occlusion_queries_->test(i, get_bounding_box(i), transforms[i]);
+    }
+    occlusion_queries_->end_tests();
+    program.use();
+    for (const auto i : visible_objects_) {
+        occlusion_queries_->draw_conditional(i, [&] { draw_object(i); });
+    }
+    occlusion_query_stats_ = occlusion_queries_->get_stats();
 }
 
 void SSAO::draw_ui() {
@@ -319,6 +546,82 @@ void SSAO::draw_ui() {
             ImGui::DragFloat("SSAO power", &ssao_power, 0.01f, 0.0f, 5.0f);
         }
         ImGui::Separator();
+        if (ImGui::CollapsingHeader("Frustum Culling", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::Checkbox("Cull objects", &frustum_culling_);
+            ImGui::Text("Visible: %zu, culled: %zu", cull_stats_.visible_count, cull_stats_.culled_count);
+            ImGui::Checkbox("Occlusion culling", &occlusion_culling_);
+            if (occlusion_culling_) {
+                ImGui::Text(
+                        "Occluder triangles: %zu, occluded: %zu", occlusion_buffer_->get_triangle_count(),
+                        occlusion_stats_.occluded_count
+                );
+                ImGui::Text("Occlusion: %.3f ms", occlusion_ms_);
+            }
+            if (ImGui::Button("Benchmark")) {
+                culling_benchmark_ = benchmark_culling(frustum_, CULLING_BENCHMARK_OBJECTS);
+            }
+            if (culling_benchmark_.object_count > 0) {
+                const auto objects = static_cast<float>(culling_benchmark_.object_count);
+                ImGui::Text(
+                        "Spheres: %zu, visible: %zu", culling_benchmark_.object_count, culling_benchmark_.visible_count
+                );
+                ImGui::Text(
+                        "Scalar: %.3f ms (%.0f spheres/ms)", culling_benchmark_.scalar_ms,
+                        objects / culling_benchmark_.scalar_ms
+                );
+                ImGui::Text(
+                        "SIMD: %.3f ms (%.0f spheres/ms)", culling_benchmark_.simd_ms,
+                        objects / culling_benchmark_.simd_ms
+                );
+            }
+        }
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Occlusion Queries", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::Checkbox("Use occlusion queries", &occlusion_queries_enabled_);
+            ImGui::Text(
+                    "Queries issued: %zu, pending: %zu", occlusion_query_stats_.queries_issued,
+                    occlusion_query_stats_.pending_queries
+            );
+            ImGui::Text(
+                    "Visible draws: %zu, conditional: %zu", occlusion_query_stats_.visible_draws,
+                    occlusion_query_stats_.conditional_draws
+            );
+            ImGui::Text("Skipped by the GPU: %zu", occlusion_query_stats_.skipped_draws);
+        }
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Render Queue", ImGuiTreeNodeFlags_DefaultOpen)) {
+            if (occlusion_queries_enabled_) {
+                ImGui::Text("Not used with occlusion queries");
+            }
+            ImGui::Checkbox("Sort draws", &sort_draws_);
+            const auto &submitted = render_queue_.get_submitted_stats();
+            const auto &executed = render_queue_.get_executed_stats();
+            ImGui::Text("Draws: %zu, sort: %.3f ms", executed.draw_count, sort_ms_);
+            // Submission order is the order of the loop over the objects, before sorting.
+            ImGui::Text("Program changes: %zu -> %zu", submitted.program_changes, executed.program_changes);
+            ImGui::Text("Material changes: %zu -> %zu", submitted.material_changes, executed.material_changes);
+            ImGui::Text(
+                    "Vertex array changes: %zu -> %zu", submitted.vertex_array_changes, executed.vertex_array_changes
+            );
+        }
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("GL State", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::Text("Issued calls: %zu", state_stats_.issued);
+            ImGui::Text("Skipped calls: %zu", state_stats_.skipped);
+        }
+        ImGui::Separator();
+        if (geometry_pool_ && ImGui::CollapsingHeader("Geometry Pool", ImGuiTreeNodeFlags_DefaultOpen)) {
+            const auto stats = geometry_pool_->get_stats();
+            ImGui::Text("Meshes: %zu", stats.allocations);
+            ImGui::Text("Vertices: %zu / %zu KB", stats.vertex_used / 1024, stats.vertex_capacity / 1024);
+            ImGui::Text("Indices: %zu / %zu KB", stats.index_used / 1024, stats.index_capacity / 1024);
+            ImGui::Text("Free blocks: %zu", stats.free_blocks);
+            ImGui::Text("Fragmented: %zu KB", stats.fragmented / 1024);
+            if (ImGui::Button("Defragment")) {
+                geometry_pool_->defragment();
+            }
+        }
+        ImGui::Separator();
         if (ImGui::Button("Reset")) {
             camera_pos_ = CAMERA_POS;
             camera_yaw_ = CAMERA_YAW;
@@ -350,6 +653,51 @@ void SSAO::draw_ui() {
         ImGui::Image(static_cast<ImTextureID>(attachment->get()), ImVec2{width, height}, ImVec2{0, 1}, ImVec2{1, 0});
     }
     ImGui::End();
+
+    // Occlusion buffer
+    if (ImGui::Begin("Occlusion buffer")) {
+        const auto level_count = static_cast<int>(occlusion_buffer_->get_level_count());
+        ImGui::SliderInt("Level", &occlusion_view_level_, 0, level_count - 1);
+        update_occlusion_view(static_cast<size_t>(occlusion_view_level_));
+        float width = ImGui::GetContentRegionAvail().x;
+        float height = width * static_cast<float>(occlusion_buffer_->get_height()) /
+                       static_cast<float>(occlusion_buffer_->get_width());
+        ImGui::Image(
+                static_cast<ImTextureID>(occlusion_view_texture_->get()), ImVec2{width, height}, ImVec2{0, 1},
+                ImVec2{1, 0}
+        );
+    }
+    ImGui::End();
+}
+
+void SSAO::update_occlusion_view(const size_t level) {
+    const auto depth = occlusion_buffer_->get_depth(level);
+    const auto level_width = occlusion_buffer_->get_width(level);
+    // Stretch the covered depths over the full range, as perspective depth crowds near one.
+    float min_depth = 1.0f, max_depth = 0.0f;
+    for (const auto d : depth) {
+        if (d < 1.0f) {
+            min_depth = std::min(min_depth, d);
+            max_depth = std::max(max_depth, d);
+        }
+    }
+    const auto range = std::max(max_depth - min_depth, 1.0e-6f);
+    const auto width = occlusion_buffer_->get_width();
+    const auto height = occlusion_buffer_->get_height();
+    occlusion_view_pixels_.resize(width * height);
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            const auto d = depth[(y >> level) * level_width + (x >> level)];
+            const auto value = d < 1.0f ? static_cast<uint32_t>(255.0f * (1.0f - 0.75f * (d - min_depth) / range)) : 0;
+            // RGBA bytes in memory order, with opaque alpha.
+            occlusion_view_pixels_[y * width + x] = value | value << 8 | value << 16 | 0xff000000u;
+        }
+    }
+    occlusion_view_texture_->bind();
+    glTexSubImage2D(
+            GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA,
+            GL_UNSIGNED_BYTE, occlusion_view_pixels_.data()
+    );
 }
 
 void SSAO::reshape(const int width, const int height) {
@@ -0,0 +1,675 @@
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/trigonometric.hpp>
+#include <imgui.h>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "glex/command_list.h"
+#include "glex/common.h"
+#include "glex/context.h"
+#include "glex/frustum.h"
+#include "glex/gl_state_cache.h"
+#include "glex/instance_buffer.h"
+#include "glex/mesh.h"
+#include "glex/program.h"
+#include "glex/scene_bvh.h"
+#include "glex/shadow_map.h"
+#include "glex/thread_pool.h"
+
+namespace {
+
+    /// Distance between the centers of neighboring spheres.
+    constexpr float SPACING{1.5f};
+    constexpr int MAX_SPHERE_COUNT{100000};
+
+    /// Direction of the directional light whose shadow casters are selected from the BVH.
+    constexpr glm::vec3 SHADOW_LIGHT_DIRECTION{-0.4f, -1.0f, -0.3f};
+
+    /// Object counts of the BVH benchmark.
+    constexpr std::array<size_t, 3> BVH_BENCHMARK_OBJECTS{10000, 100000, 1000000};
+    /// Runs of each query, to average out the timer resolution.
+    constexpr size_t BVH_BENCHMARK_RUNS{10};
+    /// Rays cast per run of the raycast benchmark.
+    constexpr size_t BVH_BENCHMARK_RAYS{1000};
+    /// Uniforms set per run of the uniform benchmark.
+    constexpr size_t UNIFORM_BENCHMARK_UNIFORMS{1000};
+    constexpr size_t UNIFORM_BENCHMARK_RUNS{100};
+
+    /// Per-draw data of `DrawBlock` in `pbr.vs`, laid out as `std140`.
+    struct DrawBlockData {
+        glm::mat4 model_transform;
+        /// Metallic and roughness
+        glm::vec4 params;
+    };
+
+    /// @returns The number of spheres along each side of the cube that holds `count` spheres.
+    size_t get_grid_side(const size_t count) {
+        return static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+    }
+
+    /// Timings of `SceneBVH` over random boxes, in milliseconds unless noted.
+    struct BVHBenchmark {
+        size_t object_count{0};
+        size_t node_count{0};
+        size_t visible_count{0};
+        float build_ms{0.0f};
+        float refit_ms{0.0f};
+        /// `SceneBVH::query` per run.
+        float query_ms{0.0f};
+        /// `BoundingSphereSet::cull` over every object per run, for comparison.
+        float brute_force_ms{0.0f};
+        /// `SceneBVH::raycast` per ray, in microseconds.
+        float raycast_us{0.0f};
+    };
+
+    BVHBenchmark benchmark_bvh(const size_t object_count) {
+        std::mt19937 gen{42};
+        const auto extent = static_cast<float>(std::cbrt(static_cast<double>(object_count))) * SPACING;
+        std::uniform_real_distribution<float> dis_pos{-extent, extent};
+        std::uniform_real_distribution<float> dis_size{0.1f, 1.0f};
+        std::vector<BoundingBox> boxes;
+        boxes.reserve(object_count);
+        BoundingSphereSet sphere_set;
+        sphere_set.reserve(object_count);
+        for (size_t i = 0; i < object_count; ++i) {
+            const glm::vec3 center{dis_pos(gen), dis_pos(gen), dis_pos(gen)};
+            const auto half_size = dis_size(gen);
+            boxes.push_back({.min = center - half_size, .max = center + half_size});
+            sphere_set.add({.center = center, .radius = half_size * std::sqrt(3.0f)}, glm::mat4{1.0f});
+        }
+        const auto time_ms = [](const auto &run, const size_t run_count) {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < run_count; ++i) {
+                run();
+            }
+            const auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<float, std::milli>(end - start).count() / static_cast<float>(run_count);
+        };
+
+        SceneBVH bvh;
+        BVHBenchmark result{.object_count = object_count};
+        result.build_ms = time_ms([&] { bvh.build(boxes); }, 1);
+        result.node_count = bvh.get_node_count();
+        for (uint32_t i = 0; i < object_count; ++i) {
+            const glm::vec3 offset{0.0f, std::sin(static_cast<float>(i)) * 0.5f, 0.0f};
+            bvh.update(i, {.min = boxes[i].min + offset, .max = boxes[i].max + offset});
+        }
+        result.refit_ms = time_ms([&] { bvh.refit(); }, 1);
+
+        // A camera at the center of the cube looking down the negative z axis sees about a tenth of the objects.
+        const auto projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, extent);
+        const auto view = glm::lookAt(glm::vec3{0.0f}, glm::vec3{0.0f, 0.0f, -1.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+        const auto frustum = Frustum::from_matrix(projection * view);
+        std::vector<uint32_t> visible;
+        visible.reserve(object_count);
+        result.query_ms = time_ms([&] { bvh.query(frustum, visible); }, BVH_BENCHMARK_RUNS);
+        result.visible_count = visible.size();
+        result.brute_force_ms = time_ms([&] { sphere_set.cull(frustum, visible); }, BVH_BENCHMARK_RUNS);
+
+        // Rays from random points, mostly along the positive z axis.
+        std::vector<std::pair<glm::vec3, glm::vec3>> rays;
+        rays.reserve(BVH_BENCHMARK_RAYS);
+        for (size_t i = 0; i < BVH_BENCHMARK_RAYS; ++i) {
+            const glm::vec3 origin{dis_pos(gen), dis_pos(gen), dis_pos(gen)};
+            rays.emplace_back(origin, glm::vec3{dis_pos(gen), dis_pos(gen), extent});
+        }
+        size_t hit_count = 0;
+        const auto raycast_ms = time_ms(
+                [&] {
+                    for (const auto &[origin, direction] : rays) {
+                        hit_count += bvh.raycast(origin, direction) ? 1 : 0;
+                    }
+                },
+                1
+        );
+        result.raycast_us = raycast_ms * 1000.0f / static_cast<float>(rays.size());
+
+        SPDLOG_INFO(
+                "Scene BVH of {} boxes, {} nodes: build {:.2f} ms, refit {:.2f} ms, query {:.3f} ms ({} visible), "
+                "brute force {:.3f} ms, raycast {:.2f} us ({} of {} rays hit)",
+                result.object_count, result.node_count, result.build_ms, result.refit_ms, result.query_ms,
+                result.visible_count, result.brute_force_ms, result.raycast_us, hit_count, rays.size()
+        );
+        return result;
+    }
+
+    /// Time per `set_uniform` call of each way to find a uniform, in nanoseconds.
+    struct UniformBenchmark {
+        /// `glGetUniformLocation` on every call, as before the locations were cached.
+        float location_query_ns{0.0f};
+        /// `Program::set_uniform` by name, through the cached locations.
+        float name_ns{0.0f};
+        /// `Program::set_uniform` through a `UniformHandle`.
+        float handle_ns{0.0f};
+    };
+
+    UniformBenchmark benchmark_uniforms(const Program &program) {
+        const std::array<std::string, 3> names{"material.metallic", "material.roughness", "material.ao"};
+        std::array<UniformHandle, names.size()> handles;
+        for (size_t i = 0; i < names.size(); ++i) {
+            handles[i] = program.get_uniform_handle(names[i]);
+        }
+        const auto time_ns = [&](const auto &set) {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t run = 0; run < UNIFORM_BENCHMARK_RUNS; ++run) {
+                for (size_t i = 0; i < UNIFORM_BENCHMARK_UNIFORMS; ++i) {
+                    set(i % names.size(), static_cast<float>(i) / static_cast<float>(UNIFORM_BENCHMARK_UNIFORMS));
+                }
+            }
+            const auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<float, std::nano>(end - start).count() /
+                   static_cast<float>(UNIFORM_BENCHMARK_RUNS * UNIFORM_BENCHMARK_UNIFORMS);
+        };
+
+        program.use();
+        UniformBenchmark result;
+        result.location_query_ns = time_ns([&](const size_t i, const float value) {
+            glUniform1f(glGetUniformLocation(program.get(), names[i].c_str()), value);
+        });
+        result.name_ns = time_ns([&](const size_t i, const float value) { program.set_uniform(names[i], value); });
+        result.handle_ns = time_ns([&](const size_t i, const float value) { program.set_uniform(handles[i], value); });
+        SPDLOG_INFO(
+                "set_uniform of {} uniforms: glGetUniformLocation {:.1f} ns, name {:.1f} ns, handle {:.1f} ns",
+                UNIFORM_BENCHMARK_UNIFORMS, result.location_query_ns, result.name_ns, result.handle_ns
+        );
+        return result;
+    }
+
+} // namespace
+
+/// Draws a cube of up to 100k spheres to measure draw-call throughput, either with one instanced draw call or with a
+/// draw call per sphere, issued directly or recorded into command lists on the thread pool and replayed. A `SceneBVH`
+/// over the spheres culls them to the camera, counts the shadow casters of a directional light, and picks the sphere
+/// under the cursor on a left click.
+class StressTest : Context {
+    std::unique_ptr<Program> pbr_program_, pbr_instanced_program_, pbr_draw_block_program_;
+    std::shared_ptr<Mesh> sphere_mesh_;
+
+    std::vector<PointLight> lights_;
+
+    std::vector<InstanceData> instances_;
+    std::unique_ptr<InstanceBuffer> instance_buffer_;
+
+    ///@{
+    /// Scene BVH over the world-space boxes of the spheres
+    SceneBVH bvh_;
+    std::vector<BoundingBox> sphere_bounds_;
+    bool bvh_culling_{false};
+    std::vector<uint32_t> visible_spheres_;
+    std::vector<uint32_t> shadow_casters_;
+    /// The instances of the visible spheres, uploaded instead of all of them while culling.
+    std::vector<InstanceData> visible_instances_;
+    SceneBVHQueryStats bvh_stats_;
+    float bvh_ms_{0.0f};
+    std::optional<uint32_t> picked_sphere_;
+    std::vector<BVHBenchmark> bvh_benchmarks_;
+    ///@}
+
+    std::optional<UniformBenchmark> uniform_benchmark_;
+
+    ///@{
+    /// Draws recorded on the thread pool and replayed on the context thread, when not instancing
+    std::unique_ptr<CommandQueue> command_queue_;
+    bool use_command_lists_{false};
+    /// Threads recording at once, including the context thread, or `0` for all of them.
+    int record_threads_{0};
+    float record_ms_{0.0f};
+    float replay_ms_{0.0f};
+    ///@}
+
+    ///@{
+    /// Scene options
+    int sphere_count_{MAX_SPHERE_COUNT};
+    bool use_instancing_{true};
+    bool animate_{false};
+    ///@}
+
+    ///@{
+    /// Timings of the last frame in milliseconds. The GPU time is read one frame late from alternating queries, and
+    /// only once it is available, so reading it never waits for the GPU.
+    float update_ms_{0.0f};
+    float submit_ms_{0.0f};
+    float gpu_ms_{0.0f};
+    size_t draw_calls_{0};
+    std::array<uint32_t, 2> time_queries_{};
+    size_t frame_index_{0};
+    ///@}
+
+public:
+    ~StressTest() override;
+
+    bool init() override;
+    void render() override;
+    void draw_ui() override;
+    void draw_scene(const glm::mat4 &view, const glm::mat4 &projection, const Program &program) override;
+    void reshape(int width, int height) override;
+
+private:
+    /// Lays out `sphere_count_` spheres in a cube, moving them along a wave if `animate_` is set.
+    void update_instances(float time);
+
+    /// Builds the BVH over the spheres again if their number changed, or refits it to their new positions.
+    void update_bvh();
+
+    /// Culls the spheres and selects the shadow casters of `SHADOW_LIGHT_DIRECTION` with the BVH.
+    void query_bvh(const glm::mat4 &view, const glm::mat4 &projection);
+
+    /// Picks the sphere under the cursor with a ray through the BVH.
+    void pick_sphere(const glm::mat4 &view, const glm::mat4 &projection);
+};
+
+std::unique_ptr<Context> Context::create() {
+    auto context = std::unique_ptr<Context>{reinterpret_cast<Context *>(new StressTest{})};
+    if (!context->init()) {
+        SPDLOG_ERROR("Failed to create context");
+        return nullptr;
+    }
+    SPDLOG_INFO("Context has been created");
+    return std::move(context);
+}
+
+StressTest::~StressTest() {
+    glDeleteQueries(static_cast<GLsizei>(time_queries_.size()), time_queries_.data());
+}
+
+bool StressTest::init() {
+    // A coarse sphere keeps the test bound by draw submission rather than by vertex processing.
+    sphere_mesh_ = Mesh::create_sphere(8, 16);
+    if (!sphere_mesh_) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+
+    // Load programs. All variants share the shaders; the instanced one reads the transforms from the instances, and
+    // the draw block one from the uniform data of command list packets.
+    const auto pbr_defines = ShaderDefines{}.set("MAX_LIGHTS", 4);
+    const auto pbr_instanced_defines = ShaderDefines(pbr_defines).set("INSTANCED");
+    const auto pbr_draw_block_defines = ShaderDefines(pbr_defines).set("DRAW_BLOCK");
+    auto pending_pbr = Program::create_async("./shader/pbr.vs", "./shader/pbr.fs", pbr_defines);
+    auto pending_pbr_instanced = Program::create_async("./shader/pbr.vs", "./shader/pbr.fs", pbr_instanced_defines);
+    auto pending_pbr_draw_block =
+            Program::create_async("./shader/pbr.vs", "./shader/pbr.fs", pbr_draw_block_defines);
+    pbr_program_ = pending_pbr.get();
+    pbr_instanced_program_ = pending_pbr_instanced.get();
+    pbr_draw_block_program_ = pending_pbr_draw_block.get();
+
+    command_queue_ = CommandQueue::create();
+    if (!pbr_program_ || !pbr_instanced_program_ || !pbr_draw_block_program_ || !command_queue_) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+
+    // Share camera and light data between programs.
+    if (!init_uniform_blocks()) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+    bind_uniform_blocks(*pbr_program_);
+    bind_uniform_blocks(*pbr_instanced_program_);
+    bind_uniform_blocks(*pbr_draw_block_program_);
+    pbr_draw_block_program_->bind_uniform_block("DrawBlock", command_queue_->get_uniform_binding());
+
+    update_instances(0.0f);
+    update_bvh();
+    instance_buffer_ = InstanceBuffer::create(instances_, GL_DYNAMIC_DRAW);
+    if (!instance_buffer_) {
+        SPDLOG_ERROR("Failed to initialize context");
+        return false;
+    }
+
+    glGenQueries(static_cast<GLsizei>(time_queries_.size()), time_queries_.data());
+
+    const float extent = static_cast<float>(get_grid_side(MAX_SPHERE_COUNT)) * SPACING;
+    lights_.emplace_back(glm::vec3{extent, extent, extent}, glm::vec3{4000.0f});
+    lights_.emplace_back(glm::vec3{-extent, extent, extent}, glm::vec3{4000.0f});
+    lights_.emplace_back(glm::vec3{-extent, -extent, extent}, glm::vec3{4000.0f});
+    lights_.emplace_back(glm::vec3{extent, -extent, extent}, glm::vec3{4000.0f});
+
+    camera_pos_ = glm::vec3{0.0f, 0.0f, extent * 1.5f};
+
+    // Enable depth test and cull face.
+    GLStateCache::enable(GL_DEPTH_TEST);
+    GLStateCache::enable(GL_CULL_FACE);
+
+    return true;
+}
+
+void StressTest::render() {
+    // Clear color buffer with `glClearColor` and depth buffer with 1.0.
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Dear ImGui UI
+    draw_ui();
+
+    // Calculate camera front direction.
+    camera_front_ = glm::rotate(glm::mat4{1.0f}, glm::radians(camera_yaw_), glm::vec3{0.0f, 1.0f, 0.0f}) *
+                    glm::rotate(glm::mat4{1.0f}, glm::radians(camera_pitch_), glm::vec3{1.0f, 0.0f, 0.0f}) *
+                    glm::vec4{0.0f, 0.0f, -1.0f, 0.0f};
+
+    const auto projection = glm::perspective(glm::radians(45.0f), aspect_ratio_, 0.1f, 500.0f);
+    const auto view = glm::lookAt(camera_pos_, camera_pos_ + camera_front_, camera_up_);
+    upload_camera_block(view, projection);
+    upload_lights_block(lights_);
+
+    // Read the GPU time of the frame that used the other query.
+    const auto previous_query = time_queries_[(frame_index_ + 1) % time_queries_.size()];
+    int32_t available = GL_FALSE;
+    if (frame_index_ > 0) {
+        glGetQueryObjectiv(previous_query, GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+    if (available) {
+        uint64_t elapsed_ns = 0;
+        glGetQueryObjectui64v(previous_query, GL_QUERY_RESULT, &elapsed_ns);
+        gpu_ms_ = static_cast<float>(elapsed_ns) / 1.0e6f;
+    }
+
+    const auto update_start = std::chrono::steady_clock::now();
+    if (animate_ || instances_.size() != static_cast<size_t>(sphere_count_)) {
+        update_instances(static_cast<float>(glfwGetTime()));
+        update_bvh();
+        if (use_instancing_ && !bvh_culling_) {
+            instance_buffer_->set_instances(instances_);
+        }
+    }
+    const auto bvh_start = std::chrono::steady_clock::now();
+    if (bvh_culling_) {
+        query_bvh(view, projection);
+        if (use_instancing_) {
+            visible_instances_.clear();
+            for (const auto i : visible_spheres_) {
+                visible_instances_.push_back(instances_[i]);
+            }
+            instance_buffer_->set_instances(visible_instances_);
+        }
+    }
+    if (const auto &io = ImGui::GetIO(); ImGui::IsMouseClicked(ImGuiMouseButton_Left) && !io.WantCaptureMouse) {
+        pick_sphere(view, projection);
+    }
+    const auto submit_start = std::chrono::steady_clock::now();
+
+    glBeginQuery(GL_TIME_ELAPSED, time_queries_[frame_index_ % time_queries_.size()]);
+    const auto &program = use_instancing_       ? *pbr_instanced_program_
+                          : use_command_lists_ ? *pbr_draw_block_program_
+                                               : *pbr_program_;
+    program.use();
+    program.set_uniform("material.albedo", glm::vec3{0.8f, 0.3f, 0.2f});
+    program.set_uniform("material.ao", 0.1f);
+    draw_scene(view, projection, program);
+    if (picked_sphere_) {
+        // Draw the picked sphere again, slightly larger, in a highlight color.
+        pbr_program_->use();
+        pbr_program_->set_uniform(
+                "modelTransform", glm::scale(instances_[*picked_sphere_].model_transform, glm::vec3{1.1f})
+        );
+        pbr_program_->set_uniform("material.albedo", glm::vec3{0.2f, 0.8f, 1.0f});
+        pbr_program_->set_uniform("material.ao", 0.1f);
+        pbr_program_->set_uniform("material.metallic", 0.0f);
+        pbr_program_->set_uniform("material.roughness", 0.5f);
+        sphere_mesh_->draw(*pbr_program_);
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+
+    const auto submit_end = std::chrono::steady_clock::now();
+    update_ms_ = std::chrono::duration<float, std::milli>(bvh_start - update_start).count();
+    bvh_ms_ = std::chrono::duration<float, std::milli>(submit_start - bvh_start).count();
+    submit_ms_ = std::chrono::duration<float, std::milli>(submit_end - submit_start).count();
+    ++frame_index_;
+}
+
+void StressTest::draw_scene(const glm::mat4 &view, const glm::mat4 &projection, const Program &program) {
+    program.use();
+    if (use_instancing_) {
+        sphere_mesh_->draw_instanced(program, *instance_buffer_);
+        draw_calls_ = 1;
+        return;
+    }
+    if (use_command_lists_) {
+        // Workers prepare the uniform data and the packets of disjoint ranges; this thread only replays them.
+        if (const auto &material = sphere_mesh_->get_material()) {
+            material->set_to_program(program);
+        }
+        const auto command = sphere_mesh_->get_draw_command();
+        const auto count = bvh_culling_ ? visible_spheres_.size() : instances_.size();
+        const auto record_start = std::chrono::steady_clock::now();
+        command_queue_->record(
+                count,
+                [&](CommandList &list, const size_t first, const size_t last) {
+                    for (size_t i = first; i < last; ++i) {
+                        const auto &instance = instances_[bvh_culling_ ? visible_spheres_[i] : i];
+                        list.draw(
+                                program, command,
+                                DrawBlockData{.model_transform = instance.model_transform, .params = instance.params}
+                        );
+                    }
+                },
+                {.max_threads = static_cast<size_t>(record_threads_)}
+        );
+        const auto replay_start = std::chrono::steady_clock::now();
+        command_queue_->execute();
+        const auto replay_end = std::chrono::steady_clock::now();
+        record_ms_ = std::chrono::duration<float, std::milli>(replay_start - record_start).count();
+        replay_ms_ = std::chrono::duration<float, std::milli>(replay_end - replay_start).count();
+        draw_calls_ = count;
+        return;
+    }
+    const auto draw = [&](const InstanceData &instance) {
+        program.set_uniform("modelTransform", instance.model_transform);
+        program.set_uniform("material.metallic", instance.params.x);
+        program.set_uniform("material.roughness", instance.params.y);
+        sphere_mesh_->draw(program);
+    };
+    if (bvh_culling_) {
+        for (const auto i : visible_spheres_) {
+            draw(instances_[i]);
+        }
+        draw_calls_ = visible_spheres_.size();
+        return;
+    }
+    for (const auto &instance : instances_) {
+        draw(instance);
+    }
+    draw_calls_ = instances_.size();
+}
+
+void StressTest::update_instances(const float time) {
+    const auto count = static_cast<size_t>(sphere_count_);
+    const auto side = get_grid_side(count);
+    const float center = static_cast<float>(side - 1) * 0.5f;
+    instances_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const auto x = static_cast<float>(i % side);
+        const auto y = static_cast<float>(i / side % side);
+        const auto z = static_cast<float>(i / (side * side));
+        auto position = (glm::vec3{x, y, z} - center) * SPACING;
+        if (animate_) {
+            position.y += std::sin(time * 2.0f + (x + z) * 0.3f) * 0.5f;
+        }
+        instances_[i] = {
+                .model_transform = glm::translate(glm::mat4{1.0f}, position),
+                .params = {x / static_cast<float>(side), y / static_cast<float>(side), 0.0f, 0.0f},
+        };
+    }
+}
+
+void StressTest::update_bvh() {
+    const auto &sphere_box = sphere_mesh_->get_bounding_box();
+    const auto rebuild = sphere_bounds_.size() != instances_.size();
+    sphere_bounds_.resize(instances_.size());
+    for (size_t i = 0; i < instances_.size(); ++i) {
+        sphere_bounds_[i] = sphere_box.transform(instances_[i].model_transform);
+    }
+    if (rebuild) {
+        bvh_.build(sphere_bounds_);
+        picked_sphere_.reset();
+        return;
+    }
+    for (uint32_t i = 0; i < sphere_bounds_.size(); ++i) {
+        bvh_.update(i, sphere_bounds_[i]);
+    }
+    bvh_.refit();
+}
+
+void StressTest::query_bvh(const glm::mat4 &view, const glm::mat4 &projection) {
+    bvh_stats_ = {};
+    bvh_.query(Frustum::from_matrix(projection * view), visible_spheres_, &bvh_stats_);
+    if (visible_spheres_.empty()) {
+        shadow_casters_.clear();
+        return;
+    }
+
+    // Only the visible spheres receive shadows that are seen.
+    auto receivers = sphere_bounds_[visible_spheres_.front()];
+    for (const auto i : visible_spheres_) {
+        receivers = receivers.merge(sphere_bounds_[i]);
+    }
+    const auto scene_bounds = bvh_.get_bounds();
+    const BoundingSphere scene_sphere{
+            .center = scene_bounds.get_center(),
+            .radius = glm::length(scene_bounds.max - scene_bounds.min) * 0.5f,
+    };
+    const auto light_frustum =
+            Frustum::from_matrix(ShadowMap::get_light_transform(SHADOW_LIGHT_DIRECTION, scene_sphere));
+    bvh_.query_shadow_casters(light_frustum, SHADOW_LIGHT_DIRECTION, receivers, shadow_casters_, &bvh_stats_);
+}
+
+void StressTest::pick_sphere(const glm::mat4 &view, const glm::mat4 &projection) {
+    // Unproject the cursor at the near and far planes.
+    const auto &mouse = ImGui::GetIO().MousePos;
+    const glm::vec2 ndc{
+            mouse.x / static_cast<float>(width_) * 2.0f - 1.0f,
+            1.0f - mouse.y / static_cast<float>(height_) * 2.0f,
+    };
+    const auto inverse = glm::inverse(projection * view);
+    const auto near = inverse * glm::vec4{ndc, -1.0f, 1.0f};
+    const auto far = inverse * glm::vec4{ndc, 1.0f, 1.0f};
+    const auto origin = glm::vec3{near} / near.w;
+    const auto direction = glm::normalize(glm::vec3{far} / far.w - origin);
+
+    const auto radius = sphere_mesh_->get_bounding_sphere().radius;
+    const auto intersect_sphere = [&](const uint32_t object) -> std::optional<float> {
+        const auto to_center = glm::vec3{instances_[object].model_transform[3]} - origin;
+        const auto projected = glm::dot(to_center, direction);
+        const auto distance2 = glm::dot(to_center, to_center) - projected * projected;
+        if (distance2 > radius * radius) {
+            return std::nullopt;
+        }
+        return projected - std::sqrt(radius * radius - distance2);
+    };
+    const auto hit = bvh_.raycast(origin, direction, std::numeric_limits<float>::max(), intersect_sphere);
+    picked_sphere_ = hit ? std::optional{hit->object} : std::nullopt;
+    if (hit) {
+        SPDLOG_INFO("Picked sphere {} at distance {:.2f}", hit->object, hit->distance);
+    }
+}
+
+void StressTest::draw_ui() {
+    // ImGui Components.
+    if (ImGui::Begin("UI")) {
+        if (ImGui::CollapsingHeader("Camera", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::DragFloat3("Position", glm::value_ptr(camera_pos_), 0.1f);
+            ImGui::DragFloat("Yaw", &camera_yaw_, 0.5f);
+            ImGui::DragFloat("Pitch", &camera_pitch_, 0.5f, -89.0f, 89.0f);
+        }
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Scene", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::SliderInt("Spheres", &sphere_count_, 1, MAX_SPHERE_COUNT);
+            if (ImGui::Checkbox("Instancing", &use_instancing_) && use_instancing_) {
+                instance_buffer_->set_instances(instances_);
+            }
+            ImGui::Checkbox("Animate", &animate_);
+            if (!use_instancing_) {
+                ImGui::Checkbox("Command lists", &use_command_lists_);
+            }
+            if (!use_instancing_ && use_command_lists_) {
+                const auto max_threads = static_cast<int>(ThreadPool::get_default().get_thread_count() + 1);
+                ImGui::SliderInt("Record threads (0: all)", &record_threads_, 0, max_threads);
+            }
+        }
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Scene BVH", ImGuiTreeNodeFlags_DefaultOpen)) {
+            if (ImGui::Checkbox("BVH culling", &bvh_culling_) && !bvh_culling_ && use_instancing_) {
+                instance_buffer_->set_instances(instances_);
+            }
+            ImGui::Text("Nodes: %zu", bvh_.get_node_count());
+            if (bvh_culling_) {
+                ImGui::Text("Visible: %zu / %zu", visible_spheres_.size(), instances_.size());
+                ImGui::Text("Shadow casters: %zu", shadow_casters_.size());
+                ImGui::Text("Nodes visited: %zu", bvh_stats_.node_count);
+                ImGui::Text("Queries: %.3f ms", bvh_ms_);
+            }
+            if (picked_sphere_) {
+                ImGui::Text("Picked: %u", *picked_sphere_);
+            } else {
+                ImGui::Text("Picked: none (left click a sphere)");
+            }
+            if (ImGui::Button("Benchmark")) {
+                bvh_benchmarks_.clear();
+                for (const auto object_count : BVH_BENCHMARK_OBJECTS) {
+                    bvh_benchmarks_.push_back(benchmark_bvh(object_count));
+                }
+            }
+            for (const auto &benchmark : bvh_benchmarks_) {
+                ImGui::Text(
+                        "%zu objects: build %.1f ms, refit %.2f ms", benchmark.object_count, benchmark.build_ms,
+                        benchmark.refit_ms
+                );
+                ImGui::Text(
+                        "  query %.3f ms vs brute force %.3f ms, raycast %.2f us", benchmark.query_ms,
+                        benchmark.brute_force_ms, benchmark.raycast_us
+                );
+            }
+        }
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Uniforms")) {
+            if (ImGui::Button("Benchmark set_uniform")) {
+                uniform_benchmark_ = benchmark_uniforms(*pbr_program_);
+            }
+            if (uniform_benchmark_) {
+                ImGui::Text("%zu uniforms per run, per call:", UNIFORM_BENCHMARK_UNIFORMS);
+                ImGui::Text("  glGetUniformLocation: %.1f ns", uniform_benchmark_->location_query_ns);
+                ImGui::Text("  by name: %.1f ns", uniform_benchmark_->name_ns);
+                ImGui::Text("  by handle: %.1f ns", uniform_benchmark_->handle_ns);
+            }
+        }
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Stats", ImGuiTreeNodeFlags_DefaultOpen)) {
+            const auto &io = ImGui::GetIO();
+            ImGui::Text("Frame: %.2f ms (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+            ImGui::Text("Draw calls: %zu", draw_calls_);
+            ImGui::Text("Instance update: %.3f ms", update_ms_);
+            ImGui::Text("CPU submit: %.3f ms", submit_ms_);
+            if (!use_instancing_ && use_command_lists_) {
+                const auto &stats = command_queue_->get_stats();
+                ImGui::Text("  record: %.3f ms (%zu lists)", record_ms_, stats.list_count);
+                ImGui::Text("  replay: %.3f ms (%zu KB uniforms)", replay_ms_, stats.uniform_bytes / 1024);
+            }
+            ImGui::Text("GPU: %.3f ms", gpu_ms_);
+        }
+        ImGui::Separator();
+        if (ImGui::Button("Reset")) {
+            camera_pos_ = glm::vec3{0.0f, 0.0f, static_cast<float>(get_grid_side(MAX_SPHERE_COUNT)) * SPACING * 1.5f};
+            camera_yaw_ = CAMERA_YAW;
+            camera_pitch_ = CAMERA_PITCH;
+        }
+    }
+    ImGui::End();
+}
+
+void StressTest::reshape(const int width, const int height) {
+    width_ = width;
+    height_ = height;
+    aspect_ratio_ = static_cast<float>(width) / static_cast<float>(height);
+}
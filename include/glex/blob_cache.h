@@ -0,0 +1,146 @@
+#ifndef __BLOB_CACHE_H__
+#define __BLOB_CACHE_H__
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+/// # CachedBlob
+///
+/// The contents of a file of a `BlobCache`.
+struct CachedBlob {
+    /// A value stored along with the data, e.g., a binary format or a version.
+    uint32_t tag;
+    std::vector<char> data;
+};
+
+/// # BlobCache
+///
+/// A directory of binary files, each stored under a 64-bit key, shared by the on-disk caches such as
+/// `ProgramBinaryCache` and `MeshLodCache`.
+///
+/// Every file starts with a header holding the magic number of the cache, a tag, the key and the size of the data, so
+/// files of another cache, of another key, or cut short are ignored. Files are written to a temporary file first and
+/// then renamed, so a concurrent reader never sees a partial file.
+///
+/// `BlobCache::load` counts a miss when no valid file is found. Callers that check the data further count the result
+/// with `BlobCache::add_hit` or `BlobCache::add_miss`.
+///
+/// ## Examples
+///
+/// ```cpp
+/// BlobCache cache{"Program binary cache", ".bin", 0x42584c47};
+/// cache.set_directory("./.cache/program_binary");
+/// if (auto blob = cache.load(key)) {
+///     cache.add_hit();
+/// }
+/// ```
+class BlobCache {
+    const std::string name_;
+    const std::string extension_;
+    const uint32_t magic_;
+    std::filesystem::path directory_;
+    bool enabled_{false};
+    std::atomic<size_t> hit_count_{0};
+    std::atomic<size_t> miss_count_{0};
+
+public:
+    /// ## BlobCache::BlobCache
+    ///
+    /// Constructor of a disabled cache.
+    ///
+    /// @param name: The name of the cache in log messages, e.g., `"Mesh LOD cache"`.
+    /// @param extension: The extension of the files, e.g., `".lod"`.
+    /// @param magic: The number that starts every file of the cache.
+    BlobCache(std::string name, std::string extension, uint32_t magic);
+
+    BlobCache(const BlobCache &) = delete;
+    BlobCache &operator=(const BlobCache &) = delete;
+
+    /// ## BlobCache::set_directory
+    ///
+    /// Enables the cache and sets the directory to store files in. The directory is created if it does not exist.
+    ///
+    /// @param directory: The directory to store files in.
+    ///
+    /// @returns `true` if the cache is enabled, `false` if the directory cannot be created.
+    bool set_directory(const std::filesystem::path &directory);
+
+    /// ## BlobCache::disable
+    ///
+    /// Disables the cache, so that loads find nothing and stores are dropped.
+    void disable() {
+        enabled_ = false;
+    }
+
+    /// ## BlobCache::is_enabled
+    ///
+    /// @returns `true` if a directory is set.
+    [[nodiscard]]
+    bool is_enabled() const {
+        return enabled_;
+    }
+
+    /// ## BlobCache::load
+    ///
+    /// @param key: The key of the file.
+    ///
+    /// @returns The tag and data stored under the key, or `std::nullopt` if there are none or the file is corrupted.
+    std::optional<CachedBlob> load(uint64_t key);
+
+    /// ## BlobCache::store
+    ///
+    /// Stores the data under the key, replacing the previous file.
+    ///
+    /// @param key: The key of the file.
+    /// @param tag: The value to store along with the data.
+    /// @param data: The data to store.
+    ///
+    /// @returns The path of the file if successful, or `std::nullopt` if the cache is disabled or writing failed.
+    std::optional<std::filesystem::path> store(uint64_t key, uint32_t tag, std::span<const char> data);
+
+    /// ## BlobCache::get_path
+    ///
+    /// @returns The path of the file of the key.
+    [[nodiscard]]
+    std::filesystem::path get_path(uint64_t key) const;
+
+    /// ## BlobCache::add_hit
+    ///
+    /// Counts a loaded file whose data was used.
+    void add_hit() {
+        ++hit_count_;
+    }
+
+    /// ## BlobCache::add_miss
+    ///
+    /// Counts a loaded file whose data was rejected by the caller, e.g., a stale program binary.
+    void add_miss() {
+        ++miss_count_;
+    }
+
+    /// ## BlobCache::get_hit_count
+    ///
+    /// @returns The number of loads whose data was used.
+    [[nodiscard]]
+    size_t get_hit_count() const {
+        return hit_count_;
+    }
+
+    /// ## BlobCache::get_miss_count
+    ///
+    /// @returns The number of loads that found no usable data while the cache was enabled.
+    [[nodiscard]]
+    size_t get_miss_count() const {
+        return miss_count_;
+    }
+};
+
+
+#endif // __BLOB_CACHE_H__
@@ -92,6 +92,22 @@ public:
     /// Binds the OpenGL buffer.
     void bind() const;
 
+    /// ## Buffer::bind_base
+    ///
+    /// Binds the OpenGL buffer to an indexed binding point of its buffer type using `glBindBufferBase`.
+    ///
+    /// @param index: The index of the binding point.
+    void bind_base(uint32_t index) const;
+
+    /// ## Buffer::set_data
+    ///
+    /// Updates a range of the data store of the buffer using `glBufferSubData`.
+    ///
+    /// @param data: Pointer to the new data.
+    /// @param size: The size of the data in bytes.
+    /// @param offset: The byte offset into the buffer where the data replacement will begin.
+    void set_data(const void *data, size_t size, size_t offset = 0) const;
+
 private:
     Buffer(uint32_t buffer_id, uint32_t buffer_type, uint32_t usage, size_t stride, size_t count);
 };
@@ -0,0 +1,247 @@
+#ifndef __COMMAND_LIST_H__
+#define __COMMAND_LIST_H__
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+#include "glex/buffer.h"
+#include "glex/common.h"
+#include "glex/mesh.h"
+#include "glex/program.h"
+#include "glex/thread_pool.h"
+
+/// # DrawPacket
+///
+/// A draw recorded into a `CommandList`: the program, the draw call with its vertex array, and the range of its
+/// uniform data.
+struct DrawPacket {
+    const Program *program;
+    DrawCommand command;
+    uint32_t instance_count;
+    /// The offset of the uniform data in the uniform data of the list, a multiple of the uniform buffer offset
+    /// alignment.
+    uint32_t uniform_offset;
+    /// The size of the uniform data in bytes, or `0` to leave the draw block bound as it is.
+    uint32_t uniform_size;
+};
+
+/// # CommandList
+///
+/// Draw packets recorded without OpenGL, so that any thread can record them, to be replayed by `CommandQueue` on the
+/// thread of the context. Lists are obtained from `CommandQueue::begin`, and each must be recorded by one thread at a
+/// time.
+///
+/// The uniform data of each draw, e.g., its model transform, is copied into the list at an offset aligned for
+/// `glBindBufferRange`, and bound to the draw block of the program by range when the packet is replayed.
+class CommandList {
+    size_t uniform_alignment_;
+    std::vector<DrawPacket> packets_;
+    std::vector<uint8_t> uniform_data_;
+
+public:
+    /// ## CommandList::draw
+    ///
+    /// Records a draw with its uniform data.
+    ///
+    /// @param program: The program to draw with, which must outlive the replay.
+    /// @param command: The draw call, e.g., from `Mesh::get_draw_command`.
+    /// @param uniforms: The contents of the draw block, laid out as `std140`.
+    /// @param instance_count: The number of instances to draw.
+    template <typename T>
+    void
+    draw(const Program &program, const DrawCommand &command, const T &uniforms, const uint32_t instance_count = 1) {
+        const auto offset = uniform_data_.size();
+        const auto block_size = (sizeof(T) + uniform_alignment_ - 1) / uniform_alignment_ * uniform_alignment_;
+        uniform_data_.resize(offset + block_size);
+        std::memcpy(uniform_data_.data() + offset, &uniforms, sizeof(T));
+        packets_.push_back({
+                .program = &program,
+                .command = command,
+                .instance_count = instance_count,
+                .uniform_offset = static_cast<uint32_t>(offset),
+                .uniform_size = sizeof(T),
+        });
+    }
+
+    /// ## CommandList::draw
+    ///
+    /// Records a draw without uniform data, which uses the draw block bound by the previous packet.
+    ///
+    /// @param program: The program to draw with.
+    /// @param command: The draw call.
+    /// @param instance_count: The number of instances to draw.
+    void draw(const Program &program, const DrawCommand &command, const uint32_t instance_count = 1) {
+        packets_.push_back({
+                .program = &program,
+                .command = command,
+                .instance_count = instance_count,
+                .uniform_offset = 0,
+                .uniform_size = 0,
+        });
+    }
+
+    /// ## CommandList::clear
+    ///
+    /// Removes the recorded packets, keeping the memory for the next frame.
+    void clear() {
+        packets_.clear();
+        uniform_data_.clear();
+    }
+
+    /// ## CommandList::get_packets
+    ///
+    /// @returns The packets in the order they were recorded.
+    [[nodiscard]]
+    std::span<const DrawPacket> get_packets() const {
+        return packets_;
+    }
+
+    /// ## CommandList::get_uniform_data
+    ///
+    /// @returns The uniform data of the packets.
+    [[nodiscard]]
+    std::span<const uint8_t> get_uniform_data() const {
+        return uniform_data_;
+    }
+
+private:
+    friend class CommandQueue;
+
+    explicit CommandList(const size_t uniform_alignment)
+        : uniform_alignment_{uniform_alignment} {}
+};
+
+/// # CommandRecordOptions
+///
+/// Options of `CommandQueue::record`.
+struct CommandRecordOptions {
+    /// The pool to record on, or `nullptr` to use `ThreadPool::get_default`.
+    ThreadPool *pool{nullptr};
+    /// The maximum number of threads recording at once, including the calling thread, or `0` for one per worker of the
+    /// pool and the calling thread. `1` records everything on the calling thread.
+    size_t max_threads{0};
+    /// The smallest number of items worth a list of its own.
+    size_t min_items_per_list{1024};
+};
+
+/// # CommandQueueStats
+///
+/// Work of the last `CommandQueue::execute`.
+struct CommandQueueStats {
+    size_t list_count{0};
+    size_t packet_count{0};
+    size_t uniform_bytes{0};
+    size_t program_changes{0};
+    size_t vertex_array_changes{0};
+};
+
+/// # CommandQueue
+///
+/// The command lists of a frame, and their replay on the thread of the OpenGL context.
+///
+/// `CommandQueue::record` splits the items of a scene into contiguous ranges and records each range into a list of
+/// its own on the thread pool, so that traversal, matrix math and uniform preparation run on several threads.
+/// `CommandQueue::execute` then uploads the uniform data of every list to one buffer and replays the packets in list
+/// order, using a program and binding a vertex array only when they change, and binding the uniform data of each draw
+/// by range to the draw block binding point. The dequantization uniforms of packed meshes are set when their bounds
+/// differ from those of the previous draw.
+///
+/// Programs read their per-draw data from a uniform block bound to `CommandQueue::get_uniform_binding`. The uniform
+/// buffers of two frames alternate, so the upload of a frame does not wait for the draws of the previous one.
+///
+/// ## Examples
+///
+/// ```cpp
+/// program->bind_uniform_block("DrawBlock", queue->get_uniform_binding());
+/// const auto command = mesh->get_draw_command();
+/// queue->record(objects.size(), [&](CommandList &list, const size_t first, const size_t last) {
+///     for (size_t i = first; i < last; ++i) {
+///         list.draw(*program, command, DrawBlock{.model_transform = objects[i].get_transform()});
+///     }
+/// });
+/// queue->execute();
+/// ```
+class CommandQueue {
+    const uint32_t uniform_binding_;
+    const size_t uniform_alignment_;
+    std::array<std::unique_ptr<Buffer>, 2> uniform_buffers_;
+    size_t frame_index_{0};
+    std::vector<CommandList> lists_;
+    /// Lists handed out by the last `CommandQueue::begin`
+    size_t list_count_{0};
+    CommandQueueStats stats_{};
+
+public:
+    /// ## CommandQueue::create
+    ///
+    /// Creates a new command queue and reserves a uniform block binding point for the per-draw data.
+    ///
+    /// @returns `CommandQueue` object wrapped in `std::unique_ptr` if successful, or `nullptr` if there is no free
+    /// binding point.
+    static std::unique_ptr<CommandQueue> create();
+
+    /// ## CommandQueue::~CommandQueue
+    ///
+    /// Destructor that releases the binding point.
+    ~CommandQueue();
+
+    CommandQueue(const CommandQueue &) = delete;
+    CommandQueue &operator=(const CommandQueue &) = delete;
+
+    /// ## CommandQueue::begin
+    ///
+    /// Starts a frame with empty lists, removing the packets of the previous one. Needs no OpenGL.
+    ///
+    /// @param list_count: The number of lists, at least `1`.
+    ///
+    /// @returns The lists, to be recorded by different threads and replayed in this order.
+    std::span<CommandList> begin(size_t list_count);
+
+    /// ## CommandQueue::record
+    ///
+    /// Starts a frame and records the items in contiguous ranges on the thread pool, one list per range, the first
+    /// range on the calling thread. Must not be called from a task of the pool.
+    ///
+    /// @param item_count: The number of items, e.g., objects of the scene.
+    /// @param record_range: Records the items `[first, last)` into the list, called once per list, possibly at once
+    /// from several threads.
+    /// @param options: The threads to use.
+    void record(
+            size_t item_count, const std::function<void(CommandList &list, size_t first, size_t last)> &record_range,
+            const CommandRecordOptions &options = {}
+    );
+
+    /// ## CommandQueue::execute
+    ///
+    /// Uploads the uniform data and replays the packets of the lists of `CommandQueue::begin` in order. Must be called
+    /// on the thread of the context.
+    void execute();
+
+    /// ## CommandQueue::get_uniform_binding
+    ///
+    /// @returns The uniform block binding point of the per-draw data.
+    [[nodiscard]]
+    uint32_t get_uniform_binding() const {
+        return uniform_binding_;
+    }
+
+    /// ## CommandQueue::get_stats
+    ///
+    /// @returns The work of the last `CommandQueue::execute`.
+    [[nodiscard]]
+    const CommandQueueStats &get_stats() const {
+        return stats_;
+    }
+
+private:
+    CommandQueue(uint32_t uniform_binding, size_t uniform_alignment);
+};
+
+
+#endif // __COMMAND_LIST_H__
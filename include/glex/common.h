@@ -6,9 +6,12 @@
 #include <glfw/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <glm/gtc/type_ptr.hpp>
 #include <optional>
 #include <string>
+#include <string_view>
 
 /// ## loadTextFile
 ///
@@ -35,5 +38,32 @@ std::optional<std::string> load_text_file(const std::string &filename);
 /// attenuation coefficients.
 glm::vec3 get_attenuation_coefficient(float dist);
 
+/// The offset basis of the 64-bit FNV-1a hash, the hash of no bytes.
+constexpr uint64_t HASH_OFFSET_BASIS{0xcbf29ce484222325ull};
+
+/// ## hash_bytes
+///
+/// Calculates the 64-bit FNV-1a hash of bytes. Hashes of several byte ranges are chained by passing the hash of the
+/// previous range.
+///
+/// @param data: The bytes to hash.
+/// @param size: The number of bytes.
+/// @param hash: The hash to continue, or `HASH_OFFSET_BASIS` to start a new one.
+///
+/// @returns The hash of the bytes following `hash`.
+uint64_t hash_bytes(const void *data, size_t size, uint64_t hash = HASH_OFFSET_BASIS);
+
+/// ## hash_bytes
+///
+/// Calculates the 64-bit FNV-1a hash of the bytes of a string.
+///
+/// @param bytes: The bytes to hash.
+/// @param hash: The hash to continue, or `HASH_OFFSET_BASIS` to start a new one.
+///
+/// @returns The hash of the bytes following `hash`.
+inline uint64_t hash_bytes(const std::string_view bytes, const uint64_t hash = HASH_OFFSET_BASIS) {
+    return hash_bytes(bytes.data(), bytes.size(), hash);
+}
+
 
 #endif // __COMMON_H__
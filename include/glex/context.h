@@ -3,7 +3,9 @@
 
 
 #include <memory>
+#include <span>
 #include "glex/program.h"
+#include "glex/uniform_buffer.h"
 
 /// # Context
 ///
@@ -36,7 +38,24 @@ protected:
     int width_{WINDOW_WIDTH}, height_{WINDOW_HEIGHT};
     float aspect_ratio_{static_cast<float>(WINDOW_WIDTH) / static_cast<float>(WINDOW_HEIGHT)};
 
+    /// # Context::PointLight
+    ///
+    /// A point light shared with shaders through the `Lights` uniform block.
+    struct PointLight {
+        glm::vec3 position;
+        glm::vec3 color;
+    };
+
+    ///@{
+    /// Uniform blocks shared by all programs of the context
+    std::unique_ptr<UniformBuffer> camera_block_;
+    std::unique_ptr<UniformBuffer> lights_block_;
+    ///@}
+
 public:
+    /// Maximum number of lights in the `Lights` uniform block. It must match `MAX_LIGHTS` in the shaders.
+    static constexpr size_t MAX_LIGHTS{256};
+
     /// ## Context::create
     ///
     /// Creates and initializes a new `Context` object.
@@ -101,6 +120,37 @@ public:
 
 protected:
     Context() {}
+
+    /// ## Context::init_uniform_blocks
+    ///
+    /// Creates the uniform buffers of the `Camera` and `Lights` uniform blocks.
+    ///
+    /// @returns `true` if the buffers are created successfully, `false` otherwise.
+    bool init_uniform_blocks();
+
+    /// ## Context::bind_uniform_blocks
+    ///
+    /// Connects the `Camera` and `Lights` uniform blocks of the program to the buffers of the context. Blocks that
+    /// are not used by the program are ignored.
+    ///
+    /// @param program: The program to bind the uniform blocks of.
+    void bind_uniform_blocks(const Program &program) const;
+
+    /// ## Context::upload_camera_block
+    ///
+    /// Uploads the view and projection matrices and the camera position to the `Camera` uniform block.
+    ///
+    /// @param view: The view matrix.
+    /// @param projection: The projection matrix.
+    void upload_camera_block(const glm::mat4 &view, const glm::mat4 &projection) const;
+
+    /// ## Context::upload_lights_block
+    ///
+    /// Uploads lights to the `Lights` uniform block. Lights beyond `Context::MAX_LIGHTS` are ignored. Only the count
+    /// and the slots of the given lights are uploaded.
+    ///
+    /// @param lights: The lights to upload.
+    void upload_lights_block(std::span<const PointLight> lights) const;
 };
 
 
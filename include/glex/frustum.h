@@ -0,0 +1,140 @@
+#ifndef __FRUSTUM_H__
+#define __FRUSTUM_H__
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glex/common.h"
+#include "glex/mesh.h"
+
+/// # Frustum
+///
+/// The six planes bounding the volume a view-projection matrix maps into clip space.
+///
+/// ## Examples
+///
+/// ```cpp
+/// const auto frustum = Frustum::from_matrix(projection * view);
+/// if (frustum.intersects(mesh->get_bounding_box().transform(transform))) {
+///     mesh->draw(*program);
+/// }
+/// ```
+struct Frustum {
+    /// The planes as `(normal, distance)` with unit normals facing inward, in the order left, right, bottom, top, near,
+    /// far. A point `p` is inside a plane if `dot(normal, p) + distance >= 0`.
+    std::array<glm::vec4, 6> planes;
+
+    /// ## Frustum::from_matrix
+    ///
+    /// Extracts the planes from the rows of a matrix.
+    ///
+    /// @param matrix: The product of the projection and view matrices, for planes in world space, or of those and a
+    /// model transform, for planes in model space.
+    ///
+    /// @returns The frustum of the matrix.
+    static Frustum from_matrix(const glm::mat4 &matrix);
+
+    /// ## Frustum::intersects
+    ///
+    /// @param sphere: A sphere in the space of the planes.
+    ///
+    /// @returns `false` if the sphere is entirely outside a plane. Spheres just outside a corner of the frustum may
+    /// pass, which only costs a draw.
+    [[nodiscard]]
+    bool intersects(const BoundingSphere &sphere) const;
+
+    /// ## Frustum::intersects
+    ///
+    /// @param box: A box in the space of the planes.
+    ///
+    /// @returns `false` if the box is entirely outside a plane, tested at the corner farthest along its normal.
+    [[nodiscard]]
+    bool intersects(const BoundingBox &box) const;
+};
+
+/// # FrustumCullStats
+///
+/// Results of `BoundingSphereSet::cull`, summed over the calls that share them.
+struct FrustumCullStats {
+    size_t visible_count{0};
+    size_t culled_count{0};
+};
+
+/// # BoundingSphereSet
+///
+/// World-space bounding spheres of many objects in structure-of-arrays form, culled against a frustum several at a
+/// time.
+///
+/// Each coordinate and the radius are kept in an array of their own, padded to a multiple of eight, so `cull` loads
+/// the same component of eight spheres with one AVX instruction, or four with SSE2, and tests them against a plane
+/// together. Without either, the spheres are tested one by one.
+///
+/// ## Examples
+///
+/// ```cpp
+/// BoundingSphereSet spheres;
+/// for (const auto &object : objects) {
+///     spheres.add(object.mesh->get_bounding_sphere(), object.transform);
+/// }
+/// std::vector<uint32_t> visible;
+/// spheres.cull(Frustum::from_matrix(projection * view), visible);
+/// for (const auto i : visible) {
+///     objects[i].mesh->draw(*program);
+/// }
+/// ```
+class BoundingSphereSet {
+    std::vector<float> center_x_, center_y_, center_z_, radius_;
+    size_t size_{0};
+
+public:
+    /// ## BoundingSphereSet::clear
+    ///
+    /// Removes every sphere, keeping the storage for the next ones.
+    void clear();
+
+    /// ## BoundingSphereSet::reserve
+    ///
+    /// @param capacity: The number of spheres to allocate storage for.
+    void reserve(size_t capacity);
+
+    /// ## BoundingSphereSet::add
+    ///
+    /// Adds a sphere after transforming it to world space with `BoundingSphere::transform`.
+    ///
+    /// @param sphere: The sphere in model space.
+    /// @param transform: The model transform of the object.
+    ///
+    /// @returns The index of the sphere, which `cull` reports if it is visible.
+    uint32_t add(const BoundingSphere &sphere, const glm::mat4 &transform);
+
+    /// ## BoundingSphereSet::set
+    ///
+    /// Replaces a sphere, e.g., after its object moved.
+    ///
+    /// @param index: The index of the sphere.
+    /// @param sphere: The sphere in model space.
+    /// @param transform: The model transform of the object.
+    void set(uint32_t index, const BoundingSphere &sphere, const glm::mat4 &transform);
+
+    /// ## BoundingSphereSet::size
+    ///
+    /// @returns The number of spheres.
+    [[nodiscard]]
+    size_t size() const {
+        return size_;
+    }
+
+    /// ## BoundingSphereSet::cull
+    ///
+    /// Tests every sphere against the frustum with `Frustum::intersects`.
+    ///
+    /// @param frustum: The frustum in world space.
+    /// @param visible: The indices of the spheres that intersect the frustum in ascending order, replaced.
+    /// @param stats: The statistics to add the results to, or `nullptr`.
+    void cull(const Frustum &frustum, std::vector<uint32_t> &visible, FrustumCullStats *stats = nullptr) const;
+};
+
+
+#endif // __FRUSTUM_H__
@@ -0,0 +1,324 @@
+#ifndef __GEOMETRY_POOL_H__
+#define __GEOMETRY_POOL_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+#include "glex/buffer.h"
+#include "glex/common.h"
+#include "glex/vertex_layout.h"
+
+/// # RangeAllocator
+///
+/// A first-fit free-list allocator of ranges in `[0, capacity)`. It only does the bookkeeping; the memory itself lives
+/// elsewhere, e.g., in a buffer object.
+///
+/// Free blocks are kept sorted by offset, and a freed range is merged with its free neighbors, so that the free list
+/// stays as short as the fragmentation allows.
+class RangeAllocator {
+    size_t capacity_;
+    size_t used_{0};
+    /// Free blocks, from offset to size.
+    std::map<size_t, size_t> free_blocks_;
+
+public:
+    /// ## RangeAllocator::RangeAllocator
+    ///
+    /// @param capacity: The size of the range to allocate from.
+    explicit RangeAllocator(size_t capacity);
+
+    /// ## RangeAllocator::allocate
+    ///
+    /// @param size: The size of the range, greater than zero.
+    ///
+    /// @returns The offset of the first free block large enough, or `std::nullopt` if there is none.
+    std::optional<size_t> allocate(size_t size);
+
+    /// ## RangeAllocator::free
+    ///
+    /// Returns a range returned by `RangeAllocator::allocate` to the free list.
+    void free(size_t offset, size_t size);
+
+    /// ## RangeAllocator::grow
+    ///
+    /// Extends the capacity, appending the new space to the last free block.
+    ///
+    /// @param capacity: The new capacity, not less than the current one.
+    void grow(size_t capacity);
+
+    /// ## RangeAllocator::reset
+    ///
+    /// Marks `[0, used)` as allocated and the rest as one free block, e.g., after the ranges have been compacted.
+    void reset(size_t used);
+
+    /// ## RangeAllocator::get_capacity
+    ///
+    /// @returns The size of the range to allocate from.
+    [[nodiscard]]
+    size_t get_capacity() const {
+        return capacity_;
+    }
+
+    /// ## RangeAllocator::get_used
+    ///
+    /// @returns The total size of the allocated ranges.
+    [[nodiscard]]
+    size_t get_used() const {
+        return used_;
+    }
+
+    /// ## RangeAllocator::get_free_block_count
+    ///
+    /// @returns The number of free blocks.
+    [[nodiscard]]
+    size_t get_free_block_count() const {
+        return free_blocks_.size();
+    }
+
+    /// ## RangeAllocator::get_largest_free_block
+    ///
+    /// @returns The size of the largest free block, which is the largest size that can be allocated.
+    [[nodiscard]]
+    size_t get_largest_free_block() const;
+};
+
+/// # VertexAttrib
+///
+/// One attribute of a vertex format, as passed to `VertexLayout::set_attrib`. The offset is relative to a vertex in the
+/// stream, i.e., the buffer, that holds the attribute.
+struct VertexAttrib {
+    uint32_t index;
+    int count;
+    uint32_t type;
+    bool normalized;
+    size_t offset;
+    uint32_t stream{0};
+};
+
+/// # GeometryRange
+///
+/// Where the vertices and indices of one mesh are in a `GeometryPool`. Indices are relative to the first vertex, which
+/// is passed as the base vertex of the draw call.
+struct GeometryRange {
+    size_t vertex_offset;
+    size_t vertex_count;
+    size_t index_offset;
+    size_t index_count;
+};
+
+/// # GeometryPool
+///
+/// Large vertex and index buffers that many meshes of the same vertex format are sub-allocated from, together with the
+/// single vertex array object that describes them.
+///
+/// Meshes in a pool are drawn with `glDrawElementsBaseVertex` without switching vertex array objects or buffers in
+/// between. When a buffer runs out of space, it is reallocated at twice the size and its contents are copied on the
+/// GPU. Freed ranges return to a free list; `GeometryPool::defragment` packs the live ranges to the start of the
+/// buffers, which keeps their IDs valid.
+///
+/// The vertices may be split into several streams, each in its own vertex buffer at the same vertex offsets. A pool
+/// with more than one stream also has a vertex array object that reads only stream 0, e.g., the positions for depth
+/// passes.
+///
+/// ## Examples
+///
+/// ```cpp
+/// auto pool = GeometryPool::create(attribs, {sizeof(Vertex)});
+/// const void *streams[] = {vertices.data()};
+/// const auto id = pool->allocate(streams, vertices.size(), indices.data(), indices.size());
+/// pool->bind();
+/// pool->draw(*id, GL_TRIANGLES);
+/// pool->free(*id);
+/// ```
+class GeometryPool {
+public:
+    /// Memory usage of a `GeometryPool`. Sizes are in bytes.
+    struct Stats {
+        size_t allocations{0};
+        size_t vertex_capacity{0};
+        size_t vertex_used{0};
+        size_t index_capacity{0};
+        size_t index_used{0};
+        /// Free blocks in the vertex and index buffers. More than one per buffer means the pool is fragmented.
+        size_t free_blocks{0};
+        /// Free bytes outside the largest free block of each buffer, which large meshes cannot use until the pool is
+        /// defragmented.
+        size_t fragmented{0};
+    };
+
+private:
+    const std::vector<VertexAttrib> attribs_;
+    /// Vertex sizes of the streams in bytes.
+    const std::vector<size_t> vertex_strides_;
+
+    std::unique_ptr<VertexLayout> vertex_layout_;
+    /// Vertex array object of stream 0, or `nullptr` if there is a single stream.
+    std::unique_ptr<VertexLayout> stream0_layout_;
+    std::vector<std::unique_ptr<Buffer>> vertex_buffers_;
+    std::unique_ptr<Buffer> index_buffer_;
+    RangeAllocator vertex_allocator_;
+    RangeAllocator index_allocator_;
+
+    /// Ranges by ID, where freed IDs hold `std::nullopt` until they are reused.
+    std::vector<std::optional<GeometryRange>> ranges_;
+    std::vector<uint32_t> free_ids_;
+
+public:
+    /// Default number of vertices the vertex buffer is created with.
+    static constexpr size_t DEFAULT_VERTEX_CAPACITY{256 * 1024};
+    /// Default number of indices the index buffer is created with.
+    static constexpr size_t DEFAULT_INDEX_CAPACITY{1024 * 1024};
+
+    /// ## GeometryPool::create
+    ///
+    /// Creates a new pool with its vertex array object and buffers.
+    ///
+    /// @param attribs: The attributes of the vertex format.
+    /// @param vertex_strides: The size of a vertex in bytes, per stream.
+    /// @param vertex_capacity: The number of vertices the vertex buffers hold initially.
+    /// @param index_capacity: The number of indices the index buffer holds initially.
+    ///
+    /// @returns `GeometryPool` object wrapped in `std::unique_ptr` if successful, or `nullptr` if creation fails.
+    static std::unique_ptr<GeometryPool> create(
+            const std::vector<VertexAttrib> &attribs, const std::vector<size_t> &vertex_strides,
+            size_t vertex_capacity = DEFAULT_VERTEX_CAPACITY, size_t index_capacity = DEFAULT_INDEX_CAPACITY
+    );
+
+    GeometryPool(const GeometryPool &) = delete;
+    GeometryPool &operator=(const GeometryPool &) = delete;
+
+    /// ## GeometryPool::allocate
+    ///
+    /// Copies vertices and 32-bit indices into the pool, growing its buffers if needed.
+    ///
+    /// @param vertex_streams: Pointers to the vertices of each stream in the format of the pool.
+    /// @param vertex_count: The number of vertices.
+    /// @param indices: Pointer to the indices, relative to the first vertex.
+    /// @param index_count: The number of indices.
+    ///
+    /// @returns ID of the range, or `std::nullopt` if the buffers cannot grow.
+    std::optional<uint32_t> allocate(
+            std::span<const void *const> vertex_streams, size_t vertex_count, const uint32_t *indices,
+            size_t index_count
+    );
+
+    /// ## GeometryPool::free
+    ///
+    /// Releases the range of an ID returned by `GeometryPool::allocate`. The ID may be reused afterwards.
+    void free(uint32_t id);
+
+    /// ## GeometryPool::get_range
+    ///
+    /// @returns The current range of the ID, which changes when the pool is defragmented.
+    [[nodiscard]]
+    const GeometryRange &get_range(const uint32_t id) const {
+        return *ranges_[id];
+    }
+
+    /// ## GeometryPool::get_vertex_layout
+    ///
+    /// @returns The vertex array object shared by all meshes in the pool.
+    [[nodiscard]]
+    const VertexLayout &get_vertex_layout() const {
+        return *vertex_layout_;
+    }
+
+    /// ## GeometryPool::get_stream0_vertex_layout
+    ///
+    /// @returns The vertex array object that reads only stream 0, which is the one of `GeometryPool::get_vertex_layout`
+    /// if there is a single stream.
+    [[nodiscard]]
+    const VertexLayout &get_stream0_vertex_layout() const {
+        return stream0_layout_ ? *stream0_layout_ : *vertex_layout_;
+    }
+
+    /// ## GeometryPool::get_stream_count
+    ///
+    /// @returns The number of vertex streams.
+    [[nodiscard]]
+    size_t get_stream_count() const {
+        return vertex_strides_.size();
+    }
+
+    /// ## GeometryPool::bind
+    ///
+    /// Binds the vertex array object of the pool.
+    void bind() const;
+
+    /// ## GeometryPool::bind_stream0
+    ///
+    /// Binds the vertex array object that reads only stream 0.
+    void bind_stream0() const;
+
+    /// ## GeometryPool::draw
+    ///
+    /// Draws the range of an ID with `glDrawElementsBaseVertex`. One of the vertex array objects of the pool must be
+    /// bound.
+    ///
+    /// @param id: ID of the range.
+    /// @param primitive_type: The type of primitive to render (e.g., GL_TRIANGLES).
+    /// @param instance_count: The number of instances, drawn with `glDrawElementsInstancedBaseVertex` if not `1`.
+    void draw(uint32_t id, uint32_t primitive_type, size_t instance_count = 1) const;
+
+    /// ## GeometryPool::draw_indices
+    ///
+    /// Draws part of the indices of the range of an ID, e.g., a level of detail stored after the full mesh. One of the
+    /// vertex array objects of the pool must be bound.
+    ///
+    /// @param id: ID of the range.
+    /// @param primitive_type: The type of primitive to render (e.g., GL_TRIANGLES).
+    /// @param first_index: The first index to draw, relative to the start of the range.
+    /// @param index_count: The number of indices to draw.
+    /// @param instance_count: The number of instances, drawn with `glDrawElementsInstancedBaseVertex` if not `1`.
+    void draw_indices(
+            uint32_t id, uint32_t primitive_type, size_t first_index, size_t index_count, size_t instance_count = 1
+    ) const;
+
+    /// ## GeometryPool::defragment
+    ///
+    /// Packs the live ranges to the start of the buffers in their current order, so that all free space becomes one
+    /// block at the end of each buffer. The data is copied on the GPU into new buffers of the same capacity.
+    ///
+    /// @returns `true` if the pool has been defragmented, `false` if creating the new buffers fails.
+    bool defragment();
+
+    /// ## GeometryPool::get_stats
+    ///
+    /// @returns The memory usage of the pool.
+    [[nodiscard]]
+    Stats get_stats() const;
+
+private:
+    GeometryPool(
+            const std::vector<VertexAttrib> &attribs, const std::vector<size_t> &vertex_strides,
+            std::unique_ptr<VertexLayout> vertex_layout, std::unique_ptr<VertexLayout> stream0_layout,
+            std::vector<std::unique_ptr<Buffer>> vertex_buffers, std::unique_ptr<Buffer> index_buffer
+    );
+
+    /// ## GeometryPool::set_attribs
+    ///
+    /// Points the vertex attributes and the element arrays of the vertex array objects at the current buffers.
+    void set_attribs() const;
+
+    /// ## GeometryPool::grow_vertices
+    ///
+    /// Reallocates the vertex buffers large enough for a free block of `count` vertices, and copies their contents.
+    ///
+    /// @returns `true` if the buffers have grown, `false` if reallocation fails.
+    bool grow_vertices(size_t count);
+
+    /// ## GeometryPool::reserve
+    ///
+    /// Grows the buffers until they have a free block for the given number of vertices and indices.
+    ///
+    /// @returns `true` if there is enough space, `false` if growing fails.
+    bool reserve(size_t vertex_count, size_t index_count);
+};
+
+
+#endif // __GEOMETRY_POOL_H__
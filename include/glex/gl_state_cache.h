@@ -0,0 +1,202 @@
+#ifndef __GL_STATE_CACHE_H__
+#define __GL_STATE_CACHE_H__
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "glex/common.h"
+
+/// # GLStateCache
+///
+/// A shadow copy of the binding and fixed-function state of the current OpenGL context, which drops calls that would
+/// not change the state.
+///
+/// It tracks the bound program, vertex array, read and draw framebuffers, active texture unit, the 2D texture, cube map
+/// texture and sampler of every texture unit, generic and indexed uniform buffer bindings, other generic buffer
+/// bindings, the viewport, the depth, cull, blend, stencil, scissor and multisample capabilities, and the depth
+/// function, depth mask, color mask, cull face and blend function.
+///
+/// Every state change must go through the cache for the shadow copy to stay correct. The wrapper classes (`Program`,
+/// `VertexLayout`, `Buffer`, `Texture`, `FrameBuffer`, ...) do so, and they tell the cache when they delete an object,
+/// since deleting a bound object resets the binding to zero. After code outside the cache changes state, such as the
+/// ImGui backend or a different context being made current, call `GLStateCache::invalidate`.
+///
+/// `GL_ELEMENT_ARRAY_BUFFER` is part of the vertex array state, so its bindings are always issued.
+///
+/// ## Examples
+///
+/// ```cpp
+/// GLStateCache::enable(GL_DEPTH_TEST);
+/// program->use();
+/// // Skipped, because the program is already in use.
+/// program->use();
+/// const auto stats = GLStateCache::get_stats(); // 2 issued, 1 skipped
+/// ```
+class GLStateCache {
+public:
+    /// Number of state changes passed to the driver and number of calls dropped because the state was unchanged.
+    struct Stats {
+        size_t issued{0};
+        size_t skipped{0};
+    };
+
+    /// Number of texture units tracked by the cache. Units above it are always issued.
+    static constexpr uint32_t MAX_TEXTURE_UNITS{32};
+    /// Number of indexed uniform buffer binding points tracked by the cache. Binding points above it are always issued.
+    static constexpr uint32_t MAX_UNIFORM_BUFFER_BINDINGS{36};
+
+    /// ## GLStateCache::use_program
+    ///
+    /// Equivalent to `glUseProgram`.
+    static void use_program(uint32_t program);
+
+    /// ## GLStateCache::bind_vertex_array
+    ///
+    /// Equivalent to `glBindVertexArray`.
+    static void bind_vertex_array(uint32_t vertex_array);
+
+    /// ## GLStateCache::bind_framebuffer
+    ///
+    /// Equivalent to `glBindFramebuffer`.
+    ///
+    /// @param target: `GL_FRAMEBUFFER`, `GL_READ_FRAMEBUFFER` or `GL_DRAW_FRAMEBUFFER`.
+    /// @param framebuffer: The framebuffer ID, or `0` for the default framebuffer.
+    static void bind_framebuffer(GLenum target, uint32_t framebuffer);
+
+    /// ## GLStateCache::active_texture
+    ///
+    /// Equivalent to `glActiveTexture(GL_TEXTURE0 + texture_unit)`.
+    static void active_texture(uint32_t texture_unit);
+
+    /// ## GLStateCache::bind_texture
+    ///
+    /// Equivalent to `glBindTexture`, which binds the texture to the active texture unit.
+    static void bind_texture(GLenum target, uint32_t texture);
+
+    /// ## GLStateCache::bind_texture_to_unit
+    ///
+    /// Binds a texture to a texture unit. The active texture unit is changed only if the binding of the unit changes,
+    /// so the active texture unit is unspecified afterwards.
+    ///
+    /// @param texture_unit: The texture unit to bind the texture to.
+    /// @param target: The texture target (e.g., `GL_TEXTURE_2D`, `GL_TEXTURE_CUBE_MAP`).
+    /// @param texture: The texture ID.
+    static void bind_texture_to_unit(uint32_t texture_unit, GLenum target, uint32_t texture);
+
+    /// ## GLStateCache::bind_sampler
+    ///
+    /// Equivalent to `glBindSampler`.
+    static void bind_sampler(uint32_t texture_unit, uint32_t sampler);
+
+    /// ## GLStateCache::bind_buffer
+    ///
+    /// Equivalent to `glBindBuffer`.
+    static void bind_buffer(GLenum target, uint32_t buffer);
+
+    /// ## GLStateCache::bind_buffer_base
+    ///
+    /// Equivalent to `glBindBufferBase`, which also binds the buffer to the generic binding point of the target.
+    static void bind_buffer_base(GLenum target, uint32_t index, uint32_t buffer);
+
+    /// ## GLStateCache::bind_buffer_range
+    ///
+    /// Equivalent to `glBindBufferRange`, which also binds the buffer to the generic binding point of the target.
+    /// Ranges are not tracked, so the call is always issued, and the next `GLStateCache::bind_buffer_base` of the same
+    /// index is issued as well.
+    static void bind_buffer_range(GLenum target, uint32_t index, uint32_t buffer, size_t offset, size_t size);
+
+    /// ## GLStateCache::set_viewport
+    ///
+    /// Equivalent to `glViewport`.
+    static void set_viewport(int32_t x, int32_t y, int32_t width, int32_t height);
+
+    /// ## GLStateCache::enable
+    ///
+    /// Equivalent to `glEnable`.
+    static void enable(GLenum capability);
+
+    /// ## GLStateCache::disable
+    ///
+    /// Equivalent to `glDisable`.
+    static void disable(GLenum capability);
+
+    /// ## GLStateCache::set_depth_func
+    ///
+    /// Equivalent to `glDepthFunc`.
+    static void set_depth_func(GLenum func);
+
+    /// ## GLStateCache::set_depth_mask
+    ///
+    /// Equivalent to `glDepthMask`.
+    static void set_depth_mask(bool enabled);
+
+    /// ## GLStateCache::get_depth_mask
+    ///
+    /// @returns Whether depth writes are enabled. If the cache does not know it yet, it is read from the context.
+    [[nodiscard]]
+    static bool get_depth_mask();
+
+    /// ## GLStateCache::set_color_mask
+    ///
+    /// Equivalent to `glColorMask`.
+    static void set_color_mask(bool red, bool green, bool blue, bool alpha);
+
+    /// ## GLStateCache::set_color_mask
+    ///
+    /// Equivalent to `glColorMask`, with the channels in red, green, blue, alpha order.
+    static void set_color_mask(const std::array<bool, 4> &mask) {
+        set_color_mask(mask[0], mask[1], mask[2], mask[3]);
+    }
+
+    /// ## GLStateCache::get_color_mask
+    ///
+    /// @returns Whether writes to the red, green, blue and alpha channels are enabled. If the cache does not know it
+    /// yet, it is read from the context.
+    [[nodiscard]]
+    static std::array<bool, 4> get_color_mask();
+
+    /// ## GLStateCache::set_cull_face
+    ///
+    /// Equivalent to `glCullFace`.
+    static void set_cull_face(GLenum mode);
+
+    /// ## GLStateCache::set_blend_func
+    ///
+    /// Equivalent to `glBlendFunc`.
+    static void set_blend_func(GLenum source_factor, GLenum destination_factor);
+
+    ///@{
+    /// ## GLStateCache::forget_*
+    ///
+    /// Resets the bindings of a deleted object to zero, as OpenGL does when a bound object is deleted. It must be
+    /// called when an object is deleted, because a new object may get the same ID.
+    static void forget_program(uint32_t program);
+    static void forget_vertex_array(uint32_t vertex_array);
+    static void forget_framebuffer(uint32_t framebuffer);
+    static void forget_texture(uint32_t texture);
+    static void forget_sampler(uint32_t sampler);
+    static void forget_buffer(uint32_t buffer);
+    ///@}
+
+    /// ## GLStateCache::invalidate
+    ///
+    /// Forgets all tracked state, so that the next call for each state is issued.
+    static void invalidate();
+
+    /// ## GLStateCache::get_stats
+    ///
+    /// @returns The number of issued and skipped calls since the last `GLStateCache::reset_stats`.
+    [[nodiscard]]
+    static Stats get_stats();
+
+    /// ## GLStateCache::reset_stats
+    ///
+    /// Resets the issued and skipped counts, e.g., at the start of a frame.
+    static void reset_stats();
+
+    GLStateCache() = delete;
+};
+
+
+#endif // __GL_STATE_CACHE_H__
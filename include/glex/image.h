@@ -4,9 +4,22 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <glm/vec4.hpp>
 #include <memory>
 #include <string>
+#include <vector>
+#include "glex/thread_pool.h"
+
+/// # ImageLoadOptions
+///
+/// Options of `Image::load_many`.
+struct ImageLoadOptions {
+    /// Whether to load the images with their vertical flipped or load them as is.
+    bool flip_vertical{true};
+    /// The pool to decode the images on, or `nullptr` to use `ThreadPool::get_default`.
+    ThreadPool *pool{nullptr};
+};
 
 /// # Image
 ///
@@ -29,9 +42,33 @@ public:
     /// @param flip_vertical: Whether to load the image with its vertical flipped or load it as is.
     ///
     /// @returns `std::unique_ptr` to an `Image` object if successful, or `nullptr` if loading fails.
+    ///
+    /// #### Details
+    /// The flip setting applies only to this call, so images can be loaded from several threads at once.
     [[nodiscard]]
     static std::unique_ptr<Image> load(const std::string &filepath, bool flip_vertical = true);
 
+    /// ## Image::load_many
+    ///
+    /// Decodes several image files in parallel on a thread pool.
+    ///
+    /// @param filepaths: The paths to the image files.
+    /// @param options: The options for loading images.
+    /// @param on_loaded: Optional callback invoked on the calling thread for each successfully loaded image as soon as
+    ///                   it is decoded, in completion order, with the index of its path. It can be used to upload
+    ///                   textures while the remaining images are still being decoded.
+    ///
+    /// @returns `std::unique_ptr`s to the `Image` objects in the order of `filepaths`, with `nullptr` for images that
+    /// failed to load.
+    ///
+    /// #### Details
+    /// The number of images, the decoded size and the throughput in MB/s are logged for each call.
+    [[nodiscard]]
+    static std::vector<std::unique_ptr<Image>> load_many(
+            const std::vector<std::string> &filepaths, const ImageLoadOptions &options = {},
+            const std::function<void(size_t index, const Image &image)> &on_loaded = {}
+    );
+
     /// ## Image::create
     ///
     /// Creates a new empty image with the specified dimensions and number of color channels.
@@ -90,6 +127,14 @@ public:
         return bytes_per_channel_;
     }
 
+    /// ## Image::get_byte_size
+    ///
+    /// @returns size of the pixel data in bytes.
+    [[nodiscard]]
+    size_t get_byte_size() const {
+        return width_ * height_ * channels_ * bytes_per_channel_;
+    }
+
     /// ## Image::set_check_image
     ///
     /// Sets the image data to a checkerboard pattern.
@@ -0,0 +1,209 @@
+#ifndef __INDIRECT_DRAW_LIST_H__
+#define __INDIRECT_DRAW_LIST_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "glex/buffer.h"
+#include "glex/common.h"
+#include "glex/geometry_pool.h"
+#include "glex/mesh.h"
+#include "glex/model.h"
+#include "glex/program.h"
+
+/// # DrawElementsIndirectCommand
+///
+/// One draw of `glMultiDrawElementsIndirect`, laid out as OpenGL reads it from `GL_DRAW_INDIRECT_BUFFER`.
+struct DrawElementsIndirectCommand {
+    uint32_t count;
+    uint32_t instance_count;
+    uint32_t first_index;
+    int32_t base_vertex;
+    uint32_t base_instance;
+};
+
+/// # DrawData
+///
+/// Per-draw data of `IndirectDrawList`, read by shaders from the `drawData` buffer texture as six `vec4` texels.
+struct DrawData {
+    glm::mat4 model_transform;
+    /// Bounding box of packed positions as `PositionQuantization`, or the identity for `VertexFormat::Float`.
+    glm::vec4 position_scale;
+    glm::vec4 position_offset;
+};
+
+/// # IndirectDrawList
+///
+/// A list of pooled meshes with their model transforms, submitted with one `glMultiDrawElementsIndirect` call per
+/// material.
+///
+/// `IndirectDrawList::upload` sorts the draws by material and writes a `DrawElementsIndirectCommand` per draw to the
+/// indirect buffer, and a `DrawData` per draw to a buffer texture. A shader compiled with the `DRAW_INDIRECT` define
+/// reads its `DrawData` from the `drawData` buffer texture at the index given by the `aDrawId` attribute. The
+/// attribute is fed per instance from a buffer of draw indices, offset by the base instance of each command.
+///
+/// Without OpenGL 4.3 or `GL_ARB_multi_draw_indirect`, the same commands are submitted one by one with
+/// `glDrawElementsInstancedBaseVertex`, setting `aDrawId` as a constant attribute instead.
+///
+/// ## Examples
+///
+/// ```cpp
+/// auto draw_list = IndirectDrawList::create();
+/// for (const auto &transform : transforms) {
+///     draw_list->add(*model, transform);
+/// }
+/// draw_list->upload();
+/// program->use();
+/// draw_list->draw(*program);
+/// ```
+class IndirectDrawList {
+public:
+    /// Attribute location of `aDrawId`, after the instance attributes of `InstanceBuffer`.
+    static constexpr uint32_t DRAW_ID_ATTRIB_INDEX{9};
+    /// Texture unit of the `drawData` buffer texture, out of the way of material textures.
+    static constexpr uint32_t DRAW_DATA_TEXTURE_UNIT{15};
+
+private:
+    struct Draw {
+        std::shared_ptr<Material> material;
+        uint32_t primitive_type;
+        uint32_t pool_id;
+        /// Index range of the level of detail, relative to the range of the mesh in the pool
+        uint32_t first_index;
+        uint32_t index_count;
+        DrawData data;
+    };
+
+    /// Consecutive commands with the same material and primitive type.
+    struct Batch {
+        std::shared_ptr<Material> material;
+        uint32_t primitive_type;
+        size_t first_command;
+        size_t command_count;
+    };
+
+    std::shared_ptr<GeometryPool> pool_;
+    std::vector<Draw> draws_;
+
+    std::vector<DrawElementsIndirectCommand> commands_;
+    std::vector<Batch> batches_;
+
+    /// `nullptr` if multi-draw indirect is not supported.
+    std::unique_ptr<Buffer> command_buffer_;
+    std::unique_ptr<Buffer> draw_id_buffer_;
+    std::unique_ptr<Buffer> draw_data_buffer_;
+    uint32_t draw_data_texture_{0};
+
+public:
+    /// ## IndirectDrawList::create
+    ///
+    /// Creates an empty draw list.
+    ///
+    /// @returns `IndirectDrawList` object wrapped in `std::unique_ptr` if successful, or `nullptr` if creation fails.
+    static std::unique_ptr<IndirectDrawList> create();
+
+    /// ## IndirectDrawList::is_multi_draw_supported
+    ///
+    /// @returns `true` if `glMultiDrawElementsIndirect` is available, `false` if the draws are submitted one by one.
+    static bool is_multi_draw_supported();
+
+    IndirectDrawList(const IndirectDrawList &) = delete;
+    IndirectDrawList &operator=(const IndirectDrawList &) = delete;
+
+    /// ## IndirectDrawList::~IndirectDrawList
+    ///
+    /// Destructor that deletes the buffer texture.
+    ~IndirectDrawList();
+
+    /// ## IndirectDrawList::add
+    ///
+    /// Adds a draw of the mesh. The mesh must be pooled, in the same pool as the other meshes of the list.
+    ///
+    /// @param mesh: The mesh to draw.
+    /// @param transform: The model transform of the mesh.
+    /// @param lod: The level of detail to draw, `0` being the full mesh.
+    ///
+    /// @returns `true` if the draw is added, `false` if the mesh is not in the pool of the list.
+    bool add(const Mesh &mesh, const glm::mat4 &transform, size_t lod = 0);
+
+    /// ## IndirectDrawList::add
+    ///
+    /// Adds a draw of every mesh of the model.
+    ///
+    /// @param model: The model to draw.
+    /// @param transform: The model transform of the model.
+    /// @param lods: The level of detail of each mesh, e.g., updated by `Model::draw`, or empty to draw the full meshes.
+    ///
+    /// @returns `true` if the draws are added, `false` if a mesh is not in the pool of the list.
+    bool add(const Model &model, const glm::mat4 &transform, std::span<const uint32_t> lods = {});
+
+    /// ## IndirectDrawList::clear
+    ///
+    /// Removes every draw. The buffers keep their storage for the next `IndirectDrawList::upload`.
+    void clear();
+
+    /// ## IndirectDrawList::upload
+    ///
+    /// Builds the commands and uploads them with the `DrawData`. Must be called after the draws change or the pool is
+    /// defragmented.
+    ///
+    /// @returns `true` if the commands are uploaded, `false` if reallocating a buffer fails.
+    bool upload();
+
+    /// ## IndirectDrawList::draw
+    ///
+    /// Submits the uploaded commands with one `glMultiDrawElementsIndirect` call per material, setting the material
+    /// to the program in between. The program must be in use and compiled with the `DRAW_INDIRECT` define.
+    ///
+    /// @param program: The program to set the materials and the buffer texture to.
+    /// @param multi_draw: Whether to use `glMultiDrawElementsIndirect` if supported, or submit the draws one by one.
+    ///
+    /// @returns The number of draw calls issued.
+    size_t draw(const Program &program, bool multi_draw = true) const;
+
+    /// ## IndirectDrawList::draw_depth
+    ///
+    /// Submits the uploaded commands for a depth-only pass, without setting the materials. The draws of every material
+    /// are merged into one `glMultiDrawElementsIndirect` call per primitive type, and only the positions are fetched if
+    /// the pool splits them into a stream of their own. The program must be in use, compiled with the `DRAW_INDIRECT`
+    /// define, and read no vertex attribute but `aPos` and `aDrawId`.
+    ///
+    /// @param program: The program to set the buffer texture to.
+    /// @param multi_draw: Whether to use `glMultiDrawElementsIndirect` if supported, or submit the draws one by one.
+    ///
+    /// @returns The number of draw calls issued.
+    size_t draw_depth(const Program &program, bool multi_draw = true) const;
+
+    /// ## IndirectDrawList::get_draw_count
+    ///
+    /// @returns The number of uploaded draws.
+    [[nodiscard]]
+    size_t get_draw_count() const {
+        return commands_.size();
+    }
+
+    /// ## IndirectDrawList::get_batch_count
+    ///
+    /// @returns The number of uploaded material groups, which is the number of multi-draw calls.
+    [[nodiscard]]
+    size_t get_batch_count() const {
+        return batches_.size();
+    }
+
+private:
+    IndirectDrawList(
+            std::unique_ptr<Buffer> command_buffer, std::unique_ptr<Buffer> draw_id_buffer,
+            std::unique_ptr<Buffer> draw_data_buffer, uint32_t draw_data_texture
+    );
+
+    /// ## IndirectDrawList::submit
+    ///
+    /// Submits the commands in `batches`, through the vertex array object of the pool or of its stream 0.
+    size_t submit(const Program &program, const std::vector<Batch> &batches, bool multi_draw, bool depth_only) const;
+};
+
+
+#endif // __INDIRECT_DRAW_LIST_H__
@@ -0,0 +1,92 @@
+#ifndef __INSTANCE_BUFFER_H__
+#define __INSTANCE_BUFFER_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include "glex/buffer.h"
+#include "glex/common.h"
+
+/// # InstanceData
+///
+/// Per-instance attributes read by shaders compiled with the `INSTANCED` define.
+struct InstanceData {
+    /// Model transform, read as `layout (location = 4) in mat4 aModelTransform`.
+    glm::mat4 model_transform{1.0f};
+    /// Material parameters, read as `layout (location = 8) in vec4 aInstanceParams`. The PBR shaders use `x` as
+    /// metallic and `y` as roughness.
+    glm::vec4 params{0.0f};
+};
+
+/// # InstanceBuffer
+///
+/// A vertex buffer of `InstanceData` that `Mesh::draw_instanced` reads with an attribute divisor of one, so that a
+/// single draw call renders every instance.
+///
+/// ## Examples
+///
+/// ```cpp
+/// std::vector<InstanceData> instances(1000);
+/// // Fill the transforms and parameters...
+/// auto instance_buffer = InstanceBuffer::create(instances);
+/// mesh->draw_instanced(*program, *instance_buffer);
+/// ```
+class InstanceBuffer {
+    std::unique_ptr<Buffer> buffer_;
+    const uint32_t usage_;
+    size_t count_;
+
+public:
+    /// First attribute location of the instance attributes. The model transform takes four locations and the
+    /// parameters one more.
+    static constexpr uint32_t ATTRIB_INDEX{4};
+    /// Number of attribute locations taken by the instance attributes.
+    static constexpr uint32_t ATTRIB_COUNT{5};
+
+    /// ## InstanceBuffer::create
+    ///
+    /// Creates a new instance buffer with the given instances.
+    ///
+    /// @param instances: The instances to upload.
+    /// @param usage: Usage pattern of the data store, `GL_DYNAMIC_DRAW` for instances updated every frame.
+    ///
+    /// @returns `InstanceBuffer` object wrapped in `std::unique_ptr` if successful, or `nullptr` if creation fails.
+    static std::unique_ptr<InstanceBuffer>
+    create(std::span<const InstanceData> instances, uint32_t usage = GL_STATIC_DRAW);
+
+    InstanceBuffer(const InstanceBuffer &) = delete;
+    InstanceBuffer &operator=(const InstanceBuffer &) = delete;
+
+    /// ## InstanceBuffer::get_buffer
+    ///
+    /// @returns Reference to the vertex buffer holding the instances.
+    [[nodiscard]]
+    const Buffer &get_buffer() const {
+        return *buffer_;
+    }
+
+    /// ## InstanceBuffer::get_count
+    ///
+    /// @returns The number of instances.
+    [[nodiscard]]
+    size_t get_count() const {
+        return count_;
+    }
+
+    /// ## InstanceBuffer::set_instances
+    ///
+    /// Replaces the instances. The buffer is reallocated only if there are more instances than it can hold.
+    ///
+    /// @param instances: The new instances.
+    ///
+    /// @returns `true` if the instances are uploaded, `false` if reallocation fails.
+    bool set_instances(std::span<const InstanceData> instances);
+
+private:
+    InstanceBuffer(std::unique_ptr<Buffer> buffer, uint32_t usage, size_t count);
+};
+
+
+#endif // __INSTANCE_BUFFER_H__
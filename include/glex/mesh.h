@@ -4,10 +4,15 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <glm/gtc/type_precision.hpp>
 #include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 #include "glex/buffer.h"
 #include "glex/common.h"
+#include "glex/geometry_pool.h"
+#include "glex/instance_buffer.h"
 #include "glex/program.h"
 #include "glex/texture.h"
 #include "glex/vertex_layout.h"
@@ -61,6 +66,209 @@ struct Vertex {
     );
 };
 
+/// # VertexFormat
+///
+/// The format a `Mesh` stores its vertices in on the GPU.
+enum class VertexFormat {
+    /// `Vertex`, 44 bytes of full floats.
+    Float,
+    /// `PackedVertex`, 20 bytes of quantized attributes. Shaders must be compiled with the `QUANTIZED` define.
+    Packed,
+};
+
+/// # PositionQuantization
+///
+/// The bounding box that the positions of `PackedVertex` are quantized in. A shader dequantizes a position as
+/// `position * scale + offset`.
+struct PositionQuantization {
+    glm::vec3 scale{1.0f};
+    glm::vec3 offset{0.0f};
+
+    /// ## PositionQuantization::from_bounds
+    ///
+    /// @param vertices: Pointer to an array of `Vertex` structures.
+    /// @param vertices_size: The number of vertices in the array.
+    ///
+    /// @returns The quantization that maps the bounding box of the vertices to `[0, 1]`.
+    static PositionQuantization from_bounds(const Vertex *vertices, size_t vertices_size);
+
+    bool operator==(const PositionQuantization &) const = default;
+};
+
+/// # PackedVertex
+///
+/// A compact form of `Vertex`, read through normalized integer and half-float attributes.
+///
+/// Positions keep 16 bits per axis across the bounding box of the mesh, and unit vectors are octahedral-encoded into
+/// two 16-bit components, both well below the precision a mesh is authored at. Half-float texture coordinates lose
+/// precision on coordinates far outside `[0, 1]`, e.g., on heavily tiled surfaces.
+struct PackedVertex {
+    /// Position in the bounding box of the mesh, as unsigned normalized integers. The fourth is padding.
+    glm::u16vec4 position;
+    /// Octahedral-encoded normal vector, as signed normalized integers.
+    glm::i16vec2 normal;
+    /// Texture coordinate, as half floats.
+    glm::u16vec2 tex_coord;
+    /// Octahedral-encoded tangent vector, as signed normalized integers.
+    glm::i16vec2 tangent;
+
+    /// ## PackedVertex::pack
+    ///
+    /// @param vertex: The vertex to pack.
+    /// @param quantization: The bounding box of the mesh, from `PositionQuantization::from_bounds`.
+    ///
+    /// @returns The packed vertex.
+    static PackedVertex pack(const Vertex &vertex, const PositionQuantization &quantization);
+
+    /// ## PackedVertex::encode_octahedral
+    ///
+    /// Projects a unit vector onto an octahedron and unfolds it onto a square, which spreads the precision evenly over
+    /// the sphere.
+    ///
+    /// @param v: The vector to encode, normalized or zero.
+    ///
+    /// @returns The encoded vector, as signed normalized integers.
+    static glm::i16vec2 encode_octahedral(const glm::vec3 &v);
+};
+
+/// # BoundingBox
+///
+/// An axis-aligned box enclosing the positions of a mesh, in model space.
+struct BoundingBox {
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+
+    /// ## BoundingBox::from_vertices
+    ///
+    /// @param vertices: Pointer to an array of `Vertex` structures.
+    /// @param vertices_size: The number of vertices in the array.
+    ///
+    /// @returns The smallest box enclosing the vertices, or an empty box at the origin if there are none.
+    static BoundingBox from_vertices(const Vertex *vertices, size_t vertices_size);
+
+    /// ## BoundingBox::get_center
+    ///
+    /// @returns The center of the box.
+    [[nodiscard]]
+    glm::vec3 get_center() const {
+        return (min + max) * 0.5f;
+    }
+
+    /// ## BoundingBox::merge
+    ///
+    /// @param other: The box to enclose.
+    ///
+    /// @returns The smallest box enclosing both boxes.
+    [[nodiscard]]
+    BoundingBox merge(const BoundingBox &other) const {
+        return {.min = glm::min(min, other.min), .max = glm::max(max, other.max)};
+    }
+
+    /// ## BoundingBox::transform
+    ///
+    /// @param transform: An affine transform.
+    ///
+    /// @returns The smallest axis-aligned box enclosing the transformed box.
+    [[nodiscard]]
+    BoundingBox transform(const glm::mat4 &transform) const;
+};
+
+/// # BoundingSphere
+///
+/// A sphere enclosing the positions of a mesh, in model space.
+struct BoundingSphere {
+    glm::vec3 center{0.0f};
+    float radius{0.0f};
+
+    /// ## BoundingSphere::from_vertices
+    ///
+    /// @param vertices: Pointer to an array of `Vertex` structures.
+    /// @param vertices_size: The number of vertices in the array.
+    ///
+    /// @returns The sphere around the center of the bounding box of the vertices that encloses all of them.
+    static BoundingSphere from_vertices(const Vertex *vertices, size_t vertices_size);
+
+    /// ## BoundingSphere::transform
+    ///
+    /// @param transform: An affine transform.
+    ///
+    /// @returns The sphere around the transformed center, with the radius scaled by the largest axis of the transform,
+    /// which encloses the transformed sphere.
+    [[nodiscard]]
+    BoundingSphere transform(const glm::mat4 &transform) const;
+};
+
+/// # MeshLod
+///
+/// A level of detail of a mesh, which is a range of its indices over the same vertices.
+struct MeshLod {
+    uint32_t first_index;
+    uint32_t index_count;
+    /// The largest distance between this level and the full mesh in model space, used to select the level.
+    float error;
+};
+
+/// # DrawCommand
+///
+/// An indexed draw call of a mesh, with the vertex array and the index range to issue it without the mesh, e.g., from
+/// a `CommandList` recorded on another thread. Indices are 32-bit.
+struct DrawCommand {
+    uint32_t vertex_array;
+    uint32_t primitive_type;
+    uint32_t index_count;
+    /// The first index in the element buffer of the vertex array.
+    uint32_t first_index;
+    int32_t base_vertex;
+    /// The bounds to dequantize the positions with, set to the `positionScale` and `positionOffset` uniforms, if the
+    /// vertices are `VertexFormat::Packed`.
+    std::optional<PositionQuantization> quantization;
+};
+
+/// # Meshlet
+///
+/// A cluster of neighboring triangles of a mesh, stored as a range of its index buffer, with the bounds to cull it as a
+/// whole.
+struct Meshlet {
+    uint32_t first_index;
+    uint32_t index_count;
+    /// The number of distinct vertices the triangles refer to.
+    uint32_t vertex_count;
+    /// The sphere enclosing the triangles in model space.
+    BoundingSphere bounds;
+    /// The average direction of the triangle normals in model space.
+    glm::vec3 cone_axis;
+    /// The sine of the largest angle between the axis and a triangle normal, or `1` if the normals spread over more
+    /// than a hemisphere, which never culls.
+    float cone_cutoff;
+};
+
+/// # LodView
+///
+/// The view that levels of detail are selected for.
+///
+/// A level is selected if its error, projected onto the screen at the distance of the bounding sphere of the mesh,
+/// is at most `max_screen_error` pixels. To keep meshes near a threshold from switching levels every frame, a coarser
+/// level than the current one must be under `max_screen_error * (1 - hysteresis)`, and the current or a finer level
+/// must exceed `max_screen_error * (1 + hysteresis)` to be left.
+struct LodView {
+    /// The position of the camera in world space.
+    glm::vec3 camera_pos{0.0f};
+    /// Pixels per world unit at a distance of one, from `LodView::get_projection_scale`.
+    float projection_scale{1.0f};
+    /// The largest error on the screen in pixels.
+    float max_screen_error{1.0f};
+    /// The fraction of `max_screen_error` a level must cross beyond the threshold to be switched to.
+    float hysteresis{0.2f};
+
+    /// ## LodView::get_projection_scale
+    ///
+    /// @param fovy: The vertical field of view of the perspective projection in radians.
+    /// @param viewport_height: The height of the viewport in pixels.
+    ///
+    /// @returns The pixels per world unit at a distance of one.
+    static float get_projection_scale(float fovy, float viewport_height);
+};
+
 /// # Material
 ///
 /// A class that represents the material properties of a mesh.
@@ -95,18 +303,68 @@ struct Material {
     void set_to_program(const Program &program) const;
 };
 
+/// # MeshOptions
+///
+/// Options for creating a `Mesh`.
+struct MeshOptions {
+    /// Sub-allocates the vertices and indices from the geometry pool shared by all pooled meshes, instead of creating
+    /// a vertex array object and buffers for the mesh.
+    bool pooled{false};
+    /// The format to store the vertices in.
+    VertexFormat format{VertexFormat::Float};
+    /// Stores the positions in a stream of their own, apart from the other attributes, so that a depth pass fetches
+    /// only the positions with `Mesh::draw_depth`.
+    bool split_positions{false};
+    /// The number of levels of detail to generate for a triangle mesh, including the full mesh. Each level has about
+    /// half the triangles of the previous one, and fewer levels are kept if simplification stalls. The levels are
+    /// loaded from `MeshLodCache` if it has them.
+    size_t lod_count{1};
+    /// Splits the full triangle mesh into meshlets with `build_meshlets`, so that `Mesh::draw_meshlets` draws only the
+    /// clusters that pass `cull_meshlets`.
+    bool meshlets{false};
+};
+
 /// # Mesh
 ///
 /// A class that encapsulates the OpenGL vertex layout, vertex buffer, and element buffer for a mesh.
+///
+/// A pooled mesh has no buffers of its own. Its geometry is a range of the shared `GeometryPool`, and meshes in the
+/// same pool draw without switching vertex array objects.
+///
+/// A mesh with split positions keeps them in a separate vertex buffer, read alone by a second vertex array object.
+///
+/// A mesh with levels of detail keeps their indices after those of the full mesh in the same index buffer, so every
+/// level draws from the same vertices. `Mesh::select_lod` picks the level for a transform and a view.
+///
+/// A mesh with meshlets orders the triangles of the full mesh by meshlet, so each meshlet is a range of its indices.
 class Mesh {
     /// Type of primitive to render (e.g., GL_TRIANGLES)
     const uint32_t primitive_type_;
-    /// VAO, Vertex Array Object
+    /// VAO, Vertex Array Object, or `nullptr` if the mesh is pooled
     const std::unique_ptr<VertexLayout> vertex_layout_;
-    /// VBO, Vertex Buffer Object
+    /// VBO, Vertex Buffer Object, or `nullptr` if the mesh is pooled
     const std::shared_ptr<Buffer> vertex_buffer_;
-    /// EBO, Element Buffer Object
+    /// VAO and VBO of the positions, or `nullptr` if the mesh is pooled or the positions are not split
+    const std::unique_ptr<VertexLayout> position_layout_;
+    const std::shared_ptr<Buffer> position_buffer_;
+    /// EBO, Element Buffer Object, or `nullptr` if the mesh is pooled
     const std::shared_ptr<Buffer> index_buffer_;
+    /// Geometry pool and the ID of the range of the mesh in it, if the mesh is pooled
+    const std::shared_ptr<GeometryPool> pool_;
+    const uint32_t pool_id_{0};
+    /// Format of the vertices on the GPU, and the bounding box of the positions if they are packed
+    const VertexFormat vertex_format_;
+    const bool split_positions_;
+    const PositionQuantization quantization_;
+    /// The number of vertices
+    const size_t vertex_count_;
+    /// Index ranges of the levels of detail, the full mesh first
+    const std::vector<MeshLod> lods_;
+    /// Bounds of the vertices in model space
+    const BoundingBox bounding_box_;
+    const BoundingSphere bounding_sphere_;
+    /// Clusters of the full mesh in index order, or empty if the mesh has no meshlets
+    const std::vector<Meshlet> meshlets_;
     /// Material
     std::shared_ptr<Material> material_;
 
@@ -120,11 +378,12 @@ public:
     /// @param indices: Pointer to an array of indices.
     /// @param indices_size: The number of indices in the array.
     /// @param primitive_type: The type of primitive to render (e.g., GL_TRIANGLES).
+    /// @param options: Whether the mesh is pooled, and the format of the vertices.
     ///
     /// @returns `Mesh` object wrapped in `std::unique_ptr` if successful, or `nullptr` if initialization fails.
     static std::unique_ptr<Mesh>
     create(Vertex *vertices, size_t vertices_size, const uint32_t *indices, size_t indices_size,
-           uint32_t primitive_type);
+           uint32_t primitive_type, const MeshOptions &options = {});
 
     /// ## Mesh::create
     ///
@@ -133,10 +392,13 @@ public:
     /// @param vertices: A vector of `Vertex` structures.
     /// @param indices: A vector of indices.
     /// @param primitive_type: The type of primitive to render (e.g., GL_TRIANGLES).
+    /// @param options: Whether the mesh is pooled, and the format of the vertices.
     ///
     /// @returns `Mesh` object wrapped in `std::unique_ptr` if successful, or `nullptr` if initialization fails.
-    static std::unique_ptr<Mesh>
-    create(std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t primitive_type);
+    static std::unique_ptr<Mesh> create(
+            std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t primitive_type,
+            const MeshOptions &options = {}
+    );
 
     /// ## Mesh::create_cube
     ///
@@ -160,22 +422,58 @@ public:
     ///
     /// @param lati_segment: The number of latitude segments.
     /// @param longi_segment: The number of longitude segments.
+    /// @param options: Whether the mesh is pooled, the format of the vertices, and the levels of detail.
     ///
     /// @returns sphere-shaped `Mesh` object wrapped in `std::unique_ptr` if successful, or `nullptr` if initialization
     /// fails.
-    static std::unique_ptr<Mesh> create_sphere(const size_t lati_segment = 16, const size_t longi_segment = 32);
+    static std::unique_ptr<Mesh> create_sphere(
+            const size_t lati_segment = 16, const size_t longi_segment = 32, const MeshOptions &options = {}
+    );
+
+    /// ## Mesh::get_geometry_pool
+    ///
+    /// Returns the geometry pool of pooled meshes in a vertex format, creating it if no such mesh is alive. The pool is
+    /// released with the last mesh using it.
+    ///
+    /// @param format: The vertex format of the pool.
+    /// @param split_positions: Whether the pool keeps the positions in a stream of their own.
+    ///
+    /// @returns Shared pointer to the `GeometryPool` object, or `nullptr` if creation fails.
+    static std::shared_ptr<GeometryPool>
+    get_geometry_pool(VertexFormat format = VertexFormat::Float, bool split_positions = false);
+
+    /// ## Mesh::get_vertex_stride
+    ///
+    /// @param format: The vertex format.
+    ///
+    /// @returns The size of a vertex in the format in bytes.
+    static size_t get_vertex_stride(VertexFormat format);
+
+    /// ## Mesh::get_position_stride
+    ///
+    /// @param format: The vertex format.
+    ///
+    /// @returns The size of the position of a vertex in the format in bytes, which is the stride of split positions.
+    static size_t get_position_stride(VertexFormat format);
+
+    /// ## Mesh::~Mesh
+    ///
+    /// Destructor that returns the range of a pooled mesh to its pool.
+    ~Mesh();
 
     /// ## Mesh::get_vertex_layout
     ///
-    /// @returns Pointer to the `VertexLayout` object.
+    /// @returns Pointer to the `VertexLayout` object, which is shared with the other meshes in the pool if the mesh is
+    /// pooled.
     [[nodiscard]]
     const VertexLayout *get_vertex_layout() const {
-        return vertex_layout_.get();
+        return pool_ ? &pool_->get_vertex_layout() : vertex_layout_.get();
     }
 
     /// ## Mesh::get_vertex_buffer
     ///
-    /// @returns Shared pointer to the `Buffer` object representing the vertex buffer.
+    /// @returns Shared pointer to the `Buffer` object representing the vertex buffer, which holds every attribute but
+    /// the positions if they are split, or `nullptr` if the mesh is pooled.
     [[nodiscard]]
     std::shared_ptr<Buffer> get_vertex_buffer() const {
         return vertex_buffer_;
@@ -183,12 +481,149 @@ public:
 
     /// ## Mesh::get_index_buffer
     ///
-    /// @returns Shared pointer to the `Buffer` object representing the index buffer.
+    /// @returns Shared pointer to the `Buffer` object representing the index buffer, or `nullptr` if the mesh is
+    /// pooled.
     [[nodiscard]]
     std::shared_ptr<Buffer> get_index_buffer() const {
         return index_buffer_;
     }
 
+    /// ## Mesh::get_pool
+    ///
+    /// @returns Shared pointer to the geometry pool of the mesh, or `nullptr` if the mesh is not pooled.
+    [[nodiscard]]
+    const std::shared_ptr<GeometryPool> &get_pool() const {
+        return pool_;
+    }
+
+    /// ## Mesh::get_pool_id
+    ///
+    /// @returns ID of the range of the mesh in its geometry pool, if the mesh is pooled.
+    [[nodiscard]]
+    uint32_t get_pool_id() const {
+        return pool_id_;
+    }
+
+    /// ## Mesh::get_vertex_format
+    ///
+    /// @returns The format of the vertices on the GPU.
+    [[nodiscard]]
+    VertexFormat get_vertex_format() const {
+        return vertex_format_;
+    }
+
+    /// ## Mesh::has_split_positions
+    ///
+    /// @returns `true` if the positions are stored in a stream of their own.
+    [[nodiscard]]
+    bool has_split_positions() const {
+        return split_positions_;
+    }
+
+    /// ## Mesh::get_quantization
+    ///
+    /// @returns The bounding box the positions are quantized in, if the vertex format is `VertexFormat::Packed`.
+    [[nodiscard]]
+    const PositionQuantization &get_quantization() const {
+        return quantization_;
+    }
+
+    /// ## Mesh::get_vertex_count
+    ///
+    /// @returns The number of vertices.
+    [[nodiscard]]
+    size_t get_vertex_count() const {
+        return vertex_count_;
+    }
+
+    /// ## Mesh::get_index_count
+    ///
+    /// @returns The number of indices of the full mesh.
+    [[nodiscard]]
+    size_t get_index_count() const {
+        return lods_.front().index_count;
+    }
+
+    /// ## Mesh::get_lod_count
+    ///
+    /// @returns The number of levels of detail, which is `1` if the mesh has only the full mesh.
+    [[nodiscard]]
+    size_t get_lod_count() const {
+        return lods_.size();
+    }
+
+    /// ## Mesh::get_lod
+    ///
+    /// @param lod: The level of detail, `0` being the full mesh.
+    ///
+    /// @returns The index range and the error of the level.
+    [[nodiscard]]
+    const MeshLod &get_lod(const size_t lod) const {
+        return lods_[lod];
+    }
+
+    /// ## Mesh::get_bounding_box
+    ///
+    /// @returns The box enclosing the vertices in model space.
+    [[nodiscard]]
+    const BoundingBox &get_bounding_box() const {
+        return bounding_box_;
+    }
+
+    /// ## Mesh::get_bounding_sphere
+    ///
+    /// @returns The sphere enclosing the vertices in model space.
+    [[nodiscard]]
+    const BoundingSphere &get_bounding_sphere() const {
+        return bounding_sphere_;
+    }
+
+    /// ## Mesh::get_meshlets
+    ///
+    /// @returns The meshlets of the full mesh, or an empty span if the mesh is created without them.
+    [[nodiscard]]
+    std::span<const Meshlet> get_meshlets() const {
+        return meshlets_;
+    }
+
+    /// ## Mesh::select_lod
+    ///
+    /// Selects the coarsest level of detail whose error on the screen is within the limits of the view.
+    ///
+    /// @param transform: The model transform of the mesh.
+    /// @param view: The camera position, projection, and error limits.
+    /// @param current_lod: The level drawn last time, which the hysteresis of the view favors.
+    ///
+    /// @returns The level of detail to draw.
+    [[nodiscard]]
+    size_t select_lod(const glm::mat4 &transform, const LodView &view, size_t current_lod = 0) const;
+
+    /// ## Mesh::get_vertex_bytes
+    ///
+    /// @returns The size of the vertices on the GPU in bytes, which is also the vertex data fetched by a draw that
+    /// touches every vertex once.
+    [[nodiscard]]
+    size_t get_vertex_bytes() const {
+        return vertex_count_ * get_vertex_stride(vertex_format_);
+    }
+
+    /// ## Mesh::get_depth_vertex_bytes
+    ///
+    /// @returns The vertex data fetched by `Mesh::draw_depth` that touches every vertex once in bytes, which is only
+    /// the positions if they are split.
+    [[nodiscard]]
+    size_t get_depth_vertex_bytes() const {
+        return split_positions_ ? vertex_count_ * get_position_stride(vertex_format_) : get_vertex_bytes();
+    }
+
+    /// ## Mesh::get_primitive_type
+    ///
+    /// @returns The type of primitive to render (e.g., GL_TRIANGLES).
+    [[nodiscard]]
+    uint32_t get_primitive_type() const {
+        return primitive_type_;
+    }
+
     /// ## Mesh::set_material
     ///
     /// Sets the material for the mesh.
@@ -209,13 +644,80 @@ public:
     /// ## Mesh::draw
     ///
     /// @param program Reference to the `Program` object.
+    /// @param lod: The level of detail to draw, `0` being the full mesh.
     ///
     /// Draws the mesh using the current OpenGL context.
-    void draw(const Program &program) const;
+    void draw(const Program &program, size_t lod = 0) const;
+
+    /// ## Mesh::draw_geometry
+    ///
+    /// Draws the mesh like `Mesh::draw` without setting its material, for callers that set the material themselves
+    /// only when it changes, such as `RenderQueue`.
+    ///
+    /// @param program: Reference to the `Program` object.
+    /// @param lod: The level of detail to draw, `0` being the full mesh.
+    void draw_geometry(const Program &program, size_t lod = 0) const;
+
+    /// ## Mesh::get_draw_command
+    ///
+    /// Describes the draw call of a level of detail, which `Mesh::draw_geometry` would issue, so that it can be issued
+    /// later. The quantization of packed positions is part of it, the material is not.
+    ///
+    /// @param lod: The level of detail to draw, `0` being the full mesh.
+    ///
+    /// @returns The draw call.
+    [[nodiscard]]
+    DrawCommand get_draw_command(size_t lod = 0) const;
+
+    /// ## Mesh::draw_instanced
+    ///
+    /// Draws every instance of the instance buffer with a single draw call. The program must read the instance
+    /// attributes, e.g., be compiled with the `INSTANCED` define.
+    ///
+    /// @param program: Reference to the `Program` object.
+    /// @param instances: The per-instance transforms and parameters.
+    void draw_instanced(const Program &program, const InstanceBuffer &instances) const;
+
+    /// ## Mesh::draw_depth
+    ///
+    /// Draws the mesh for a depth-only pass, e.g., a depth prepass or a shadow map, without setting the material. Only
+    /// the positions are fetched if they are split, so the program must read no attribute but `aPos`.
+    ///
+    /// @param program: Reference to the `Program` object.
+    /// @param lod: The level of detail to draw, `0` being the full mesh.
+    void draw_depth(const Program &program, size_t lod = 0) const;
+
+    /// ## Mesh::draw_meshlets
+    ///
+    /// Draws the meshlets of the full mesh, e.g., those that passed `cull_meshlets`, with one
+    /// `glMultiDrawElementsBaseVertex` call. Meshlets that follow each other in the index buffer are merged into one
+    /// range.
+    ///
+    /// @param program: Reference to the `Program` object.
+    /// @param visible: The indices of the meshlets to draw, in ascending order.
+    void draw_meshlets(const Program &program, std::span<const uint32_t> visible) const;
 
 private:
     Mesh(uint32_t primitive_type, std::unique_ptr<VertexLayout> &&vertex_layout,
-         const std::shared_ptr<Buffer> &vertex_buffer, const std::shared_ptr<Buffer> &index_buffer);
+         const std::shared_ptr<Buffer> &vertex_buffer, std::unique_ptr<VertexLayout> &&position_layout,
+         const std::shared_ptr<Buffer> &position_buffer, const std::shared_ptr<Buffer> &index_buffer,
+         VertexFormat vertex_format, const PositionQuantization &quantization, size_t vertex_count,
+         std::vector<MeshLod> &&lods, const BoundingBox &bounding_box, const BoundingSphere &bounding_sphere,
+         std::vector<Meshlet> &&meshlets);
+    Mesh(uint32_t primitive_type, const std::shared_ptr<GeometryPool> &pool, uint32_t pool_id,
+         VertexFormat vertex_format, bool split_positions, const PositionQuantization &quantization,
+         std::vector<MeshLod> &&lods, const BoundingBox &bounding_box, const BoundingSphere &bounding_sphere,
+         std::vector<Meshlet> &&meshlets);
+
+    /// ## Mesh::draw_lod
+    ///
+    /// Draws the indices of a level of detail through the bound vertex array object.
+    void draw_lod(size_t lod, size_t instance_count = 1) const;
+
+    /// ## Mesh::set_quantization_to_program
+    ///
+    /// Sets the bounding box of packed positions to the `positionScale` and `positionOffset` uniforms.
+    void set_quantization_to_program(const Program &program) const;
 };
 
 
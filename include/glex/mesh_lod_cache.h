@@ -0,0 +1,91 @@
+#ifndef __MESH_LOD_CACHE_H__
+#define __MESH_LOD_CACHE_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include "glex/mesh.h"
+#include "glex/mesh_simplifier.h"
+
+/// # MeshLodCache
+///
+/// An on-disk cache of the levels of detail built by `build_lod_chain`, so that meshes are simplified only the first
+/// time they are loaded.
+///
+/// A chain is stored under a key computed from the vertices, the indices and the options it is built with. If any of
+/// them change, the key changes and the chain is built again.
+///
+/// The cache is disabled until a directory is set with `MeshLodCache::set_directory`.
+///
+/// ## Examples
+///
+/// ```cpp
+/// MeshLodCache::set_directory("./.cache/mesh_lod");
+/// // `Mesh::create` with `MeshOptions::lod_count` now loads cached levels when they are available.
+/// auto model = Model::load("./model/backpack/backpack.obj", {.lod_count = 4});
+/// ```
+class MeshLodCache {
+public:
+    /// ## MeshLodCache::set_directory
+    ///
+    /// Enables the cache and sets the directory to store levels of detail in. The directory is created if it does not
+    /// exist.
+    ///
+    /// @param directory: The directory to store levels of detail in.
+    static void set_directory(const std::filesystem::path &directory);
+
+    /// ## MeshLodCache::is_enabled
+    ///
+    /// @returns `true` if a cache directory is set.
+    [[nodiscard]]
+    static bool is_enabled();
+
+    /// ## MeshLodCache::make_key
+    ///
+    /// Computes the cache key of the levels of detail of a mesh.
+    ///
+    /// @param vertices: The vertices of the mesh.
+    /// @param indices: The indices of the full mesh.
+    /// @param options: The options the chain is built with.
+    ///
+    /// @returns The cache key.
+    [[nodiscard]]
+    static uint64_t
+    make_key(std::span<const Vertex> vertices, std::span<const uint32_t> indices, const LodChainOptions &options);
+
+    /// ## MeshLodCache::load
+    ///
+    /// @param key: The cache key of the mesh.
+    ///
+    /// @returns The levels of detail stored under the key, or `std::nullopt` if there are none or the file is
+    /// corrupted.
+    static std::optional<LodChain> load(uint64_t key);
+
+    /// ## MeshLodCache::store
+    ///
+    /// Stores the levels of detail under the key.
+    ///
+    /// @param key: The cache key of the mesh.
+    /// @param chain: The levels of detail.
+    static void store(uint64_t key, const LodChain &chain);
+
+    /// ## MeshLodCache::get_hit_count
+    ///
+    /// @returns The number of meshes whose levels of detail were loaded from the cache.
+    [[nodiscard]]
+    static size_t get_hit_count();
+
+    /// ## MeshLodCache::get_miss_count
+    ///
+    /// @returns The number of meshes that had to be simplified while the cache was enabled.
+    [[nodiscard]]
+    static size_t get_miss_count();
+
+    MeshLodCache() = delete;
+};
+
+
+#endif // __MESH_LOD_CACHE_H__
@@ -0,0 +1,108 @@
+#ifndef __MESH_OPTIMIZER_H__
+#define __MESH_OPTIMIZER_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "glex/mesh.h"
+
+/// # VertexCacheStats
+///
+/// Efficiency of an index buffer on a simulated FIFO post-transform vertex cache.
+struct VertexCacheStats {
+    /// Average cache miss ratio, the vertex shader invocations per triangle. `0.5` is the ideal of a large regular
+    /// grid, and `3.0` the worst case.
+    float acmr{0.0f};
+    /// Average transformed vertex ratio, the vertex shader invocations per referenced vertex. `1.0` is ideal.
+    float atvr{0.0f};
+};
+
+/// # MeshOptimizerOptions
+///
+/// Options of `optimize_mesh`.
+struct MeshOptimizerOptions {
+    /// The number of vertices in the simulated post-transform cache.
+    size_t cache_size{16};
+    /// How much worse than the vertex cache order the ACMR may get to reorder for overdraw, e.g., `1.05` for 5%.
+    float overdraw_threshold{1.05f};
+};
+
+/// # MeshOptimizationReport
+///
+/// Effect of `optimize_mesh` on a mesh.
+struct MeshOptimizationReport {
+    size_t vertex_count_before{0};
+    size_t vertex_count_after{0};
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+/// ## analyze_vertex_cache
+///
+/// Simulates a FIFO post-transform vertex cache over a triangle list.
+///
+/// @param indices: The indices of the triangle list.
+/// @param vertex_count: The number of vertices the indices refer to.
+/// @param cache_size: The number of vertices in the cache.
+///
+/// @returns The ACMR and ATVR of the index buffer.
+VertexCacheStats analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count, size_t cache_size = 16);
+
+/// ## weld_vertices
+///
+/// Merges vertices with identical attributes and rewrites the indices to the merged vertices.
+///
+/// @param vertices: The vertices, compacted in place.
+/// @param indices: The indices, rewritten in place.
+void weld_vertices(std::vector<Vertex> &vertices, std::span<uint32_t> indices);
+
+/// ## optimize_vertex_cache
+///
+/// Reorders the triangles for post-transform vertex cache locality with Tipsify, which fans around recently used
+/// vertices and restarts from the most recent vertex with unemitted triangles at dead ends. It runs in linear time.
+///
+/// @param indices: The indices of the triangle list, reordered in place.
+/// @param vertex_count: The number of vertices the indices refer to.
+/// @param cache_size: The number of vertices in the cache to optimize for.
+void optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count, size_t cache_size = 16);
+
+/// ## optimize_overdraw
+///
+/// Reorders clusters of triangles so that the ones facing away from the center of the mesh are drawn first, which
+/// lets the depth test reject more of the occluded fragments from any direction. The indices must be optimized with
+/// `optimize_vertex_cache` first. Clusters start where the cache order restarts, and are split further where it
+/// costs at most `threshold` times the ACMR of the cluster.
+///
+/// @param indices: The indices of the triangle list, reordered in place.
+/// @param vertices: The vertices the indices refer to.
+/// @param threshold: How much worse the ACMR of a cluster may get from splitting it, e.g., `1.05` for 5%.
+/// @param cache_size: The number of vertices in the cache.
+void optimize_overdraw(
+        std::span<uint32_t> indices, std::span<const Vertex> vertices, float threshold = 1.05f, size_t cache_size = 16
+);
+
+/// ## optimize_vertex_fetch
+///
+/// Reorders the vertices in the order the indices first refer to them, so that vertex fetches walk the buffer
+/// forward, and drops unreferenced vertices.
+///
+/// @param vertices: The vertices, reordered in place.
+/// @param indices: The indices, rewritten in place.
+void optimize_vertex_fetch(std::vector<Vertex> &vertices, std::span<uint32_t> indices);
+
+/// ## optimize_mesh
+///
+/// Runs `weld_vertices`, `optimize_vertex_cache`, `optimize_overdraw` and `optimize_vertex_fetch` on a triangle list.
+///
+/// @param vertices: The vertices, optimized in place.
+/// @param indices: The indices of the triangle list, optimized in place.
+/// @param options: The cache size and overdraw threshold.
+///
+/// @returns The vertex count and the vertex cache efficiency before and after.
+MeshOptimizationReport
+optimize_mesh(std::vector<Vertex> &vertices, std::span<uint32_t> indices, const MeshOptimizerOptions &options = {});
+
+
+#endif // __MESH_OPTIMIZER_H__
@@ -0,0 +1,76 @@
+#ifndef __MESH_SIMPLIFIER_H__
+#define __MESH_SIMPLIFIER_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+#include "glex/mesh.h"
+
+/// # SimplifiedMesh
+///
+/// Result of `simplify_mesh`.
+struct SimplifiedMesh {
+    /// Indices of the remaining triangles, referring to the original vertices.
+    std::vector<uint32_t> indices;
+    /// Estimated largest distance between the simplified surface and the input, in model space.
+    float error{0.0f};
+};
+
+/// # LodChainOptions
+///
+/// Options of `build_lod_chain`.
+struct LodChainOptions {
+    /// The number of levels, including the full mesh.
+    size_t lod_count{4};
+    /// The fraction of the triangles of a level that the next level aims to keep.
+    float reduction{0.5f};
+};
+
+/// # LodChain
+///
+/// Levels of detail of a mesh as consecutive ranges of one index buffer over the same vertices.
+struct LodChain {
+    /// Indices of every level, the full mesh first.
+    std::vector<uint32_t> indices;
+    /// Range and error of each level, from the finest to the coarsest.
+    std::vector<MeshLod> lods;
+};
+
+/// ## simplify_mesh
+///
+/// Simplifies a triangle list by collapsing edges in the order of their quadric error metric, i.e., the sum of
+/// squared distances to the planes of the triangles merged into each vertex. A vertex is only collapsed onto a
+/// neighbor, so the result reuses the original vertices. Vertices on open borders and on attribute seams, i.e.,
+/// sharing their position with another vertex, are never removed, which keeps the outline and the texture mapping
+/// intact. Collapses that would flip a triangle are rejected.
+///
+/// @param vertices: The vertices the indices refer to.
+/// @param indices: The indices of the triangle list.
+/// @param target_index_count: The number of indices to stop at.
+/// @param max_error: The largest error in model space to stop at.
+///
+/// @returns The remaining triangles and their error. The target is not reached if no more collapse is allowed.
+SimplifiedMesh simplify_mesh(
+        std::span<const Vertex> vertices, std::span<const uint32_t> indices, size_t target_index_count,
+        float max_error = std::numeric_limits<float>::max()
+);
+
+/// ## build_lod_chain
+///
+/// Builds levels of detail by simplifying each level from the previous one, and orders the triangles of each level
+/// for the vertex cache. Stops early if a level barely reduces the previous one.
+///
+/// @param vertices: The vertices the indices refer to.
+/// @param indices: The indices of the full mesh, which are the first level.
+/// @param options: The number of levels and the reduction between them.
+///
+/// @returns The levels in one index buffer.
+LodChain build_lod_chain(
+        std::span<const Vertex> vertices, std::span<const uint32_t> indices, const LodChainOptions &options = {}
+);
+
+
+#endif // __MESH_SIMPLIFIER_H__
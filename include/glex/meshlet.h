@@ -0,0 +1,69 @@
+#ifndef __MESHLET_H__
+#define __MESHLET_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "glex/common.h"
+#include "glex/mesh.h"
+
+/// # MeshletOptions
+///
+/// Options of `build_meshlets`.
+struct MeshletOptions {
+    /// The largest number of distinct vertices in a meshlet.
+    size_t max_vertices{64};
+    /// The largest number of triangles in a meshlet.
+    size_t max_triangles{124};
+};
+
+/// # MeshletCullStats
+///
+/// Results of `cull_meshlets`, summed over the calls that share them.
+struct MeshletCullStats {
+    size_t meshlet_count{0};
+    /// Meshlets whose bounding sphere is outside the view frustum.
+    size_t frustum_culled{0};
+    /// Meshlets whose every triangle faces away from the camera.
+    size_t backface_culled{0};
+    size_t triangle_count{0};
+    /// Triangles of the meshlets that passed.
+    size_t visible_triangle_count{0};
+};
+
+/// ## build_meshlets
+///
+/// Splits a triangle list into meshlets and reorders its triangles so that each meshlet is a contiguous index range.
+///
+/// A meshlet grows greedily from the first unassigned triangle in index order, so a cache-optimized order carries over,
+/// by adding the neighboring triangle that brings in the fewest new vertices and, among those, whose normal is closest
+/// to the meshlet's, which keeps the normal cones narrow.
+///
+/// @param vertices: The vertices the indices refer to.
+/// @param indices: The indices of the triangle list, reordered in place.
+/// @param options: The vertex and triangle limits of a meshlet.
+///
+/// @returns The meshlets in index order.
+std::vector<Meshlet>
+build_meshlets(std::span<const Vertex> vertices, std::span<uint32_t> indices, const MeshletOptions &options = {});
+
+/// ## cull_meshlets
+///
+/// Rejects the meshlets outside the view frustum and those facing away from the camera. The tests run in model space,
+/// so they hold for any affine model transform.
+///
+/// @param meshlets: The meshlets of a mesh.
+/// @param model_transform: The model transform of the mesh.
+/// @param view_projection: The product of the projection and view matrices.
+/// @param camera_pos: The position of the camera in world space.
+/// @param visible: The indices of the meshlets that passed, replaced.
+/// @param stats: The statistics to add the results to, or `nullptr`.
+void cull_meshlets(
+        std::span<const Meshlet> meshlets, const glm::mat4 &model_transform, const glm::mat4 &view_projection,
+        const glm::vec3 &camera_pos, std::vector<uint32_t> &visible, MeshletCullStats *stats = nullptr
+);
+
+
+#endif // __MESHLET_H__
@@ -4,9 +4,11 @@
 
 #include <assimp/scene.h>
 #include <memory>
+#include <span>
 #include <vector>
 #include "glex/common.h"
 #include "glex/mesh.h"
+#include "glex/meshlet.h"
 #include "glex/program.h"
 
 /// # Model
@@ -15,6 +17,11 @@
 class Model {
     std::vector<std::shared_ptr<Mesh>> meshes_;
     std::vector<std::shared_ptr<Material>> materials_;
+    /// Options every mesh is created with
+    const MeshOptions mesh_options_;
+    /// Bounds of all meshes in model space
+    BoundingBox bounding_box_{};
+    BoundingSphere bounding_sphere_{};
 
 public:
     /// ## Model::load
@@ -22,9 +29,11 @@ public:
     /// Loads a model from the specified file path.
     ///
     /// @param filepath: The path to the model file.
+    /// @param options: The options every mesh is created with, e.g., `MeshOptions::pooled` to sub-allocate the meshes
+    /// from the geometry pool.
     ///
     /// @returns `std::unique_ptr` to a `Model` object if successful, or `nullptr` if loading fails.
-    static std::unique_ptr<Model> load(const std::string &filepath);
+    static std::unique_ptr<Model> load(const std::string &filepath, const MeshOptions &options = {});
 
     /// ## Model::get_mesh_count
     ///
@@ -46,6 +55,68 @@ public:
         return meshes_[index];
     }
 
+    /// ## Model::get_vertex_format
+    ///
+    /// @returns The format the vertices of the meshes are stored in.
+    [[nodiscard]]
+    VertexFormat get_vertex_format() const {
+        return mesh_options_.format;
+    }
+
+    /// ## Model::has_split_positions
+    ///
+    /// @returns `true` if the positions of the meshes are stored in a stream of their own.
+    [[nodiscard]]
+    bool has_split_positions() const {
+        return mesh_options_.split_positions;
+    }
+
+    /// ## Model::get_lod_count
+    ///
+    /// @returns The number of levels of detail requested for each mesh. A mesh may have fewer if it could not be
+    /// simplified further.
+    [[nodiscard]]
+    size_t get_lod_count() const {
+        return mesh_options_.lod_count;
+    }
+
+    /// ## Model::has_meshlets
+    ///
+    /// @returns `true` if the meshes are split into meshlets.
+    [[nodiscard]]
+    bool has_meshlets() const {
+        return mesh_options_.meshlets;
+    }
+
+    /// ## Model::get_bounding_box
+    ///
+    /// @returns The box enclosing the boxes of all meshes in model space.
+    [[nodiscard]]
+    const BoundingBox &get_bounding_box() const {
+        return bounding_box_;
+    }
+
+    /// ## Model::get_bounding_sphere
+    ///
+    /// @returns The sphere around the center of the bounding box that encloses the spheres of all meshes in model
+    /// space.
+    [[nodiscard]]
+    const BoundingSphere &get_bounding_sphere() const {
+        return bounding_sphere_;
+    }
+
+    /// ## Model::get_vertex_bytes
+    ///
+    /// @returns The size of the vertices of all meshes on the GPU in bytes.
+    [[nodiscard]]
+    size_t get_vertex_bytes() const;
+
+    /// ## Model::get_depth_vertex_bytes
+    ///
+    /// @returns The vertex data of all meshes fetched by `Model::draw_depth` in bytes.
+    [[nodiscard]]
+    size_t get_depth_vertex_bytes() const;
+
     /// ## Model::draw
     ///
     /// @param program Reference to the `Program` object.
@@ -53,6 +124,46 @@ public:
     /// Draws the model by rendering all its meshes.
     void draw(const Program &program) const;
 
+    /// ## Model::draw
+    ///
+    /// Sets the transform to the `modelTransform` uniform, and draws each mesh at the level of detail selected by
+    /// `Mesh::select_lod`.
+    ///
+    /// @param program: Reference to the `Program` object.
+    /// @param transform: The model transform of the model.
+    /// @param view: The camera position, projection, and error limits.
+    /// @param lods: The level each mesh was drawn at last time, updated to the levels drawn now. It is resized to the
+    /// number of meshes, so an empty vector starts every mesh at the full mesh.
+    ///
+    /// @returns The number of triangles drawn.
+    size_t
+    draw(const Program &program, const glm::mat4 &transform, const LodView &view, std::vector<uint32_t> &lods) const;
+
+    /// ## Model::draw_depth
+    ///
+    /// Draws all meshes for a depth-only pass with `Mesh::draw_depth`.
+    ///
+    /// @param program: Reference to the `Program` object.
+    /// @param lods: The level of detail of each mesh, e.g., updated by `Model::draw`, or empty to draw the full meshes.
+    void draw_depth(const Program &program, std::span<const uint32_t> lods = {}) const;
+
+    /// ## Model::draw_meshlets
+    ///
+    /// Sets the transform to the `modelTransform` uniform, and draws the meshlets of each mesh that pass
+    /// `cull_meshlets`. Meshes without meshlets are drawn whole.
+    ///
+    /// @param program: Reference to the `Program` object.
+    /// @param transform: The model transform of the model.
+    /// @param view_projection: The product of the projection and view matrices.
+    /// @param camera_pos: The position of the camera in world space.
+    /// @param stats: The culling statistics to add the results of the meshes to.
+    ///
+    /// @returns The number of triangles drawn.
+    size_t draw_meshlets(
+            const Program &program, const glm::mat4 &transform, const glm::mat4 &view_projection,
+            const glm::vec3 &camera_pos, MeshletCullStats &stats
+    ) const;
+
 private:
     /// ## Model::load_by_assimp
     ///
@@ -78,7 +189,13 @@ private:
     /// @param mesh: Pointer to the Assimp mesh.
     void process_mesh(const aiMesh *mesh);
 
-    Model() {}
+    /// ## Model::compute_bounds
+    ///
+    /// Computes the bounds of the model from those of its meshes.
+    void compute_bounds();
+
+    explicit Model(const MeshOptions &mesh_options)
+        : mesh_options_{mesh_options} {}
 };
 
 
@@ -0,0 +1,208 @@
+#ifndef __OCCLUSION_BUFFER_H__
+#define __OCCLUSION_BUFFER_H__
+
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "glex/common.h"
+#include "glex/mesh.h"
+#include "glex/thread_pool.h"
+
+/// # OcclusionBufferOptions
+///
+/// Options of `OcclusionBuffer::rasterize`.
+struct OcclusionBufferOptions {
+    /// The pool to rasterize on, or `nullptr` to use `ThreadPool::get_default`.
+    ThreadPool *pool{nullptr};
+    /// The maximum number of threads working at once, including the calling thread, or `0` for one per worker of the
+    /// pool and the calling thread. `1` runs everything on the calling thread.
+    size_t max_threads{0};
+};
+
+/// # OcclusionCullStats
+///
+/// Results of `OcclusionBuffer::is_visible`, summed over the calls that share them.
+struct OcclusionCullStats {
+    size_t visible_count{0};
+    size_t occluded_count{0};
+};
+
+/// # OcclusionBuffer
+///
+/// A small depth buffer on the CPU that occluders are rasterized into, for culling objects hidden behind them before
+/// anything is submitted to OpenGL.
+///
+/// `OcclusionBuffer::add_occluder` transforms the triangles of an occluder to the screen, clipping them at the near
+/// plane and dropping the back faces. `OcclusionBuffer::rasterize` then splits the buffer into bands of rows, one per
+/// thread, and fills each band with the nearest depth of the triangles at the pixel centers, four pixels at a time
+/// with SSE2 if available. Finally, it builds a pyramid of levels, each texel holding the farthest depth of the four
+/// below it, so `OcclusionBuffer::is_visible` tests the screen rectangle of a box against a few texels only.
+///
+/// Everything runs on the CPU without OpenGL. Depth is that of OpenGL window space, `0` at the near plane and `1` at
+/// the far plane, and rows go from the bottom of the screen up.
+///
+/// ## Examples
+///
+/// ```cpp
+/// auto occlusion = OcclusionBuffer::create();
+/// occlusion->begin(projection * view);
+/// occlusion->add_occluder(wall->get_bounding_box(), wall_transform);
+/// occlusion->rasterize();
+/// if (occlusion->is_visible(object->get_bounding_box(), object_transform)) {
+///     object->draw(*program);
+/// }
+/// ```
+class OcclusionBuffer {
+    /// # OcclusionBuffer::Triangle
+    ///
+    /// A front-facing triangle in window space, set up for rasterization.
+    struct Triangle {
+        /// The edge functions `a * x + b * y + c` of the pixel center `(x, y)` as `(a, b, c)`, non-negative inside.
+        std::array<glm::vec3, 3> edges;
+        /// The depth as a function of the pixel center, in the same form.
+        glm::vec3 depth;
+        /// The pixels whose centers the triangle may cover, as `[x_begin, x_end)` by `[y_begin, y_end)`, with the
+        /// columns rounded out to multiples of four.
+        uint32_t x_begin, x_end, y_begin, y_end;
+    };
+
+    const size_t width_, height_;
+    /// The depth of each pixel at level `0`, followed by the coarser levels, each half the size of the previous one,
+    /// rounded up.
+    std::vector<std::vector<float>> levels_;
+    glm::mat4 view_projection_{1.0f};
+    std::vector<Triangle> triangles_;
+
+public:
+    /// ## OcclusionBuffer::create
+    ///
+    /// Creates a new, cleared occlusion buffer.
+    ///
+    /// @param width: The width in pixels, a multiple of four.
+    /// @param height: The height in pixels.
+    ///
+    /// @returns `OcclusionBuffer` object wrapped in `std::unique_ptr` if successful, or `nullptr` if the size is
+    /// invalid.
+    static std::unique_ptr<OcclusionBuffer> create(size_t width = 256, size_t height = 128);
+
+    /// ## OcclusionBuffer::begin
+    ///
+    /// Starts a frame, removing the occluders of the previous one.
+    ///
+    /// @param view_projection: The product of the projection and view matrices of the camera.
+    void begin(const glm::mat4 &view_projection);
+
+    /// ## OcclusionBuffer::add_occluder
+    ///
+    /// Adds the triangles of an occluder, which are rasterized by the next `OcclusionBuffer::rasterize`. Triangles
+    /// wound clockwise on the screen are dropped, as OpenGL culls them by default.
+    ///
+    /// @param positions: The positions of the vertices in model space.
+    /// @param indices: The indices of a triangle list. Trailing indices of an incomplete triangle are ignored.
+    /// @param transform: The model transform of the occluder.
+    void add_occluder(
+            std::span<const glm::vec3> positions, std::span<const uint32_t> indices, const glm::mat4 &transform
+    );
+
+    /// ## OcclusionBuffer::add_occluder
+    ///
+    /// Adds the faces of a box as an occluder, for meshes that fill their box, such as walls, floors, or cubes.
+    ///
+    /// @param box: The box in model space.
+    /// @param transform: The model transform of the occluder.
+    void add_occluder(const BoundingBox &box, const glm::mat4 &transform);
+
+    /// ## OcclusionBuffer::rasterize
+    ///
+    /// Clears the buffer, rasterizes the occluders added since `OcclusionBuffer::begin`, and builds the levels.
+    /// Must not be called from a task of the pool.
+    ///
+    /// @param options: The threads to use.
+    void rasterize(const OcclusionBufferOptions &options = {});
+
+    /// ## OcclusionBuffer::is_visible
+    ///
+    /// Tests a box against the rasterized occluders. The box is visible if any texel under its screen rectangle is at
+    /// least as far as its nearest corner, at the coarsest level where the rectangle covers at most four by four
+    /// texels.
+    ///
+    /// @param box: The box in model space.
+    /// @param transform: The model transform of the object.
+    /// @param stats: The statistics to add the result to, or `nullptr`.
+    ///
+    /// @returns `false` if the box is hidden behind the occluders or outside the screen, `true` otherwise, including
+    /// when it crosses the near plane.
+    [[nodiscard]]
+    bool is_visible(const BoundingBox &box, const glm::mat4 &transform, OcclusionCullStats *stats = nullptr) const;
+
+    /// ## OcclusionBuffer::get_width
+    ///
+    /// @param level: The level of the pyramid.
+    ///
+    /// @returns The width of the level in texels.
+    [[nodiscard]]
+    size_t get_width(const size_t level = 0) const {
+        return get_level_size(width_, level);
+    }
+
+    /// ## OcclusionBuffer::get_height
+    ///
+    /// @param level: The level of the pyramid.
+    ///
+    /// @returns The height of the level in texels.
+    [[nodiscard]]
+    size_t get_height(const size_t level = 0) const {
+        return get_level_size(height_, level);
+    }
+
+    /// ## OcclusionBuffer::get_level_count
+    ///
+    /// @returns The number of levels, down to a single texel.
+    [[nodiscard]]
+    size_t get_level_count() const {
+        return levels_.size();
+    }
+
+    /// ## OcclusionBuffer::get_depth
+    ///
+    /// @param level: The level of the pyramid.
+    ///
+    /// @returns The depth of the texels of the level, row by row from the bottom, e.g., for a debug view.
+    [[nodiscard]]
+    std::span<const float> get_depth(const size_t level = 0) const {
+        return levels_[level];
+    }
+
+    /// ## OcclusionBuffer::get_triangle_count
+    ///
+    /// @returns The number of occluder triangles facing the camera since `OcclusionBuffer::begin`.
+    [[nodiscard]]
+    size_t get_triangle_count() const {
+        return triangles_.size();
+    }
+
+private:
+    OcclusionBuffer(size_t width, size_t height);
+
+    static size_t get_level_size(const size_t size, const size_t level) {
+        return std::max<size_t>((size + (size_t{1} << level) - 1) >> level, 1);
+    }
+
+    /// ## OcclusionBuffer::add_triangle
+    ///
+    /// Clips a triangle in clip space at the near plane and adds the front-facing parts in window space.
+    void add_triangle(const std::array<glm::vec4, 3> &clip);
+
+    /// ## OcclusionBuffer::rasterize_rows
+    ///
+    /// Rasterizes every triangle into the rows `[first, last)` of level `0`.
+    void rasterize_rows(size_t first, size_t last);
+};
+
+
+#endif // __OCCLUSION_BUFFER_H__
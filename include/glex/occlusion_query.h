@@ -0,0 +1,253 @@
+#ifndef __OCCLUSION_QUERY_H__
+#define __OCCLUSION_QUERY_H__
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "glex/buffer.h"
+#include "glex/common.h"
+#include "glex/mesh.h"
+#include "glex/program.h"
+#include "glex/vertex_layout.h"
+
+/// # OcclusionQueryStats
+///
+/// Work of `OcclusionQueryPool` in a frame, from `OcclusionQueryPool::begin_frame` to the next one.
+struct OcclusionQueryStats {
+    /// `GL_ANY_SAMPLES_PASSED` queries begun, on proxy boxes or around the draws of visible objects.
+    size_t queries_issued{0};
+    /// Objects drawn without a condition, as they were visible last time they were tested.
+    size_t visible_draws{0};
+    /// Objects drawn behind `glBeginConditionalRender`, as they were occluded last time they were tested.
+    size_t conditional_draws{0};
+    /// Conditional draws whose query has come back with no samples, so the GPU skipped them. They are counted in the
+    /// frame the result arrives, usually a frame or two after the draw.
+    size_t skipped_draws{0};
+    /// Queries whose result was not available yet at `OcclusionQueryPool::begin_frame`.
+    size_t pending_queries{0};
+};
+
+/// # OcclusionQueryPool
+///
+/// Occlusion culling on the GPU with `GL_ANY_SAMPLES_PASSED` queries and conditional rendering, reusing the results of
+/// earlier frames so that the CPU never waits for a query.
+///
+/// Each object, identified by an index chosen by the caller, keeps the visibility of its latest query result. A frame
+/// then goes through three passes:
+///
+/// 1. `OcclusionQueryPool::draw_visible` draws the objects that were visible. Every `retest_interval` frames, staggered
+///    by the object index, the draw runs inside a query, so an object that became hidden is found out.
+/// 2. Between `OcclusionQueryPool::begin_tests` and `OcclusionQueryPool::end_tests`, `OcclusionQueryPool::test`
+///    draws the box of each object that was occluded inside a query, with color and depth writes off, against the
+///    depth of the visible objects.
+/// 3. `OcclusionQueryPool::draw_conditional` draws the objects that were occluded inside
+///    `glBeginConditionalRender`, so the GPU skips them if their query of this frame found no samples.
+///
+/// `OcclusionQueryPool::begin_frame` reads the results that have arrived without waiting for the others, and query
+/// names are recycled once their result is read. A box that crosses the near plane may hide its own object, so such
+/// an object is taken as visible without a query.
+///
+/// Since a visible object is tested with its own draw, the objects should be drawn roughly front to back in the first
+/// pass; an object drawn before its occluder stays visible until the occluder is drawn first.
+///
+/// ## Examples
+///
+/// ```cpp
+/// queries->begin_frame(projection * view, objects.size());
+/// program->use();
+/// for (uint32_t i = 0; i < objects.size(); ++i) {
+///     queries->draw_visible(i, [&] { objects[i].model->draw(*program); });
+/// }
+/// queries->begin_tests();
+/// for (uint32_t i = 0; i < objects.size(); ++i) {
+///     queries->test(i, objects[i].model->get_bounding_box(), objects[i].transform);
+/// }
+/// queries->end_tests();
+/// program->use();
+/// for (uint32_t i = 0; i < objects.size(); ++i) {
+///     queries->draw_conditional(i, [&] { objects[i].model->draw(*program); });
+/// }
+/// ```
+class OcclusionQueryPool {
+    /// # OcclusionQueryPool::Object
+    ///
+    /// The visibility of an object and its query of the current frame.
+    struct Object {
+        bool visible{true};
+        /// The frame of the query whose result set `visible`, so that an older result arriving late is dropped.
+        uint64_t result_frame{0};
+        /// The query begun in the current frame, valid if `query_frame` is the current frame.
+        uint32_t query{0};
+        uint64_t query_frame{0};
+        /// Set by `OcclusionQueryPool::draw_visible`, so that `OcclusionQueryPool::draw_conditional` does not draw the
+        /// object again.
+        uint64_t drawn_frame{0};
+    };
+
+    /// # OcclusionQueryPool::PendingQuery
+    ///
+    /// A query whose result has not been read yet.
+    struct PendingQuery {
+        uint32_t query;
+        uint32_t object;
+        uint64_t frame;
+        /// Whether the query decides a conditional draw, so that a result without samples counts as skipped.
+        bool conditional;
+    };
+
+    const std::unique_ptr<Program> proxy_program_;
+    /// Unit box from the origin to `(1, 1, 1)`, scaled to the box of each object.
+    const std::unique_ptr<VertexLayout> proxy_layout_;
+    const std::unique_ptr<Buffer> proxy_vertex_buffer_, proxy_index_buffer_;
+    const uint32_t retest_interval_;
+
+    /// Starts at `1`, so that no object has a query of the current frame before its first one.
+    uint64_t frame_{1};
+    glm::mat4 view_projection_{1.0f};
+    std::vector<Object> objects_;
+    /// Pending queries in the order they were begun
+    std::vector<PendingQuery> pending_;
+    std::vector<uint32_t> free_queries_;
+    OcclusionQueryStats stats_{};
+    ///@{
+    /// Write masks in effect before `OcclusionQueryPool::begin_tests`, restored by `OcclusionQueryPool::end_tests`
+    std::array<bool, 4> saved_color_mask_{true, true, true, true};
+    bool saved_depth_mask_{true};
+    ///@}
+
+public:
+    /// ## OcclusionQueryPool::create
+    ///
+    /// Creates a new query pool, with its proxy box and program.
+    ///
+    /// @param retest_interval: The number of frames between two queries of a visible object, at least `1`.
+    ///
+    /// @returns `OcclusionQueryPool` object wrapped in `std::unique_ptr` if successful, or `nullptr` if creation
+    /// fails.
+    static std::unique_ptr<OcclusionQueryPool> create(uint32_t retest_interval = 4);
+
+    /// ## OcclusionQueryPool::~OcclusionQueryPool
+    ///
+    /// Destructor that deletes the OpenGL queries, including the pending ones.
+    ~OcclusionQueryPool();
+
+    OcclusionQueryPool(const OcclusionQueryPool &) = delete;
+    OcclusionQueryPool &operator=(const OcclusionQueryPool &) = delete;
+
+    /// ## OcclusionQueryPool::begin_frame
+    ///
+    /// Starts a frame: reads the query results that are available without blocking, updates the visibility of their
+    /// objects, and resets the stats.
+    ///
+    /// @param view_projection: The product of the projection and view matrices of the camera.
+    /// @param object_count: The number of objects. New objects start visible; removed ones forget their visibility.
+    void begin_frame(const glm::mat4 &view_projection, size_t object_count);
+
+    /// ## OcclusionQueryPool::is_visible
+    ///
+    /// @param object: The index of the object.
+    ///
+    /// @returns Whether the latest query result of the object found samples, or `true` if it has none yet.
+    [[nodiscard]]
+    bool is_visible(const uint32_t object) const {
+        return objects_[object].visible;
+    }
+
+    /// ## OcclusionQueryPool::draw_visible
+    ///
+    /// Draws an object if it was visible, inside a query if the object is due for a test. Does nothing otherwise.
+    ///
+    /// @param object: The index of the object.
+    /// @param draw: Issues the draw calls of the object, e.g., with `Mesh::draw` or `Model::draw`.
+    template <typename Draw>
+    void draw_visible(const uint32_t object, Draw &&draw) {
+        if (!objects_[object].visible) {
+            return;
+        }
+        const auto query = is_retest_due(object) ? begin_query(object, false) : 0;
+        draw();
+        if (query) {
+            glEndQuery(GL_ANY_SAMPLES_PASSED);
+        }
+        objects_[object].drawn_frame = frame_;
+        stats_.visible_draws++;
+    }
+
+    /// ## OcclusionQueryPool::begin_tests
+    ///
+    /// Uses the proxy program, and turns color and depth writes off for `OcclusionQueryPool::test`. The caller must
+    /// use its own program again afterwards.
+    void begin_tests();
+
+    /// ## OcclusionQueryPool::test
+    ///
+    /// Draws the box of an object inside a query if the object was occluded. Does nothing otherwise. An object whose
+    /// box crosses the near plane becomes visible instead.
+    ///
+    /// @param object: The index of the object.
+    /// @param box: The box of the object in model space.
+    /// @param transform: The model transform of the object.
+    void test(uint32_t object, const BoundingBox &box, const glm::mat4 &transform);
+
+    /// ## OcclusionQueryPool::end_tests
+    ///
+    /// Restores the color and depth write masks in effect before `OcclusionQueryPool::begin_tests`.
+    void end_tests();
+
+    /// ## OcclusionQueryPool::draw_conditional
+    ///
+    /// Draws an object that was not drawn by `OcclusionQueryPool::draw_visible`, behind its query of this frame if it
+    /// has one, or unconditionally otherwise.
+    ///
+    /// @param object: The index of the object.
+    /// @param draw: Issues the draw calls of the object.
+    template <typename Draw>
+    void draw_conditional(const uint32_t object, Draw &&draw) {
+        const auto &state = objects_[object];
+        if (state.drawn_frame == frame_) {
+            return;
+        }
+        if (state.query_frame != frame_) {
+            draw();
+            stats_.visible_draws++;
+            return;
+        }
+        glBeginConditionalRender(state.query, GL_QUERY_WAIT);
+        draw();
+        glEndConditionalRender();
+        stats_.conditional_draws++;
+    }
+
+    /// ## OcclusionQueryPool::get_stats
+    ///
+    /// @returns The work of the current frame so far.
+    [[nodiscard]]
+    const OcclusionQueryStats &get_stats() const {
+        return stats_;
+    }
+
+private:
+    OcclusionQueryPool(
+            std::unique_ptr<Program> proxy_program, std::unique_ptr<VertexLayout> proxy_layout,
+            std::unique_ptr<Buffer> proxy_vertex_buffer, std::unique_ptr<Buffer> proxy_index_buffer,
+            uint32_t retest_interval
+    );
+
+    [[nodiscard]]
+    bool is_retest_due(const uint32_t object) const {
+        return (frame_ + object) % retest_interval_ == 0;
+    }
+
+    /// ## OcclusionQueryPool::begin_query
+    ///
+    /// Takes a free query name, or generates one, and begins a `GL_ANY_SAMPLES_PASSED` query for an object.
+    ///
+    /// @returns The query name.
+    uint32_t begin_query(uint32_t object, bool conditional);
+};
+
+
+#endif // __OCCLUSION_QUERY_H__
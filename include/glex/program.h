@@ -5,15 +5,60 @@
 #include <cstdint>
 #include <glm/fwd.hpp>
 #include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 #include "common.h"
 #include "shader.h"
 
+/// # UniformHandle
+///
+/// A uniform location resolved once from a `Program`. Setting a uniform through a handle does not look up the name,
+/// so it is the preferred way to update uniforms in per-frame code.
+///
+/// ## Examples
+///
+/// ```cpp
+/// // At initialization time:
+/// const auto color = program->get_uniform_handle("color");
+/// // Every frame:
+/// program->set_uniform(color, glm::vec4{1.0f});
+/// ```
+struct UniformHandle {
+    /// Uniform location, or `-1` if the uniform is not active in the program.
+    int32_t location{-1};
+
+    /// ## UniformHandle::is_valid
+    ///
+    /// @returns `true` if the handle refers to an active uniform.
+    [[nodiscard]]
+    bool is_valid() const {
+        return location >= 0;
+    }
+};
+
+class PendingProgram;
+
 /// # Program
 ///
 /// A class that encapsulates an OpenGL shader program.
+///
+/// The locations of all active uniforms are read once after linking and kept in a table sorted by name, so setting a
+/// uniform by name never queries the driver.
 class Program {
+    friend class PendingProgram;
+
     const uint32_t program_;
+    /// Attached shaders, kept alive so that other programs can share them through `Shader::create_shared`.
+    std::vector<std::shared_ptr<Shader>> shaders_;
+
+    struct UniformEntry {
+        std::string name;
+        int32_t location;
+    };
+    /// Active uniforms sorted by name.
+    std::vector<UniformEntry> uniforms_;
 
 public:
     /// ## Program::create
@@ -29,14 +74,37 @@ public:
     /// ## Program::create
     ///
     /// Creates and links a new `Program` object from the provided vertex and fragment shader files.
-    /// It reads the shader source code from the files, compiles them, and links them into a pipeline program.
+    /// It reads and preprocesses the shader source code from the files, compiles them, and links them into a pipeline
+    /// program. Shaders already compiled with the same source code and definitions are shared.
     ///
     /// @param vertex_shader_filename: The filename of the vertex shader source code.
     /// @param frag_shader_filename: The filename of the fragment shader source code.
+    /// @param defines: The preprocessor definitions injected into both shaders.
     ///
     /// @returns `Program` object wrapped in `std::unique_ptr` if successful, or `nullptr` if linking fails.
-    static std::unique_ptr<Program>
-    create(const std::string &vertex_shader_filename, const std::string &frag_shader_filename);
+    static std::unique_ptr<Program> create(
+            const std::string &vertex_shader_filename, const std::string &frag_shader_filename,
+            const ShaderDefines &defines = {}
+    );
+
+    /// ## Program::create_async
+    ///
+    /// Submits the compilation and linking of a new `Program` from the provided vertex and fragment shader files
+    /// without waiting for the driver. The compile and link status are checked only when the returned handle is
+    /// resolved with `PendingProgram::get`.
+    ///
+    /// Submitting every program of a context before resolving any of them lets the driver compile them in parallel
+    /// when `GL_KHR_parallel_shader_compile` is available, and avoids a pipeline stall per shader otherwise.
+    ///
+    /// @param vertex_shader_filename: The filename of the vertex shader source code.
+    /// @param frag_shader_filename: The filename of the fragment shader source code.
+    /// @param defines: The preprocessor definitions injected into both shaders.
+    ///
+    /// @returns `PendingProgram` handle of the program.
+    static PendingProgram create_async(
+            const std::string &vertex_shader_filename, const std::string &frag_shader_filename,
+            const ShaderDefines &defines = {}
+    );
 
     /// ## Program::~Program
     ///
@@ -56,13 +124,34 @@ public:
     /// Uses the program for rendering using OpenGL `glUseProgram` function.
     void use() const;
 
+    /// ## Program::get_uniform_handle
+    ///
+    /// Finds the location of an active uniform. Array elements and struct members can be looked up by their full
+    /// names, e.g. `lights[3].position` or `samples[7]`.
+    ///
+    /// @param name: The name of the uniform variable in the shader.
+    ///
+    /// @returns `UniformHandle` of the uniform. The handle is invalid if the uniform is not active in the program.
+    [[nodiscard]]
+    UniformHandle get_uniform_handle(std::string_view name) const;
+
+    /// ## Program::bind_uniform_block
+    ///
+    /// Assigns a uniform block of the program to a uniform buffer binding point.
+    ///
+    /// @param name: The name of the uniform block in the shader.
+    /// @param binding: The binding point, usually `UniformBuffer::get_binding`.
+    ///
+    /// @returns `true` if the block is active in the program, `false` otherwise.
+    bool bind_uniform_block(std::string_view name, uint32_t binding) const;
+
     /// ## Program::set_uniform
     ///
     /// Sets an integer uniform value in the shader program.
     ///
     /// @param name: The name of the uniform variable in the shader.
     /// @param value: The integer value to set the uniform to.
-    void set_uniform(const std::string &name, int value) const;
+    void set_uniform(std::string_view name, int value) const;
 
     /// ## Program::set_uniform
     ///
@@ -70,7 +159,7 @@ public:
     ///
     /// @param name: The name of the uniform variable in the shader.
     /// @param value: The float value to set the uniform to.
-    void set_uniform(const std::string &name, float value) const;
+    void set_uniform(std::string_view name, float value) const;
 
     /// ## Program::set_uniform
     ///
@@ -78,7 +167,7 @@ public:
     ///
     /// @param name: The name of the uniform variable in the shader.
     /// @param value: The `glm::vec2` vector value to set the uniform to.
-    void set_uniform(const std::string &name, const glm::vec2 &value) const;
+    void set_uniform(std::string_view name, const glm::vec2 &value) const;
 
     /// ## Program::set_uniform
     ///
@@ -86,7 +175,7 @@ public:
     ///
     /// @param name: The name of the uniform variable in the shader.
     /// @param value: The `glm::vec3` vector value to set the uniform to.
-    void set_uniform(const std::string &name, const glm::vec3 &value) const;
+    void set_uniform(std::string_view name, const glm::vec3 &value) const;
 
     /// ## Program::set_uniform
     ///
@@ -94,7 +183,7 @@ public:
     ///
     /// @param name: The name of the uniform variable in the shader.
     /// @param value: The `glm::vec4` vector value to set the uniform to.
-    void set_uniform(const std::string &name, const glm::vec4 &value) const;
+    void set_uniform(std::string_view name, const glm::vec4 &value) const;
 
     /// ## Program::set_uniform
     ///
@@ -102,13 +191,105 @@ public:
     ///
     /// @param name: The name of the uniform variable in the shader.
     /// @param value: The `glm::mat4` matrix value to set the uniform to.
-    void set_uniform(const std::string &name, const glm::mat4 &value) const;
+    void set_uniform(std::string_view name, const glm::mat4 &value) const;
+
+    ///@{
+    /// ## Program::set_uniform
+    ///
+    /// Sets a uniform value through a handle obtained from `Program::get_uniform_handle`. Invalid handles are ignored.
+    ///
+    /// @param handle: The handle of the uniform variable in the shader.
+    /// @param value: The value to set the uniform to.
+    void set_uniform(UniformHandle handle, int value) const;
+    void set_uniform(UniformHandle handle, float value) const;
+    void set_uniform(UniformHandle handle, const glm::vec2 &value) const;
+    void set_uniform(UniformHandle handle, const glm::vec3 &value) const;
+    void set_uniform(UniformHandle handle, const glm::vec4 &value) const;
+    void set_uniform(UniformHandle handle, const glm::mat4 &value) const;
+    ///@}
+
+    /// ## Program::set_uniform
+    ///
+    /// Sets a whole `vec3` array uniform with a single call.
+    ///
+    /// @param handle: The handle of the first element of the array, e.g. `samples[0]` or `samples`.
+    /// @param values: The values to set the array to.
+    void set_uniform(UniformHandle handle, std::span<const glm::vec3> values) const;
 
 private:
     explicit Program(uint32_t program);
 
+    /// ## Program::submit_link
+    ///
+    /// Attaches the shaders and starts linking the program without waiting for the result.
+    ///
+    /// @param shaders: The shaders to link into the program.
+    void submit_link(const std::vector<std::shared_ptr<Shader>> &shaders) const;
+
+    /// ## Program::is_linked
+    ///
+    /// Checks the link status of the program and logs the info log if linking failed.
+    ///
+    /// @returns `true` if the program is successfully linked, `false` otherwise.
     [[nodiscard]]
-    bool link(const std::vector<std::shared_ptr<Shader>> &shaders) const;
+    bool is_linked() const;
+
+    /// ## Program::load_uniforms
+    ///
+    /// Reads the names and locations of all active uniforms of the linked program into the lookup table.
+    void load_uniforms();
+};
+
+/// # PendingProgram
+///
+/// A handle to a program whose shaders are still being compiled and linked by the driver, returned by
+/// `Program::create_async`.
+///
+/// ## Examples
+///
+/// ```cpp
+/// // Submit all programs first.
+/// auto pending_simple = Program::create_async("./shader/simple.vs", "./shader/simple.fs");
+/// auto pending_pbr = Program::create_async("./shader/pbr.vs", "./shader/pbr.fs");
+/// // Collect the results later.
+/// simple_program = pending_simple.get();
+/// pbr_program = pending_pbr.get();
+/// ```
+class PendingProgram {
+    friend class Program;
+
+    std::unique_ptr<Program> program_;
+    std::vector<std::shared_ptr<Shader>> shaders_;
+    uint64_t cache_key_{0};
+    bool linked_{false};
+
+public:
+    PendingProgram() = default;
+    PendingProgram(PendingProgram &&) noexcept = default;
+    PendingProgram &operator=(PendingProgram &&) noexcept = default;
+
+    /// ## PendingProgram::is_ready
+    ///
+    /// Polls the driver without blocking. Without `GL_KHR_parallel_shader_compile` the completion status cannot be
+    /// queried, so the program is always reported as ready and `PendingProgram::get` waits for it.
+    ///
+    /// @returns `true` if `PendingProgram::get` will not wait for the driver.
+    [[nodiscard]]
+    bool is_ready() const;
+
+    /// ## PendingProgram::get
+    ///
+    /// Waits for the program to be linked and checks the result. The handle is empty afterward.
+    ///
+    /// @returns `Program` object wrapped in `std::unique_ptr` if successful, or `nullptr` if compiling or linking
+    /// fails.
+    std::unique_ptr<Program> get();
+
+private:
+    PendingProgram(
+            std::unique_ptr<Program> &&program, std::vector<std::shared_ptr<Shader>> &&shaders, uint64_t cache_key,
+            bool linked
+    );
 };
 
 
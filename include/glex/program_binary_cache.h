@@ -0,0 +1,95 @@
+#ifndef __PROGRAM_BINARY_CACHE_H__
+#define __PROGRAM_BINARY_CACHE_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+#include "glex/common.h"
+
+/// # ProgramBinaryCache
+///
+/// An on-disk cache of linked program binaries using `glGetProgramBinary` and `glProgramBinary`.
+///
+/// A binary is stored under a key computed from the source code of every shader stage and the vendor, renderer and
+/// version strings of the driver. If the sources or the driver change, the key changes and the program is compiled
+/// from source again. If the driver rejects a stored binary, the program is also compiled from source and the stale
+/// binary is replaced.
+///
+/// The cache is disabled until a directory is set with `ProgramBinaryCache::set_directory`, and it stays disabled if
+/// the OpenGL context does not support any program binary format.
+///
+/// ## Examples
+///
+/// ```cpp
+/// ProgramBinaryCache::set_directory("./.cache/program_binary");
+/// // `Program::create` now loads cached binaries when they are available.
+/// auto program = Program::create("./shader/simple.vs", "./shader/simple.fs");
+/// ```
+class ProgramBinaryCache {
+public:
+    /// Shader type and source code of each stage of a program.
+    using Sources = std::vector<std::pair<GLenum, std::string>>;
+
+    /// ## ProgramBinaryCache::set_directory
+    ///
+    /// Enables the cache and sets the directory to store program binaries in. The directory is created if it does
+    /// not exist.
+    ///
+    /// @param directory: The directory to store program binaries in.
+    static void set_directory(const std::filesystem::path &directory);
+
+    /// ## ProgramBinaryCache::is_enabled
+    ///
+    /// @returns `true` if a cache directory is set and the context supports program binaries.
+    [[nodiscard]]
+    static bool is_enabled();
+
+    /// ## ProgramBinaryCache::make_key
+    ///
+    /// Computes the cache key of a program from the sources of its stages and the current driver.
+    ///
+    /// @param sources: The shader type and source code of each stage.
+    ///
+    /// @returns The cache key.
+    [[nodiscard]]
+    static uint64_t make_key(const Sources &sources);
+
+    /// ## ProgramBinaryCache::load
+    ///
+    /// Loads the binary stored under the key into the program and checks whether the driver accepts it.
+    ///
+    /// @param program_id: The OpenGL program ID to load the binary into.
+    /// @param key: The cache key of the program.
+    ///
+    /// @returns `true` if the program is successfully linked from the cached binary, `false` otherwise.
+    static bool load(uint32_t program_id, uint64_t key);
+
+    /// ## ProgramBinaryCache::store
+    ///
+    /// Retrieves the binary of the linked program and stores it under the key.
+    ///
+    /// @param program_id: The OpenGL program ID to retrieve the binary from.
+    /// @param key: The cache key of the program.
+    static void store(uint32_t program_id, uint64_t key);
+
+    /// ## ProgramBinaryCache::get_hit_count
+    ///
+    /// @returns The number of programs loaded from the cache.
+    [[nodiscard]]
+    static size_t get_hit_count();
+
+    /// ## ProgramBinaryCache::get_miss_count
+    ///
+    /// @returns The number of programs that had to be compiled from source while the cache was enabled.
+    [[nodiscard]]
+    static size_t get_miss_count();
+
+    ProgramBinaryCache() = delete;
+};
+
+
+#endif // __PROGRAM_BINARY_CACHE_H__
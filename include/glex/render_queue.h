@@ -0,0 +1,188 @@
+#ifndef __RENDER_QUEUE_H__
+#define __RENDER_QUEUE_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "glex/common.h"
+#include "glex/mesh.h"
+#include "glex/model.h"
+#include "glex/program.h"
+
+/// # RenderQueueStats
+///
+/// State changes of the draws of a `RenderQueue`, counted in a given order.
+struct RenderQueueStats {
+    size_t draw_count{0};
+    size_t program_changes{0};
+    /// Materials set to the program, each binding its textures.
+    size_t material_changes{0};
+    size_t vertex_array_changes{0};
+};
+
+/// # RenderQueue
+///
+/// A list of draws, each submitted as a 64-bit sort key and a payload, sorted every frame so that draws sharing a
+/// program, a material, or a mesh are executed together.
+///
+/// From the most significant bits down, the key holds the pass, the program, the material, the mesh, and the view
+/// depth bucket, so draws are grouped by the most expensive state first and go front to back within the same state.
+/// Programs, materials and meshes get small ids in the order they are first submitted after `RenderQueue::begin`.
+/// Ids too large for their field wrap around, which only makes the order less tight: `RenderQueue::execute` compares
+/// the state itself, not the keys.
+///
+/// `RenderQueue::sort` sorts the keys with an 8-bit least significant digit radix sort, skipping the digits that
+/// every key shares. `RenderQueue::execute` then uses a program, sets a material, and binds a vertex array only when
+/// it differs from that of the previous draw, and sets the `modelTransform` uniform of every draw.
+///
+/// The queue keeps pointers to the submitted programs, materials and meshes, which must outlive
+/// `RenderQueue::execute`.
+///
+/// ## Examples
+///
+/// ```cpp
+/// queue.begin(view, 100.0f);
+/// queue.submit(0, *program, *cube_mesh, cube_material.get(), cube_transform);
+/// queue.submit(0, *program, *model, model_transform);
+/// queue.sort();
+/// queue.execute();
+/// ```
+class RenderQueue {
+public:
+    ///@{
+    /// Bits of each field of the sort key, from the most significant down.
+    static constexpr uint32_t PASS_BITS{4};
+    static constexpr uint32_t PROGRAM_BITS{12};
+    static constexpr uint32_t MATERIAL_BITS{14};
+    static constexpr uint32_t MESH_BITS{18};
+    static constexpr uint32_t DEPTH_BITS{16};
+    ///@}
+
+    /// # RenderQueue::Draw
+    ///
+    /// The payload of a key.
+    struct Draw {
+        const Program *program;
+        /// The material to set, or `nullptr` to leave that of the previous draw.
+        const Material *material;
+        const Mesh *mesh;
+        glm::mat4 transform;
+        uint32_t lod;
+    };
+
+private:
+    /// # RenderQueue::Item
+    ///
+    /// A sort key and the index of its draw.
+    struct Item {
+        uint64_t key;
+        uint32_t draw;
+    };
+
+    /// # RenderQueue::State
+    ///
+    /// The state left by a draw, to count the changes of the next one.
+    struct State {
+        const Program *program{nullptr};
+        const Material *material{nullptr};
+        uint32_t vertex_array{0};
+    };
+
+    /// Draws in submission order
+    std::vector<Draw> draws_;
+    std::vector<Item> items_, scratch_;
+    std::unordered_map<const void *, uint32_t> program_ids_, material_ids_, mesh_ids_;
+    glm::mat4 view_{1.0f};
+    float depth_range_{1.0f};
+    State submitted_state_{};
+    RenderQueueStats submitted_stats_{}, executed_stats_{};
+
+public:
+    /// ## RenderQueue::begin
+    ///
+    /// Starts a frame, removing the draws of the previous one and forgetting the ids of their state.
+    ///
+    /// @param view: The view matrix of the camera, for the depth of the draws.
+    /// @param depth_range: The view depth mapped to the last depth bucket, usually the far plane. Farther draws share
+    /// that bucket.
+    void begin(const glm::mat4 &view, float depth_range);
+
+    /// ## RenderQueue::submit
+    ///
+    /// Adds a draw of a mesh, at the view depth of the origin of its transform.
+    ///
+    /// @param pass: The pass of the draw, less than `1 << PASS_BITS`. Lower passes are executed first.
+    /// @param program: The program to draw with.
+    /// @param mesh: The mesh to draw.
+    /// @param material: The material to set, or `nullptr` for that of the mesh.
+    /// @param transform: The model transform, set to the `modelTransform` uniform.
+    /// @param lod: The level of detail to draw.
+    void submit(
+            uint32_t pass, const Program &program, const Mesh &mesh, const Material *material,
+            const glm::mat4 &transform, uint32_t lod = 0
+    );
+
+    /// ## RenderQueue::submit
+    ///
+    /// Adds a draw of each mesh of a model with its own material.
+    ///
+    /// @param pass: The pass of the draws.
+    /// @param program: The program to draw with.
+    /// @param model: The model to draw.
+    /// @param transform: The model transform.
+    void submit(uint32_t pass, const Program &program, const Model &model, const glm::mat4 &transform);
+
+    /// ## RenderQueue::sort
+    ///
+    /// Sorts the draws by their keys. Draws with the same key keep their submission order.
+    void sort();
+
+    /// ## RenderQueue::execute
+    ///
+    /// Issues the draws in their current order, sorted or not, changing only the state that differs between
+    /// consecutive draws.
+    void execute();
+
+    /// ## RenderQueue::make_key
+    ///
+    /// Packs the fields of a sort key. Each field is truncated to its bits.
+    ///
+    /// @returns The sort key.
+    [[nodiscard]]
+    static uint64_t make_key(uint32_t pass, uint32_t program, uint32_t material, uint32_t mesh, uint32_t depth);
+
+    /// ## RenderQueue::get_size
+    ///
+    /// @returns The number of draws since `RenderQueue::begin`.
+    [[nodiscard]]
+    size_t get_size() const {
+        return draws_.size();
+    }
+
+    /// ## RenderQueue::get_submitted_stats
+    ///
+    /// @returns The state changes the draws would take in submission order.
+    [[nodiscard]]
+    const RenderQueueStats &get_submitted_stats() const {
+        return submitted_stats_;
+    }
+
+    /// ## RenderQueue::get_executed_stats
+    ///
+    /// @returns The state changes of the last `RenderQueue::execute`.
+    [[nodiscard]]
+    const RenderQueueStats &get_executed_stats() const {
+        return executed_stats_;
+    }
+
+private:
+    /// ## RenderQueue::count_changes
+    ///
+    /// Adds the state changes of a draw following `state` to the stats, and updates `state`.
+    static void count_changes(const Draw &draw, State &state, RenderQueueStats &stats);
+};
+
+
+#endif // __RENDER_QUEUE_H__
@@ -0,0 +1,133 @@
+#ifndef __RESOURCE_CACHE_H__
+#define __RESOURCE_CACHE_H__
+
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "glex/common.h"
+#include "glex/image.h"
+#include "glex/model.h"
+#include "glex/shader.h"
+#include "glex/texture.h"
+
+/// # ResourceCache
+///
+/// An in-process cache that hands out shared handles to GPU resources, so a resource requested several times is
+/// decoded and uploaded only once.
+///
+/// Resources loaded from files are keyed by the canonical path of the file and the load options. Textures created from
+/// generated images are keyed by a hash of the image content.
+///
+/// The cache does not own the resources. An entry is reused while at least one handle to it is alive, and the resource
+/// is deleted together with its last handle. Therefore, every resource is released before the OpenGL context is
+/// destroyed as long as its users are.
+///
+/// ## Examples
+///
+/// ```cpp
+/// auto diffuse = ResourceCache::get_texture("./image/container.jpg");
+/// // Returns the same texture without decoding the file again.
+/// auto same_diffuse = ResourceCache::get_texture("./image/../image/container.jpg");
+/// ```
+class ResourceCache {
+public:
+    /// Kinds of cached resources.
+    enum class ResourceType {
+        TEXTURE,
+        CUBE_TEXTURE,
+        SHADER,
+        MODEL,
+    };
+
+    /// Number of requests served from the cache and requests that loaded a new resource.
+    struct Stats {
+        size_t hits{0};
+        size_t misses{0};
+    };
+
+    /// ## ResourceCache::get_texture
+    ///
+    /// Returns the texture loaded from an image file, loading it if it is not cached.
+    ///
+    /// @param filepath: The path to the image file.
+    /// @param flip_vertical: Whether to load the image with its vertical flipped or load it as is.
+    ///
+    /// @returns Shared pointer to the `Texture` object, or `nullptr` if loading fails.
+    static std::shared_ptr<Texture> get_texture(const std::string &filepath, bool flip_vertical = true);
+
+    /// ## ResourceCache::get_textures
+    ///
+    /// Returns the textures loaded from several image files. The files that are not cached are decoded in parallel
+    /// with `Image::load_many`, and each texture is uploaded as soon as its image is decoded.
+    ///
+    /// @param filepaths: The paths to the image files.
+    /// @param flip_vertical: Whether to load the images with their vertical flipped or load them as is.
+    ///
+    /// @returns Shared pointers to the `Texture` objects in the order of `filepaths`, with `nullptr` for files that
+    /// failed to load.
+    static std::vector<std::shared_ptr<Texture>>
+    get_textures(const std::vector<std::string> &filepaths, bool flip_vertical = true);
+
+    /// ## ResourceCache::get_texture
+    ///
+    /// Returns the texture created from an image with the same size, format and pixels, creating it if it is not
+    /// cached. This is meant for generated images such as single color images.
+    ///
+    /// @param image: The `Image` object containing the texture data.
+    ///
+    /// @returns Shared pointer to the `Texture` object, or `nullptr` if creation fails.
+    static std::shared_ptr<Texture> get_texture(const Image &image);
+
+    /// ## ResourceCache::get_cube_texture
+    ///
+    /// Returns the cube texture loaded from six image files, loading it if it is not cached.
+    ///
+    /// @param filepaths: The paths to the image files of the faces, in the order of `CubeTexture::create_from_images`.
+    /// @param flip_vertical: Whether to load the images with their vertical flipped or load them as is.
+    ///
+    /// @returns Shared pointer to the `CubeTexture` object, or `nullptr` if loading fails.
+    static std::shared_ptr<CubeTexture>
+    get_cube_texture(const std::vector<std::string> &filepaths, bool flip_vertical = false);
+
+    /// ## ResourceCache::get_shader
+    ///
+    /// Returns the shader compiled from a file with the given definitions, compiling it if it is not cached.
+    ///
+    /// @param filename: The path to the shader file.
+    /// @param shader_type: The type of the shader (e.g., `GL_VERTEX_SHADER`, `GL_FRAGMENT_SHADER`).
+    /// @param defines: The preprocessor definitions to inject into the source code.
+    ///
+    /// @returns Shared pointer to the `Shader` object, or `nullptr` if compiling fails.
+    static std::shared_ptr<Shader>
+    get_shader(const std::string &filename, GLenum shader_type, const ShaderDefines &defines = {});
+
+    /// ## ResourceCache::get_model
+    ///
+    /// Returns the model loaded from a file, loading it if it is not cached.
+    ///
+    /// @param filepath: The path to the model file.
+    /// @param options: The options of the meshes, as `Model::load`. Each combination of options is cached separately.
+    ///
+    /// @returns Shared pointer to the `Model` object, or `nullptr` if loading fails.
+    static std::shared_ptr<Model> get_model(const std::string &filepath, const MeshOptions &options = {});
+
+    /// ## ResourceCache::get_stats
+    ///
+    /// @param type: The kind of resources.
+    ///
+    /// @returns The hit and miss counts of the kind of resources.
+    [[nodiscard]]
+    static Stats get_stats(ResourceType type);
+
+    /// ## ResourceCache::log_stats
+    ///
+    /// Logs the hit and miss counts of all kinds of resources.
+    static void log_stats();
+
+    ResourceCache() = delete;
+};
+
+
+#endif // __RESOURCE_CACHE_H__
@@ -0,0 +1,113 @@
+#ifndef __SAMPLER_H__
+#define __SAMPLER_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <memory>
+#include "glex/common.h"
+
+/// # SamplerDesc
+///
+/// Filtering and wrapping state of a `Sampler`. The defaults match the state of a texture created by
+/// `Texture::create(const Image &)`.
+struct SamplerDesc {
+    int32_t min_filter{GL_LINEAR_MIPMAP_LINEAR};
+    int32_t mag_filter{GL_LINEAR};
+    int32_t wrap_s{GL_CLAMP_TO_EDGE};
+    int32_t wrap_t{GL_CLAMP_TO_EDGE};
+    int32_t wrap_r{GL_CLAMP_TO_EDGE};
+    /// Used with `GL_CLAMP_TO_BORDER` wrap modes.
+    glm::vec4 border_color{0.0f};
+    /// Maximum degree of anisotropic filtering, where `1.0` disables it. It is clamped to the limit of the driver and
+    /// ignored if anisotropic filtering is not supported.
+    float max_anisotropy{1.0f};
+
+    bool operator==(const SamplerDesc &other) const = default;
+};
+
+/// # Sampler
+///
+/// A class that encapsulates an OpenGL sampler object, which holds filtering and wrapping state separately from
+/// textures.
+///
+/// A sampler bound to a texture unit overrides the parameters of the texture bound to that unit. Textures sharing a
+/// `Sampler` from `Sampler::create_shared` don't need their own parameters set, and the driver does not revalidate the
+/// parameters when they are bound.
+///
+/// ## Examples
+///
+/// ```cpp
+/// auto sampler = Sampler::create_shared({.min_filter = GL_NEAREST, .mag_filter = GL_NEAREST});
+/// texture->set_sampler(sampler);
+/// // Binds both the texture and the sampler to unit 0.
+/// texture->bind_to_unit(0);
+/// ```
+class Sampler {
+    const uint32_t sampler_;
+    const SamplerDesc desc_;
+
+public:
+    /// ## Sampler::create
+    ///
+    /// Creates a new sampler object with the given state.
+    ///
+    /// @param desc: The filtering and wrapping state.
+    ///
+    /// @returns `Sampler` object wrapped in `std::unique_ptr` if successful, or `nullptr` if creation fails.
+    static std::unique_ptr<Sampler> create(const SamplerDesc &desc = {});
+
+    /// ## Sampler::create_shared
+    ///
+    /// Returns the sampler with the given state, sharing it with every other user of the same state. A new sampler
+    /// object is created only if no sampler with the same state is alive.
+    ///
+    /// @param desc: The filtering and wrapping state.
+    ///
+    /// @returns Shared pointer to the `Sampler` object, or `nullptr` if creation fails.
+    static std::shared_ptr<Sampler> create_shared(const SamplerDesc &desc = {});
+
+    /// ## Sampler::get_shared_count
+    ///
+    /// @returns The number of distinct samplers alive among those returned by `Sampler::create_shared`.
+    [[nodiscard]]
+    static size_t get_shared_count();
+
+    /// ## Sampler::~Sampler
+    ///
+    /// Destructor that deletes the OpenGL sampler object.
+    ~Sampler();
+
+    Sampler(const Sampler &) = delete;
+    Sampler &operator=(const Sampler &) = delete;
+
+    /// ## Sampler::get
+    ///
+    /// @returns OpenGL sampler ID.
+    [[nodiscard]]
+    uint32_t get() const {
+        return sampler_;
+    }
+
+    /// ## Sampler::get_desc
+    ///
+    /// @returns The filtering and wrapping state of the sampler.
+    [[nodiscard]]
+    const SamplerDesc &get_desc() const {
+        return desc_;
+    }
+
+    /// ## Sampler::bind_to_unit
+    ///
+    /// Binds the sampler to a texture unit.
+    ///
+    /// @param texture_unit: The texture unit ID to bind the sampler to.
+    void bind_to_unit(uint32_t texture_unit) const;
+
+private:
+    Sampler(uint32_t sampler_id, const SamplerDesc &desc);
+};
+
+
+#endif // __SAMPLER_H__
@@ -0,0 +1,202 @@
+#ifndef __SCENE_BVH_H__
+#define __SCENE_BVH_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+#include "glex/common.h"
+#include "glex/frustum.h"
+#include "glex/mesh.h"
+
+/// # SceneBVHOptions
+///
+/// Options of `SceneBVH::build`.
+struct SceneBVHOptions {
+    /// The largest number of objects in a leaf. Larger nodes are always split.
+    size_t max_leaf_size{4};
+    /// The number of bins the centroids are sorted into along each axis to evaluate the surface area heuristic.
+    size_t bin_count{16};
+};
+
+/// # SceneBVHQueryStats
+///
+/// Work done by the queries of `SceneBVH`, summed over the calls that share them.
+struct SceneBVHQueryStats {
+    /// Nodes whose box was reached by the traversal.
+    size_t node_count{0};
+    /// Objects returned.
+    size_t object_count{0};
+};
+
+/// # SceneBVHHit
+///
+/// The nearest object hit by a ray, from `SceneBVH::raycast`.
+struct SceneBVHHit {
+    uint32_t object;
+    /// The distance along the ray, in units of the length of its direction.
+    float distance;
+};
+
+/// # SceneBVH
+///
+/// A bounding volume hierarchy over the world-space boxes of scene objects, for frustum culling, shadow caster
+/// selection, and ray picking without visiting every object.
+///
+/// `SceneBVH::build` splits the objects top-down at the binned split of least surface area heuristic cost. The nodes
+/// are stored in depth-first order in one array, each 32 bytes, with the first child right after its parent, so a
+/// traversal mostly walks forward in memory. Each leaf refers to a contiguous range of object indices.
+///
+/// Moving objects keep the topology: `SceneBVH::update` changes the box of an object, and `SceneBVH::refit` then
+/// recomputes the boxes of the nodes bottom-up in one reverse pass. Refitting lets the boxes grow looser as objects
+/// move apart, so the hierarchy should be built again after large changes.
+///
+/// ## Examples
+///
+/// ```cpp
+/// SceneBVH bvh;
+/// bvh.build(object_bounds);
+/// std::vector<uint32_t> visible;
+/// bvh.query(Frustum::from_matrix(projection * view), visible);
+/// ```
+class SceneBVH {
+public:
+    /// # SceneBVH::Node
+    ///
+    /// A node of the hierarchy.
+    struct Node {
+        BoundingBox bounds;
+        /// For an inner node, the index of the second child, the first one following the node. For a leaf, the index
+        /// of its first object in the object indices.
+        uint32_t offset;
+        /// The number of objects of a leaf, or `0` for an inner node.
+        uint32_t object_count;
+    };
+
+private:
+    std::vector<Node> nodes_;
+    /// Object indices in leaf order
+    std::vector<uint32_t> object_indices_;
+    /// World-space box of each object, by object index
+    std::vector<BoundingBox> object_bounds_;
+
+public:
+    /// ## SceneBVH::build
+    ///
+    /// Builds the hierarchy over the boxes, replacing the previous one.
+    ///
+    /// @param bounds: The world-space box of each object, indexed by object.
+    /// @param options: The leaf size and the number of bins.
+    void build(std::span<const BoundingBox> bounds, const SceneBVHOptions &options = {});
+
+    /// ## SceneBVH::update
+    ///
+    /// Changes the box of an object. The nodes are only updated by `SceneBVH::refit`.
+    ///
+    /// @param object: The index of the object.
+    /// @param bounds: The new world-space box of the object.
+    void update(uint32_t object, const BoundingBox &bounds) {
+        object_bounds_[object] = bounds;
+    }
+
+    /// ## SceneBVH::refit
+    ///
+    /// Recomputes the box of every node from the boxes of the objects, keeping the hierarchy.
+    void refit();
+
+    /// ## SceneBVH::query
+    ///
+    /// Finds the objects whose box intersects the frustum. A node inside a plane is not tested against it again below,
+    /// and the objects of a node inside every plane are returned without further tests.
+    ///
+    /// @param frustum: The frustum in world space.
+    /// @param objects: The indices of the objects found, replaced.
+    /// @param stats: The statistics to add the work to, or `nullptr`.
+    void query(const Frustum &frustum, std::vector<uint32_t> &objects, SceneBVHQueryStats *stats = nullptr) const;
+
+    /// ## SceneBVH::query_shadow_casters
+    ///
+    /// Finds the objects that may cast a shadow from a directional light onto the receivers: those whose box
+    /// intersects the light frustum and, swept along the light direction, reaches the box of the receivers.
+    ///
+    /// @param light_frustum: The frustum of the light's view-projection matrix, e.g., from
+    /// `ShadowMap::get_light_transform`.
+    /// @param light_direction: The direction the light travels in.
+    /// @param receivers: The world-space box of the objects the shadows fall on, e.g., those visible to the camera.
+    /// @param objects: The indices of the objects found, replaced.
+    /// @param stats: The statistics to add the work to, or `nullptr`.
+    void query_shadow_casters(
+            const Frustum &light_frustum, const glm::vec3 &light_direction, const BoundingBox &receivers,
+            std::vector<uint32_t> &objects, SceneBVHQueryStats *stats = nullptr
+    ) const;
+
+    /// ## SceneBVH::raycast
+    ///
+    /// Finds the nearest object hit by a ray, visiting the nearer child first and skipping nodes beyond the nearest
+    /// hit so far.
+    ///
+    /// @param origin: The origin of the ray in world space.
+    /// @param direction: The direction of the ray, which need not be normalized.
+    /// @param max_distance: The largest distance along the ray to look at.
+    /// @param intersect: The exact test of an object whose box the ray enters, returning the distance of the hit, or
+    /// empty to take the distance to the box.
+    /// @param stats: The statistics to add the work to, or `nullptr`.
+    ///
+    /// @returns The nearest hit, or `std::nullopt` if the ray hits nothing.
+    [[nodiscard]]
+    std::optional<SceneBVHHit> raycast(
+            const glm::vec3 &origin, const glm::vec3 &direction,
+            float max_distance = std::numeric_limits<float>::max(),
+            const std::function<std::optional<float>(uint32_t object)> &intersect = {},
+            SceneBVHQueryStats *stats = nullptr
+    ) const;
+
+    /// ## SceneBVH::get_bounds
+    ///
+    /// @returns The box enclosing every object, or an empty box if there are none.
+    [[nodiscard]]
+    BoundingBox get_bounds() const {
+        return nodes_.empty() ? BoundingBox{} : nodes_.front().bounds;
+    }
+
+    /// ## SceneBVH::get_object_bounds
+    ///
+    /// @param object: The index of the object.
+    ///
+    /// @returns The world-space box of the object.
+    [[nodiscard]]
+    const BoundingBox &get_object_bounds(const uint32_t object) const {
+        return object_bounds_[object];
+    }
+
+    /// ## SceneBVH::get_object_count
+    ///
+    /// @returns The number of objects.
+    [[nodiscard]]
+    size_t get_object_count() const {
+        return object_bounds_.size();
+    }
+
+    /// ## SceneBVH::get_node_count
+    ///
+    /// @returns The number of nodes.
+    [[nodiscard]]
+    size_t get_node_count() const {
+        return nodes_.size();
+    }
+
+    /// ## SceneBVH::get_nodes
+    ///
+    /// @returns The nodes in depth-first order, the root first.
+    [[nodiscard]]
+    std::span<const Node> get_nodes() const {
+        return nodes_;
+    }
+};
+
+
+#endif // __SCENE_BVH_H__
@@ -2,14 +2,105 @@
 #define __SHADER_H__
 
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include "common.h"
 
+/// # ShaderDefines
+///
+/// A set of preprocessor definitions injected into shader source code right after the `#version` directive.
+///
+/// Definitions are kept sorted by name, so the same set always produces the same source code and the same permutation
+/// key regardless of the order in which the definitions were added.
+///
+/// ## Examples
+///
+/// ```cpp
+/// auto defines = ShaderDefines{}.set("USE_SSAO").set("KERNEL_SIZE", 32);
+/// auto program = Program::create("./shader/ssao.vs", "./shader/ssao.fs", defines);
+/// ```
+class ShaderDefines {
+    std::vector<std::pair<std::string, std::string>> defines_;
+
+public:
+    ShaderDefines() = default;
+
+    /// ## ShaderDefines::ShaderDefines
+    ///
+    /// @param defines: Pairs of a macro name and its replacement text.
+    ShaderDefines(std::initializer_list<std::pair<std::string, std::string>> defines);
+
+    /// ## ShaderDefines::set
+    ///
+    /// Adds a definition or replaces the value of an existing one.
+    ///
+    /// @param name: The macro name.
+    /// @param value: The replacement text, or an empty string to define the macro without a value.
+    ///
+    /// @returns Reference to this object.
+    ShaderDefines &set(std::string_view name, std::string_view value = "");
+
+    /// ## ShaderDefines::set
+    ///
+    /// Adds an integer definition or replaces the value of an existing one.
+    ///
+    /// @param name: The macro name.
+    /// @param value: The integer value of the macro.
+    ///
+    /// @returns Reference to this object.
+    ShaderDefines &set(std::string_view name, int value);
+
+    /// ## ShaderDefines::empty
+    ///
+    /// @returns `true` if there is no definition.
+    [[nodiscard]]
+    bool empty() const {
+        return defines_.empty();
+    }
+
+    /// ## ShaderDefines::get_all
+    ///
+    /// @returns Pairs of a macro name and its replacement text, sorted by name.
+    [[nodiscard]]
+    const std::vector<std::pair<std::string, std::string>> &get_all() const {
+        return defines_;
+    }
+
+    /// ## ShaderDefines::get_key
+    ///
+    /// @returns The permutation key, e.g. `KERNEL_SIZE=32;USE_SSAO`.
+    [[nodiscard]]
+    std::string get_key() const;
+
+    /// ## ShaderDefines::to_source
+    ///
+    /// @returns The `#define` directives of all definitions, one per line.
+    [[nodiscard]]
+    std::string to_source() const;
+};
+
 /// # Shader
 ///
 /// A class that encapsulates an OpenGL shader.
+///
+/// Shader source files are preprocessed before compilation:
+///
+/// - `#include "path"` is replaced by the content of the file at `path`, relative to the including file. Each file is
+///   included at most once per shader. `#line` directives are emitted so that compile errors refer to the original
+///   line numbers; source string `0` is the main file and included files are numbered in the order they are included.
+/// - `ShaderDefines` are injected right after the `#version` directive. Definitions whose names do not occur in the
+///   source code are left out, so a stage unaffected by a permutation is compiled once for all of its variants.
+///
+/// Shaders created with `Shader::create_shared` are cached in-process by their preprocessed source code, so every
+/// program that uses the same (source, defines) variant shares a single compiled shader.
 class Shader {
     const uint32_t shader_;
+    const std::string name_;
 
 public:
     /// ## Shader::create_from_file
@@ -18,9 +109,61 @@ public:
     ///
     /// @param filename: The path to the shader file.
     /// @param shader_type: The type of the shader (e.g., `GL_VERTEX_SHADER`, `GL_FRAGMENT_SHADER`).
+    /// @param defines: The preprocessor definitions to inject into the source code.
     ///
     /// @returns `Shader` object wrapped in `std::unique_ptr` if successful, or `nullptr` if creation fails.
-    static std::unique_ptr<Shader> create_from_file(const std::string &filename, GLenum shader_type);
+    static std::unique_ptr<Shader>
+    create_from_file(const std::string &filename, GLenum shader_type, const ShaderDefines &defines = {});
+
+    /// ## Shader::create_from_source
+    ///
+    /// Creates a new `Shader` object from source code.
+    ///
+    /// @param source: The source code of the shader.
+    /// @param shader_type: The type of the shader (e.g., `GL_VERTEX_SHADER`, `GL_FRAGMENT_SHADER`).
+    /// @param name: The name of the shader used in log messages, usually the path of the source file.
+    ///
+    /// @returns `Shader` object wrapped in `std::unique_ptr` if successful, or `nullptr` if creation fails.
+    static std::unique_ptr<Shader>
+    create_from_source(const std::string &source, GLenum shader_type, const std::string &name = "<source>");
+
+    /// ## Shader::create_pending
+    ///
+    /// Creates a new `Shader` object and submits its source code to the driver without waiting for the compilation.
+    /// The result is checked later with `Shader::is_compiled`, typically after the shader has been linked into a
+    /// program, so that the driver can compile several shaders in parallel.
+    ///
+    /// @param source: The source code of the shader.
+    /// @param shader_type: The type of the shader (e.g., `GL_VERTEX_SHADER`, `GL_FRAGMENT_SHADER`).
+    /// @param name: The name of the shader used in log messages, usually the path of the source file.
+    ///
+    /// @returns `Shader` object wrapped in `std::unique_ptr`, or `nullptr` if the shader object cannot be created.
+    static std::unique_ptr<Shader>
+    create_pending(const std::string &source, GLenum shader_type, const std::string &name = "<source>");
+
+    /// ## Shader::create_shared
+    ///
+    /// Returns the cached shader compiled from the same source code and type if it is still alive, or creates a new
+    /// one with `Shader::create_pending` and caches it. The cache does not own the shaders; a shader is removed from
+    /// it once no program uses it anymore.
+    ///
+    /// @param source: The preprocessed source code of the shader.
+    /// @param shader_type: The type of the shader (e.g., `GL_VERTEX_SHADER`, `GL_FRAGMENT_SHADER`).
+    /// @param name: The name of the shader used in log messages, usually the path of the source file.
+    ///
+    /// @returns `Shader` object wrapped in `std::shared_ptr`, or `nullptr` if the shader object cannot be created.
+    static std::shared_ptr<Shader>
+    create_shared(const std::string &source, GLenum shader_type, const std::string &name = "<source>");
+
+    /// ## Shader::load_source
+    ///
+    /// Loads a shader source file, resolves its `#include` directives and injects the definitions.
+    ///
+    /// @param filename: The path to the shader file.
+    /// @param defines: The preprocessor definitions to inject into the source code.
+    ///
+    /// @returns The preprocessed source code, or `std::nullopt` if the file or one of its includes cannot be loaded.
+    static std::optional<std::string> load_source(const std::string &filename, const ShaderDefines &defines = {});
 
     /// ## Shader::~Shader
     ///
@@ -35,17 +178,32 @@ public:
         return shader_;
     }
 
-private:
-    explicit Shader(uint32_t shader);
+    /// ## Shader::get_name
+    ///
+    /// @returns The name of the shader used in log messages.
+    [[nodiscard]]
+    const std::string &get_name() const {
+        return name_;
+    }
 
-    /// ## Shader::load_file
+    /// ## Shader::is_compiled
     ///
-    /// Loads and compiles a shader from a file.
+    /// Checks the compile status of the shader and logs the info log if the compilation failed. This waits for the
+    /// driver to finish compiling the shader.
     ///
-    /// @param filename: The path to the shader file.
+    /// @returns `true` if the shader is successfully compiled, `false` otherwise.
+    [[nodiscard]]
+    bool is_compiled() const;
+
+private:
+    Shader(uint32_t shader, std::string name);
+
+    /// ## Shader::submit
+    ///
+    /// Sets the source code of the shader and starts compiling it.
     ///
-    /// @returns `true` if the shader is successfully loaded and compiled, `false` otherwise.
-    bool load_file(const std::string &filename) const;
+    /// @param source: The source code of the shader.
+    void submit(const std::string &source) const;
 };
 
 #endif // __SHADER_H__
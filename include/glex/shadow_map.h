@@ -4,6 +4,8 @@
 
 #include <cstdint>
 #include <memory>
+#include "glex/common.h"
+#include "glex/mesh.h"
 #include "glex/texture.h"
 
 class ShadowMap {
@@ -27,6 +29,17 @@ public:
         return shadow_map_;
     }
 
+    /// ## ShadowMap::get_light_transform
+    ///
+    /// Computes the view-projection matrix of a directional light whose orthographic volume just encloses a sphere, so
+    /// every object inside the sphere is rendered to the shadow map.
+    ///
+    /// @param direction: The direction the light travels in.
+    /// @param bounds: A world-space sphere enclosing the scene, e.g., around the box of `SceneBVH::get_bounds`.
+    ///
+    /// @returns The matrix transforming world space to the light's clip space.
+    static glm::mat4 get_light_transform(const glm::vec3 &direction, const BoundingSphere &bounds);
+
 private:
     ShadowMap(const uint32_t framebuffer_id, const std::shared_ptr<Texture> shadow_map);
 };
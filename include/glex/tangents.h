@@ -0,0 +1,42 @@
+#ifndef __TANGENTS_H__
+#define __TANGENTS_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "glex/mesh.h"
+#include "glex/thread_pool.h"
+
+/// # TangentOptions
+///
+/// Options of `generate_tangents`.
+struct TangentOptions {
+    /// The pool to process the triangles on, or `nullptr` to use `ThreadPool::get_default`.
+    ThreadPool *pool{nullptr};
+    /// The maximum number of threads working at once, including the calling thread, or `0` for one per worker of the
+    /// pool and the calling thread. `1` runs everything on the calling thread.
+    size_t max_threads{0};
+};
+
+/// ## generate_tangents
+///
+/// Computes the tangent vector of every vertex of a triangle list from the positions and texture coordinates.
+///
+/// Each triangle adds its tangent to its three vertices. The sums are then orthogonalized against the normals and
+/// normalized. Vertices without a valid sum, e.g., with no texture coordinates, get an arbitrary unit vector
+/// perpendicular to the normal.
+///
+/// Large meshes are split into chunks of triangles, accumulated on the threads of the pool into one array per
+/// thread and summed per vertex afterward, so no two threads write the same memory. The triangles and the vertices
+/// are processed four at a time with SSE2 if available. Must not be called from a task of the same pool.
+///
+/// @param vertices: The vertices, whose tangents are overwritten.
+/// @param indices: The indices of the triangle list. Trailing indices of an incomplete triangle are ignored.
+/// @param options: The threads to use.
+void generate_tangents(
+        std::span<Vertex> vertices, std::span<const uint32_t> indices, const TangentOptions &options = {}
+);
+
+
+#endif // __TANGENTS_H__
@@ -6,9 +6,27 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
 #include "glex/common.h"
 #include "glex/image.h"
+#include "glex/sampler.h"
+
+/// # TextureOptions
+///
+/// Storage and sampling options of `Texture` and `CubeTexture`.
+struct TextureOptions {
+    /// Whether to allocate immutable storage with `glTexStorage2D`, so that the driver does not have to revalidate the
+    /// completeness of the texture. Mutable storage is allocated instead if the context supports neither OpenGL 4.2
+    /// nor `GL_ARB_texture_storage`.
+    bool immutable{false};
+    /// The exact number of mip levels to allocate, or `0` for the full chain down to 1x1 for textures created from
+    /// images and a single level for empty textures.
+    uint32_t mip_levels{0};
+    /// The sampler bound together with the texture by `bind_to_unit`, or `nullptr` to use the parameters of the
+    /// texture.
+    std::shared_ptr<Sampler> sampler{};
+};
 
 /// # Texture
 ///
@@ -47,12 +65,18 @@
 /// glDeleteTextures(1, &texture_);
 /// ```
 class Texture {
+    friend class TextureUploader;
+
     const uint32_t texture_;
 
     const size_t width_, height_;
     const uint32_t format_;
     const uint32_t type_;
 
+    /// Texture bound in place of this one until its pixels are uploaded by `TextureUploader`.
+    std::shared_ptr<Texture> placeholder_;
+    std::shared_ptr<Sampler> sampler_;
+
 public:
     /// ## Texture::create
     ///
@@ -61,18 +85,34 @@ public:
     /// and `GL_CLAMP_TO_EDGE` wrap modes as default.
     ///
     /// @param image: The `Image` object containing the texture data.
+    /// @param options: The storage and sampling options.
     ///
     /// @returns `Texture` object wrapped in `std::unique_ptr` if successful, or `nullptr` if initialization fails.
-    static std::unique_ptr<Texture> create(const Image &image);
+    static std::unique_ptr<Texture> create(const Image &image, const TextureOptions &options = {});
 
     /// ## Texture::create
     ///
     /// Creates and initializes a new **empty** `Texture` object.
     /// This Texture object has `GL_LINEAR` min and mag filters, and `GL_CLAMP_TO_EDGE` wrap modes as default.
     ///
+    /// @param options: The storage and sampling options.
+    ///
     /// @returns `Texture` object wrapped in `std::unique_ptr` if successful, or `nullptr` if initialization fails.
-    static std::unique_ptr<Texture>
-    create(size_t width, size_t height, uint32_t format, uint32_t type = GL_UNSIGNED_BYTE);
+    static std::unique_ptr<Texture> create(
+            size_t width, size_t height, uint32_t format, uint32_t type = GL_UNSIGNED_BYTE,
+            const TextureOptions &options = {}
+    );
+
+    /// ## Texture::create_storage
+    ///
+    /// Creates a new `Texture` object with the size and format of the **given image**, without its pixels.
+    /// This Texture object has the same filter and wrap modes as one created by `Texture::create(const Image &)`.
+    ///
+    /// @param image: The `Image` object whose size and format are used.
+    /// @param options: The storage and sampling options.
+    ///
+    /// @returns `Texture` object wrapped in `std::unique_ptr` if successful, or `nullptr` if initialization fails.
+    static std::unique_ptr<Texture> create_storage(const Image &image, const TextureOptions &options = {});
 
     /// ## Texture::~Texture
     ///
@@ -119,15 +159,48 @@ public:
         return type_;
     }
 
+    /// ## Texture::get_pixel_format
+    ///
+    /// @returns format of the pixel data passed to `glTexImage2D` and `glTexSubImage2D` (e.g., `GL_RGB`).
+    [[nodiscard]]
+    uint32_t get_pixel_format() const;
+
+    /// ## Texture::get_sampler
+    ///
+    /// @returns The sampler bound together with the texture, or `nullptr` if the parameters of the texture are used.
+    [[nodiscard]]
+    const std::shared_ptr<Sampler> &get_sampler() const {
+        return sampler_;
+    }
+
+    /// ## Texture::set_sampler
+    ///
+    /// Sets the sampler bound together with the texture by `bind_to_unit`.
+    ///
+    /// @param sampler: The sampler, or `nullptr` to use the parameters of the texture.
+    void set_sampler(std::shared_ptr<Sampler> sampler) {
+        sampler_ = std::move(sampler);
+    }
+
+    /// ## Texture::is_resident
+    ///
+    /// @returns `false` while `TextureUploader` is still uploading the pixels of the texture, `true` otherwise.
+    [[nodiscard]]
+    bool is_resident() const {
+        return !placeholder_;
+    }
+
     /// ## Texture::bind
     ///
-    /// Binds the OpenGL texture.
+    /// Binds the OpenGL texture. While the texture is not resident, its placeholder is bound instead.
     void bind() const;
 
     /// ## Texture::bind_to_unit
     ///
     /// Assigns a texture to a texture unit. After this, the texture can be bound to a uniform variable by passing the
     /// unit ID as the second argument of `Program::set_uniform(std::string&, int)`.
+    /// The sampler of the texture is bound to the unit as well, or the unit is left without a sampler if the texture
+    /// has none. The active texture unit is unspecified afterwards, see `GLStateCache::bind_texture_to_unit`.
     ///
     /// @param texture_unit: The texture unit ID to assign the texture to. It must be betwwen 0 and 31 because OpenGL
     /// provides only 32 texture units.
@@ -135,7 +208,8 @@ public:
 
     /// ## Texture::set_filter
     ///
-    /// Sets the texture filtering parameters.
+    /// Binds the texture to the active texture unit and sets its filtering parameters. They are overridden by the
+    /// sampler of the texture when it is bound with `bind_to_unit`.
     ///
     /// @param min_filter: The minifying function used whenever the pixel being textured maps to an area
     ///                    greater than one texture element.
@@ -165,12 +239,17 @@ class CubeTexture {
     const uint32_t format_;
     const uint32_t type_;
 
+    std::shared_ptr<Sampler> sampler_;
+
 public:
-    static std::unique_ptr<CubeTexture>
-    create_from_images(const std::vector<std::reference_wrapper<const Image>> &images);
+    static std::unique_ptr<CubeTexture> create_from_images(
+            const std::vector<std::reference_wrapper<const Image>> &images, const TextureOptions &options = {}
+    );
 
-    static std::unique_ptr<CubeTexture>
-    create(size_t width, size_t height, uint32_t format, uint32_t type = GL_UNSIGNED_BYTE);
+    static std::unique_ptr<CubeTexture> create(
+            size_t width, size_t height, uint32_t format, uint32_t type = GL_UNSIGNED_BYTE,
+            const TextureOptions &options = {}
+    );
 
     ~CubeTexture();
 
@@ -199,8 +278,19 @@ public:
         return type_;
     }
 
+    [[nodiscard]]
+    const std::shared_ptr<Sampler> &get_sampler() const {
+        return sampler_;
+    }
+
+    void set_sampler(std::shared_ptr<Sampler> sampler) {
+        sampler_ = std::move(sampler);
+    }
+
     void bind() const;
 
+    void bind_to_unit(uint32_t texture_unit) const;
+
     void generate_mipmap() const;
 
 private:
@@ -0,0 +1,157 @@
+#ifndef __TEXTURE_UPLOADER_H__
+#define __TEXTURE_UPLOADER_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include "glex/buffer.h"
+#include "glex/common.h"
+#include "glex/image.h"
+#include "glex/texture.h"
+
+/// # TextureUploader
+///
+/// Streams images into textures over several frames through a ring buffer of pixel buffer objects, instead of copying
+/// them from client memory with `glTexImage2D`.
+///
+/// `TextureUploader::upload` returns a texture immediately. Until its pixels have arrived, binding it binds a small
+/// placeholder texture. Every frame, `TextureUploader::update` copies at most the per-frame budget of rows into free
+/// space of the ring and issues `glTexSubImage2D` from there, followed by a fence. When the fence of the last rows of a
+/// texture signals, its mipmaps are ready and the texture becomes resident.
+///
+/// The ring is mapped with `GL_MAP_UNSYNCHRONIZED_BIT`, and a region is reused only after the fence of the copy that
+/// read it has signaled, so neither mapping nor copying waits for the GPU.
+///
+/// ## Examples
+///
+/// ```cpp
+/// auto uploader = TextureUploader::create();
+/// auto texture = uploader->upload(Image::load("./image/container.jpg"));
+/// // `texture` can be bound right away; it shows the placeholder until it is resident.
+///
+/// // Once per frame:
+/// uploader->update();
+/// ```
+class TextureUploader {
+public:
+    /// Upload progress of a `TextureUploader`.
+    struct Stats {
+        /// Textures that are waiting for their pixels or their fences.
+        size_t pending_textures{0};
+        /// Bytes copied into the ring during the last `TextureUploader::update`.
+        size_t bytes_last_frame{0};
+        /// Bytes copied into the ring since the uploader was created.
+        size_t bytes_total{0};
+        /// Textures that have become resident since the uploader was created.
+        size_t resident_textures{0};
+    };
+
+private:
+    /// An image whose rows are not yet all copied into the ring.
+    struct Job {
+        std::weak_ptr<Texture> texture;
+        std::unique_ptr<Image> image;
+        size_t next_row{0};
+    };
+
+    /// A region of the ring read by a `glTexSubImage2D` that may still be running.
+    struct Fence {
+        GLsync sync;
+        size_t offset;
+        size_t size;
+        /// The texture that becomes resident when this fence signals, if these were its last rows.
+        std::weak_ptr<Texture> completed;
+    };
+
+    std::unique_ptr<Buffer> ring_;
+    const size_t ring_size_;
+    const size_t budget_per_frame_;
+    size_t ring_head_{0};
+
+    std::shared_ptr<Texture> placeholder_;
+    std::deque<Job> jobs_;
+    std::deque<Fence> fences_;
+    Stats stats_;
+
+public:
+    /// Default size of the ring buffer in bytes.
+    static constexpr size_t DEFAULT_RING_SIZE{32 * 1024 * 1024};
+    /// Default number of bytes copied into the ring per frame.
+    static constexpr size_t DEFAULT_BUDGET_PER_FRAME{4 * 1024 * 1024};
+
+    /// ## TextureUploader::create
+    ///
+    /// Creates a new uploader with its ring buffer and placeholder texture.
+    ///
+    /// @param ring_size: The size of the ring buffer in bytes. A single row of an image must fit in it.
+    /// @param budget_per_frame: The maximum number of bytes copied into the ring per `TextureUploader::update`. At
+    ///                          least one row is copied per frame even if it exceeds the budget.
+    ///
+    /// @returns `TextureUploader` object wrapped in `std::unique_ptr`, or `nullptr` if creation fails.
+    static std::unique_ptr<TextureUploader>
+    create(size_t ring_size = DEFAULT_RING_SIZE, size_t budget_per_frame = DEFAULT_BUDGET_PER_FRAME);
+
+    /// ## TextureUploader::~TextureUploader
+    ///
+    /// Destructor that deletes the remaining fences. Textures that are still pending keep showing the placeholder.
+    ~TextureUploader();
+
+    TextureUploader(const TextureUploader &) = delete;
+    TextureUploader &operator=(const TextureUploader &) = delete;
+
+    /// ## TextureUploader::upload
+    ///
+    /// Allocates a texture for the image and queues its pixels for upload.
+    ///
+    /// @param image: The image to upload. The uploader keeps it until all its rows are copied into the ring.
+    /// @param options: The storage and sampling options of the texture.
+    ///
+    /// @returns Shared pointer to the `Texture` object, which is valid immediately and shows the placeholder until it
+    /// becomes resident, or `nullptr` if the image is `nullptr` or empty, or the texture cannot be created.
+    ///
+    /// #### Details
+    /// The texture has `GL_LINEAR_MIPMAP_LINEAR` min filter, `GL_LINEAR` mag filter and `GL_CLAMP_TO_EDGE` wrap modes
+    /// like `Texture::create(const Image &)`. If the texture is released before it becomes resident, the rest of its
+    /// upload is skipped.
+    std::shared_ptr<Texture> upload(std::unique_ptr<Image> image, const TextureOptions &options = {});
+
+    /// ## TextureUploader::update
+    ///
+    /// Makes the textures whose fences have signaled resident, and copies the next rows of the queued images into the
+    /// ring within the per-frame budget. It must be called once per frame on the thread of the OpenGL context.
+    void update();
+
+    /// ## TextureUploader::get_stats
+    ///
+    /// @returns The upload progress.
+    [[nodiscard]]
+    const Stats &get_stats() const {
+        return stats_;
+    }
+
+private:
+    TextureUploader(
+            std::unique_ptr<Buffer> ring, size_t ring_size, size_t budget_per_frame,
+            std::shared_ptr<Texture> placeholder
+    );
+
+    /// ## TextureUploader::retire_fences
+    ///
+    /// Releases the ring regions of the signaled fences, oldest first, without waiting.
+    void retire_fences();
+
+    /// ## TextureUploader::allocate
+    ///
+    /// Finds free contiguous space in the ring.
+    ///
+    /// @param size: The number of bytes to allocate.
+    ///
+    /// @returns The offset of the space in the ring, or `std::nullopt` if the ring has no free space of that size.
+    std::optional<size_t> allocate(size_t size);
+};
+
+
+#endif // __TEXTURE_UPLOADER_H__
@@ -0,0 +1,102 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// # ThreadPool
+///
+/// A fixed number of worker threads that run submitted tasks in FIFO order.
+///
+/// Tasks must not call OpenGL functions, because the OpenGL context is current only on the main thread. CPU-side work
+/// such as decoding images or processing meshes runs on the pool, and the results are handed back to the main thread
+/// through the returned futures.
+///
+/// ## Examples
+///
+/// ```cpp
+/// auto &pool = ThreadPool::get_default();
+/// auto future = pool.submit([] { return Image::load("./image/container.jpg"); });
+/// // ...do something else
+/// auto image = future.get();
+/// ```
+class ThreadPool {
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stopping_{false};
+
+public:
+    /// ## ThreadPool::create
+    ///
+    /// Creates a new thread pool and starts its worker threads.
+    ///
+    /// @param thread_count: The number of worker threads, or `0` to use the number of hardware threads.
+    ///
+    /// @returns `ThreadPool` object wrapped in `std::unique_ptr`.
+    static std::unique_ptr<ThreadPool> create(size_t thread_count = 0);
+
+    /// ## ThreadPool::get_default
+    ///
+    /// @returns The process-wide thread pool with one worker per hardware thread, created on first use.
+    static ThreadPool &get_default();
+
+    /// ## ThreadPool::~ThreadPool
+    ///
+    /// Destructor that runs the remaining tasks and joins the worker threads.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// ## ThreadPool::get_thread_count
+    ///
+    /// @returns The number of worker threads.
+    [[nodiscard]]
+    size_t get_thread_count() const {
+        return workers_.size();
+    }
+
+    /// ## ThreadPool::submit
+    ///
+    /// Queues a task to run on one of the worker threads.
+    ///
+    /// @param task: The callable to run. Its return value or exception is delivered through the future.
+    ///
+    /// @returns `std::future` of the result of the task.
+    template<typename F>
+    auto submit(F &&task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        // `std::function` requires a copyable callable, so the packaged task is shared.
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        auto future = packaged->get_future();
+        {
+            std::lock_guard lock{mutex_};
+            tasks_.emplace_back([packaged] { (*packaged)(); });
+        }
+        condition_.notify_one();
+        return future;
+    }
+
+private:
+    explicit ThreadPool(size_t thread_count);
+
+    /// ## ThreadPool::run_worker
+    ///
+    /// Main loop of a worker thread that runs queued tasks until the pool is destroyed.
+    void run_worker();
+};
+
+
+#endif // __THREAD_POOL_H__
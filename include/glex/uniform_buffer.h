@@ -0,0 +1,216 @@
+#ifndef __UNIFORM_BUFFER_H__
+#define __UNIFORM_BUFFER_H__
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "glex/buffer.h"
+#include "glex/common.h"
+
+/// # Std140Layout
+///
+/// A helper that computes member offsets of a uniform block following the `std140` layout rules.
+///
+/// ## Examples
+///
+/// ```cpp
+/// // struct Light { vec3 position; vec3 color; };
+/// Std140Layout light;
+/// const auto position_offset = light.add<glm::vec3>();
+/// const auto color_offset = light.add<glm::vec3>();
+///
+/// // layout (std140) uniform Lights { int lightCount; Light lights[MAX_LIGHTS]; };
+/// Std140Layout block;
+/// const auto count_offset = block.add<int>();
+/// const auto lights_offset = block.add_struct(light, MAX_LIGHTS);
+/// ```
+class Std140Layout {
+    size_t size_{0};
+
+public:
+    /// ## Std140Layout::add
+    ///
+    /// Appends a member of a basic type (`int`, `float`, `glm::vec2`, `glm::vec3`, `glm::vec4` or `glm::mat4`).
+    ///
+    /// @param array_size: The number of array elements, or `0` if the member is not an array.
+    ///
+    /// @returns The byte offset of the member in the block.
+    template<typename T>
+    size_t add(size_t array_size = 0) {
+        if (array_size > 0) {
+            // Each array element is aligned to the size of `vec4`.
+            return append(16, round_up(base_size<T>(), 16) * array_size);
+        }
+        return append(base_alignment<T>(), base_size<T>());
+    }
+
+    /// ## Std140Layout::add_struct
+    ///
+    /// Appends a member of a structure type whose members are described by another `Std140Layout`.
+    ///
+    /// @param layout: The layout of the structure members.
+    /// @param array_size: The number of array elements, or `0` if the member is not an array.
+    ///
+    /// @returns The byte offset of the member in the block.
+    size_t add_struct(const Std140Layout &layout, const size_t array_size = 0) {
+        return append(16, layout.get_stride() * std::max<size_t>(array_size, 1));
+    }
+
+    /// ## Std140Layout::get_size
+    ///
+    /// @returns The number of bytes used by the members added so far.
+    [[nodiscard]]
+    size_t get_size() const {
+        return size_;
+    }
+
+    /// ## Std140Layout::get_stride
+    ///
+    /// @returns The size of the layout rounded up to the alignment of `vec4`, i.e. the array stride of a structure
+    /// described by this layout.
+    [[nodiscard]]
+    size_t get_stride() const {
+        return round_up(size_, 16);
+    }
+
+private:
+    static constexpr size_t round_up(const size_t value, const size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    size_t append(const size_t alignment, const size_t size) {
+        const auto offset = round_up(size_, alignment);
+        size_ = offset + size;
+        return offset;
+    }
+
+    template<typename T>
+    static constexpr size_t base_size() {
+        return sizeof(T);
+    }
+
+    template<typename T>
+    static constexpr size_t base_alignment() {
+        if constexpr (sizeof(T) <= 4) {
+            return 4;
+        } else if constexpr (sizeof(T) <= 8) {
+            return 8;
+        } else {
+            // `vec3`, `vec4` and matrices are aligned to 16 bytes.
+            return 16;
+        }
+    }
+};
+
+/// # UniformBuffer
+///
+/// A class that encapsulates an OpenGL uniform buffer object bound to its own uniform block binding point.
+///
+/// Values are written into a CPU-side copy of the block with `UniformBuffer::set`, and the whole block is uploaded at
+/// once with `UniformBuffer::upload`. Programs refer to the block through `Program::bind_uniform_block` with the
+/// binding point returned by `UniformBuffer::get_binding`, so data uploaded once is shared by all of them.
+///
+/// ## Examples
+///
+/// ```cpp
+/// auto camera = UniformBuffer::create(layout.get_size());
+/// program->bind_uniform_block("Camera", camera->get_binding());
+/// // Every frame:
+/// camera->set(view_offset, view);
+/// camera->set(projection_offset, projection);
+/// camera->upload();
+/// ```
+class UniformBuffer {
+    const std::unique_ptr<Buffer> buffer_;
+    const uint32_t binding_;
+    std::vector<uint8_t> data_;
+
+public:
+    /// ## UniformBuffer::create
+    ///
+    /// Creates a uniform buffer and reserves an unused uniform block binding point for it.
+    ///
+    /// @param size: The size of the uniform block in bytes.
+    /// @param usage: Usage pattern of the data store.
+    ///
+    /// @returns `UniformBuffer` object wrapped in `std::unique_ptr` if successful, or `nullptr` if there is no free
+    /// binding point or the buffer cannot be created.
+    static std::unique_ptr<UniformBuffer> create(size_t size, uint32_t usage = GL_DYNAMIC_DRAW);
+
+    /// ## UniformBuffer::~UniformBuffer
+    ///
+    /// Destructor that releases the binding point of the buffer.
+    ~UniformBuffer();
+
+    /// ## UniformBuffer::get_binding
+    ///
+    /// @returns The uniform block binding point of the buffer.
+    [[nodiscard]]
+    uint32_t get_binding() const {
+        return binding_;
+    }
+
+    /// ## UniformBuffer::get_size
+    ///
+    /// @returns The size of the uniform block in bytes.
+    [[nodiscard]]
+    size_t get_size() const {
+        return data_.size();
+    }
+
+    /// ## UniformBuffer::set
+    ///
+    /// Writes a value into the CPU-side copy of the block. The value is sent to the GPU by the next
+    /// `UniformBuffer::upload` call.
+    ///
+    /// @param offset: The byte offset of the member, as returned by `Std140Layout`.
+    /// @param value: The value to write.
+    template<typename T>
+    void set(const size_t offset, const T &value) {
+        std::memcpy(data_.data() + offset, &value, sizeof(T));
+    }
+
+    /// ## UniformBuffer::upload
+    ///
+    /// Uploads the whole block to the GPU and binds the buffer to its binding point.
+    void upload() const {
+        upload(data_.size());
+    }
+
+    /// ## UniformBuffer::upload
+    ///
+    /// Uploads the start of the block to the GPU and binds the buffer to its binding point. The rest of the block
+    /// keeps the data of previous uploads, e.g., the unused slots of an array.
+    ///
+    /// @param size: The number of bytes to upload from the start of the block, at most `UniformBuffer::get_size`.
+    void upload(size_t size) const;
+
+    /// ## UniformBuffer::bind
+    ///
+    /// Binds the buffer to its uniform block binding point.
+    void bind() const;
+
+    /// ## UniformBuffer::acquire_binding
+    ///
+    /// Reserves an unused uniform block binding point, for buffers bound other than through `UniformBuffer`, e.g., by
+    /// range.
+    ///
+    /// @returns The binding point, or `std::nullopt` if every binding point is in use.
+    static std::optional<uint32_t> acquire_binding();
+
+    /// ## UniformBuffer::release_binding
+    ///
+    /// Returns a binding point reserved by `UniformBuffer::acquire_binding`.
+    static void release_binding(uint32_t binding);
+
+private:
+    UniformBuffer(std::unique_ptr<Buffer> &&buffer, uint32_t binding, size_t size);
+};
+
+
+#endif // __UNIFORM_BUFFER_H__
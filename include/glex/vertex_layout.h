@@ -58,6 +58,14 @@ public:
     /// @param attrib_index: The index of the vertex attribute to disable.
     void disable_attrib(int attrib_index) const;
 
+    /// ## VertexLayout::set_attrib_divisor
+    ///
+    /// Sets how often the vertex attribute advances during instanced rendering.
+    ///
+    /// @param attrib_index: The index of the vertex attribute.
+    /// @param divisor: The number of instances drawn before the attribute advances, or `0` to advance per vertex.
+    void set_attrib_divisor(uint32_t attrib_index, uint32_t divisor) const;
+
 private:
     explicit VertexLayout(uint32_t vertex_array_object);
 };
@@ -4,7 +4,8 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTex;
 
-uniform mat4 transform;
+#include "include/camera.glsl"
+
 uniform mat4 modelTransform;
 
 out vec3 position;
@@ -12,8 +13,8 @@ out vec3 normal;
 out vec2 texCoord;
 
 void main() {
-    gl_Position = (transform * vec4(aPos, 1.0));
     position = (modelTransform * vec4(aPos, 1.0)).xyz;
+    gl_Position = projection * view * vec4(position, 1.0);
     normal = (transpose(inverse(modelTransform)) * vec4(aNormal, 0.0)).xyz;
     texCoord = aTex;
 }
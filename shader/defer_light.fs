@@ -1,7 +1,5 @@
 #version 330 core
 
-const int NR_LIGHTS = 32;
-
 in vec2 texCoord;
 
 uniform sampler2D gPosition;
@@ -9,13 +7,10 @@ uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
 
 uniform sampler2D ssao;
-uniform int useSsao;
 
-uniform vec3 viewPos;
-uniform struct {
-    vec3 position;
-    vec3 color;
-} lights[NR_LIGHTS];
+#include "include/camera.glsl"
+
+#include "include/lights.glsl"
 
 out vec4 fragColor;
 
@@ -27,14 +22,14 @@ void main() {
     float spec = albedoSpec.a;
 
     vec3 ambient = albedo * 0.4;
-    if (useSsao == 1) {
-        ambient *= texture2D(ssao, texCoord).r;
-    }
+#ifdef USE_SSAO
+    ambient *= texture2D(ssao, texCoord).r;
+#endif
 
     vec3 lighting = ambient;
 
     vec3 viewDir = normalize(viewPos - fragPos);
-    for (int i = 0; i < NR_LIGHTS; ++i) {
+    for (int i = 0; i < min(lightCount, MAX_LIGHTS); ++i) {
         // diffuse
         vec3 lightDir = normalize(lights[i].position - fragPos);
         vec3 diffuse = max(0.0, dot(lightDir, normal)) * albedo * lights[i].color;
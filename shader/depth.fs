@@ -0,0 +1,5 @@
+#version 330 core
+
+// Depth-only pass. The depth is written by the fixed function, so there is nothing to output.
+void main() {
+}
@@ -0,0 +1,45 @@
+#version 330 core
+
+// Reads only the position, so that meshes with split positions fetch nothing else.
+#ifdef QUANTIZED
+layout (location = 0) in vec3 aPackedPos;
+#else
+layout (location = 0) in vec3 aPos;
+#endif
+
+// The camera of a depth prepass, or the light of a shadow map.
+#include "include/camera.glsl"
+
+#ifdef DRAW_INDIRECT
+// Index of the draw in `IndirectDrawList`, which selects its `DrawData` from the buffer texture.
+layout (location = 9) in float aDrawId;
+uniform samplerBuffer drawData;
+#else
+uniform mat4 modelTransform;
+#ifdef QUANTIZED
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+#endif
+#endif
+
+// A depth prepass must compute the same depth as the color pass for its `GL_LEQUAL` test to pass.
+invariant gl_Position;
+
+void main() {
+#ifdef DRAW_INDIRECT
+    int texel = int(aDrawId) * 6;
+    mat4 modelTransform = mat4(
+        texelFetch(drawData, texel),
+        texelFetch(drawData, texel + 1),
+        texelFetch(drawData, texel + 2),
+        texelFetch(drawData, texel + 3)
+    );
+    vec3 positionScale = texelFetch(drawData, texel + 4).xyz;
+    vec3 positionOffset = texelFetch(drawData, texel + 5).xyz;
+#endif
+#ifdef QUANTIZED
+    vec3 aPos = aPackedPos * positionScale + positionOffset;
+#endif
+    vec3 fragPos = (modelTransform * vec4(aPos, 1.0)).xyz;
+    gl_Position = projection * view * vec4(fragPos, 1.0);
+}
@@ -0,0 +1,6 @@
+// Camera data shared by all programs through `Context::upload_camera_block`.
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
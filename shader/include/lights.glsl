@@ -0,0 +1,14 @@
+// Point lights shared by all programs through `Context::upload_lights_block`.
+// Define MAX_LIGHTS to compile a variant sized for a known number of lights.
+#ifndef MAX_LIGHTS
+#define MAX_LIGHTS 256
+#endif
+
+struct Light {
+    vec3 position;
+    vec3 color;
+};
+layout (std140) uniform Lights {
+    int lightCount;
+    Light lights[MAX_LIGHTS];
+};
@@ -0,0 +1,36 @@
+// Cook-Torrance BRDF terms shared by the PBR shaders.
+
+const float PI = 3.14159265359;
+
+float distributionGGX(vec3 normal, vec3 halfDir, float roughness) {
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float dotNH = max(0.0, dot(normal, halfDir));
+    float dotNH2 = dotNH * dotNH;
+    float denom = dotNH2 * (a2 - 1.0) + 1.0;
+    return a2 / (PI * denom * denom);
+}
+
+float geometrySchlickGGX(float dotNV, float roughness) {
+    float r = roughness + 1.0;
+    float k = r * r / 8.0;
+    float nom = dotNV;
+    float denom = dotNV * (1.0 - k) + k;
+    return nom / denom;
+}
+
+float geometrySmith(vec3 normal, vec3 viewDir, vec3 lightDir, float roughness) {
+    float dotNV = max(0.0, dot(normal, viewDir));
+    float dotNL = max(0.0, dot(normal, lightDir));
+    float ggx2 = geometrySchlickGGX(dotNV, roughness);
+    float ggx1 = geometrySchlickGGX(dotNL, roughness);
+    return ggx1 * ggx2;
+}
+
+vec3 fresnelSchlick(float cosTheta, vec3 F0) {
+    return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
+}
+
+vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness) {
+    return F0 + (max(F0, vec3(1.0 - roughness)) - F0) * pow(1.0 - cosTheta, 5.0);
+}
@@ -0,0 +1,13 @@
+// Decoding of the attributes of `PackedVertex`, for shaders compiled with the QUANTIZED define.
+// Positions are dequantized as `position * positionScale + positionOffset` with the bounding box of the mesh.
+
+// Decodes a unit vector from its octahedral encoding.
+vec3 decodeOctahedral(vec2 encoded) {
+    vec3 v = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    // Unfold the lower hemisphere from the corners of the square.
+    if (v.z < 0.0) {
+        vec2 signs = vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+        v.xy = (1.0 - abs(v.yx)) * signs;
+    }
+    return normalize(v);
+}
@@ -0,0 +1,32 @@
+#version 330 core
+
+in vec3 fragPos;
+in vec3 normal;
+in vec2 texCoord;
+
+#include "include/camera.glsl"
+#include "include/lights.glsl"
+
+uniform struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+} material;
+
+out vec4 fragColor;
+
+void main() {
+    vec3 albedo = texture(material.diffuse, texCoord).rgb;
+    vec3 fragNormal = normalize(normal);
+    vec3 color = albedo * 0.05;
+    for (int i = 0; i < lightCount; ++i) {
+        vec3 lightVec = lights[i].position - fragPos;
+        float dist = length(lightVec);
+        float diffuse = max(dot(fragNormal, lightVec / dist), 0.0);
+        color += albedo * lights[i].color * diffuse / (dist * dist);
+    }
+    // Reinhard tone mapping (HDR) + gamma correction
+    color = color / (color + 1.0);
+    color = pow(color, vec3(1.0 / 2.2));
+    fragColor = vec4(color, 1.0);
+}
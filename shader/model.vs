@@ -0,0 +1,55 @@
+#version 330 core
+
+#ifdef QUANTIZED
+// Attributes of `PackedVertex`.
+layout (location = 0) in vec3 aPackedPos;
+layout (location = 1) in vec2 aPackedNormal;
+#include "include/quantized.glsl"
+#else
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+#endif
+layout (location = 2) in vec2 aTex;
+
+#include "include/camera.glsl"
+
+#ifdef DRAW_INDIRECT
+// Index of the draw in `IndirectDrawList`, which selects its `DrawData` from the buffer texture.
+layout (location = 9) in float aDrawId;
+uniform samplerBuffer drawData;
+#else
+uniform mat4 modelTransform;
+#ifdef QUANTIZED
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+#endif
+#endif
+
+out vec3 fragPos;
+out vec3 normal;
+out vec2 texCoord;
+// Matches the depth of `depth.vs` for a depth prepass.
+invariant gl_Position;
+
+void main() {
+#ifdef DRAW_INDIRECT
+    int texel = int(aDrawId) * 6;
+    mat4 modelTransform = mat4(
+        texelFetch(drawData, texel),
+        texelFetch(drawData, texel + 1),
+        texelFetch(drawData, texel + 2),
+        texelFetch(drawData, texel + 3)
+    );
+    vec3 positionScale = texelFetch(drawData, texel + 4).xyz;
+    vec3 positionOffset = texelFetch(drawData, texel + 5).xyz;
+#endif
+#ifdef QUANTIZED
+    vec3 aPos = aPackedPos * positionScale + positionOffset;
+    vec3 aNormal = decodeOctahedral(aPackedNormal);
+#endif
+    fragPos = (modelTransform * vec4(aPos, 1.0)).xyz;
+    gl_Position = projection * view * vec4(fragPos, 1.0);
+    // Models are scaled uniformly, so the normal matrix is the rotation part of the model transform.
+    normal = mat3(modelTransform) * aNormal;
+    texCoord = aTex;
+}
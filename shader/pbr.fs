@@ -3,16 +3,16 @@
 in vec3 fragPos;
 in vec3 normal;
 in vec2 texCoord;
+#if defined(INSTANCED) || defined(DRAW_BLOCK)
+// Metallic and roughness of the instance or the draw.
+flat in vec4 instanceParams;
+#endif
+
+#include "include/camera.glsl"
 
-uniform vec3 viewPos;
 uniform samplerCube irradianceMap;
-uniform int useIrradiance;
 
-const int LIGHT_COUNT = 4;
-uniform struct {
-    vec3 position;
-    vec3 color;
-} lights[LIGHT_COUNT];
+#include "include/lights.glsl"
 
 struct Material {
     vec3 albedo;
@@ -22,47 +22,18 @@ struct Material {
 };
 uniform Material material;
 
-const float PI = 3.14159265359;
-
 out vec4 fragColor;
 
-float distributionGGX(vec3 normal, vec3 halfDir, float roughness) {
-    float a = roughness * roughness;
-    float a2 = a * a;
-    float dotNH = max(0.0, dot(normal, halfDir));
-    float dotNH2 = dotNH * dotNH;
-    float denom = dotNH2 * (a2 - 1.0) + 1.0;
-    return a2 / (PI * denom * denom);
-}
-
-float geometrySchlickGGX(float dotNV, float roughness) {
-    float r = roughness + 1.0;
-    float k = r * r / 8.0;
-    float nom = dotNV;
-    float denom = dotNV * (1.0 - k) + k;
-    return nom / denom;
-}
-
-float geometrySmith(vec3 normal, vec3 viewDir, vec3 lightDir, float roughness) {
-    float dotNV = max(0.0, dot(normal, viewDir));
-    float dotNL = max(0.0, dot(normal, lightDir));
-    float ggx2 = geometrySchlickGGX(dotNV, roughness);
-    float ggx1 = geometrySchlickGGX(dotNL, roughness);
-    return ggx1 * ggx2;
-}
-
-vec3 fresnelSchlick(float cosTheta, vec3 F0) {
-    return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
-}
-
-vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness) {
-    return F0 + (max(F0, vec3(1.0 - roughness)) - F0) * pow(1.0 - cosTheta, 5.0);
-}
+#include "include/pbr.glsl"
 
 void main() {
     vec3 albedo = material.albedo;
     float metallic = material.metallic;
     float roughness = material.roughness;
+#if defined(INSTANCED) || defined(DRAW_BLOCK)
+    metallic = instanceParams.x;
+    roughness = instanceParams.y;
+#endif
     float ao = material.ao;
     vec3 fragNormal = normalize(normal);
     vec3 viewDir = normalize(viewPos - fragPos);
@@ -73,7 +44,7 @@ void main() {
 
     // Reflectance equation
     vec3 outRadiance = vec3(0.0);
-    for (int i = 0; i < LIGHT_COUNT; ++i) {
+    for (int i = 0; i < min(lightCount, MAX_LIGHTS); ++i) {
         vec3 lightDir = normalize(lights[i].position - fragPos);
         vec3 halfDir = normalize(lightDir + viewDir);
 
@@ -101,16 +72,15 @@ void main() {
         outRadiance += (kD * albedo / PI + specular) * radiance * dotNL;
     }
 
-    vec3 ambient;
-    if (useIrradiance == 0) {
-        ambient = vec3(0.03) * albedo * ao;
-    } else {
-        vec3 kS = fresnelSchlickRoughness(dotNV, F0, roughness);
-        vec3 kD = 1.0 - kS;
-        vec3 irradiance = textureCube(irradianceMap, fragNormal).rgb;
-        vec3 diffuse = irradiance * albedo;
-        ambient = (kD * diffuse) * ao;
-    }
+#ifdef USE_IRRADIANCE
+    vec3 kS = fresnelSchlickRoughness(dotNV, F0, roughness);
+    vec3 kD = 1.0 - kS;
+    vec3 irradiance = textureCube(irradianceMap, fragNormal).rgb;
+    vec3 diffuse = irradiance * albedo;
+    vec3 ambient = (kD * diffuse) * ao;
+#else
+    vec3 ambient = vec3(0.03) * albedo * ao;
+#endif
 
     vec3 color = ambient + outRadiance;
 
@@ -4,16 +4,38 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTex;
 
-uniform mat4 transform;
+#include "include/camera.glsl"
+
+#ifdef INSTANCED
+// Per-instance attributes of `InstanceBuffer`.
+layout (location = 4) in mat4 aModelTransform;
+layout (location = 8) in vec4 aInstanceParams;
+#define modelTransform aModelTransform
+flat out vec4 instanceParams;
+#elif defined(DRAW_BLOCK)
+// Per-draw data of a `CommandList` packet, bound by range for each draw.
+layout (std140) uniform DrawBlock {
+    mat4 drawTransform;
+    vec4 drawParams;
+};
+#define modelTransform drawTransform
+flat out vec4 instanceParams;
+#else
 uniform mat4 modelTransform;
+#endif
 
 out vec3 fragPos;
 out vec3 normal;
 out vec2 texCoord;
 
 void main() {
-    gl_Position = transform * vec4(aPos, 1.0);
+#ifdef INSTANCED
+    instanceParams = aInstanceParams;
+#elif defined(DRAW_BLOCK)
+    instanceParams = drawParams;
+#endif
     fragPos = (modelTransform * vec4(aPos, 1.0)).xyz;
+    gl_Position = projection * view * vec4(fragPos, 1.0);
     normal = (transpose(inverse(modelTransform)) * vec4(aNormal, 0.0)).xyz;
     texCoord = aTex;
 }
@@ -4,13 +4,9 @@ in vec3 fragPos;
 in vec2 texCoord;
 in mat3 TBN;
 
-uniform vec3 viewPos;
+#include "include/camera.glsl"
 
-const int LIGHT_COUNT = 4;
-uniform struct {
-    vec3 position;
-    vec3 color;
-} lights[LIGHT_COUNT];
+#include "include/lights.glsl"
 
 struct Material {
     sampler2D albedo;
@@ -21,38 +17,9 @@ struct Material {
 };
 uniform Material material;
 
-const float PI = 3.14159265359;
-
 out vec4 fragColor;
 
-float distributionGGX(vec3 normal, vec3 halfDir, float roughness) {
-    float a = roughness * roughness;
-    float a2 = a * a;
-    float dotNH = max(0.0, dot(normal, halfDir));
-    float dotNH2 = dotNH * dotNH;
-    float denom = dotNH2 * (a2 - 1.0) + 1.0;
-    return a2 / (PI * denom * denom);
-}
-
-float geometrySchlickGGX(float dotNV, float roughness) {
-    float r = roughness + 1.0;
-    float k = r * r / 8.0;
-    float num = dotNV;
-    float denom = dotNV * (1.0 - k) + k;
-    return num / denom;
-}
-
-float geometrySmith(vec3 normal, vec3 viewDir, vec3 lightDir, float roughness) {
-    float dotNV = max(0.0, dot(normal, viewDir));
-    float dotNL = max(0.0, dot(normal, lightDir));
-    float ggx2 = geometrySchlickGGX(dotNV, roughness);
-    float ggx1 = geometrySchlickGGX(dotNL, roughness);
-    return ggx1 * ggx2;
-}
-
-vec3 fresnelSchlick(float cosTheta, vec3 F0) {
-    return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
-}
+#include "include/pbr.glsl"
 
 void main() {
     // Convert from SRGB to linear-RGB
@@ -70,7 +37,7 @@ void main() {
 
     // Reflectance equation
     vec3 outRadiance = vec3(0.0);
-    for (int i = 0; i < LIGHT_COUNT; ++i) {
+    for (int i = 0; i < min(lightCount, MAX_LIGHTS); ++i) {
         vec3 lightDir = normalize(lights[i].position - fragPos);
         vec3 halfDir = normalize(lightDir + viewDir);
 
@@ -5,16 +5,23 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 layout (location = 3) in vec3 aTangent;
 
-uniform mat4 transform;
+#include "include/camera.glsl"
+
+#ifdef INSTANCED
+// Per-instance attributes of `InstanceBuffer`.
+layout (location = 4) in mat4 aModelTransform;
+#define modelTransform aModelTransform
+#else
 uniform mat4 modelTransform;
+#endif
 
 out vec3 fragPos;
 out vec2 texCoord;
 out mat3 TBN;
 
 void main() {
-    gl_Position = transform * vec4(aPos, 1.0);
     fragPos = (modelTransform * vec4(aPos, 1.0)).xyz;
+    gl_Position = projection * view * vec4(fragPos, 1.0);
     texCoord = aTexCoord;
     vec3 normal = (transpose(inverse(modelTransform)) * vec4(aNormal, 0.0)).xyz;
     vec3 tangent = (modelTransform * vec4(aTangent, 0.0)).xyz;
@@ -5,15 +5,16 @@ in vec2 texCoord;
 uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 
-uniform mat4 view;
-uniform mat4 projection;
+#include "include/camera.glsl"
 
 uniform sampler2D texNoise;
 uniform vec2 noiseScale;
 uniform float radius;
 uniform float power;
 
-const int KERNEL_SIZE = 16;
+#ifndef KERNEL_SIZE
+#define KERNEL_SIZE 16
+#endif
 const float BIAS = 0.025;
 uniform vec3 samples[KERNEL_SIZE];
 
@@ -0,0 +1,103 @@
+#include "glex/blob_cache.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    struct BlobFileHeader {
+        uint32_t magic;
+        uint32_t tag;
+        uint64_t key;
+        uint64_t size;
+    };
+
+} // namespace
+
+BlobCache::BlobCache(std::string name, std::string extension, const uint32_t magic)
+    : name_{std::move(name)}
+    , extension_{std::move(extension)}
+    , magic_{magic} {}
+
+bool BlobCache::set_directory(const fs::path &directory) {
+    enabled_ = false;
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error) {
+        SPDLOG_WARN("{} is disabled: failed to create \"{}\": {}", name_, directory.string(), error.message());
+        return false;
+    }
+    directory_ = directory;
+    enabled_ = true;
+    SPDLOG_INFO("{} directory: \"{}\"", name_, directory.string());
+    return true;
+}
+
+std::optional<CachedBlob> BlobCache::load(const uint64_t key) {
+    if (!enabled_) {
+        return std::nullopt;
+    }
+    const auto path = get_path(key);
+    std::ifstream is{path, std::ios::binary};
+    if (!is.is_open()) {
+        ++miss_count_;
+        return std::nullopt;
+    }
+    BlobFileHeader header{};
+    is.read(reinterpret_cast<char *>(&header), sizeof(header));
+    std::error_code error;
+    const auto file_size = fs::file_size(path, error);
+    CachedBlob blob{.tag = header.tag, .data = {}};
+    // The size is checked against the file before allocating, so a corrupted header cannot ask for a huge buffer.
+    if (is && header.magic == magic_ && header.key == key && !error && file_size - sizeof(header) == header.size) {
+        blob.data.resize(header.size);
+        is.read(blob.data.data(), static_cast<std::streamsize>(blob.data.size()));
+    }
+    if (!is || blob.data.empty()) {
+        SPDLOG_WARN("Ignore corrupted file of {}: \"{}\"", name_, path.string());
+        ++miss_count_;
+        return std::nullopt;
+    }
+    return blob;
+}
+
+std::optional<fs::path> BlobCache::store(const uint64_t key, const uint32_t tag, const std::span<const char> data) {
+    if (!enabled_) {
+        return std::nullopt;
+    }
+    const auto path = get_path(key);
+    // Write into a temporary file first so that a concurrent reader never sees a partial file.
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream os{temp_path, std::ios::binary | std::ios::trunc};
+        const BlobFileHeader header{.magic = magic_, .tag = tag, .key = key, .size = data.size()};
+        os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        os.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!os) {
+            SPDLOG_WARN("Failed to write file of {}: \"{}\"", name_, temp_path.string());
+            return std::nullopt;
+        }
+    }
+    std::error_code error;
+    fs::rename(temp_path, path, error);
+    if (error) {
+        SPDLOG_WARN("Failed to write file of {}: \"{}\": {}", name_, path.string(), error.message());
+        return std::nullopt;
+    }
+    return path;
+}
+
+fs::path BlobCache::get_path(const uint64_t key) const {
+    return directory_ / std::format("{:016x}{}", key, extension_);
+}
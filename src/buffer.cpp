@@ -2,6 +2,7 @@
 #include <memory>
 #include <spdlog/spdlog.h>
 #include "glex/common.h"
+#include "glex/gl_state_cache.h"
 
 std::unique_ptr<Buffer> Buffer::create_with_data(
         const uint32_t buffer_type, const uint32_t usage, const void *data, const size_t stride, const size_t count
@@ -26,12 +27,22 @@ std::unique_ptr<Buffer> Buffer::create_with_data(
 Buffer::~Buffer() {
     if (buffer_) {
         glDeleteBuffers(1, &buffer_);
+        GLStateCache::forget_buffer(buffer_);
         SPDLOG_INFO("Delete buffer: {}", buffer_);
     }
 }
 
 void Buffer::bind() const {
-    glBindBuffer(buffer_type_, buffer_);
+    GLStateCache::bind_buffer(buffer_type_, buffer_);
+}
+
+void Buffer::bind_base(const uint32_t index) const {
+    GLStateCache::bind_buffer_base(buffer_type_, index, buffer_);
+}
+
+void Buffer::set_data(const void *data, const size_t size, const size_t offset) const {
+    bind();
+    glBufferSubData(buffer_type_, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
 }
 
 Buffer::Buffer(
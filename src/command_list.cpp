@@ -0,0 +1,143 @@
+#include "glex/command_list.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <vector>
+#include "glex/buffer.h"
+#include "glex/common.h"
+#include "glex/gl_state_cache.h"
+#include "glex/mesh.h"
+#include "glex/thread_pool.h"
+#include "glex/uniform_buffer.h"
+
+std::unique_ptr<CommandQueue> CommandQueue::create() {
+    const auto binding = UniformBuffer::acquire_binding();
+    if (!binding) {
+        SPDLOG_ERROR("Failed to create command queue: no free uniform buffer binding point");
+        return nullptr;
+    }
+    int alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    SPDLOG_INFO("CommandQueue has been created: binding: {}, uniform alignment: {}", *binding, alignment);
+    return std::unique_ptr<CommandQueue>{new CommandQueue{*binding, static_cast<size_t>(std::max(alignment, 1))}};
+}
+
+CommandQueue::CommandQueue(const uint32_t uniform_binding, const size_t uniform_alignment)
+    : uniform_binding_{uniform_binding}
+    , uniform_alignment_{uniform_alignment} {}
+
+CommandQueue::~CommandQueue() {
+    UniformBuffer::release_binding(uniform_binding_);
+}
+
+std::span<CommandList> CommandQueue::begin(const size_t list_count) {
+    list_count_ = std::max<size_t>(list_count, 1);
+    while (lists_.size() < list_count_) {
+        lists_.push_back(CommandList{uniform_alignment_});
+    }
+    for (size_t i = 0; i < list_count_; ++i) {
+        lists_[i].clear();
+    }
+    return std::span{lists_}.first(list_count_);
+}
+
+void CommandQueue::record(
+        const size_t item_count, const std::function<void(CommandList &list, size_t first, size_t last)> &record_range,
+        const CommandRecordOptions &options
+) {
+    auto &pool = options.pool ? *options.pool : ThreadPool::get_default();
+    const auto thread_count = options.max_threads ? options.max_threads : pool.get_thread_count() + 1;
+    const auto list_count =
+            std::clamp<size_t>(item_count / std::max<size_t>(options.min_items_per_list, 1), 1, thread_count);
+    const auto lists = begin(list_count);
+    const auto get_first = [&](const size_t i) { return item_count * i / list_count; };
+    std::vector<std::future<void>> futures;
+    futures.reserve(list_count - 1);
+    for (size_t i = 1; i < list_count; ++i) {
+        futures.push_back(pool.submit([&, i] { record_range(lists[i], get_first(i), get_first(i + 1)); }));
+    }
+    record_range(lists[0], 0, get_first(1));
+    for (auto &future : futures) {
+        future.get();
+    }
+}
+
+void CommandQueue::execute() {
+    const auto lists = std::span{lists_}.first(list_count_);
+    stats_ = {.list_count = lists.size()};
+    for (const auto &list : lists) {
+        stats_.packet_count += list.packets_.size();
+        stats_.uniform_bytes += list.uniform_data_.size();
+    }
+    if (stats_.packet_count == 0) {
+        return;
+    }
+
+    // Upload the uniform data of the lists one after another. Each list takes a whole number of aligned blocks, so
+    // every block stays aligned.
+    auto &uniform_buffer = uniform_buffers_[frame_index_++ % uniform_buffers_.size()];
+    if (stats_.uniform_bytes > 0 && (!uniform_buffer || uniform_buffer->get_count() < stats_.uniform_bytes)) {
+        const auto capacity = std::max(stats_.uniform_bytes, uniform_buffer ? uniform_buffer->get_count() * 2 : 0);
+        uniform_buffer = Buffer::create_with_data(GL_UNIFORM_BUFFER, GL_STREAM_DRAW, nullptr, 1, capacity);
+        if (!uniform_buffer) {
+            SPDLOG_ERROR("Failed to execute command lists: cannot allocate {} bytes of uniform data", capacity);
+            return;
+        }
+    }
+    size_t list_offset = 0;
+    for (const auto &list : lists) {
+        if (!list.uniform_data_.empty()) {
+            uniform_buffer->set_data(list.uniform_data_.data(), list.uniform_data_.size(), list_offset);
+        }
+        list_offset += list.uniform_data_.size();
+    }
+
+    const Program *program = nullptr;
+    uint32_t vertex_array = 0;
+    std::optional<PositionQuantization> quantization;
+    list_offset = 0;
+    for (const auto &list : lists) {
+        for (const auto &[packet_program, command, instance_count, uniform_offset, uniform_size] : list.packets_) {
+            if (packet_program != program) {
+                program = packet_program;
+                program->use();
+                quantization.reset();
+                stats_.program_changes++;
+            }
+            if (command.vertex_array != vertex_array) {
+                vertex_array = command.vertex_array;
+                GLStateCache::bind_vertex_array(vertex_array);
+                stats_.vertex_array_changes++;
+            }
+            // Packed positions are dequantized with uniforms of the program, set only when the bounds change.
+            if (command.quantization && command.quantization != quantization) {
+                quantization = command.quantization;
+                program->set_uniform("positionScale", quantization->scale);
+                program->set_uniform("positionOffset", quantization->offset);
+            }
+            if (uniform_size > 0) {
+                GLStateCache::bind_buffer_range(
+                        GL_UNIFORM_BUFFER, uniform_binding_, uniform_buffer->get(), list_offset + uniform_offset,
+                        uniform_size
+                );
+            }
+            const auto count = static_cast<GLsizei>(command.index_count);
+            const auto offset = reinterpret_cast<const void *>(size_t{command.first_index} * sizeof(uint32_t));
+            if (instance_count == 1) {
+                glDrawElementsBaseVertex(command.primitive_type, count, GL_UNSIGNED_INT, offset, command.base_vertex);
+            } else {
+                glDrawElementsInstancedBaseVertex(
+                        command.primitive_type, count, GL_UNSIGNED_INT, offset, static_cast<GLsizei>(instance_count),
+                        command.base_vertex
+                );
+            }
+        }
+        list_offset += list.uniform_data_.size();
+    }
+}
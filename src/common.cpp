@@ -1,4 +1,6 @@
 #include "glex/common.h"
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <optional>
 #include <spdlog/spdlog.h>
@@ -26,3 +28,12 @@ glm::vec3 get_attenuation_coefficient(const float dist) {
     const float k_q = glm::dot(quad_co, dvec);
     return {k_c, glm::max(k_l, 0.0f), glm::max(k_q * k_q, 0.0f)};
 }
+
+uint64_t hash_bytes(const void *data, const size_t size, uint64_t hash) {
+    const auto bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
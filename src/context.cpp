@@ -1,4 +1,54 @@
 #include "glex/context.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace {
+
+    /// Member offsets of the `Camera` uniform block.
+    struct CameraBlockLayout {
+        size_t view;
+        size_t projection;
+        size_t view_pos;
+        size_t size;
+    };
+
+    /// Member offsets of the `Lights` uniform block.
+    struct LightsBlockLayout {
+        size_t light_count;
+        size_t lights;
+        size_t light_stride;
+        size_t position;
+        size_t color;
+        size_t size;
+    };
+
+    CameraBlockLayout make_camera_block_layout() {
+        Std140Layout block;
+        CameraBlockLayout layout{};
+        layout.view = block.add<glm::mat4>();
+        layout.projection = block.add<glm::mat4>();
+        layout.view_pos = block.add<glm::vec3>();
+        layout.size = block.get_stride();
+        return layout;
+    }
+
+    LightsBlockLayout make_lights_block_layout() {
+        Std140Layout light;
+        LightsBlockLayout layout{};
+        layout.position = light.add<glm::vec3>();
+        layout.color = light.add<glm::vec3>();
+        layout.light_stride = light.get_stride();
+        Std140Layout block;
+        layout.light_count = block.add<int>();
+        layout.lights = block.add_struct(light, Context::MAX_LIGHTS);
+        layout.size = block.get_stride();
+        return layout;
+    }
+
+    const CameraBlockLayout camera_layout = make_camera_block_layout();
+    const LightsBlockLayout lights_layout = make_lights_block_layout();
+
+} // namespace
 
 void Context::process_input(GLFWwindow *window) {
     constexpr auto camera_speed = 0.05f;
@@ -62,3 +112,37 @@ void Context::mouse_button(const int button, const int action, const double x, c
         }
     }
 }
+
+bool Context::init_uniform_blocks() {
+    camera_block_ = UniformBuffer::create(camera_layout.size);
+    lights_block_ = UniformBuffer::create(lights_layout.size);
+    if (!camera_block_ || !lights_block_) {
+        SPDLOG_ERROR("Failed to create uniform blocks");
+        return false;
+    }
+    return true;
+}
+
+void Context::bind_uniform_blocks(const Program &program) const {
+    program.bind_uniform_block("Camera", camera_block_->get_binding());
+    program.bind_uniform_block("Lights", lights_block_->get_binding());
+}
+
+void Context::upload_camera_block(const glm::mat4 &view, const glm::mat4 &projection) const {
+    camera_block_->set(camera_layout.view, view);
+    camera_block_->set(camera_layout.projection, projection);
+    camera_block_->set(camera_layout.view_pos, camera_pos_);
+    camera_block_->upload();
+}
+
+void Context::upload_lights_block(const std::span<const PointLight> lights) const {
+    const auto count = std::min(lights.size(), MAX_LIGHTS);
+    lights_block_->set(lights_layout.light_count, static_cast<int>(count));
+    for (size_t i = 0; i < count; ++i) {
+        const auto offset = lights_layout.lights + lights_layout.light_stride * i;
+        lights_block_->set(offset + lights_layout.position, lights[i].position);
+        lights_block_->set(offset + lights_layout.color, lights[i].color);
+    }
+    // Shaders read only the first `lightCount` slots, so the unused ones are not uploaded.
+    lights_block_->upload(lights_layout.lights + lights_layout.light_stride * count);
+}
@@ -4,6 +4,7 @@
 #include <memory>
 #include <spdlog/spdlog.h>
 #include "glex/common.h"
+#include "glex/gl_state_cache.h"
 
 std::unique_ptr<FrameBuffer> FrameBuffer::create(const std::vector<std::shared_ptr<Texture>> &color_attachments) {
     // Generate framebuffer and renderbuffer.
@@ -22,7 +23,7 @@ std::unique_ptr<FrameBuffer> FrameBuffer::create(const std::vector<std::shared_p
     return std::move(framebuffer);
 }
 void FrameBuffer::bind_to_default() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 FrameBuffer::~FrameBuffer() {
@@ -33,15 +34,16 @@ FrameBuffer::~FrameBuffer() {
     if (framebuffer_) {
         SPDLOG_INFO("Delete framebuffer: {}", framebuffer_);
         glDeleteFramebuffers(1, &framebuffer_);
+        GLStateCache::forget_framebuffer(framebuffer_);
     }
 }
 
 void FrameBuffer::bind() const {
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, framebuffer_);
 }
 
 bool FrameBuffer::init() const {
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, framebuffer_);
 
     for (size_t i = 0; i < get_color_attachments_size(); ++i) {
         glFramebufferTexture2D(
@@ -104,11 +106,12 @@ CubeFrameBuffer::~CubeFrameBuffer() {
     }
     if (framebuffer_id_) {
         glDeleteFramebuffers(1, &framebuffer_id_);
+        GLStateCache::forget_framebuffer(framebuffer_id_);
     }
 }
 
 void CubeFrameBuffer::bind(int cube_index) const {
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id_);
+    GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, framebuffer_id_);
     glFramebufferTexture2D(
             GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + cube_index, color_attachment_->get(),
             mip_level_
@@ -116,7 +119,7 @@ void CubeFrameBuffer::bind(int cube_index) const {
 }
 
 bool CubeFrameBuffer::init() {
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id_);
+    GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, framebuffer_id_);
     glFramebufferTexture2D(
             GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X, color_attachment_->get(), mip_level_
     );
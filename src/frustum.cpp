@@ -0,0 +1,174 @@
+#include "glex/frustum.h"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glex/common.h"
+#include "glex/mesh.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_USE_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_USE_SSE2
+#endif
+
+namespace {
+
+    /// Spheres the arrays of `BoundingSphereSet` are padded to a multiple of, the widest SIMD width.
+    constexpr size_t SPHERE_BLOCK_SIZE{8};
+
+#if defined(FRUSTUM_USE_AVX)
+    constexpr size_t SPHERE_LANES{8};
+
+    /// @returns A bit per sphere of the `SPHERE_LANES` spheres at `first`, set if it intersects every plane.
+    uint32_t test_spheres(
+            const Frustum &frustum, const float *center_x, const float *center_y, const float *center_z,
+            const float *radius, const size_t first
+    ) {
+        const auto x = _mm256_loadu_ps(center_x + first);
+        const auto y = _mm256_loadu_ps(center_y + first);
+        const auto z = _mm256_loadu_ps(center_z + first);
+        const auto r = _mm256_loadu_ps(radius + first);
+        auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const auto &plane : frustum.planes) {
+            const auto distance = _mm256_add_ps(
+                    _mm256_add_ps(
+                            _mm256_mul_ps(_mm256_set1_ps(plane.x), x), _mm256_mul_ps(_mm256_set1_ps(plane.y), y)
+                    ),
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), z), _mm256_set1_ps(plane.w))
+            );
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        return static_cast<uint32_t>(_mm256_movemask_ps(inside));
+    }
+#elif defined(FRUSTUM_USE_SSE2)
+    constexpr size_t SPHERE_LANES{4};
+
+    /// @returns A bit per sphere of the `SPHERE_LANES` spheres at `first`, set if it intersects every plane.
+    uint32_t test_spheres(
+            const Frustum &frustum, const float *center_x, const float *center_y, const float *center_z,
+            const float *radius, const size_t first
+    ) {
+        const auto x = _mm_loadu_ps(center_x + first);
+        const auto y = _mm_loadu_ps(center_y + first);
+        const auto z = _mm_loadu_ps(center_z + first);
+        const auto r = _mm_loadu_ps(radius + first);
+        auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const auto &plane : frustum.planes) {
+            const auto distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w))
+            );
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, r), _mm_setzero_ps()));
+        }
+        return static_cast<uint32_t>(_mm_movemask_ps(inside));
+    }
+#else
+    constexpr size_t SPHERE_LANES{1};
+
+    /// @returns `1` if the sphere at `first` intersects every plane, `0` otherwise.
+    uint32_t test_spheres(
+            const Frustum &frustum, const float *center_x, const float *center_y, const float *center_z,
+            const float *radius, const size_t first
+    ) {
+        const BoundingSphere sphere{
+                .center = {center_x[first], center_y[first], center_z[first]},
+                .radius = radius[first],
+        };
+        return frustum.intersects(sphere) ? 1 : 0;
+    }
+#endif
+
+} // namespace
+
+Frustum Frustum::from_matrix(const glm::mat4 &matrix) {
+    const auto &m = matrix;
+    const auto row = [&](const int i) { return glm::vec4{m[0][i], m[1][i], m[2][i], m[3][i]}; };
+    Frustum frustum{{
+            row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(3) + row(2), row(3) - row(2),
+    }};
+    for (auto &plane : frustum.planes) {
+        plane /= glm::length(glm::vec3{plane});
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const BoundingSphere &sphere) const {
+    for (const auto &plane : planes) {
+        if (glm::dot(glm::vec3{plane}, sphere.center) + plane.w < -sphere.radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersects(const BoundingBox &box) const {
+    for (const auto &plane : planes) {
+        const auto corner = glm::vec3{
+                plane.x >= 0.0f ? box.max.x : box.min.x,
+                plane.y >= 0.0f ? box.max.y : box.min.y,
+                plane.z >= 0.0f ? box.max.z : box.min.z,
+        };
+        if (glm::dot(glm::vec3{plane}, corner) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BoundingSphereSet::clear() {
+    size_ = 0;
+}
+
+void BoundingSphereSet::reserve(const size_t capacity) {
+    const auto padded = (capacity + SPHERE_BLOCK_SIZE - 1) / SPHERE_BLOCK_SIZE * SPHERE_BLOCK_SIZE;
+    center_x_.reserve(padded);
+    center_y_.reserve(padded);
+    center_z_.reserve(padded);
+    radius_.reserve(padded);
+}
+
+uint32_t BoundingSphereSet::add(const BoundingSphere &sphere, const glm::mat4 &transform) {
+    if (size_ == center_x_.size()) {
+        // Grow by a whole block, so the last load of `cull` stays within the arrays.
+        const auto padded = size_ + SPHERE_BLOCK_SIZE;
+        center_x_.resize(padded, 0.0f);
+        center_y_.resize(padded, 0.0f);
+        center_z_.resize(padded, 0.0f);
+        radius_.resize(padded, 0.0f);
+    }
+    const auto index = static_cast<uint32_t>(size_++);
+    set(index, sphere, transform);
+    return index;
+}
+
+void BoundingSphereSet::set(const uint32_t index, const BoundingSphere &sphere, const glm::mat4 &transform) {
+    const auto world = sphere.transform(transform);
+    center_x_[index] = world.center.x;
+    center_y_[index] = world.center.y;
+    center_z_[index] = world.center.z;
+    radius_[index] = world.radius;
+}
+
+void BoundingSphereSet::cull(const Frustum &frustum, std::vector<uint32_t> &visible, FrustumCullStats *stats) const {
+    visible.clear();
+    for (size_t first = 0; first < size_; first += SPHERE_LANES) {
+        auto mask = test_spheres(frustum, center_x_.data(), center_y_.data(), center_z_.data(), radius_.data(), first);
+        // Padding past the last sphere may pass, so the indices are bounded by the size.
+        while (mask != 0) {
+            const auto index = first + static_cast<size_t>(std::countr_zero(mask));
+            if (index >= size_) {
+                break;
+            }
+            visible.push_back(static_cast<uint32_t>(index));
+            mask &= mask - 1;
+        }
+    }
+    if (stats) {
+        stats->visible_count += visible.size();
+        stats->culled_count += size_ - visible.size();
+    }
+}
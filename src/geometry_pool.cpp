@@ -0,0 +1,387 @@
+#include "glex/geometry_pool.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <utility>
+#include <vector>
+#include "glex/buffer.h"
+#include "glex/common.h"
+#include "glex/gl_state_cache.h"
+#include "glex/vertex_layout.h"
+
+namespace {
+
+    void copy_buffer(
+            const Buffer &source, const Buffer &destination, const size_t source_offset,
+            const size_t destination_offset, const size_t size
+    ) {
+        GLStateCache::bind_buffer(GL_COPY_READ_BUFFER, source.get());
+        GLStateCache::bind_buffer(GL_COPY_WRITE_BUFFER, destination.get());
+        glCopyBufferSubData(
+                GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(source_offset),
+                static_cast<GLintptr>(destination_offset), static_cast<GLsizeiptr>(size)
+        );
+    }
+
+    /// @returns The capacity after growing from `capacity` to fit a block of `count` more elements. Doubling keeps the
+    /// number of reallocations logarithmic in the total size.
+    size_t get_grown_capacity(const size_t capacity, const size_t count) {
+        return std::max(capacity * 2, capacity + count);
+    }
+
+} // namespace
+
+RangeAllocator::RangeAllocator(const size_t capacity)
+    : capacity_{capacity} {
+    if (capacity > 0) {
+        free_blocks_.emplace(0, capacity);
+    }
+}
+
+std::optional<size_t> RangeAllocator::allocate(const size_t size) {
+    for (auto it = free_blocks_.begin(); it != free_blocks_.end(); ++it) {
+        const auto [offset, block_size] = *it;
+        if (block_size < size) {
+            continue;
+        }
+        free_blocks_.erase(it);
+        if (block_size > size) {
+            free_blocks_.emplace(offset + size, block_size - size);
+        }
+        used_ += size;
+        return offset;
+    }
+    return std::nullopt;
+}
+
+void RangeAllocator::free(const size_t offset, const size_t size) {
+    used_ -= size;
+    auto begin = offset;
+    auto end = offset + size;
+    // Merge with the following and preceding free blocks.
+    auto next = free_blocks_.lower_bound(offset);
+    if (next != free_blocks_.end() && next->first == end) {
+        end += next->second;
+        next = free_blocks_.erase(next);
+    }
+    if (next != free_blocks_.begin()) {
+        if (const auto previous = std::prev(next); previous->first + previous->second == begin) {
+            begin = previous->first;
+            free_blocks_.erase(previous);
+        }
+    }
+    free_blocks_.emplace(begin, end - begin);
+}
+
+void RangeAllocator::grow(const size_t capacity) {
+    if (capacity <= capacity_) {
+        return;
+    }
+    const auto old_capacity = capacity_;
+    const auto added = capacity - capacity_;
+    capacity_ = capacity;
+    // Freeing the new space merges it with a free block at the old end.
+    used_ += added;
+    free(old_capacity, added);
+}
+
+void RangeAllocator::reset(const size_t used) {
+    used_ = used;
+    free_blocks_.clear();
+    if (used < capacity_) {
+        free_blocks_.emplace(used, capacity_ - used);
+    }
+}
+
+size_t RangeAllocator::get_largest_free_block() const {
+    size_t largest = 0;
+    for (const auto &[offset, size] : free_blocks_) {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
+
+std::unique_ptr<GeometryPool> GeometryPool::create(
+        const std::vector<VertexAttrib> &attribs, const std::vector<size_t> &vertex_strides,
+        const size_t vertex_capacity, const size_t index_capacity
+) {
+    if (vertex_strides.empty()) {
+        SPDLOG_ERROR("Failed to create geometry pool: no vertex streams");
+        return nullptr;
+    }
+    // Generate VAOs before generating the buffers, so that the index buffer is bound to one.
+    auto vertex_layout = VertexLayout::create();
+    auto stream0_layout = vertex_strides.size() > 1 ? VertexLayout::create() : nullptr;
+    if (!vertex_layout || (vertex_strides.size() > 1 && !stream0_layout)) {
+        SPDLOG_ERROR("Failed to create geometry pool");
+        return nullptr;
+    }
+    vertex_layout->bind();
+    std::vector<std::unique_ptr<Buffer>> vertex_buffers;
+    for (const auto stride : vertex_strides) {
+        auto vertex_buffer =
+                Buffer::create_with_data(GL_ARRAY_BUFFER, GL_STATIC_DRAW, nullptr, stride, vertex_capacity);
+        if (!vertex_buffer) {
+            SPDLOG_ERROR("Failed to create geometry pool");
+            return nullptr;
+        }
+        vertex_buffers.push_back(std::move(vertex_buffer));
+    }
+    auto index_buffer = Buffer::create_with_data(
+            GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW, nullptr, sizeof(uint32_t), index_capacity
+    );
+    if (!index_buffer) {
+        SPDLOG_ERROR("Failed to create geometry pool");
+        return nullptr;
+    }
+    auto pool = std::unique_ptr<GeometryPool>{new GeometryPool{
+            attribs, vertex_strides, std::move(vertex_layout), std::move(stream0_layout), std::move(vertex_buffers),
+            std::move(index_buffer)
+    }};
+    pool->set_attribs();
+    SPDLOG_INFO(
+            "GeometryPool has been created: {} vertices in {} streams, {} indices", vertex_capacity,
+            vertex_strides.size(), index_capacity
+    );
+    return std::move(pool);
+}
+
+GeometryPool::GeometryPool(
+        const std::vector<VertexAttrib> &attribs, const std::vector<size_t> &vertex_strides,
+        std::unique_ptr<VertexLayout> vertex_layout, std::unique_ptr<VertexLayout> stream0_layout,
+        std::vector<std::unique_ptr<Buffer>> vertex_buffers, std::unique_ptr<Buffer> index_buffer
+)
+    : attribs_{attribs}
+    , vertex_strides_{vertex_strides}
+    , vertex_layout_{std::move(vertex_layout)}
+    , stream0_layout_{std::move(stream0_layout)}
+    , vertex_buffers_{std::move(vertex_buffers)}
+    , index_buffer_{std::move(index_buffer)}
+    , vertex_allocator_{vertex_buffers_.front()->get_count()}
+    , index_allocator_{index_buffer_->get_count()} {}
+
+std::optional<uint32_t> GeometryPool::allocate(
+        const std::span<const void *const> vertex_streams, const size_t vertex_count, const uint32_t *indices,
+        const size_t index_count
+) {
+    if (vertex_count == 0 || index_count == 0) {
+        SPDLOG_ERROR("Failed to allocate geometry: empty mesh");
+        return std::nullopt;
+    }
+    if (vertex_streams.size() != vertex_strides_.size()) {
+        SPDLOG_ERROR("Failed to allocate geometry: {} streams for {}", vertex_streams.size(), vertex_strides_.size());
+        return std::nullopt;
+    }
+    if (!reserve(vertex_count, index_count)) {
+        SPDLOG_ERROR("Failed to allocate geometry: {} vertices, {} indices", vertex_count, index_count);
+        return std::nullopt;
+    }
+    const auto vertex_offset = *vertex_allocator_.allocate(vertex_count);
+    const auto index_offset = *index_allocator_.allocate(index_count);
+    // The element array binding belongs to the bound VAO, so bind the pool before uploading the indices.
+    bind();
+    for (size_t i = 0; i < vertex_buffers_.size(); ++i) {
+        const auto stride = vertex_strides_[i];
+        vertex_buffers_[i]->set_data(vertex_streams[i], vertex_count * stride, vertex_offset * stride);
+    }
+    index_buffer_->set_data(indices, index_count * sizeof(uint32_t), index_offset * sizeof(uint32_t));
+
+    const GeometryRange range{vertex_offset, vertex_count, index_offset, index_count};
+    if (!free_ids_.empty()) {
+        const auto id = free_ids_.back();
+        free_ids_.pop_back();
+        ranges_[id] = range;
+        return id;
+    }
+    ranges_.push_back(range);
+    return static_cast<uint32_t>(ranges_.size() - 1);
+}
+
+void GeometryPool::free(const uint32_t id) {
+    if (id >= ranges_.size() || !ranges_[id]) {
+        SPDLOG_ERROR("Failed to free geometry: invalid id {}", id);
+        return;
+    }
+    const auto &range = *ranges_[id];
+    vertex_allocator_.free(range.vertex_offset, range.vertex_count);
+    index_allocator_.free(range.index_offset, range.index_count);
+    ranges_[id].reset();
+    free_ids_.push_back(id);
+}
+
+void GeometryPool::bind() const {
+    vertex_layout_->bind();
+}
+
+void GeometryPool::bind_stream0() const {
+    get_stream0_vertex_layout().bind();
+}
+
+void GeometryPool::draw(const uint32_t id, const uint32_t primitive_type, const size_t instance_count) const {
+    draw_indices(id, primitive_type, 0, get_range(id).index_count, instance_count);
+}
+
+void GeometryPool::draw_indices(
+        const uint32_t id, const uint32_t primitive_type, const size_t first_index, const size_t index_count,
+        const size_t instance_count
+) const {
+    const auto &range = get_range(id);
+    const auto count = static_cast<GLsizei>(index_count);
+    const auto offset = reinterpret_cast<const void *>((range.index_offset + first_index) * sizeof(uint32_t));
+    const auto base_vertex = static_cast<GLint>(range.vertex_offset);
+    if (instance_count == 1) {
+        glDrawElementsBaseVertex(primitive_type, count, GL_UNSIGNED_INT, offset, base_vertex);
+    } else {
+        glDrawElementsInstancedBaseVertex(
+                primitive_type, count, GL_UNSIGNED_INT, offset, static_cast<GLsizei>(instance_count), base_vertex
+        );
+    }
+}
+
+bool GeometryPool::defragment() {
+    // Bind the pool first, since creating the index buffer binds it to the bound VAO.
+    bind();
+    std::vector<std::unique_ptr<Buffer>> vertex_buffers;
+    for (const auto stride : vertex_strides_) {
+        vertex_buffers.push_back(Buffer::create_with_data(
+                GL_ARRAY_BUFFER, GL_STATIC_DRAW, nullptr, stride, vertex_allocator_.get_capacity()
+        ));
+    }
+    auto index_buffer = Buffer::create_with_data(
+            GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW, nullptr, sizeof(uint32_t), index_allocator_.get_capacity()
+    );
+    if (std::ranges::any_of(vertex_buffers, std::logical_not{}) || !index_buffer) {
+        SPDLOG_ERROR("Failed to defragment geometry pool");
+        set_attribs();
+        return false;
+    }
+
+    std::vector<GeometryRange *> live_ranges;
+    for (auto &range : ranges_) {
+        if (range) {
+            live_ranges.push_back(&*range);
+        }
+    }
+    // Pack the vertices and the indices separately, each in their current order.
+    std::ranges::sort(live_ranges, {}, &GeometryRange::vertex_offset);
+    size_t vertex_end = 0;
+    for (const auto range : live_ranges) {
+        for (size_t i = 0; i < vertex_buffers.size(); ++i) {
+            const auto stride = vertex_strides_[i];
+            copy_buffer(
+                    *vertex_buffers_[i], *vertex_buffers[i], range->vertex_offset * stride, vertex_end * stride,
+                    range->vertex_count * stride
+            );
+        }
+        range->vertex_offset = vertex_end;
+        vertex_end += range->vertex_count;
+    }
+    std::ranges::sort(live_ranges, {}, &GeometryRange::index_offset);
+    size_t index_end = 0;
+    for (const auto range : live_ranges) {
+        copy_buffer(
+                *index_buffer_, *index_buffer, range->index_offset * sizeof(uint32_t), index_end * sizeof(uint32_t),
+                range->index_count * sizeof(uint32_t)
+        );
+        range->index_offset = index_end;
+        index_end += range->index_count;
+    }
+    vertex_allocator_.reset(vertex_end);
+    index_allocator_.reset(index_end);
+
+    vertex_buffers_ = std::move(vertex_buffers);
+    index_buffer_ = std::move(index_buffer);
+    set_attribs();
+    SPDLOG_INFO("GeometryPool has been defragmented: {} ranges", live_ranges.size());
+    return true;
+}
+
+GeometryPool::Stats GeometryPool::get_stats() const {
+    const auto index_stride = sizeof(uint32_t);
+    size_t vertex_stride = 0;
+    for (const auto stride : vertex_strides_) {
+        vertex_stride += stride;
+    }
+    const auto vertex_free = vertex_allocator_.get_capacity() - vertex_allocator_.get_used();
+    const auto index_free = index_allocator_.get_capacity() - index_allocator_.get_used();
+    return {
+            .allocations = ranges_.size() - free_ids_.size(),
+            .vertex_capacity = vertex_allocator_.get_capacity() * vertex_stride,
+            .vertex_used = vertex_allocator_.get_used() * vertex_stride,
+            .index_capacity = index_allocator_.get_capacity() * index_stride,
+            .index_used = index_allocator_.get_used() * index_stride,
+            .free_blocks = vertex_allocator_.get_free_block_count() + index_allocator_.get_free_block_count(),
+            .fragmented = (vertex_free - vertex_allocator_.get_largest_free_block()) * vertex_stride +
+                          (index_free - index_allocator_.get_largest_free_block()) * index_stride,
+    };
+}
+
+void GeometryPool::set_attribs() const {
+    const auto set_layout_attribs = [this](const VertexLayout &layout, const bool stream0_only) {
+        layout.bind();
+        for (const auto &[index, count, type, normalized, offset, stream] : attribs_) {
+            if (stream0_only && stream != 0) {
+                continue;
+            }
+            vertex_buffers_[stream]->bind();
+            layout.set_attrib(index, count, type, normalized, vertex_strides_[stream], offset);
+        }
+        index_buffer_->bind();
+    };
+    if (stream0_layout_) {
+        set_layout_attribs(*stream0_layout_, true);
+    }
+    set_layout_attribs(*vertex_layout_, false);
+}
+
+bool GeometryPool::grow_vertices(const size_t count) {
+    const auto capacity = vertex_allocator_.get_capacity();
+    const auto new_capacity = get_grown_capacity(capacity, count);
+    std::vector<std::unique_ptr<Buffer>> vertex_buffers;
+    for (size_t i = 0; i < vertex_buffers_.size(); ++i) {
+        const auto stride = vertex_strides_[i];
+        auto vertex_buffer = Buffer::create_with_data(GL_ARRAY_BUFFER, GL_STATIC_DRAW, nullptr, stride, new_capacity);
+        if (!vertex_buffer) {
+            return false;
+        }
+        copy_buffer(*vertex_buffers_[i], *vertex_buffer, 0, 0, capacity * stride);
+        vertex_buffers.push_back(std::move(vertex_buffer));
+    }
+    vertex_buffers_ = std::move(vertex_buffers);
+    vertex_allocator_.grow(new_capacity);
+    SPDLOG_INFO("GeometryPool vertex buffers have grown: {} -> {} vertices", capacity, new_capacity);
+    return true;
+}
+
+bool GeometryPool::reserve(const size_t vertex_count, const size_t index_count) {
+    const auto grow_vertices = vertex_allocator_.get_largest_free_block() < vertex_count;
+    const auto grow_indices = index_allocator_.get_largest_free_block() < index_count;
+    if (!grow_vertices && !grow_indices) {
+        return true;
+    }
+    // Creating the index buffer binds it to the bound VAO.
+    bind();
+    auto result = !grow_vertices || this->grow_vertices(vertex_count);
+    if (result && grow_indices) {
+        const auto capacity = index_allocator_.get_capacity();
+        const auto new_capacity = get_grown_capacity(capacity, index_count);
+        auto index_buffer = Buffer::create_with_data(
+                GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW, nullptr, sizeof(uint32_t), new_capacity
+        );
+        result = index_buffer != nullptr;
+        if (result) {
+            copy_buffer(*index_buffer_, *index_buffer, 0, 0, capacity * sizeof(uint32_t));
+            index_buffer_ = std::move(index_buffer);
+            index_allocator_.grow(new_capacity);
+            SPDLOG_INFO("GeometryPool index buffer has grown: {} -> {} indices", capacity, new_capacity);
+        }
+    }
+    set_attribs();
+    return result;
+}
@@ -0,0 +1,357 @@
+#include "glex/gl_state_cache.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include "glex/common.h"
+
+namespace {
+
+    /// Value of state that has not been set through the cache yet.
+    constexpr uint32_t UNKNOWN = std::numeric_limits<uint32_t>::max();
+
+    /// Generic buffer binding points tracked by the cache.
+    constexpr std::array<GLenum, 8> BUFFER_TARGETS{
+            GL_ARRAY_BUFFER,     GL_UNIFORM_BUFFER,    GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER,
+            GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GL_TEXTURE_BUFFER,    GL_TRANSFORM_FEEDBACK_BUFFER,
+    };
+
+    /// Capabilities tracked by the cache.
+    constexpr std::array<GLenum, 8> CAPABILITIES{
+            GL_DEPTH_TEST,   GL_CULL_FACE,   GL_BLEND,
+            GL_STENCIL_TEST, GL_SCISSOR_TEST, GL_MULTISAMPLE,
+            GL_TEXTURE_CUBE_MAP_SEAMLESS, GL_POLYGON_OFFSET_FILL,
+    };
+
+    struct State {
+        uint32_t program{UNKNOWN};
+        uint32_t vertex_array{UNKNOWN};
+        uint32_t read_framebuffer{UNKNOWN};
+        uint32_t draw_framebuffer{UNKNOWN};
+        uint32_t active_texture_unit{UNKNOWN};
+        std::array<uint32_t, GLStateCache::MAX_TEXTURE_UNITS> textures_2d{};
+        std::array<uint32_t, GLStateCache::MAX_TEXTURE_UNITS> cube_textures{};
+        std::array<uint32_t, GLStateCache::MAX_TEXTURE_UNITS> samplers{};
+        std::array<uint32_t, BUFFER_TARGETS.size()> buffers{};
+        std::array<uint32_t, GLStateCache::MAX_UNIFORM_BUFFER_BINDINGS> uniform_buffers{};
+        std::array<int32_t, 4> viewport{-1, -1, -1, -1};
+        std::array<uint32_t, CAPABILITIES.size()> capabilities{};
+        uint32_t depth_func{UNKNOWN};
+        uint32_t depth_mask{UNKNOWN};
+        std::array<uint32_t, 4> color_mask{UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN};
+        uint32_t cull_face{UNKNOWN};
+        std::array<uint32_t, 2> blend_func{UNKNOWN, UNKNOWN};
+
+        State() {
+            textures_2d.fill(UNKNOWN);
+            cube_textures.fill(UNKNOWN);
+            samplers.fill(UNKNOWN);
+            buffers.fill(UNKNOWN);
+            uniform_buffers.fill(UNKNOWN);
+            capabilities.fill(UNKNOWN);
+        }
+    };
+
+    State state;
+    GLStateCache::Stats stats;
+
+    /// Stores the new value of a state.
+    ///
+    /// @returns `true` if the state changes and the call must be issued, `false` if it can be skipped.
+    template<typename T>
+    bool update(T &cached, const T &value) {
+        if (cached == value) {
+            ++stats.skipped;
+            return false;
+        }
+        cached = value;
+        ++stats.issued;
+        return true;
+    }
+
+    /// Counts a call that the cache does not track.
+    void pass_through() {
+        ++stats.issued;
+    }
+
+    std::optional<size_t> get_buffer_slot(const GLenum target) {
+        for (size_t i = 0; i < BUFFER_TARGETS.size(); ++i) {
+            if (BUFFER_TARGETS[i] == target) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<size_t> get_capability_slot(const GLenum capability) {
+        for (size_t i = 0; i < CAPABILITIES.size(); ++i) {
+            if (CAPABILITIES[i] == capability) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /// @returns The bindings of the texture target on every unit, or `nullptr` if the target is not tracked.
+    std::array<uint32_t, GLStateCache::MAX_TEXTURE_UNITS> *get_texture_bindings(const GLenum target) {
+        switch (target) {
+        case GL_TEXTURE_2D: return &state.textures_2d;
+        case GL_TEXTURE_CUBE_MAP: return &state.cube_textures;
+        default: return nullptr;
+        }
+    }
+
+    void set_capability(const GLenum capability, const bool enabled) {
+        if (const auto slot = get_capability_slot(capability)) {
+            if (!update(state.capabilities[*slot], static_cast<uint32_t>(enabled))) {
+                return;
+            }
+        } else {
+            pass_through();
+        }
+        if (enabled) {
+            glEnable(capability);
+        } else {
+            glDisable(capability);
+        }
+    }
+
+    template<size_t N>
+    void forget(std::array<uint32_t, N> &bindings, const uint32_t object) {
+        for (auto &binding : bindings) {
+            if (binding == object) {
+                binding = 0;
+            }
+        }
+    }
+
+} // namespace
+
+void GLStateCache::use_program(const uint32_t program) {
+    if (update(state.program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void GLStateCache::bind_vertex_array(const uint32_t vertex_array) {
+    if (update(state.vertex_array, vertex_array)) {
+        glBindVertexArray(vertex_array);
+    }
+}
+
+void GLStateCache::bind_framebuffer(const GLenum target, const uint32_t framebuffer) {
+    switch (target) {
+    case GL_READ_FRAMEBUFFER:
+        if (update(state.read_framebuffer, framebuffer)) {
+            glBindFramebuffer(target, framebuffer);
+        }
+        return;
+    case GL_DRAW_FRAMEBUFFER:
+        if (update(state.draw_framebuffer, framebuffer)) {
+            glBindFramebuffer(target, framebuffer);
+        }
+        return;
+    default:
+        if (state.read_framebuffer == framebuffer && state.draw_framebuffer == framebuffer) {
+            ++stats.skipped;
+            return;
+        }
+        state.read_framebuffer = framebuffer;
+        state.draw_framebuffer = framebuffer;
+        ++stats.issued;
+        glBindFramebuffer(target, framebuffer);
+    }
+}
+
+void GLStateCache::active_texture(const uint32_t texture_unit) {
+    if (update(state.active_texture_unit, texture_unit)) {
+        glActiveTexture(GL_TEXTURE0 + texture_unit);
+    }
+}
+
+void GLStateCache::bind_texture(const GLenum target, const uint32_t texture) {
+    const auto bindings = get_texture_bindings(target);
+    if (bindings && state.active_texture_unit < MAX_TEXTURE_UNITS) {
+        if (!update((*bindings)[state.active_texture_unit], texture)) {
+            return;
+        }
+    } else {
+        pass_through();
+    }
+    glBindTexture(target, texture);
+}
+
+void GLStateCache::bind_texture_to_unit(const uint32_t texture_unit, const GLenum target, const uint32_t texture) {
+    if (const auto bindings = get_texture_bindings(target); bindings && texture_unit < MAX_TEXTURE_UNITS) {
+        if ((*bindings)[texture_unit] == texture) {
+            // Leave the active texture unit as it is.
+            ++stats.skipped;
+            return;
+        }
+    }
+    active_texture(texture_unit);
+    bind_texture(target, texture);
+}
+
+void GLStateCache::bind_sampler(const uint32_t texture_unit, const uint32_t sampler) {
+    if (texture_unit < MAX_TEXTURE_UNITS) {
+        if (!update(state.samplers[texture_unit], sampler)) {
+            return;
+        }
+    } else {
+        pass_through();
+    }
+    glBindSampler(texture_unit, sampler);
+}
+
+void GLStateCache::bind_buffer(const GLenum target, const uint32_t buffer) {
+    if (const auto slot = get_buffer_slot(target)) {
+        if (!update(state.buffers[*slot], buffer)) {
+            return;
+        }
+    } else {
+        pass_through();
+    }
+    glBindBuffer(target, buffer);
+}
+
+void GLStateCache::bind_buffer_base(const GLenum target, const uint32_t index, const uint32_t buffer) {
+    if (target == GL_UNIFORM_BUFFER && index < MAX_UNIFORM_BUFFER_BINDINGS) {
+        if (!update(state.uniform_buffers[index], buffer)) {
+            return;
+        }
+    } else {
+        pass_through();
+    }
+    glBindBufferBase(target, index, buffer);
+    if (const auto slot = get_buffer_slot(target)) {
+        state.buffers[*slot] = buffer;
+    }
+}
+
+void GLStateCache::bind_buffer_range(
+        const GLenum target, const uint32_t index, const uint32_t buffer, const size_t offset, const size_t size
+) {
+    pass_through();
+    glBindBufferRange(target, index, buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+    if (target == GL_UNIFORM_BUFFER && index < MAX_UNIFORM_BUFFER_BINDINGS) {
+        state.uniform_buffers[index] = UNKNOWN;
+    }
+    if (const auto slot = get_buffer_slot(target)) {
+        state.buffers[*slot] = buffer;
+    }
+}
+
+void GLStateCache::set_viewport(const int32_t x, const int32_t y, const int32_t width, const int32_t height) {
+    if (update(state.viewport, {x, y, width, height})) {
+        glViewport(x, y, width, height);
+    }
+}
+
+void GLStateCache::enable(const GLenum capability) {
+    set_capability(capability, true);
+}
+
+void GLStateCache::disable(const GLenum capability) {
+    set_capability(capability, false);
+}
+
+void GLStateCache::set_depth_func(const GLenum func) {
+    if (update(state.depth_func, static_cast<uint32_t>(func))) {
+        glDepthFunc(func);
+    }
+}
+
+void GLStateCache::set_depth_mask(const bool enabled) {
+    if (update(state.depth_mask, static_cast<uint32_t>(enabled))) {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+bool GLStateCache::get_depth_mask() {
+    if (state.depth_mask == UNKNOWN) {
+        GLboolean mask = GL_TRUE;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &mask);
+        state.depth_mask = mask == GL_TRUE;
+    }
+    return state.depth_mask != 0;
+}
+
+void GLStateCache::set_color_mask(const bool red, const bool green, const bool blue, const bool alpha) {
+    if (update(state.color_mask, {red, green, blue, alpha})) {
+        glColorMask(red, green, blue, alpha);
+    }
+}
+
+std::array<bool, 4> GLStateCache::get_color_mask() {
+    if (std::ranges::find(state.color_mask, UNKNOWN) != state.color_mask.end()) {
+        std::array<GLboolean, 4> mask{GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE};
+        glGetBooleanv(GL_COLOR_WRITEMASK, mask.data());
+        for (size_t i = 0; i < mask.size(); ++i) {
+            state.color_mask[i] = mask[i] == GL_TRUE;
+        }
+    }
+    return {state.color_mask[0] != 0, state.color_mask[1] != 0, state.color_mask[2] != 0, state.color_mask[3] != 0};
+}
+
+void GLStateCache::set_cull_face(const GLenum mode) {
+    if (update(state.cull_face, static_cast<uint32_t>(mode))) {
+        glCullFace(mode);
+    }
+}
+
+void GLStateCache::set_blend_func(const GLenum source_factor, const GLenum destination_factor) {
+    if (update(state.blend_func, {source_factor, destination_factor})) {
+        glBlendFunc(source_factor, destination_factor);
+    }
+}
+
+void GLStateCache::forget_program(const uint32_t program) {
+    // A program in use is only flagged for deletion, but its ID must not be trusted anymore.
+    if (state.program == program) {
+        state.program = UNKNOWN;
+    }
+}
+
+void GLStateCache::forget_vertex_array(const uint32_t vertex_array) {
+    if (state.vertex_array == vertex_array) {
+        state.vertex_array = 0;
+    }
+}
+
+void GLStateCache::forget_framebuffer(const uint32_t framebuffer) {
+    if (state.read_framebuffer == framebuffer) {
+        state.read_framebuffer = 0;
+    }
+    if (state.draw_framebuffer == framebuffer) {
+        state.draw_framebuffer = 0;
+    }
+}
+
+void GLStateCache::forget_texture(const uint32_t texture) {
+    forget(state.textures_2d, texture);
+    forget(state.cube_textures, texture);
+}
+
+void GLStateCache::forget_sampler(const uint32_t sampler) {
+    forget(state.samplers, sampler);
+}
+
+void GLStateCache::forget_buffer(const uint32_t buffer) {
+    forget(state.buffers, buffer);
+    forget(state.uniform_buffers, buffer);
+}
+
+void GLStateCache::invalidate() {
+    state = State{};
+}
+
+GLStateCache::Stats GLStateCache::get_stats() {
+    return stats;
+}
+
+void GLStateCache::reset_stats() {
+    stats = {};
+}
@@ -1,12 +1,18 @@
 #include "glex/image.h"
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <exception>
 #include <glm/gtc/type_ptr.hpp>
 #include <memory>
+#include <mutex>
 #include <ranges>
 #include <spdlog/spdlog.h>
+#include <string>
+#include <vector>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -27,9 +33,12 @@ namespace {
 std::unique_ptr<Image> Image::load(const std::string &filepath, const bool flip_vertical) {
     int width, height, channels;
     size_t bytes_per_channel;
-    stbi_set_flip_vertically_on_load(flip_vertical);
-    const auto ext =
-            filepath.substr(filepath.find_last_of('.')) | srv::transform(ascii_to_lower) | sr::to<std::string>();
+    // Unlike `stbi_set_flip_vertically_on_load`, this affects only the current thread.
+    stbi_set_flip_vertically_on_load_thread(flip_vertical);
+    const auto dot = filepath.find_last_of('.');
+    const auto ext = dot == std::string::npos
+                             ? std::string{}
+                             : filepath.substr(dot) | srv::transform(ascii_to_lower) | sr::to<std::string>();
     unsigned char *image;
     if (ext == ".hdr") {
         image = reinterpret_cast<unsigned char *>(stbi_loadf(filepath.c_str(), &width, &height, &channels, 0));
@@ -49,6 +58,66 @@ std::unique_ptr<Image> Image::load(const std::string &filepath, const bool flip_
     }};
 }
 
+std::vector<std::unique_ptr<Image>> Image::load_many(
+        const std::vector<std::string> &filepaths, const ImageLoadOptions &options,
+        const std::function<void(size_t index, const Image &image)> &on_loaded
+) {
+    auto &pool = options.pool ? *options.pool : ThreadPool::get_default();
+    const auto begin = std::chrono::steady_clock::now();
+
+    std::vector<std::unique_ptr<Image>> images(filepaths.size());
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<size_t> completed;
+    for (size_t i = 0; i < filepaths.size(); ++i) {
+        pool.submit([&, i] {
+            // Every index must be reported, or the calling thread would wait for it forever.
+            std::unique_ptr<Image> image;
+            try {
+                image = load(filepaths[i], options.flip_vertical);
+            } catch (const std::exception &e) {
+                SPDLOG_ERROR("Failed to load image \"{}\": {}", filepaths[i], e.what());
+            } catch (...) {
+                SPDLOG_ERROR("Failed to load image \"{}\": unknown error", filepaths[i]);
+            }
+            std::lock_guard lock{mutex};
+            images[i] = std::move(image);
+            completed.push_back(i);
+            // Notify while holding the lock, because the waiting thread may return right after waking up.
+            condition.notify_one();
+        });
+    }
+
+    // Hand images over to the calling thread as they complete.
+    size_t total_bytes = 0;
+    for (size_t done = 0; done < filepaths.size();) {
+        std::vector<size_t> ready;
+        {
+            std::unique_lock lock{mutex};
+            condition.wait(lock, [&] { return !completed.empty(); });
+            ready.swap(completed);
+        }
+        for (const auto index : ready) {
+            ++done;
+            if (!images[index]) {
+                continue;
+            }
+            total_bytes += images[index]->get_byte_size();
+            if (on_loaded) {
+                on_loaded(index, *images[index]);
+            }
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    const auto megabytes = static_cast<double>(total_bytes) / (1024.0 * 1024.0);
+    SPDLOG_INFO(
+            "Decoded {} images, {:.1f} MB in {:.1f} ms ({:.1f} MB/s, {} threads)", filepaths.size(), megabytes,
+            elapsed.count() * 1000.0, megabytes / std::max(elapsed.count(), 1e-9), pool.get_thread_count()
+    );
+    return images;
+}
+
 std::unique_ptr<Image> Image::create(size_t width, size_t height, size_t channels, size_t bytes_per_channel) {
     auto *data = static_cast<uint8_t *>(malloc(width * height * channels * bytes_per_channel));
     if (!data) {
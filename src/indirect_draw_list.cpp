@@ -0,0 +1,270 @@
+#include "glex/indirect_draw_list.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <utility>
+#include <vector>
+#include "glex/buffer.h"
+#include "glex/common.h"
+#include "glex/gl_state_cache.h"
+
+namespace {
+
+    using MultiDrawElementsIndirectProc = void(APIENTRYP)(
+            GLenum mode, GLenum type, const void *indirect, GLsizei draw_count, GLsizei stride
+    );
+
+    /// @returns `glMultiDrawElementsIndirect` from OpenGL 4.3 or `GL_ARB_multi_draw_indirect`, or `nullptr` if neither
+    /// is supported.
+    MultiDrawElementsIndirectProc get_multi_draw_elements_indirect() {
+        static const auto multi_draw_elements_indirect = []() -> MultiDrawElementsIndirectProc {
+            if (glMultiDrawElementsIndirect) {
+                return glMultiDrawElementsIndirect;
+            }
+            // The base instance offsets the draw index, so it must be honored as well.
+            if (glfwExtensionSupported("GL_ARB_multi_draw_indirect") &&
+                glfwExtensionSupported("GL_ARB_draw_indirect") && glfwExtensionSupported("GL_ARB_base_instance")) {
+                return reinterpret_cast<MultiDrawElementsIndirectProc>(
+                        glfwGetProcAddress("glMultiDrawElementsIndirect")
+                );
+            }
+            SPDLOG_INFO("Multi-draw indirect is not supported, draws are submitted one by one");
+            return nullptr;
+        }();
+        return multi_draw_elements_indirect;
+    }
+
+    /// Reallocates the buffer if it holds fewer than `count` elements, growing geometrically.
+    ///
+    /// @returns `true` if the buffer has been reallocated, `false` if it is large enough or reallocation fails.
+    bool reserve_buffer(std::unique_ptr<Buffer> &buffer, const uint32_t buffer_type, const size_t count) {
+        if (count <= buffer->get_count()) {
+            return false;
+        }
+        const auto capacity = std::max(count, buffer->get_count() * 2);
+        auto new_buffer =
+                Buffer::create_with_data(buffer_type, GL_DYNAMIC_DRAW, nullptr, buffer->get_stride(), capacity);
+        if (!new_buffer) {
+            return false;
+        }
+        buffer = std::move(new_buffer);
+        return true;
+    }
+
+} // namespace
+
+std::unique_ptr<IndirectDrawList> IndirectDrawList::create() {
+    std::unique_ptr<Buffer> command_buffer;
+    if (is_multi_draw_supported()) {
+        command_buffer = Buffer::create_with_data(
+                GL_DRAW_INDIRECT_BUFFER, GL_DYNAMIC_DRAW, nullptr, sizeof(DrawElementsIndirectCommand), 1
+        );
+        if (!command_buffer) {
+            SPDLOG_ERROR("Failed to create indirect draw list");
+            return nullptr;
+        }
+    }
+    constexpr float FIRST_DRAW_ID = 0.0f;
+    auto draw_id_buffer = Buffer::create_with_data(GL_ARRAY_BUFFER, GL_STATIC_DRAW, &FIRST_DRAW_ID, sizeof(float), 1);
+    auto draw_data_buffer = Buffer::create_with_data(GL_TEXTURE_BUFFER, GL_DYNAMIC_DRAW, nullptr, sizeof(DrawData), 1);
+    if (!draw_id_buffer || !draw_data_buffer) {
+        SPDLOG_ERROR("Failed to create indirect draw list");
+        return nullptr;
+    }
+    uint32_t draw_data_texture;
+    glGenTextures(1, &draw_data_texture);
+    GLStateCache::bind_texture_to_unit(DRAW_DATA_TEXTURE_UNIT, GL_TEXTURE_BUFFER, draw_data_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, draw_data_buffer->get());
+    SPDLOG_INFO("IndirectDrawList has been created: {}", draw_data_texture);
+    return std::unique_ptr<IndirectDrawList>{new IndirectDrawList{
+            std::move(command_buffer), std::move(draw_id_buffer), std::move(draw_data_buffer), draw_data_texture
+    }};
+}
+
+bool IndirectDrawList::is_multi_draw_supported() {
+    return get_multi_draw_elements_indirect() != nullptr;
+}
+
+IndirectDrawList::IndirectDrawList(
+        std::unique_ptr<Buffer> command_buffer, std::unique_ptr<Buffer> draw_id_buffer,
+        std::unique_ptr<Buffer> draw_data_buffer, const uint32_t draw_data_texture
+)
+    : command_buffer_{std::move(command_buffer)}
+    , draw_id_buffer_{std::move(draw_id_buffer)}
+    , draw_data_buffer_{std::move(draw_data_buffer)}
+    , draw_data_texture_{draw_data_texture} {}
+
+IndirectDrawList::~IndirectDrawList() {
+    if (draw_data_texture_) {
+        glDeleteTextures(1, &draw_data_texture_);
+        GLStateCache::forget_texture(draw_data_texture_);
+    }
+}
+
+bool IndirectDrawList::add(const Mesh &mesh, const glm::mat4 &transform, const size_t lod) {
+    const auto &pool = mesh.get_pool();
+    if (!pool || (pool_ && pool_ != pool)) {
+        SPDLOG_ERROR("Failed to add draw: the mesh is not in the geometry pool of the list");
+        return false;
+    }
+    pool_ = pool;
+    const auto &[scale, offset] = mesh.get_quantization();
+    const DrawData data{
+            .model_transform = transform,
+            .position_scale = glm::vec4{scale, 0.0f},
+            .position_offset = glm::vec4{offset, 0.0f},
+    };
+    const auto &[first_index, index_count, error] = mesh.get_lod(std::min(lod, mesh.get_lod_count() - 1));
+    draws_.push_back(
+            {mesh.get_material(), mesh.get_primitive_type(), mesh.get_pool_id(), first_index, index_count, data}
+    );
+    return true;
+}
+
+bool IndirectDrawList::add(const Model &model, const glm::mat4 &transform, const std::span<const uint32_t> lods) {
+    bool result = true;
+    for (size_t i = 0; i < model.get_mesh_count(); ++i) {
+        result = add(*model.get_mesh(i), transform, i < lods.size() ? lods[i] : 0) && result;
+    }
+    return result;
+}
+
+void IndirectDrawList::clear() {
+    draws_.clear();
+    commands_.clear();
+    batches_.clear();
+}
+
+bool IndirectDrawList::upload() {
+    commands_.clear();
+    batches_.clear();
+    if (draws_.empty()) {
+        return true;
+    }
+
+    // Group the draws so that each material is set once.
+    std::ranges::stable_sort(draws_, [](const Draw &a, const Draw &b) {
+        return std::pair{a.material.get(), a.primitive_type} < std::pair{b.material.get(), b.primitive_type};
+    });
+    std::vector<DrawData> draw_data;
+    draw_data.reserve(draws_.size());
+    commands_.reserve(draws_.size());
+    for (const auto &[material, primitive_type, pool_id, first_index, index_count, data] : draws_) {
+        const auto &range = pool_->get_range(pool_id);
+        // The base instance is the draw index, which offsets the `aDrawId` attribute.
+        commands_.push_back({
+                .count = index_count,
+                .instance_count = 1,
+                .first_index = static_cast<uint32_t>(range.index_offset + first_index),
+                .base_vertex = static_cast<int32_t>(range.vertex_offset),
+                .base_instance = static_cast<uint32_t>(draw_data.size()),
+        });
+        draw_data.push_back(data);
+        if (batches_.empty() || batches_.back().material != material ||
+            batches_.back().primitive_type != primitive_type) {
+            batches_.push_back({material, primitive_type, commands_.size() - 1, 0});
+        }
+        ++batches_.back().command_count;
+    }
+
+    if (reserve_buffer(draw_id_buffer_, GL_ARRAY_BUFFER, draws_.size())) {
+        std::vector<float> draw_ids(draw_id_buffer_->get_count());
+        std::iota(draw_ids.begin(), draw_ids.end(), 0.0f);
+        draw_id_buffer_->set_data(draw_ids.data(), draw_ids.size() * sizeof(float));
+    }
+    if (reserve_buffer(draw_data_buffer_, GL_TEXTURE_BUFFER, draw_data.size())) {
+        GLStateCache::bind_texture_to_unit(DRAW_DATA_TEXTURE_UNIT, GL_TEXTURE_BUFFER, draw_data_texture_);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, draw_data_buffer_->get());
+    }
+    if (command_buffer_) {
+        reserve_buffer(command_buffer_, GL_DRAW_INDIRECT_BUFFER, commands_.size());
+    }
+    if (draw_id_buffer_->get_count() < draws_.size() || draw_data_buffer_->get_count() < draw_data.size() ||
+        (command_buffer_ && command_buffer_->get_count() < commands_.size())) {
+        SPDLOG_ERROR("Failed to upload indirect draw list: {} draws", draws_.size());
+        commands_.clear();
+        batches_.clear();
+        return false;
+    }
+    draw_data_buffer_->set_data(draw_data.data(), draw_data.size() * sizeof(DrawData));
+    if (command_buffer_) {
+        command_buffer_->set_data(commands_.data(), commands_.size() * sizeof(DrawElementsIndirectCommand));
+    }
+    return true;
+}
+
+size_t IndirectDrawList::draw(const Program &program, const bool multi_draw) const {
+    return submit(program, batches_, multi_draw, false);
+}
+
+size_t IndirectDrawList::draw_depth(const Program &program, const bool multi_draw) const {
+    // Without materials, the batches only differ by primitive type. The commands of each batch are consecutive, so
+    // neighboring batches of the same primitive type merge into one.
+    std::vector<Batch> batches;
+    for (const auto &[material, primitive_type, first_command, command_count] : batches_) {
+        if (!batches.empty() && batches.back().primitive_type == primitive_type) {
+            batches.back().command_count += command_count;
+            continue;
+        }
+        batches.push_back({nullptr, primitive_type, first_command, command_count});
+    }
+    return submit(program, batches, multi_draw, true);
+}
+
+size_t IndirectDrawList::submit(
+        const Program &program, const std::vector<Batch> &batches, const bool multi_draw, const bool depth_only
+) const {
+    if (commands_.empty()) {
+        return 0;
+    }
+    const auto &vertex_layout = depth_only ? pool_->get_stream0_vertex_layout() : pool_->get_vertex_layout();
+    vertex_layout.bind();
+    GLStateCache::bind_texture_to_unit(DRAW_DATA_TEXTURE_UNIT, GL_TEXTURE_BUFFER, draw_data_texture_);
+    program.set_uniform("drawData", static_cast<int>(DRAW_DATA_TEXTURE_UNIT));
+
+    const auto multi_draw_elements_indirect = multi_draw ? get_multi_draw_elements_indirect() : nullptr;
+    if (multi_draw_elements_indirect) {
+        // Source `aDrawId` per instance, so that the base instance of each command selects its data.
+        draw_id_buffer_->bind();
+        vertex_layout.set_attrib(DRAW_ID_ATTRIB_INDEX, 1, GL_FLOAT, GL_FALSE, sizeof(float), 0);
+        vertex_layout.set_attrib_divisor(DRAW_ID_ATTRIB_INDEX, 1);
+        command_buffer_->bind();
+    }
+
+    size_t draw_calls = 0;
+    for (const auto &[material, primitive_type, first_command, command_count] : batches) {
+        if (material) {
+            material->set_to_program(program);
+        }
+        if (multi_draw_elements_indirect) {
+            multi_draw_elements_indirect(
+                    primitive_type, GL_UNSIGNED_INT,
+                    reinterpret_cast<const void *>(first_command * sizeof(DrawElementsIndirectCommand)),
+                    static_cast<GLsizei>(command_count), 0
+            );
+            ++draw_calls;
+            continue;
+        }
+        // Without the base instance, the disabled `aDrawId` array reads the constant value of the attribute.
+        for (size_t i = first_command; i < first_command + command_count; ++i) {
+            const auto &command = commands_[i];
+            glVertexAttrib1f(DRAW_ID_ATTRIB_INDEX, static_cast<float>(command.base_instance));
+            glDrawElementsInstancedBaseVertex(
+                    primitive_type, static_cast<GLsizei>(command.count), GL_UNSIGNED_INT,
+                    reinterpret_cast<const void *>(command.first_index * sizeof(uint32_t)),
+                    static_cast<GLsizei>(command.instance_count), command.base_vertex
+            );
+            ++draw_calls;
+        }
+    }
+
+    if (multi_draw_elements_indirect) {
+        // Leave the pool layout as `Mesh::draw` expects it.
+        vertex_layout.disable_attrib(static_cast<int>(DRAW_ID_ATTRIB_INDEX));
+    }
+    return draw_calls;
+}
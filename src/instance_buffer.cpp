@@ -0,0 +1,49 @@
+#include "glex/instance_buffer.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <spdlog/spdlog.h>
+#include "glex/buffer.h"
+#include "glex/common.h"
+
+std::unique_ptr<InstanceBuffer>
+InstanceBuffer::create(const std::span<const InstanceData> instances, const uint32_t usage) {
+    // A buffer cannot be empty, so allocate at least one instance.
+    auto buffer = Buffer::create_with_data(
+            GL_ARRAY_BUFFER, usage, instances.empty() ? nullptr : instances.data(), sizeof(InstanceData),
+            std::max<size_t>(instances.size(), 1)
+    );
+    if (!buffer) {
+        SPDLOG_ERROR("Failed to create instance buffer");
+        return nullptr;
+    }
+    SPDLOG_INFO("InstanceBuffer has been created: {} instances", instances.size());
+    return std::unique_ptr<InstanceBuffer>{new InstanceBuffer{std::move(buffer), usage, instances.size()}};
+}
+
+InstanceBuffer::InstanceBuffer(std::unique_ptr<Buffer> buffer, const uint32_t usage, const size_t count)
+    : buffer_{std::move(buffer)}
+    , usage_{usage}
+    , count_{count} {}
+
+bool InstanceBuffer::set_instances(const std::span<const InstanceData> instances) {
+    if (instances.size() > buffer_->get_count()) {
+        // Grow geometrically so that a slowly growing instance count does not reallocate every frame.
+        auto buffer = Buffer::create_with_data(
+                GL_ARRAY_BUFFER, usage_, nullptr, sizeof(InstanceData),
+                std::max(instances.size(), buffer_->get_count() * 2)
+        );
+        if (!buffer) {
+            SPDLOG_ERROR("Failed to reallocate instance buffer");
+            return false;
+        }
+        buffer_ = std::move(buffer);
+    }
+    if (!instances.empty()) {
+        buffer_->set_data(instances.data(), instances.size_bytes());
+    }
+    count_ = instances.size();
+    return true;
+}
@@ -1,8 +1,118 @@
 #include "glex/mesh.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
 #include <spdlog/spdlog.h>
+#include <utility>
+#include <vector>
 #include "glex/common.h"
+#include "glex/geometry_pool.h"
+#include "glex/mesh_lod_cache.h"
+#include "glex/mesh_simplifier.h"
+#include "glex/meshlet.h"
+#include "glex/tangents.h"
+
+namespace {
+
+    /// Attributes of `Vertex`. (position, normal, texCoord, tangent)
+    const std::vector<VertexAttrib> VERTEX_ATTRIBS{
+            {0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, position)},
+            {1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal)},
+            {2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, tex_coord)},
+            {3, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, tangent)},
+    };
+
+    /// Attributes of `PackedVertex`, read as floats through normalized integer and half-float types.
+    const std::vector<VertexAttrib> PACKED_VERTEX_ATTRIBS{
+            {0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(PackedVertex, position)},
+            {1, 2, GL_SHORT, GL_TRUE, offsetof(PackedVertex, normal)},
+            {2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, tex_coord)},
+            {3, 2, GL_SHORT, GL_TRUE, offsetof(PackedVertex, tangent)},
+    };
+
+    /// @returns The attributes of the format, with every attribute but the position moved to stream 1 if the positions
+    /// are split. The position is the first member of both vertex structures.
+    std::vector<VertexAttrib> get_vertex_attribs(const VertexFormat format, const bool split_positions) {
+        auto attribs = format == VertexFormat::Packed ? PACKED_VERTEX_ATTRIBS : VERTEX_ATTRIBS;
+        if (split_positions) {
+            const auto position_stride = Mesh::get_position_stride(format);
+            for (auto &attrib : attribs) {
+                if (attrib.offset >= position_stride) {
+                    attrib.offset -= position_stride;
+                    attrib.stream = 1;
+                }
+            }
+        }
+        return attribs;
+    }
+
+    /// @returns The size of a vertex in each stream.
+    std::vector<size_t> get_stream_strides(const VertexFormat format, const bool split_positions) {
+        const auto vertex_stride = Mesh::get_vertex_stride(format);
+        if (!split_positions) {
+            return {vertex_stride};
+        }
+        const auto position_stride = Mesh::get_position_stride(format);
+        return {position_stride, vertex_stride - position_stride};
+    }
+
+    /// Splits interleaved vertices into the position stream and the stream of the other attributes.
+    std::pair<std::vector<std::byte>, std::vector<std::byte>>
+    split_vertices(const void *vertices, const size_t vertices_size, const VertexFormat format) {
+        const auto vertex_stride = Mesh::get_vertex_stride(format);
+        const auto position_stride = Mesh::get_position_stride(format);
+        const auto attrib_stride = vertex_stride - position_stride;
+        std::vector<std::byte> positions(vertices_size * position_stride);
+        std::vector<std::byte> attribs(vertices_size * attrib_stride);
+        const auto src = static_cast<const std::byte *>(vertices);
+        for (size_t i = 0; i < vertices_size; ++i) {
+            const auto vertex = src + i * vertex_stride;
+            std::memcpy(positions.data() + i * position_stride, vertex, position_stride);
+            std::memcpy(attribs.data() + i * attrib_stride, vertex + position_stride, attrib_stride);
+        }
+        return {std::move(positions), std::move(attribs)};
+    }
+
+    /// Distance below which the bounding sphere of a mesh is treated as touching the camera.
+    constexpr float MIN_LOD_DISTANCE{1.0e-4f};
+
+    /// @returns The levels of detail of a triangle mesh from `MeshLodCache`, building and storing them on a miss.
+    LodChain get_lod_chain(
+            const std::span<const Vertex> vertices, const std::span<const uint32_t> indices, const size_t lod_count
+    ) {
+        const LodChainOptions options{.lod_count = lod_count};
+        const auto key = MeshLodCache::is_enabled() ? MeshLodCache::make_key(vertices, indices, options) : 0;
+        if (auto chain = MeshLodCache::load(key)) {
+            return std::move(*chain);
+        }
+        auto chain = build_lod_chain(vertices, indices, options);
+        MeshLodCache::store(key, chain);
+        SPDLOG_INFO(
+                "Mesh LODs have been built: {} levels, {} -> {} triangles, error {:.5f}", chain.lods.size(),
+                chain.lods.front().index_count / 3, chain.lods.back().index_count / 3, chain.lods.back().error
+        );
+        return chain;
+    }
+
+    /// Converts a value in `[-1, 1]` to a signed normalized 16-bit integer.
+    int16_t to_snorm16(const float value) {
+        return static_cast<int16_t>(std::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    /// Converts a value in `[0, 1]` to an unsigned normalized 16-bit integer.
+    uint16_t to_unorm16(const float value) {
+        return static_cast<uint16_t>(std::round(glm::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+
+} // namespace
 
 static const glm::vec2 *to_vec2(const float *p) {
     return reinterpret_cast<const glm::vec2 *>(p);
@@ -23,17 +133,7 @@ data_to_vertices(const float *vert_data, const size_t vert_len, const uint32_t *
         const auto uv = to_vec2(&vert_data[i + 6]);
         vertices.emplace_back(*coord, *norm, *uv);
     }
-    for (size_t i = 0; i < idx_len; i += 3) {
-        auto &[pos1, norm1, uv1, tan1] = vertices[idx_data[i]];
-        auto &[pos2, norm2, uv2, tan2] = vertices[idx_data[i + 1]];
-        auto &[pos3, norm3, uv3, tan3] = vertices[idx_data[i + 2]];
-        tan1 += Vertex::compute_tangent(pos1, pos2, pos3, uv1, uv2, uv3);
-        tan2 += Vertex::compute_tangent(pos2, pos1, pos3, uv2, uv1, uv3);
-        tan3 += Vertex::compute_tangent(pos3, pos1, pos2, uv3, uv1, uv2);
-    }
-    for (auto &v : vertices) {
-        v.tangent = glm::normalize(v.tangent);
-    }
+    generate_tangents(vertices, {idx_data, idx_len});
     return std::move(vertices);
 }
 
@@ -50,59 +150,244 @@ glm::vec3 Vertex::compute_tangent(
         return glm::vec3{0.0f};
     }
     float inv_det = 1.0f / det;
-    return inv_det * (delta_uv2.y * edge1 + delta_uv1.y * edge2);
+    return inv_det * (delta_uv2.y * edge1 - delta_uv1.y * edge2);
+}
+
+PositionQuantization PositionQuantization::from_bounds(const Vertex *vertices, const size_t vertices_size) {
+    if (vertices_size == 0) {
+        return {};
+    }
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{std::numeric_limits<float>::lowest()};
+    for (size_t i = 0; i < vertices_size; ++i) {
+        min = glm::min(min, vertices[i].position);
+        max = glm::max(max, vertices[i].position);
+    }
+    // A flat box would divide by zero when quantizing, so give every axis some extent.
+    return {.scale = glm::max(max - min, glm::vec3{1.0e-6f}), .offset = min};
+}
+
+BoundingBox BoundingBox::from_vertices(const Vertex *vertices, const size_t vertices_size) {
+    if (vertices_size == 0) {
+        return {};
+    }
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{std::numeric_limits<float>::lowest()};
+    for (size_t i = 0; i < vertices_size; ++i) {
+        min = glm::min(min, vertices[i].position);
+        max = glm::max(max, vertices[i].position);
+    }
+    return {.min = min, .max = max};
+}
+
+BoundingBox BoundingBox::transform(const glm::mat4 &transform) const {
+    // Each column of the transform moves the box along one axis, so the extents of the result are the sums of the
+    // absolute columns scaled by the half extents.
+    const auto center = glm::vec3{transform * glm::vec4{get_center(), 1.0f}};
+    const auto half_extent = (max - min) * 0.5f;
+    const auto extent = glm::abs(glm::vec3{transform[0]}) * half_extent.x +
+                        glm::abs(glm::vec3{transform[1]}) * half_extent.y +
+                        glm::abs(glm::vec3{transform[2]}) * half_extent.z;
+    return {.min = center - extent, .max = center + extent};
+}
+
+BoundingSphere BoundingSphere::from_vertices(const Vertex *vertices, const size_t vertices_size) {
+    if (vertices_size == 0) {
+        return {};
+    }
+    const auto center = BoundingBox::from_vertices(vertices, vertices_size).get_center();
+    float radius2 = 0.0f;
+    for (size_t i = 0; i < vertices_size; ++i) {
+        const auto offset = vertices[i].position - center;
+        radius2 = std::max(radius2, glm::dot(offset, offset));
+    }
+    return {.center = center, .radius = std::sqrt(radius2)};
+}
+
+BoundingSphere BoundingSphere::transform(const glm::mat4 &transform) const {
+    const auto scale = std::max({glm::length(glm::vec3{transform[0]}), glm::length(glm::vec3{transform[1]}),
+                                 glm::length(glm::vec3{transform[2]})});
+    return {.center = glm::vec3{transform * glm::vec4{center, 1.0f}}, .radius = radius * scale};
+}
+
+float LodView::get_projection_scale(const float fovy, const float viewport_height) {
+    return viewport_height / (2.0f * std::tan(fovy * 0.5f));
+}
+
+PackedVertex PackedVertex::pack(const Vertex &vertex, const PositionQuantization &quantization) {
+    const auto position = (vertex.position - quantization.offset) / quantization.scale;
+    return {
+            .position = {to_unorm16(position.x), to_unorm16(position.y), to_unorm16(position.z), 0},
+            .normal = encode_octahedral(vertex.normal),
+            .tex_coord = {glm::packHalf1x16(vertex.tex_coord.x), glm::packHalf1x16(vertex.tex_coord.y)},
+            .tangent = encode_octahedral(vertex.tangent),
+    };
+}
+
+glm::i16vec2 PackedVertex::encode_octahedral(const glm::vec3 &v) {
+    const auto l1_norm = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    if (l1_norm == 0.0f || std::isnan(l1_norm)) {
+        return {0, 0};
+    }
+    auto octahedron = glm::vec2{v.x, v.y} / l1_norm;
+    // Fold the lower hemisphere over the diagonals.
+    if (v.z < 0.0f) {
+        const auto sign = glm::vec2{octahedron.x >= 0.0f ? 1.0f : -1.0f, octahedron.y >= 0.0f ? 1.0f : -1.0f};
+        octahedron = (1.0f - glm::abs(glm::vec2{octahedron.y, octahedron.x})) * sign;
+    }
+    return {to_snorm16(octahedron.x), to_snorm16(octahedron.y)};
 }
 
 std::unique_ptr<Mesh> Mesh::create(
         Vertex *vertices, const size_t vertices_size, const uint32_t *indices, const size_t indices_size,
-        const uint32_t primitive_type
+        const uint32_t primitive_type, const MeshOptions &options
 ) {
     if (primitive_type == GL_TRIANGLES) {
         // Set tangents.
-        for (size_t i = 0; i < indices_size; i += 3) {
-            auto &[pos1, norm1, uv1, tan1] = vertices[indices[i]];
-            auto &[pos2, norm2, uv2, tan2] = vertices[indices[i + 1]];
-            auto &[pos3, norm3, uv3, tan3] = vertices[indices[i + 2]];
-            tan1 += Vertex::compute_tangent(pos1, pos2, pos3, uv1, uv2, uv3);
-            tan2 += Vertex::compute_tangent(pos2, pos1, pos3, uv2, uv1, uv3);
-            tan3 += Vertex::compute_tangent(pos3, pos1, pos2, uv3, uv1, uv2);
-        }
+        generate_tangents({vertices, vertices_size}, {indices, indices_size});
+    }
+    // The levels of detail follow the full mesh in the index buffer.
+    std::span<const uint32_t> index_data{indices, indices_size};
+    // Meshlets reorder the triangles of the full mesh, before the levels of detail are simplified from it.
+    std::vector<uint32_t> meshlet_indices;
+    std::vector<Meshlet> meshlets;
+    if (primitive_type == GL_TRIANGLES && options.meshlets) {
+        meshlet_indices.assign(indices, indices + indices_size);
+        meshlets = build_meshlets({vertices, vertices_size}, meshlet_indices);
+        index_data = meshlet_indices;
+        SPDLOG_INFO(
+                "Mesh meshlets have been built: {} meshlets, {:.1f} triangles/meshlet", meshlets.size(),
+                meshlets.empty() ? 0.0 : static_cast<double>(indices_size / 3) / static_cast<double>(meshlets.size())
+        );
+    }
+    LodChain lod_chain;
+    if (primitive_type == GL_TRIANGLES && options.lod_count > 1) {
+        lod_chain = get_lod_chain({vertices, vertices_size}, index_data, options.lod_count);
+        index_data = lod_chain.indices;
+    } else {
+        lod_chain.lods.push_back({
+                .first_index = 0,
+                .index_count = static_cast<uint32_t>(indices_size),
+                .error = 0.0f,
+        });
+    }
+    const auto bounding_box = BoundingBox::from_vertices(vertices, vertices_size);
+    const auto bounding_sphere = BoundingSphere::from_vertices(vertices, vertices_size);
+    const void *vertex_data = vertices;
+    std::vector<PackedVertex> packed_vertices;
+    PositionQuantization quantization{};
+    if (options.format == VertexFormat::Packed) {
+        quantization = PositionQuantization::from_bounds(vertices, vertices_size);
+        packed_vertices.reserve(vertices_size);
         for (size_t i = 0; i < vertices_size; ++i) {
-            vertices[i].tangent = glm::normalize(vertices[i].tangent);
+            packed_vertices.push_back(PackedVertex::pack(vertices[i], quantization));
         }
+        vertex_data = packed_vertices.data();
+    }
+    std::vector<const void *> vertex_streams{vertex_data};
+    std::pair<std::vector<std::byte>, std::vector<std::byte>> split_streams;
+    if (options.split_positions) {
+        split_streams = split_vertices(vertex_data, vertices_size, options.format);
+        vertex_streams = {split_streams.first.data(), split_streams.second.data()};
     }
-    // Generate VAO before generating VBO and EBO.
+    if (options.pooled) {
+        auto pool = get_geometry_pool(options.format, options.split_positions);
+        const auto pool_id = pool ? pool->allocate(vertex_streams, vertices_size, index_data.data(), index_data.size())
+                                  : std::nullopt;
+        if (!pool_id) {
+            SPDLOG_ERROR("Failed to create mesh");
+            return nullptr;
+        }
+        SPDLOG_INFO("Mesh has been created: pooled");
+        return std::unique_ptr<Mesh>{new Mesh{
+                primitive_type, pool, *pool_id, options.format, options.split_positions, quantization,
+                std::move(lod_chain.lods), bounding_box, bounding_sphere, std::move(meshlets)
+        }};
+    }
+    // Generate VAOs before generating VBOs and EBO.
     auto vertex_layout = VertexLayout::create();
-    if (!vertex_layout) {
+    auto position_layout = options.split_positions ? VertexLayout::create() : nullptr;
+    if (!vertex_layout || (options.split_positions && !position_layout)) {
         SPDLOG_ERROR("Failed to create mesh");
         return nullptr;
     }
-    // Generate VBO from vertices.
-    const std::shared_ptr vertex_buffer =
-            Buffer::create_with_data(GL_ARRAY_BUFFER, GL_STATIC_DRAW, vertices, sizeof(Vertex), vertices_size);
-    if (!vertex_buffer) {
-        SPDLOG_ERROR("Failed to create mesh");
-        return nullptr;
+    vertex_layout->bind();
+    // Generate a VBO per stream.
+    const auto strides = get_stream_strides(options.format, options.split_positions);
+    std::vector<std::shared_ptr<Buffer>> vertex_buffers;
+    for (size_t i = 0; i < strides.size(); ++i) {
+        const std::shared_ptr vertex_buffer = Buffer::create_with_data(
+                GL_ARRAY_BUFFER, GL_STATIC_DRAW, vertex_streams[i], strides[i], vertices_size
+        );
+        if (!vertex_buffer) {
+            SPDLOG_ERROR("Failed to create mesh");
+            return nullptr;
+        }
+        vertex_buffers.push_back(vertex_buffer);
     }
     // Generate EBO from indices.
-    const std::shared_ptr index_buffer =
-            Buffer::create_with_data(GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW, indices, sizeof(uint32_t), indices_size);
+    const std::shared_ptr index_buffer = Buffer::create_with_data(
+            GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW, index_data.data(), sizeof(uint32_t), index_data.size()
+    );
     if (!index_buffer) {
         SPDLOG_ERROR("Failed to create mesh");
         return nullptr;
     }
-    // Enable VAO attribute. (position, normal, texCoord, tangent)
-    vertex_layout->set_attrib(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
-    vertex_layout->set_attrib(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, normal));
-    vertex_layout->set_attrib(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, tex_coord));
-    vertex_layout->set_attrib(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, tangent));
+    // Enable VAO attributes.
+    const auto attribs = get_vertex_attribs(options.format, options.split_positions);
+    for (const auto &[index, count, type, normalized, offset, stream] : attribs) {
+        vertex_buffers[stream]->bind();
+        vertex_layout->set_attrib(index, count, type, normalized, strides[stream], offset);
+    }
+    if (position_layout) {
+        // The position VAO reads stream 0 with the same EBO.
+        const auto &[index, count, type, normalized, offset, stream] = attribs.front();
+        position_layout->bind();
+        vertex_buffers.front()->bind();
+        position_layout->set_attrib(index, count, type, normalized, strides.front(), offset);
+        index_buffer->bind();
+    }
     SPDLOG_INFO("Mesh has been created");
-    return std::unique_ptr<Mesh>{new Mesh{primitive_type, std::move(vertex_layout), vertex_buffer, index_buffer}};
+    return std::unique_ptr<Mesh>{new Mesh{
+            primitive_type, std::move(vertex_layout), vertex_buffers.back(), std::move(position_layout),
+            options.split_positions ? vertex_buffers.front() : nullptr, index_buffer, options.format, quantization,
+            vertices_size, std::move(lod_chain.lods), bounding_box, bounding_sphere, std::move(meshlets)
+    }};
 }
 
-std::unique_ptr<Mesh>
-Mesh::create(std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, const uint32_t primitive_type) {
-    return create(vertices.data(), vertices.size(), indices.data(), indices.size(), primitive_type);
+std::unique_ptr<Mesh> Mesh::create(
+        std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, const uint32_t primitive_type,
+        const MeshOptions &options
+) {
+    return create(vertices.data(), vertices.size(), indices.data(), indices.size(), primitive_type, options);
+}
+
+std::shared_ptr<GeometryPool> Mesh::get_geometry_pool(const VertexFormat format, const bool split_positions) {
+    // Holding the pools weakly releases them with the last pooled mesh, while the GL context is still alive.
+    static std::array<std::weak_ptr<GeometryPool>, 4> shared_pools;
+    auto &shared_pool = shared_pools[static_cast<size_t>(format) * 2 + split_positions];
+    if (auto pool = shared_pool.lock()) {
+        return pool;
+    }
+    const std::shared_ptr pool = GeometryPool::create(
+            get_vertex_attribs(format, split_positions), get_stream_strides(format, split_positions)
+    );
+    shared_pool = pool;
+    return pool;
+}
+
+size_t Mesh::get_vertex_stride(const VertexFormat format) {
+    return format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+size_t Mesh::get_position_stride(const VertexFormat format) {
+    return format == VertexFormat::Packed ? sizeof(PackedVertex::position) : sizeof(Vertex::position);
+}
+
+Mesh::~Mesh() {
+    if (pool_) {
+        pool_->free(pool_id_);
+    }
 }
 
 std::unique_ptr<Mesh> Mesh::create_cube() {
@@ -159,7 +444,8 @@ std::unique_ptr<Mesh> Mesh::create_plain() {
     );
 }
 
-std::unique_ptr<Mesh> Mesh::create_sphere(const size_t lati_segment, const size_t longi_segment) {
+std::unique_ptr<Mesh>
+Mesh::create_sphere(const size_t lati_segment, const size_t longi_segment, const MeshOptions &options) {
     std::vector<Vertex> vertices;
     std::vector<uint32_t> indices;
 
@@ -194,25 +480,215 @@ std::unique_ptr<Mesh> Mesh::create_sphere(const size_t lati_segment, const size_
         }
     }
 
-    return create(vertices, indices, GL_TRIANGLES);
+    return create(vertices, indices, GL_TRIANGLES, options);
 }
 
-void Mesh::draw(const Program &program) const {
-    vertex_layout_->bind();
+size_t Mesh::select_lod(const glm::mat4 &transform, const LodView &view, const size_t current_lod) const {
+    if (lods_.size() == 1) {
+        return 0;
+    }
+    // The error scales with the largest axis of the transform, and is projected at the nearest point of the sphere.
+    const auto scale = std::max({glm::length(glm::vec3{transform[0]}), glm::length(glm::vec3{transform[1]}),
+                                 glm::length(glm::vec3{transform[2]})});
+    const auto center = glm::vec3{transform * glm::vec4{bounding_sphere_.center, 1.0f}};
+    const auto distance =
+            std::max(glm::distance(center, view.camera_pos) - bounding_sphere_.radius * scale, MIN_LOD_DISTANCE);
+    const auto pixels_per_unit = view.projection_scale * scale / distance;
+    size_t lod = 0;
+    for (size_t i = 1; i < lods_.size(); ++i) {
+        const auto hysteresis = i <= current_lod ? view.hysteresis : -view.hysteresis;
+        const auto threshold = view.max_screen_error * (1.0f + hysteresis);
+        if (lods_[i].error * pixels_per_unit > threshold) {
+            break;
+        }
+        lod = i;
+    }
+    return lod;
+}
+
+void Mesh::draw(const Program &program, const size_t lod) const {
     if (material_) {
         material_->set_to_program(program);
     }
-    glDrawElements(primitive_type_, index_buffer_->get_count(), GL_UNSIGNED_INT, nullptr);
+    draw_geometry(program, lod);
+}
+
+void Mesh::draw_geometry(const Program &program, const size_t lod) const {
+    if (pool_) {
+        pool_->bind();
+    } else {
+        vertex_layout_->bind();
+    }
+    set_quantization_to_program(program);
+    draw_lod(lod);
+}
+
+DrawCommand Mesh::get_draw_command(const size_t lod) const {
+    const auto &[first_index, index_count, error] = lods_[std::min(lod, lods_.size() - 1)];
+    DrawCommand command{
+            .vertex_array = get_vertex_layout()->get(),
+            .primitive_type = primitive_type_,
+            .index_count = index_count,
+            .first_index = first_index,
+            .base_vertex = 0,
+            .quantization = std::nullopt,
+    };
+    if (vertex_format_ == VertexFormat::Packed) {
+        command.quantization = quantization_;
+    }
+    if (pool_) {
+        const auto &range = pool_->get_range(pool_id_);
+        command.first_index += static_cast<uint32_t>(range.index_offset);
+        command.base_vertex = static_cast<int32_t>(range.vertex_offset);
+    }
+    return command;
+}
+
+void Mesh::draw_instanced(const Program &program, const InstanceBuffer &instances) const {
+    if (instances.get_count() == 0) {
+        return;
+    }
+    const auto &vertex_layout = *get_vertex_layout();
+    vertex_layout.bind();
+    if (material_) {
+        material_->set_to_program(program);
+    }
+    set_quantization_to_program(program);
+    // Point the instance attributes at the buffer. A `mat4` attribute takes four consecutive locations.
+    instances.get_buffer().bind();
+    constexpr auto INDEX = InstanceBuffer::ATTRIB_INDEX;
+    for (uint32_t column = 0; column < 4; ++column) {
+        vertex_layout.set_attrib(
+                INDEX + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                offsetof(InstanceData, model_transform) + sizeof(glm::vec4) * column
+        );
+    }
+    vertex_layout.set_attrib(INDEX + 4, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), offsetof(InstanceData, params));
+    for (uint32_t i = 0; i < InstanceBuffer::ATTRIB_COUNT; ++i) {
+        vertex_layout.set_attrib_divisor(INDEX + i, 1);
+    }
+    draw_lod(0, instances.get_count());
+    // Leave the layout as `Mesh::draw` expects it, without arrays sourced from the instance buffer.
+    for (uint32_t i = 0; i < InstanceBuffer::ATTRIB_COUNT; ++i) {
+        vertex_layout.disable_attrib(static_cast<int>(INDEX + i));
+    }
+}
+
+void Mesh::draw_depth(const Program &program, const size_t lod) const {
+    if (pool_) {
+        pool_->bind_stream0();
+    } else {
+        (position_layout_ ? position_layout_ : vertex_layout_)->bind();
+    }
+    set_quantization_to_program(program);
+    draw_lod(lod);
+}
+
+void Mesh::draw_meshlets(const Program &program, const std::span<const uint32_t> visible) const {
+    if (visible.empty()) {
+        return;
+    }
+    if (pool_) {
+        pool_->bind();
+    } else {
+        vertex_layout_->bind();
+    }
+    if (material_) {
+        material_->set_to_program(program);
+    }
+    set_quantization_to_program(program);
+    size_t index_offset = 0;
+    GLint base_vertex = 0;
+    if (pool_) {
+        const auto &range = pool_->get_range(pool_id_);
+        index_offset = range.index_offset;
+        base_vertex = static_cast<GLint>(range.vertex_offset);
+    }
+    // Merge the meshlets that follow each other in the index buffer, which is most of them if few are culled.
+    std::vector<GLsizei> counts;
+    std::vector<const void *> offsets;
+    uint32_t range_end = 0;
+    for (const auto i : visible) {
+        const auto &meshlet = meshlets_[i];
+        if (!counts.empty() && meshlet.first_index == range_end) {
+            counts.back() += static_cast<GLsizei>(meshlet.index_count);
+        } else {
+            counts.push_back(static_cast<GLsizei>(meshlet.index_count));
+            offsets.push_back(reinterpret_cast<const void *>((index_offset + meshlet.first_index) * sizeof(uint32_t)));
+        }
+        range_end = meshlet.first_index + meshlet.index_count;
+    }
+    const std::vector base_vertices(counts.size(), base_vertex);
+    glMultiDrawElementsBaseVertex(
+            primitive_type_, counts.data(), GL_UNSIGNED_INT, offsets.data(), static_cast<GLsizei>(counts.size()),
+            base_vertices.data()
+    );
+}
+
+void Mesh::draw_lod(const size_t lod, const size_t instance_count) const {
+    const auto &[first_index, index_count, error] = lods_[std::min(lod, lods_.size() - 1)];
+    if (pool_) {
+        pool_->draw_indices(pool_id_, primitive_type_, first_index, index_count, instance_count);
+        return;
+    }
+    const auto offset = reinterpret_cast<const void *>(first_index * sizeof(uint32_t));
+    if (instance_count == 1) {
+        glDrawElements(primitive_type_, static_cast<GLsizei>(index_count), GL_UNSIGNED_INT, offset);
+    } else {
+        glDrawElementsInstanced(
+                primitive_type_, static_cast<GLsizei>(index_count), GL_UNSIGNED_INT, offset,
+                static_cast<GLsizei>(instance_count)
+        );
+    }
 }
 
 Mesh::Mesh(
         const uint32_t primitive_type, std::unique_ptr<VertexLayout> &&vertex_layout,
-        const std::shared_ptr<Buffer> &vertex_buffer, const std::shared_ptr<Buffer> &index_buffer
+        const std::shared_ptr<Buffer> &vertex_buffer, std::unique_ptr<VertexLayout> &&position_layout,
+        const std::shared_ptr<Buffer> &position_buffer, const std::shared_ptr<Buffer> &index_buffer,
+        const VertexFormat vertex_format, const PositionQuantization &quantization, const size_t vertex_count,
+        std::vector<MeshLod> &&lods, const BoundingBox &bounding_box, const BoundingSphere &bounding_sphere,
+        std::vector<Meshlet> &&meshlets
 )
     : primitive_type_{primitive_type}
     , vertex_layout_{std::move(vertex_layout)}
     , vertex_buffer_{vertex_buffer}
-    , index_buffer_{index_buffer} {}
+    , position_layout_{std::move(position_layout)}
+    , position_buffer_{position_buffer}
+    , index_buffer_{index_buffer}
+    , vertex_format_{vertex_format}
+    , split_positions_{position_buffer != nullptr}
+    , quantization_{quantization}
+    , vertex_count_{vertex_count}
+    , lods_{std::move(lods)}
+    , bounding_box_{bounding_box}
+    , bounding_sphere_{bounding_sphere}
+    , meshlets_{std::move(meshlets)} {}
+
+Mesh::Mesh(
+        const uint32_t primitive_type, const std::shared_ptr<GeometryPool> &pool, const uint32_t pool_id,
+        const VertexFormat vertex_format, const bool split_positions, const PositionQuantization &quantization,
+        std::vector<MeshLod> &&lods, const BoundingBox &bounding_box, const BoundingSphere &bounding_sphere,
+        std::vector<Meshlet> &&meshlets
+)
+    : primitive_type_{primitive_type}
+    , pool_{pool}
+    , pool_id_{pool_id}
+    , vertex_format_{vertex_format}
+    , split_positions_{split_positions}
+    , quantization_{quantization}
+    , vertex_count_{pool->get_range(pool_id).vertex_count}
+    , lods_{std::move(lods)}
+    , bounding_box_{bounding_box}
+    , bounding_sphere_{bounding_sphere}
+    , meshlets_{std::move(meshlets)} {}
+
+void Mesh::set_quantization_to_program(const Program &program) const {
+    if (vertex_format_ == VertexFormat::Packed) {
+        program.set_uniform("positionScale", quantization_.scale);
+        program.set_uniform("positionOffset", quantization_.offset);
+    }
+}
 
 void Material::set_to_program(const Program &program) const {
     int texture_count = 0;
@@ -0,0 +1,107 @@
+#include "glex/mesh_lod_cache.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <vector>
+#include "glex/blob_cache.h"
+#include "glex/common.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    /// Changes whenever the simplifier produces different levels for the same input or the layout of the data
+    /// changes, which invalidates stored files.
+    constexpr uint32_t CACHE_FILE_VERSION = 2;
+
+    /// The start of the data of a file, followed by the levels and the indices.
+    struct LodChainHeader {
+        uint64_t lod_count;
+        uint64_t index_count;
+    };
+
+    BlobCache cache{"Mesh LOD cache", ".lod", 0x444f4c47}; // "GLOD"
+
+} // namespace
+
+void MeshLodCache::set_directory(const fs::path &directory) {
+    cache.set_directory(directory);
+}
+
+bool MeshLodCache::is_enabled() {
+    return cache.is_enabled();
+}
+
+uint64_t MeshLodCache::make_key(
+        const std::span<const Vertex> vertices, const std::span<const uint32_t> indices, const LodChainOptions &options
+) {
+    const uint64_t header[] = {CACHE_FILE_VERSION, vertices.size(), indices.size(), options.lod_count};
+    auto hash = hash_bytes(header, sizeof(header));
+    hash = hash_bytes(&options.reduction, sizeof(options.reduction), hash);
+    hash = hash_bytes(vertices.data(), vertices.size_bytes(), hash);
+    return hash_bytes(indices.data(), indices.size_bytes(), hash);
+}
+
+std::optional<LodChain> MeshLodCache::load(const uint64_t key) {
+    const auto blob = cache.load(key);
+    if (!blob) {
+        return std::nullopt;
+    }
+    const auto &[version, data] = *blob;
+    LodChainHeader header{};
+    LodChain chain;
+    if (version == CACHE_FILE_VERSION && data.size() >= sizeof(header)) {
+        std::memcpy(&header, data.data(), sizeof(header));
+    }
+    const auto lods_size = header.lod_count * sizeof(MeshLod);
+    const auto indices_size = header.index_count * sizeof(uint32_t);
+    // The counts are bounded first, so that a corrupted header cannot wrap the sizes around.
+    bool valid = header.lod_count > 0 && header.lod_count <= data.size() && header.index_count <= data.size() &&
+                 data.size() == sizeof(header) + lods_size + indices_size;
+    if (valid) {
+        chain.lods.resize(header.lod_count);
+        chain.indices.resize(header.index_count);
+        std::memcpy(chain.lods.data(), data.data() + sizeof(header), lods_size);
+        std::memcpy(chain.indices.data(), data.data() + sizeof(header) + lods_size, indices_size);
+    }
+    // Every level must lie inside the stored indices, or drawing it would read past the index buffer.
+    for (const auto &[first_index, index_count, error] : chain.lods) {
+        valid = valid && static_cast<size_t>(first_index) + index_count <= chain.indices.size();
+    }
+    if (!valid) {
+        SPDLOG_WARN("Ignore corrupted mesh LOD cache: \"{}\"", cache.get_path(key).string());
+        cache.add_miss();
+        return std::nullopt;
+    }
+    cache.add_hit();
+    SPDLOG_DEBUG("Mesh LODs have been loaded: \"{}\"", cache.get_path(key).string());
+    return chain;
+}
+
+void MeshLodCache::store(const uint64_t key, const LodChain &chain) {
+    if (!cache.is_enabled()) {
+        return;
+    }
+    const LodChainHeader header{.lod_count = chain.lods.size(), .index_count = chain.indices.size()};
+    const auto lods_size = chain.lods.size() * sizeof(MeshLod);
+    const auto indices_size = chain.indices.size() * sizeof(uint32_t);
+    std::vector<char> data(sizeof(header) + lods_size + indices_size);
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), chain.lods.data(), lods_size);
+    std::memcpy(data.data() + sizeof(header) + lods_size, chain.indices.data(), indices_size);
+    if (const auto path = cache.store(key, CACHE_FILE_VERSION, data)) {
+        SPDLOG_DEBUG("Mesh LODs have been stored: \"{}\", {} levels", path->string(), chain.lods.size());
+    }
+}
+
+size_t MeshLodCache::get_hit_count() {
+    return cache.get_hit_count();
+}
+
+size_t MeshLodCache::get_miss_count() {
+    return cache.get_miss_count();
+}
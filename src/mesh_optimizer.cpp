@@ -0,0 +1,319 @@
+#include "glex/mesh_optimizer.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "glex/common.h"
+
+namespace {
+
+    constexpr uint32_t INVALID_INDEX{std::numeric_limits<uint32_t>::max()};
+
+    /// The bits of a vertex, so that welding compares and hashes them exactly.
+    using VertexBits = std::array<uint32_t, sizeof(Vertex) / sizeof(uint32_t)>;
+    static_assert(sizeof(Vertex) == sizeof(VertexBits), "Vertex must have no padding");
+
+    VertexBits to_bits(const Vertex &vertex) {
+        VertexBits bits;
+        std::memcpy(bits.data(), &vertex, sizeof(Vertex));
+        return bits;
+    }
+
+    /// `hash_bytes` over the bits of a vertex.
+    struct VertexBitsHash {
+        size_t operator()(const VertexBits &bits) const {
+            return static_cast<size_t>(hash_bytes(bits.data(), sizeof(bits)));
+        }
+    };
+
+    /// A FIFO post-transform vertex cache, simulated with the time each vertex entered it. The time advances on every
+    /// miss, so a vertex is in the cache while fewer than `cache_size` vertices entered after it.
+    class FifoCache {
+        std::vector<size_t> entry_times_;
+        const size_t cache_size_;
+        size_t time_;
+
+    public:
+        FifoCache(const size_t vertex_count, const size_t cache_size)
+            : entry_times_(vertex_count, 0)
+            , cache_size_{cache_size}
+            , time_{cache_size + 1} {}
+
+        /// @returns `true` if the vertex missed the cache and has been transformed.
+        bool access(const uint32_t vertex) {
+            if (time_ - entry_times_[vertex] > cache_size_) {
+                entry_times_[vertex] = time_++;
+                return true;
+            }
+            return false;
+        }
+
+        /// @returns The number of vertices of a triangle that missed the cache.
+        size_t access_triangle(const uint32_t *triangle) {
+            return access(triangle[0]) + access(triangle[1]) + access(triangle[2]);
+        }
+
+        void clear() {
+            time_ += cache_size_ + 1;
+        }
+    };
+
+    /// @returns The number of cache misses of the triangles in `[first, last)` from an empty cache.
+    size_t
+    count_misses(const std::span<const uint32_t> indices, FifoCache &cache, const size_t first, const size_t last) {
+        cache.clear();
+        size_t misses = 0;
+        for (size_t triangle = first; triangle < last; ++triangle) {
+            misses += cache.access_triangle(&indices[triangle * 3]);
+        }
+        return misses;
+    }
+
+} // namespace
+
+VertexCacheStats
+analyze_vertex_cache(const std::span<const uint32_t> indices, const size_t vertex_count, const size_t cache_size) {
+    const auto triangle_count = indices.size() / 3;
+    if (triangle_count == 0) {
+        return {};
+    }
+    FifoCache cache{vertex_count, cache_size};
+    const auto misses = count_misses(indices, cache, 0, triangle_count);
+    std::vector<bool> referenced(vertex_count, false);
+    for (const auto index : indices) {
+        referenced[index] = true;
+    }
+    const auto referenced_count = std::count(referenced.begin(), referenced.end(), true);
+    return {
+            .acmr = static_cast<float>(misses) / static_cast<float>(triangle_count),
+            .atvr = static_cast<float>(misses) / static_cast<float>(referenced_count),
+    };
+}
+
+void weld_vertices(std::vector<Vertex> &vertices, const std::span<uint32_t> indices) {
+    std::unordered_map<VertexBits, uint32_t, VertexBitsHash> unique_indices;
+    unique_indices.reserve(vertices.size());
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const auto [it, inserted] = unique_indices.try_emplace(to_bits(vertices[i]), welded.size());
+        if (inserted) {
+            welded.push_back(vertices[i]);
+        }
+        remap[i] = it->second;
+    }
+    for (auto &index : indices) {
+        index = remap[index];
+    }
+    vertices = std::move(welded);
+}
+
+void optimize_vertex_cache(const std::span<uint32_t> indices, const size_t vertex_count, const size_t cache_size) {
+    const auto triangle_count = indices.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+    // Triangles around each vertex in compressed rows, and the number of them not yet emitted.
+    std::vector<uint32_t> live_counts(vertex_count, 0);
+    for (size_t i = 0; i < triangle_count * 3; ++i) {
+        ++live_counts[indices[i]];
+    }
+    std::vector<uint32_t> offsets(vertex_count + 1, 0);
+    std::inclusive_scan(live_counts.begin(), live_counts.end(), offsets.begin() + 1);
+    std::vector<uint32_t> adjacency(triangle_count * 3);
+    std::vector<uint32_t> cursors{offsets.begin(), offsets.end() - 1};
+    for (size_t i = 0; i < triangle_count * 3; ++i) {
+        adjacency[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<size_t> entry_times(vertex_count, 0);
+    size_t time = cache_size + 1;
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<uint32_t> output;
+    output.reserve(triangle_count * 3);
+    std::vector<uint32_t> dead_ends;
+    dead_ends.reserve(triangle_count * 3);
+    std::vector<uint32_t> candidates;
+    size_t scan_cursor = 0;
+
+    auto fan = indices[0];
+    while (fan != INVALID_INDEX) {
+        // Emit every remaining triangle around the fanning vertex.
+        candidates.clear();
+        for (auto i = offsets[fan]; i < offsets[fan + 1]; ++i) {
+            const auto triangle = adjacency[i];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = true;
+            for (size_t corner = 0; corner < 3; ++corner) {
+                const auto vertex = indices[triangle * 3 + corner];
+                output.push_back(vertex);
+                dead_ends.push_back(vertex);
+                candidates.push_back(vertex);
+                --live_counts[vertex];
+                if (time - entry_times[vertex] > cache_size) {
+                    entry_times[vertex] = time++;
+                }
+            }
+        }
+
+        // Fan next around the candidate that entered the cache earliest among those that stay in it while their
+        // remaining triangles are emitted.
+        fan = INVALID_INDEX;
+        size_t best_priority = 0;
+        for (const auto vertex : candidates) {
+            if (live_counts[vertex] == 0) {
+                continue;
+            }
+            const auto age = time - entry_times[vertex];
+            if (age + 2 * live_counts[vertex] <= cache_size && age > best_priority) {
+                fan = vertex;
+                best_priority = age;
+            }
+        }
+        if (fan != INVALID_INDEX) {
+            continue;
+        }
+        // At a dead end, restart from the most recently used vertex with remaining triangles, or the next one in
+        // index order.
+        while (!dead_ends.empty() && fan == INVALID_INDEX) {
+            if (live_counts[dead_ends.back()] > 0) {
+                fan = dead_ends.back();
+            }
+            dead_ends.pop_back();
+        }
+        for (; scan_cursor < vertex_count && fan == INVALID_INDEX; ++scan_cursor) {
+            if (live_counts[scan_cursor] > 0) {
+                fan = static_cast<uint32_t>(scan_cursor);
+            }
+        }
+    }
+    std::ranges::copy(output, indices.begin());
+}
+
+void optimize_overdraw(
+        const std::span<uint32_t> indices, const std::span<const Vertex> vertices, const float threshold,
+        const size_t cache_size
+) {
+    const auto triangle_count = indices.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+    FifoCache cache{vertices.size(), cache_size};
+
+    // Hard boundaries, where the cache order restarts with a triangle that misses on all three vertices.
+    std::vector<size_t> hard_boundaries;
+    for (size_t triangle = 0; triangle < triangle_count; ++triangle) {
+        if (cache.access_triangle(&indices[triangle * 3]) == 3) {
+            hard_boundaries.push_back(triangle);
+        }
+    }
+    if (hard_boundaries.empty() || hard_boundaries.front() != 0) {
+        hard_boundaries.insert(hard_boundaries.begin(), 0);
+    }
+    hard_boundaries.push_back(triangle_count);
+
+    // Soft boundaries, where the ACMR of the cluster so far has come within the threshold of the whole cluster.
+    std::vector<size_t> boundaries;
+    for (size_t i = 0; i + 1 < hard_boundaries.size(); ++i) {
+        const auto first = hard_boundaries[i];
+        const auto last = hard_boundaries[i + 1];
+        const auto acmr_limit = threshold * static_cast<float>(count_misses(indices, cache, first, last)) /
+                                static_cast<float>(last - first);
+        cache.clear();
+        boundaries.push_back(first);
+        size_t misses = 0;
+        for (auto triangle = first; triangle + 1 < last; ++triangle) {
+            misses += cache.access_triangle(&indices[triangle * 3]);
+            if (static_cast<float>(misses) <= acmr_limit * static_cast<float>(triangle + 1 - boundaries.back())) {
+                boundaries.push_back(triangle + 1);
+                cache.clear();
+                misses = 0;
+            }
+        }
+    }
+    boundaries.push_back(triangle_count);
+
+    // Area-weighted centroids and normals of the clusters and the mesh.
+    const auto cluster_count = boundaries.size() - 1;
+    std::vector<glm::vec3> centroids(cluster_count, glm::vec3{0.0f});
+    std::vector<glm::vec3> normals(cluster_count, glm::vec3{0.0f});
+    glm::vec3 mesh_centroid{0.0f};
+    float mesh_area = 0.0f;
+    for (size_t cluster = 0; cluster < cluster_count; ++cluster) {
+        float cluster_area = 0.0f;
+        for (auto triangle = boundaries[cluster]; triangle < boundaries[cluster + 1]; ++triangle) {
+            const auto &p0 = vertices[indices[triangle * 3]].position;
+            const auto &p1 = vertices[indices[triangle * 3 + 1]].position;
+            const auto &p2 = vertices[indices[triangle * 3 + 2]].position;
+            const auto normal = glm::cross(p1 - p0, p2 - p0);
+            const auto area = glm::length(normal);
+            centroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+            normals[cluster] += normal;
+            cluster_area += area;
+        }
+        mesh_centroid += centroids[cluster];
+        mesh_area += cluster_area;
+        centroids[cluster] /= std::max(cluster_area, std::numeric_limits<float>::min());
+    }
+    mesh_centroid /= std::max(mesh_area, std::numeric_limits<float>::min());
+
+    // Draw the clusters facing away from the center first, as they are likely to occlude the others.
+    std::vector<float> facing(cluster_count, 0.0f);
+    for (size_t cluster = 0; cluster < cluster_count; ++cluster) {
+        const auto length = glm::length(normals[cluster]);
+        if (length > 0.0f) {
+            facing[cluster] = glm::dot(centroids[cluster] - mesh_centroid, normals[cluster] / length);
+        }
+    }
+    std::vector<size_t> order(cluster_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, [&](const size_t a, const size_t b) { return facing[a] > facing[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(triangle_count * 3);
+    for (const auto cluster : order) {
+        output.insert(
+                output.end(), indices.begin() + boundaries[cluster] * 3, indices.begin() + boundaries[cluster + 1] * 3
+        );
+    }
+    std::ranges::copy(output, indices.begin());
+}
+
+void optimize_vertex_fetch(std::vector<Vertex> &vertices, const std::span<uint32_t> indices) {
+    std::vector<uint32_t> remap(vertices.size(), INVALID_INDEX);
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertices.size());
+    for (auto &index : indices) {
+        if (remap[index] == INVALID_INDEX) {
+            remap[index] = static_cast<uint32_t>(ordered.size());
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(ordered);
+}
+
+MeshOptimizationReport optimize_mesh(
+        std::vector<Vertex> &vertices, const std::span<uint32_t> indices, const MeshOptimizerOptions &options
+) {
+    MeshOptimizationReport report;
+    report.vertex_count_before = vertices.size();
+    report.before = analyze_vertex_cache(indices, vertices.size(), options.cache_size);
+    weld_vertices(vertices, indices);
+    optimize_vertex_cache(indices, vertices.size(), options.cache_size);
+    optimize_overdraw(indices, vertices, options.overdraw_threshold, options.cache_size);
+    optimize_vertex_fetch(vertices, indices);
+    report.vertex_count_after = vertices.size();
+    report.after = analyze_vertex_cache(indices, vertices.size(), options.cache_size);
+    return report;
+}
@@ -0,0 +1,396 @@
+#include "glex/mesh_simplifier.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <queue>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "glex/common.h"
+#include "glex/mesh_optimizer.h"
+
+namespace {
+
+    /// Relative increase of a queued cost above which the collapse is ranked again before it is applied.
+    constexpr double COST_TOLERANCE{1.0e-6};
+
+    /// The squared distances to a set of planes as a symmetric 4x4 matrix, kept as its 10 distinct coefficients.
+    struct Quadric {
+        double a00{0.0}, a01{0.0}, a02{0.0}, a03{0.0};
+        double a11{0.0}, a12{0.0}, a13{0.0};
+        double a22{0.0}, a23{0.0};
+        double a33{0.0};
+
+        /// @returns The quadric of the plane `dot(normal, p) + d = 0` with a unit normal.
+        static Quadric from_plane(const glm::vec3 &normal, const float d) {
+            const double x = normal.x, y = normal.y, z = normal.z, w = d;
+            return {x * x, x * y, x * z, x * w, y * y, y * z, y * w, z * z, z * w, w * w};
+        }
+
+        Quadric &operator+=(const Quadric &q) {
+            a00 += q.a00;
+            a01 += q.a01;
+            a02 += q.a02;
+            a03 += q.a03;
+            a11 += q.a11;
+            a12 += q.a12;
+            a13 += q.a13;
+            a22 += q.a22;
+            a23 += q.a23;
+            a33 += q.a33;
+            return *this;
+        }
+
+        /// @returns The sum of the squared distances from the point to the planes.
+        [[nodiscard]]
+        double evaluate(const glm::vec3 &point) const {
+            const double x = point.x, y = point.y, z = point.z;
+            return a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                   + 2.0 * (a03 * x + a13 * y + a23 * z) + a33;
+        }
+    };
+
+    /// Moving the vertex `from` onto the vertex `to`, which removes the triangles sharing the edge.
+    struct Collapse {
+        double cost;
+        uint32_t from;
+        uint32_t to;
+
+        friend bool operator>(const Collapse &a, const Collapse &b) {
+            return a.cost > b.cost;
+        }
+    };
+
+    /// The bits of a position, so that vertices are grouped by exactly equal positions.
+    using PositionBits = std::array<uint32_t, 3>;
+
+    /// `hash_bytes` over the bits of a position.
+    struct PositionBitsHash {
+        size_t operator()(const PositionBits &bits) const {
+            return static_cast<size_t>(hash_bytes(bits.data(), sizeof(bits)));
+        }
+    };
+
+    /// @returns The key of an undirected edge between two positions.
+    uint64_t get_edge_key(const uint32_t a, const uint32_t b) {
+        return static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+    }
+
+    /// Collapses the edges of a triangle list in the order of their quadric error, rewriting the triangles in place.
+    /// Costs only grow as quadrics are merged, so a queued collapse whose cost has grown is queued again with the new
+    /// cost instead of being updated.
+    class EdgeCollapser {
+        const std::span<const Vertex> vertices_;
+        std::vector<uint32_t> indices_;
+        std::vector<bool> removed_triangles_;
+        std::vector<bool> removed_vertices_;
+        std::vector<bool> collapsible_;
+        /// ID of the position of each vertex, shared by the vertices of a seam.
+        std::vector<uint32_t> position_ids_;
+        /// The triangles around each vertex, including removed ones until they are pruned.
+        std::vector<std::vector<uint32_t>> vertex_triangles_;
+        std::vector<Quadric> quadrics_;
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> queue_;
+        size_t index_count_;
+        double max_cost_{0.0};
+
+    public:
+        EdgeCollapser(const std::span<const Vertex> vertices, const std::span<const uint32_t> indices)
+            : vertices_{vertices}
+            , indices_(indices.begin(), indices.begin() + (indices.size() - indices.size() % 3))
+            , removed_triangles_(indices_.size() / 3, false)
+            , removed_vertices_(vertices.size(), false)
+            , collapsible_(vertices.size(), false)
+            , position_ids_(vertices.size(), 0)
+            , vertex_triangles_(vertices.size())
+            , quadrics_(vertices.size())
+            , index_count_{indices_.size()} {
+            group_positions();
+            accumulate_quadrics();
+            find_collapsible_vertices();
+            for (uint32_t triangle = 0; triangle < removed_triangles_.size(); ++triangle) {
+                if (removed_triangles_[triangle]) {
+                    continue;
+                }
+                const auto corners = &indices_[triangle * 3];
+                for (size_t i = 0; i < 3; ++i) {
+                    vertex_triangles_[corners[i]].push_back(triangle);
+                    queue_collapse(corners[i], corners[(i + 1) % 3]);
+                    queue_collapse(corners[(i + 1) % 3], corners[i]);
+                }
+            }
+        }
+
+        /// Collapses edges until at most `target_index_count` indices remain or the cheapest collapse costs more than
+        /// `max_cost`.
+        void run(const size_t target_index_count, const double max_cost) {
+            while (index_count_ > target_index_count && !queue_.empty()) {
+                const auto collapse = queue_.top();
+                queue_.pop();
+                if (removed_vertices_[collapse.from] || removed_vertices_[collapse.to]) {
+                    continue;
+                }
+                const auto cost = get_cost(collapse.from, collapse.to);
+                if (cost > collapse.cost * (1.0 + COST_TOLERANCE)) {
+                    queue_.push({cost, collapse.from, collapse.to});
+                    continue;
+                }
+                if (cost > max_cost) {
+                    break;
+                }
+                if (is_valid(collapse.from, collapse.to)) {
+                    apply(collapse.from, collapse.to);
+                    max_cost_ = std::max(max_cost_, cost);
+                }
+            }
+        }
+
+        [[nodiscard]]
+        SimplifiedMesh get_result() const {
+            SimplifiedMesh result;
+            result.indices.reserve(index_count_);
+            for (size_t triangle = 0; triangle < removed_triangles_.size(); ++triangle) {
+                if (!removed_triangles_[triangle]) {
+                    const auto corners = &indices_[triangle * 3];
+                    result.indices.insert(result.indices.end(), corners, corners + 3);
+                }
+            }
+            result.error = static_cast<float>(std::sqrt(max_cost_));
+            return result;
+        }
+
+    private:
+        void group_positions() {
+            std::unordered_map<PositionBits, uint32_t, PositionBitsHash> ids;
+            ids.reserve(vertices_.size());
+            for (size_t vertex = 0; vertex < vertices_.size(); ++vertex) {
+                PositionBits bits;
+                std::memcpy(bits.data(), &vertices_[vertex].position, sizeof(bits));
+                position_ids_[vertex] = ids.try_emplace(bits, static_cast<uint32_t>(ids.size())).first->second;
+            }
+        }
+
+        /// Adds the plane of every triangle to its vertices, and drops the triangles with a repeated vertex.
+        void accumulate_quadrics() {
+            for (size_t triangle = 0; triangle < removed_triangles_.size(); ++triangle) {
+                const auto corners = &indices_[triangle * 3];
+                if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0]) {
+                    removed_triangles_[triangle] = true;
+                    index_count_ -= 3;
+                    continue;
+                }
+                const auto &p0 = vertices_[corners[0]].position;
+                const auto edge1 = vertices_[corners[1]].position - p0;
+                const auto edge2 = vertices_[corners[2]].position - p0;
+                const auto normal = glm::cross(edge1, edge2);
+                const auto length = glm::length(normal);
+                if (length == 0.0f) {
+                    continue;
+                }
+                const auto unit_normal = normal / length;
+                const auto plane = Quadric::from_plane(unit_normal, -glm::dot(unit_normal, p0));
+                for (size_t i = 0; i < 3; ++i) {
+                    quadrics_[corners[i]] += plane;
+                }
+            }
+        }
+
+        /// Locks the vertices on seams, on open borders, and on non-manifold edges, which are edges between positions
+        /// not shared by exactly two triangles.
+        void find_collapsible_vertices() {
+            std::vector<uint32_t> vertex_counts(vertices_.size(), 0);
+            for (const auto id : position_ids_) {
+                ++vertex_counts[id];
+            }
+            std::unordered_map<uint64_t, uint32_t> edge_counts;
+            for (size_t triangle = 0; triangle < removed_triangles_.size(); ++triangle) {
+                if (removed_triangles_[triangle]) {
+                    continue;
+                }
+                const auto corners = &indices_[triangle * 3];
+                for (size_t i = 0; i < 3; ++i) {
+                    ++edge_counts[get_edge_key(position_ids_[corners[i]], position_ids_[corners[(i + 1) % 3]])];
+                }
+            }
+            std::vector<bool> locked(vertices_.size(), false);
+            for (const auto &[key, count] : edge_counts) {
+                if (count != 2) {
+                    locked[key >> 32] = true;
+                    locked[key & 0xffffffffu] = true;
+                }
+            }
+            for (size_t vertex = 0; vertex < vertices_.size(); ++vertex) {
+                const auto id = position_ids_[vertex];
+                collapsible_[vertex] = vertex_counts[id] == 1 && !locked[id];
+            }
+        }
+
+        [[nodiscard]]
+        double get_cost(const uint32_t from, const uint32_t to) const {
+            auto quadric = quadrics_[from];
+            quadric += quadrics_[to];
+            // Rounding can make the sum slightly negative, which would never compare as up to date.
+            return std::max(quadric.evaluate(vertices_[to].position), 0.0);
+        }
+
+        void queue_collapse(const uint32_t from, const uint32_t to) {
+            if (collapsible_[from]) {
+                queue_.push({get_cost(from, to), from, to});
+            }
+        }
+
+        /// @returns `true` if the vertices still share an edge, the collapse keeps the surface manifold, and no
+        /// triangle flips over.
+        [[nodiscard]]
+        bool is_valid(const uint32_t from, const uint32_t to) const {
+            // The link condition: the only positions adjacent to both ends are the opposite corners of the shared
+            // triangles, otherwise the collapse would pinch the surface.
+            std::vector<uint32_t> from_neighbors, to_neighbors;
+            size_t shared_triangles = 0;
+            for (const auto triangle : vertex_triangles_[from]) {
+                if (removed_triangles_[triangle]) {
+                    continue;
+                }
+                const auto corners = &indices_[triangle * 3];
+                shared_triangles += corners[0] == to || corners[1] == to || corners[2] == to;
+                for (size_t i = 0; i < 3; ++i) {
+                    if (corners[i] != from) {
+                        from_neighbors.push_back(position_ids_[corners[i]]);
+                    }
+                }
+            }
+            if (shared_triangles == 0) {
+                return false;
+            }
+            for (const auto triangle : vertex_triangles_[to]) {
+                if (removed_triangles_[triangle]) {
+                    continue;
+                }
+                const auto corners = &indices_[triangle * 3];
+                for (size_t i = 0; i < 3; ++i) {
+                    if (corners[i] != to) {
+                        to_neighbors.push_back(position_ids_[corners[i]]);
+                    }
+                }
+            }
+            std::ranges::sort(from_neighbors);
+            from_neighbors.erase(std::ranges::unique(from_neighbors).begin(), from_neighbors.end());
+            std::ranges::sort(to_neighbors);
+            to_neighbors.erase(std::ranges::unique(to_neighbors).begin(), to_neighbors.end());
+            std::vector<uint32_t> common;
+            std::ranges::set_intersection(from_neighbors, to_neighbors, std::back_inserter(common));
+            // Neither end is a neighbor of itself, so neither is among the common positions.
+            if (common.size() != shared_triangles) {
+                return false;
+            }
+
+            const auto &target = vertices_[to].position;
+            for (const auto triangle : vertex_triangles_[from]) {
+                if (removed_triangles_[triangle]) {
+                    continue;
+                }
+                const auto corners = &indices_[triangle * 3];
+                if (corners[0] == to || corners[1] == to || corners[2] == to) {
+                    continue;
+                }
+                std::array<glm::vec3, 3> positions{};
+                for (size_t i = 0; i < 3; ++i) {
+                    positions[i] = vertices_[corners[i]].position;
+                }
+                const auto before = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+                for (size_t i = 0; i < 3; ++i) {
+                    if (corners[i] == from) {
+                        positions[i] = target;
+                    }
+                }
+                const auto after = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+                if (glm::dot(before, after) <= 0.0f) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void apply(const uint32_t from, const uint32_t to) {
+            for (const auto triangle : vertex_triangles_[from]) {
+                if (removed_triangles_[triangle]) {
+                    continue;
+                }
+                const auto corners = &indices_[triangle * 3];
+                if (corners[0] == to || corners[1] == to || corners[2] == to) {
+                    removed_triangles_[triangle] = true;
+                    index_count_ -= 3;
+                    continue;
+                }
+                std::replace(corners, corners + 3, from, to);
+                vertex_triangles_[to].push_back(triangle);
+            }
+            quadrics_[to] += quadrics_[from];
+            removed_vertices_[from] = true;
+            vertex_triangles_[from].clear();
+            std::erase_if(vertex_triangles_[to], [this](const uint32_t triangle) {
+                return removed_triangles_[triangle];
+            });
+            // The costs of the edges around `to` changed with its quadric.
+            for (const auto triangle : vertex_triangles_[to]) {
+                const auto corners = &indices_[triangle * 3];
+                for (size_t i = 0; i < 3; ++i) {
+                    if (corners[i] != to) {
+                        queue_collapse(corners[i], to);
+                        queue_collapse(to, corners[i]);
+                    }
+                }
+            }
+        }
+    };
+
+} // namespace
+
+SimplifiedMesh simplify_mesh(
+        const std::span<const Vertex> vertices, const std::span<const uint32_t> indices,
+        const size_t target_index_count, const float max_error
+) {
+    EdgeCollapser collapser{vertices, indices};
+    const auto max_cost = static_cast<double>(max_error) * static_cast<double>(max_error);
+    collapser.run(target_index_count, max_cost);
+    return collapser.get_result();
+}
+
+LodChain build_lod_chain(
+        const std::span<const Vertex> vertices, const std::span<const uint32_t> indices, const LodChainOptions &options
+) {
+    const auto index_count = indices.size() - indices.size() % 3;
+    LodChain chain;
+    chain.indices.assign(indices.begin(), indices.begin() + index_count);
+    chain.lods.push_back({.first_index = 0, .index_count = static_cast<uint32_t>(index_count), .error = 0.0f});
+    // A level that removes less than half of the planned triangles costs memory without saving much.
+    const auto max_kept = 1.0f - (1.0f - options.reduction) * 0.5f;
+    std::vector<uint32_t> previous = chain.indices;
+    float error = 0.0f;
+    while (chain.lods.size() < options.lod_count) {
+        const auto target_index_count =
+                static_cast<size_t>(static_cast<float>(previous.size() / 3) * options.reduction) * 3;
+        auto simplified = simplify_mesh(vertices, previous, target_index_count);
+        if (simplified.indices.empty()
+            || static_cast<float>(simplified.indices.size()) > static_cast<float>(previous.size()) * max_kept) {
+            break;
+        }
+        optimize_vertex_cache(simplified.indices, vertices.size());
+        // Each level is simplified from the previous one, so the errors add up.
+        error += simplified.error;
+        chain.lods.push_back({
+                .first_index = static_cast<uint32_t>(chain.indices.size()),
+                .index_count = static_cast<uint32_t>(simplified.indices.size()),
+                .error = error,
+        });
+        chain.indices.insert(chain.indices.end(), simplified.indices.begin(), simplified.indices.end());
+        previous = std::move(simplified.indices);
+    }
+    return chain;
+}
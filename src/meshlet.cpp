@@ -0,0 +1,219 @@
+#include "glex/meshlet.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+#include "glex/common.h"
+#include "glex/frustum.h"
+
+namespace {
+
+    constexpr uint32_t INVALID_INDEX{std::numeric_limits<uint32_t>::max()};
+
+    /// @returns The unit normal of a triangle by its winding, or zero if it has no area.
+    glm::vec3 get_triangle_normal(const std::span<const Vertex> vertices, const uint32_t *corners) {
+        const auto &p0 = vertices[corners[0]].position;
+        const auto normal = glm::cross(vertices[corners[1]].position - p0, vertices[corners[2]].position - p0);
+        const auto length = glm::length(normal);
+        return length > 0.0f ? normal / length : glm::vec3{0.0f};
+    }
+
+    /// Computes the bounding sphere and the normal cone of a meshlet from its triangles.
+    void compute_bounds(
+            const std::span<const Vertex> vertices, const std::span<const uint32_t> triangles,
+            const std::span<const glm::vec3> triangle_normals, const std::span<const uint32_t> meshlet_vertices,
+            Meshlet &meshlet
+    ) {
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{std::numeric_limits<float>::lowest()};
+        for (const auto vertex : meshlet_vertices) {
+            min = glm::min(min, vertices[vertex].position);
+            max = glm::max(max, vertices[vertex].position);
+        }
+        const auto center = (min + max) * 0.5f;
+        float radius2 = 0.0f;
+        for (const auto vertex : meshlet_vertices) {
+            const auto offset = vertices[vertex].position - center;
+            radius2 = std::max(radius2, glm::dot(offset, offset));
+        }
+        meshlet.bounds = {.center = center, .radius = std::sqrt(radius2)};
+
+        glm::vec3 normal_sum{0.0f};
+        for (const auto triangle : triangles) {
+            normal_sum += triangle_normals[triangle];
+        }
+        const auto length = glm::length(normal_sum);
+        meshlet.cone_axis = length > 0.0f ? normal_sum / length : glm::vec3{0.0f, 0.0f, 1.0f};
+        meshlet.cone_cutoff = 1.0f;
+        if (length == 0.0f) {
+            return;
+        }
+        // Triangles without an area face nowhere and do not widen the cone.
+        float min_dot = 1.0f;
+        for (const auto triangle : triangles) {
+            const auto &normal = triangle_normals[triangle];
+            if (normal != glm::vec3{0.0f}) {
+                min_dot = std::min(min_dot, glm::dot(normal, meshlet.cone_axis));
+            }
+        }
+        if (min_dot > 0.0f) {
+            meshlet.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+        }
+    }
+
+} // namespace
+
+std::vector<Meshlet> build_meshlets(
+        const std::span<const Vertex> vertices, const std::span<uint32_t> indices, const MeshletOptions &options
+) {
+    const auto triangle_count = indices.size() / 3;
+    std::vector<glm::vec3> triangle_normals(triangle_count);
+    // Triangles around each vertex, in compressed rows.
+    std::vector<uint32_t> adjacency_offsets(vertices.size() + 1, 0);
+    for (size_t triangle = 0; triangle < triangle_count; ++triangle) {
+        triangle_normals[triangle] = get_triangle_normal(vertices, &indices[triangle * 3]);
+        for (size_t i = 0; i < 3; ++i) {
+            ++adjacency_offsets[indices[triangle * 3 + i] + 1];
+        }
+    }
+    for (size_t vertex = 0; vertex < vertices.size(); ++vertex) {
+        adjacency_offsets[vertex + 1] += adjacency_offsets[vertex];
+    }
+    std::vector<uint32_t> adjacency(triangle_count * 3);
+    {
+        auto fill = adjacency_offsets;
+        for (size_t triangle = 0; triangle < triangle_count; ++triangle) {
+            for (size_t i = 0; i < 3; ++i) {
+                adjacency[fill[indices[triangle * 3 + i]]++] = static_cast<uint32_t>(triangle);
+            }
+        }
+    }
+
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> reordered;
+    reordered.reserve(triangle_count * 3);
+    std::vector<bool> emitted(triangle_count, false);
+    // The meshlet each vertex was last added to, so membership is checked without clearing.
+    std::vector<uint32_t> vertex_meshlets(vertices.size(), INVALID_INDEX);
+    std::vector<uint32_t> meshlet_vertices, meshlet_triangles, candidates;
+    size_t seed = 0;
+    while (true) {
+        while (seed < triangle_count && emitted[seed]) {
+            ++seed;
+        }
+        if (seed == triangle_count) {
+            break;
+        }
+        const auto meshlet_index = static_cast<uint32_t>(meshlets.size());
+        meshlet_vertices.clear();
+        meshlet_triangles.clear();
+        candidates.clear();
+        glm::vec3 normal_sum{0.0f};
+        const auto count_new_vertices = [&](const uint32_t triangle) {
+            size_t count = 0;
+            for (size_t i = 0; i < 3; ++i) {
+                count += vertex_meshlets[indices[triangle * 3 + i]] != meshlet_index;
+            }
+            return count;
+        };
+        const auto add_triangle = [&](const uint32_t triangle) {
+            emitted[triangle] = true;
+            meshlet_triangles.push_back(triangle);
+            normal_sum += triangle_normals[triangle];
+            for (size_t i = 0; i < 3; ++i) {
+                const auto vertex = indices[triangle * 3 + i];
+                if (vertex_meshlets[vertex] == meshlet_index) {
+                    continue;
+                }
+                vertex_meshlets[vertex] = meshlet_index;
+                meshlet_vertices.push_back(vertex);
+                for (auto j = adjacency_offsets[vertex]; j < adjacency_offsets[vertex + 1]; ++j) {
+                    if (!emitted[adjacency[j]]) {
+                        candidates.push_back(adjacency[j]);
+                    }
+                }
+            }
+        };
+
+        add_triangle(static_cast<uint32_t>(seed));
+        while (meshlet_triangles.size() < options.max_triangles) {
+            const auto axis = normal_sum == glm::vec3{0.0f} ? normal_sum : glm::normalize(normal_sum);
+            auto best = INVALID_INDEX;
+            size_t best_new_vertices = 4;
+            float best_dot = -2.0f;
+            // Drop the candidates emitted since they were found while scanning.
+            std::erase_if(candidates, [&](const uint32_t triangle) { return emitted[triangle]; });
+            for (const auto triangle : candidates) {
+                const auto new_vertices = count_new_vertices(triangle);
+                if (meshlet_vertices.size() + new_vertices > options.max_vertices) {
+                    continue;
+                }
+                const auto dot = glm::dot(triangle_normals[triangle], axis);
+                if (new_vertices < best_new_vertices || (new_vertices == best_new_vertices && dot > best_dot)) {
+                    best = triangle;
+                    best_new_vertices = new_vertices;
+                    best_dot = dot;
+                }
+            }
+            if (best == INVALID_INDEX) {
+                break;
+            }
+            add_triangle(best);
+        }
+
+        Meshlet meshlet{
+                .first_index = static_cast<uint32_t>(reordered.size()),
+                .index_count = static_cast<uint32_t>(meshlet_triangles.size() * 3),
+                .vertex_count = static_cast<uint32_t>(meshlet_vertices.size()),
+                .bounds = {},
+                .cone_axis = glm::vec3{0.0f},
+                .cone_cutoff = 1.0f,
+        };
+        compute_bounds(vertices, meshlet_triangles, triangle_normals, meshlet_vertices, meshlet);
+        for (const auto triangle : meshlet_triangles) {
+            reordered.insert(reordered.end(), &indices[triangle * 3], &indices[triangle * 3] + 3);
+        }
+        meshlets.push_back(meshlet);
+    }
+    std::ranges::copy(reordered, indices.begin());
+    return meshlets;
+}
+
+void cull_meshlets(
+        const std::span<const Meshlet> meshlets, const glm::mat4 &model_transform, const glm::mat4 &view_projection,
+        const glm::vec3 &camera_pos, std::vector<uint32_t> &visible, MeshletCullStats *stats
+) {
+    visible.clear();
+    // Both tests run in model space: the planes of the combined matrix bound the frustum there, and whether a point
+    // is in front of a triangle does not change under an affine transform.
+    const auto frustum = Frustum::from_matrix(view_projection * model_transform);
+    const auto camera = glm::vec3{glm::inverse(model_transform) * glm::vec4{camera_pos, 1.0f}};
+    size_t frustum_culled = 0, backface_culled = 0, triangle_count = 0, visible_triangle_count = 0;
+    for (size_t i = 0; i < meshlets.size(); ++i) {
+        const auto &[first_index, index_count, vertex_count, bounds, cone_axis, cone_cutoff] = meshlets[i];
+        triangle_count += index_count / 3;
+        if (!frustum.intersects(bounds)) {
+            ++frustum_culled;
+            continue;
+        }
+        // Every normal in the cone faces away if the direction to the sphere is within the cone mirrored away from
+        // the camera, widened by the radius of the sphere.
+        const auto offset = bounds.center - camera;
+        if (glm::dot(offset, cone_axis) >= cone_cutoff * glm::length(offset) + bounds.radius) {
+            ++backface_culled;
+            continue;
+        }
+        visible.push_back(static_cast<uint32_t>(i));
+        visible_triangle_count += index_count / 3;
+    }
+    if (stats) {
+        stats->meshlet_count += meshlets.size();
+        stats->frustum_culled += frustum_culled;
+        stats->backface_culled += backface_culled;
+        stats->triangle_count += triangle_count;
+        stats->visible_triangle_count += visible_triangle_count;
+    }
+}
@@ -1,27 +1,94 @@
 #include "glex/model.h"
+#include <algorithm>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <span>
 #include <spdlog/spdlog.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "glex/mesh_optimizer.h"
+#include "glex/resource_cache.h"
 
-static std::shared_ptr<Texture>
-load_texture(const std::string &dirname, const aiMaterial *material, aiTextureType type);
+static std::string get_texture_path(const std::string &dirname, const aiMaterial *material, aiTextureType type);
 
-std::unique_ptr<Model> Model::load(const std::string &filepath) {
-    auto model = std::unique_ptr<Model>{new Model{}};
+std::unique_ptr<Model> Model::load(const std::string &filepath, const MeshOptions &options) {
+    auto model = std::unique_ptr<Model>{new Model{options}};
     if (!model->load_by_assimp(filepath)) {
         SPDLOG_ERROR("Failed to create model: \"{}\"", filepath);
         return nullptr;
     }
-    SPDLOG_INFO("Model has been loaded: \"{}\"", filepath);
+    model->compute_bounds();
+    SPDLOG_INFO("Model has been loaded: \"{}\", {} KB of vertices", filepath, model->get_vertex_bytes() / 1024);
     return std::move(model);
 }
 
+size_t Model::get_vertex_bytes() const {
+    size_t vertex_bytes = 0;
+    for (const auto &mesh : meshes_) {
+        vertex_bytes += mesh->get_vertex_bytes();
+    }
+    return vertex_bytes;
+}
+
+size_t Model::get_depth_vertex_bytes() const {
+    size_t vertex_bytes = 0;
+    for (const auto &mesh : meshes_) {
+        vertex_bytes += mesh->get_depth_vertex_bytes();
+    }
+    return vertex_bytes;
+}
+
 void Model::draw(const Program &program) const {
     for (const auto &mesh : meshes_) {
         mesh->draw(program);
     }
 }
 
+size_t Model::draw(
+        const Program &program, const glm::mat4 &transform, const LodView &view, std::vector<uint32_t> &lods
+) const {
+    lods.resize(meshes_.size(), 0);
+    program.set_uniform("modelTransform", transform);
+    size_t triangle_count = 0;
+    for (size_t i = 0; i < meshes_.size(); ++i) {
+        const auto &mesh = *meshes_[i];
+        const auto lod = mesh.select_lod(transform, view, lods[i]);
+        lods[i] = static_cast<uint32_t>(lod);
+        mesh.draw(program, lod);
+        triangle_count += mesh.get_lod(lod).index_count / 3;
+    }
+    return triangle_count;
+}
+
+void Model::draw_depth(const Program &program, const std::span<const uint32_t> lods) const {
+    for (size_t i = 0; i < meshes_.size(); ++i) {
+        meshes_[i]->draw_depth(program, i < lods.size() ? lods[i] : 0);
+    }
+}
+
+size_t Model::draw_meshlets(
+        const Program &program, const glm::mat4 &transform, const glm::mat4 &view_projection,
+        const glm::vec3 &camera_pos, MeshletCullStats &stats
+) const {
+    program.set_uniform("modelTransform", transform);
+    size_t triangle_count = 0;
+    std::vector<uint32_t> visible;
+    for (const auto &mesh : meshes_) {
+        const auto meshlets = mesh->get_meshlets();
+        if (meshlets.empty()) {
+            mesh->draw(program);
+            triangle_count += mesh->get_index_count() / 3;
+            continue;
+        }
+        const auto visible_before = stats.visible_triangle_count;
+        cull_meshlets(meshlets, transform, view_projection, camera_pos, visible, &stats);
+        mesh->draw_meshlets(program, visible);
+        triangle_count += stats.visible_triangle_count - visible_before;
+    }
+    return triangle_count;
+}
+
 
 bool Model::load_by_assimp(const std::string &filepath) {
     Assimp::Importer importer;
@@ -31,11 +98,28 @@ bool Model::load_by_assimp(const std::string &filepath) {
         return false;
     }
     const auto dirname = filepath.substr(0, filepath.find_last_of('/'));
+    // Gather the texture files of all materials so that they are decoded in parallel.
+    std::vector<std::string> texture_paths;
+    std::vector<std::pair<int, int>> material_textures;
+    const auto add_texture = [&](const aiMaterial *material, const aiTextureType type) {
+        auto path = get_texture_path(dirname, material, type);
+        if (path.empty()) {
+            return -1;
+        }
+        texture_paths.push_back(std::move(path));
+        return static_cast<int>(texture_paths.size() - 1);
+    };
     for (size_t i = 0; i < scene->mNumMaterials; ++i) {
         const auto material = scene->mMaterials[i];
-        auto diffuse = load_texture(dirname, material, aiTextureType_DIFFUSE);
-        auto specular = load_texture(dirname, material, aiTextureType_SPECULAR);
-        materials_.push_back(std::make_shared<Material>(diffuse, specular));
+        const auto diffuse = add_texture(material, aiTextureType_DIFFUSE);
+        const auto specular = add_texture(material, aiTextureType_SPECULAR);
+        material_textures.emplace_back(diffuse, specular);
+    }
+    // Materials often share texture files, so they are decoded and uploaded only once.
+    const auto textures = ResourceCache::get_textures(texture_paths);
+    const auto get_texture = [&](const int index) { return index >= 0 ? textures[index] : nullptr; };
+    for (const auto &[diffuse, specular] : material_textures) {
+        materials_.push_back(std::make_shared<Material>(get_texture(diffuse), get_texture(specular)));
     }
     process_node(scene->mRootNode, scene);
     return true;
@@ -69,23 +153,55 @@ void Model::process_mesh(const aiMesh *mesh) {
         indices.push_back(mesh->mFaces[i].mIndices[1]);
         indices.push_back(mesh->mFaces[i].mIndices[2]);
     }
-    auto gl_mesh = Mesh::create(vertices, indices, GL_TRIANGLES);
+    // Assimp keeps the vertices of each face apart and the faces in file order, so weld and reorder them for the GPU.
+    const auto report = optimize_mesh(vertices, indices);
+    SPDLOG_INFO(
+            "Mesh has been optimized: {}, {} -> {} vertices, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+            mesh->mName.C_Str(), report.vertex_count_before, report.vertex_count_after, report.before.acmr,
+            report.after.acmr, report.before.atvr, report.after.atvr
+    );
+    auto gl_mesh = Mesh::create(vertices, indices, GL_TRIANGLES, mesh_options_);
+    if (!gl_mesh) {
+        SPDLOG_ERROR("Failed to process mesh: {}", mesh->mName.C_Str());
+        return;
+    }
+    // Vertex fetch bandwidth scales with the vertex size, so report it against the float format.
+    const auto vertex_stride = Mesh::get_vertex_stride(mesh_options_.format);
+    SPDLOG_INFO(
+            "Mesh has been processed: {}, {} vertices, {} KB ({} bytes/vertex, {:.0f}% of float vertices), {} LODs, "
+            "{} meshlets",
+            mesh->mName.C_Str(), gl_mesh->get_vertex_count(), gl_mesh->get_vertex_bytes() / 1024, vertex_stride,
+            100.0 * static_cast<double>(vertex_stride) / sizeof(Vertex), gl_mesh->get_lod_count(),
+            gl_mesh->get_meshlets().size()
+    );
     if (mesh->mMaterialIndex >= 0) {
         gl_mesh->set_material(materials_[mesh->mMaterialIndex]);
     }
     meshes_.push_back(std::move(gl_mesh));
 }
 
-static std::shared_ptr<Texture>
-load_texture(const std::string &dirname, const aiMaterial *material, const aiTextureType type) {
+void Model::compute_bounds() {
+    if (meshes_.empty()) {
+        return;
+    }
+    bounding_box_ = meshes_.front()->get_bounding_box();
+    for (const auto &mesh : meshes_) {
+        bounding_box_ = bounding_box_.merge(mesh->get_bounding_box());
+    }
+    const auto center = bounding_box_.get_center();
+    float radius = 0.0f;
+    for (const auto &mesh : meshes_) {
+        const auto &sphere = mesh->get_bounding_sphere();
+        radius = std::max(radius, glm::distance(center, sphere.center) + sphere.radius);
+    }
+    bounding_sphere_ = {.center = center, .radius = radius};
+}
+
+static std::string get_texture_path(const std::string &dirname, const aiMaterial *material, const aiTextureType type) {
     if (material->GetTextureCount(type) <= 0) {
-        return nullptr;
+        return {};
     }
     aiString filepath;
     material->GetTexture(type, 0, &filepath);
-    const auto image = Image::load(std::format("{}/{}", dirname, filepath.C_Str()));
-    if (!image) {
-        return nullptr;
-    }
-    return Texture::create(*image);
+    return std::format("{}/{}", dirname, filepath.C_Str());
 }
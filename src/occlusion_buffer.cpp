@@ -0,0 +1,351 @@
+#include "glex/occlusion_buffer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <memory>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <vector>
+#include "glex/common.h"
+#include "glex/mesh.h"
+#include "glex/thread_pool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_USE_SSE2
+#endif
+
+namespace {
+
+    /// Pixels the columns of a triangle are rounded out to, the SIMD width.
+    constexpr size_t PIXEL_BLOCK_SIZE{4};
+    /// Rows below which a band is not worth a task of its own.
+    constexpr size_t MIN_ROWS_PER_TASK{16};
+    /// Triangles below which rasterizing is not worth splitting across threads.
+    constexpr size_t MIN_TRIANGLES_PER_TASK{64};
+    /// Twice the screen area below which a triangle is considered degenerate.
+    constexpr float MIN_TRIANGLE_AREA{1.0e-8f};
+    /// The largest number of texels along each side of the rectangle `OcclusionBuffer::is_visible` tests.
+    constexpr size_t MAX_TEST_TEXELS{4};
+
+    /// The corners of a box, indexed by bits `x | y << 1 | z << 2` set for the maximum, and its faces wound
+    /// counterclockwise seen from outside.
+    constexpr std::array<uint32_t, 36> BOX_INDICES{
+            0, 2, 3, 0, 3, 1, // -z
+            4, 5, 7, 4, 7, 6, // +z
+            0, 4, 6, 0, 6, 2, // -x
+            1, 3, 7, 1, 7, 5, // +x
+            0, 1, 5, 0, 5, 4, // -y
+            2, 6, 7, 2, 7, 3, // +y
+    };
+
+    /// @returns The edge function `a * x + b * y + c` as `(a, b, c)`, positive to the left of `from -> to`.
+    glm::vec3 get_edge(const glm::vec3 &from, const glm::vec3 &to) {
+        return {from.y - to.y, to.x - from.x, from.x * to.y - from.y * to.x};
+    }
+
+#if defined(OCCLUSION_USE_SSE2)
+    /// Writes the nearer depth of the triangle into the pixels `[x_begin, x_end)` of a row, four at a time.
+    void rasterize_span(
+            float *row, const size_t x_begin, const size_t x_end, const float y, const std::array<glm::vec3, 3> &edges,
+            const glm::vec3 &depth
+    ) {
+        const auto offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        const auto far = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        __m128 edge_a[3], edge_row[3];
+        for (size_t i = 0; i < edges.size(); ++i) {
+            edge_a[i] = _mm_set1_ps(edges[i].x);
+            edge_row[i] = _mm_set1_ps(edges[i].y * y + edges[i].z);
+        }
+        const auto depth_a = _mm_set1_ps(depth.x);
+        const auto depth_row = _mm_set1_ps(depth.y * y + depth.z);
+        for (auto x = x_begin; x < x_end; x += PIXEL_BLOCK_SIZE) {
+            const auto px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+            auto inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[0], px), edge_row[0]), _mm_setzero_ps());
+            inside = _mm_and_ps(
+                    inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[1], px), edge_row[1]), _mm_setzero_ps())
+            );
+            inside = _mm_and_ps(
+                    inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[2], px), edge_row[2]), _mm_setzero_ps())
+            );
+            // Pixels outside take an infinite depth, which the minimum ignores.
+            const auto z = _mm_add_ps(_mm_mul_ps(depth_a, px), depth_row);
+            const auto masked = _mm_or_ps(_mm_and_ps(inside, z), _mm_andnot_ps(inside, far));
+            _mm_storeu_ps(row + x, _mm_min_ps(_mm_loadu_ps(row + x), masked));
+        }
+    }
+#else
+    /// Writes the nearer depth of the triangle into the pixels `[x_begin, x_end)` of a row.
+    void rasterize_span(
+            float *row, const size_t x_begin, const size_t x_end, const float y, const std::array<glm::vec3, 3> &edges,
+            const glm::vec3 &depth
+    ) {
+        for (auto x = x_begin; x < x_end; ++x) {
+            const auto px = static_cast<float>(x) + 0.5f;
+            const auto inside = std::ranges::all_of(edges, [&](const glm::vec3 &edge) {
+                return edge.x * px + edge.y * y + edge.z >= 0.0f;
+            });
+            if (inside) {
+                row[x] = std::min(row[x], depth.x * px + depth.y * y + depth.z);
+            }
+        }
+    }
+#endif
+
+} // namespace
+
+std::unique_ptr<OcclusionBuffer> OcclusionBuffer::create(const size_t width, const size_t height) {
+    if (width == 0 || height == 0 || width % PIXEL_BLOCK_SIZE != 0) {
+        SPDLOG_ERROR(
+                "Failed to create occlusion buffer of {}x{}, the width must be a positive multiple of {}", width,
+                height, PIXEL_BLOCK_SIZE
+        );
+        return nullptr;
+    }
+    return std::unique_ptr<OcclusionBuffer>{new OcclusionBuffer{width, height}};
+}
+
+void OcclusionBuffer::begin(const glm::mat4 &view_projection) {
+    view_projection_ = view_projection;
+    triangles_.clear();
+}
+
+void OcclusionBuffer::add_occluder(
+        const std::span<const glm::vec3> positions, const std::span<const uint32_t> indices, const glm::mat4 &transform
+) {
+    const auto matrix = view_projection_ * transform;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        add_triangle({
+                matrix * glm::vec4{positions[indices[i]], 1.0f},
+                matrix * glm::vec4{positions[indices[i + 1]], 1.0f},
+                matrix * glm::vec4{positions[indices[i + 2]], 1.0f},
+        });
+    }
+}
+
+void OcclusionBuffer::add_occluder(const BoundingBox &box, const glm::mat4 &transform) {
+    std::array<glm::vec3, 8> corners;
+    for (uint32_t i = 0; i < corners.size(); ++i) {
+        corners[i] = {
+                i & 1 ? box.max.x : box.min.x,
+                i & 2 ? box.max.y : box.min.y,
+                i & 4 ? box.max.z : box.min.z,
+        };
+    }
+    add_occluder(corners, BOX_INDICES, transform);
+}
+
+void OcclusionBuffer::rasterize(const OcclusionBufferOptions &options) {
+    auto &pool = options.pool ? *options.pool : ThreadPool::get_default();
+    const auto thread_count = options.max_threads ? options.max_threads : pool.get_thread_count() + 1;
+    const auto task_count = triangles_.size() < MIN_TRIANGLES_PER_TASK
+                                    ? 1
+                                    : std::clamp<size_t>(height_ / MIN_ROWS_PER_TASK, 1, thread_count);
+
+    // Each task owns a band of rows, so no two threads write the same pixels.
+    std::ranges::fill(levels_.front(), 1.0f);
+    const auto band_size = (height_ + task_count - 1) / task_count;
+    std::vector<std::future<void>> futures;
+    futures.reserve(task_count - 1);
+    for (size_t i = 1; i < task_count; ++i) {
+        const auto first = std::min(i * band_size, height_);
+        const auto last = std::min(first + band_size, height_);
+        futures.push_back(pool.submit([this, first, last] { rasterize_rows(first, last); }));
+    }
+    rasterize_rows(0, std::min(band_size, height_));
+    for (auto &future : futures) {
+        future.get();
+    }
+
+    for (size_t level = 1; level < levels_.size(); ++level) {
+        const auto &source = levels_[level - 1];
+        const auto source_width = get_width(level - 1);
+        const auto source_height = get_height(level - 1);
+        const auto width = get_width(level);
+        const auto height = get_height(level);
+        auto &target = levels_[level];
+        for (size_t y = 0; y < height; ++y) {
+            // Odd sizes repeat the last row or column, which does not change the maximum.
+            const auto y0 = 2 * y;
+            const auto y1 = std::min(y0 + 1, source_height - 1);
+            for (size_t x = 0; x < width; ++x) {
+                const auto x0 = 2 * x;
+                const auto x1 = std::min(x0 + 1, source_width - 1);
+                target[y * width + x] = std::max(
+                        std::max(source[y0 * source_width + x0], source[y0 * source_width + x1]),
+                        std::max(source[y1 * source_width + x0], source[y1 * source_width + x1])
+                );
+            }
+        }
+    }
+}
+
+bool OcclusionBuffer::is_visible(const BoundingBox &box, const glm::mat4 &transform, OcclusionCullStats *stats) const {
+    const auto count = [&](const bool visible) {
+        if (stats) {
+            ++(visible ? stats->visible_count : stats->occluded_count);
+        }
+        return visible;
+    };
+
+    const auto matrix = view_projection_ * transform;
+    glm::vec2 min{std::numeric_limits<float>::max()};
+    glm::vec2 max{std::numeric_limits<float>::lowest()};
+    float min_depth = std::numeric_limits<float>::max();
+    uint32_t behind_count = 0;
+    for (uint32_t i = 0; i < 8; ++i) {
+        const glm::vec4 corner{
+                i & 1 ? box.max.x : box.min.x,
+                i & 2 ? box.max.y : box.min.y,
+                i & 4 ? box.max.z : box.min.z,
+                1.0f,
+        };
+        const auto clip = matrix * corner;
+        if (clip.z < -clip.w) {
+            ++behind_count;
+            continue;
+        }
+        const auto ndc = glm::vec3{clip} / clip.w;
+        min = glm::min(min, glm::vec2{ndc});
+        max = glm::max(max, glm::vec2{ndc});
+        min_depth = std::min(min_depth, ndc.z * 0.5f + 0.5f);
+    }
+    if (behind_count > 0) {
+        // A box crossing the near plane has an unbounded projection.
+        return count(behind_count < 8);
+    }
+    if (max.x < -1.0f || min.x > 1.0f || max.y < -1.0f || min.y > 1.0f || min_depth > 1.0f) {
+        return count(false);
+    }
+
+    // The pixels the rectangle touches, then the same at the coarsest level where it covers few texels.
+    const auto to_pixel = [](const float ndc, const size_t size) {
+        const auto pixel = std::floor((ndc * 0.5f + 0.5f) * static_cast<float>(size));
+        return static_cast<size_t>(std::clamp(pixel, 0.0f, static_cast<float>(size - 1)));
+    };
+    auto x0 = to_pixel(min.x, width_), x1 = to_pixel(max.x, width_);
+    auto y0 = to_pixel(min.y, height_), y1 = to_pixel(max.y, height_);
+    size_t level = 0;
+    while (level + 1 < levels_.size() && (x1 - x0 >= MAX_TEST_TEXELS || y1 - y0 >= MAX_TEST_TEXELS)) {
+        ++level;
+        x0 >>= 1;
+        x1 >>= 1;
+        y0 >>= 1;
+        y1 >>= 1;
+    }
+    const auto &depth = levels_[level];
+    const auto width = get_width(level);
+    for (auto y = y0; y <= y1; ++y) {
+        for (auto x = x0; x <= x1; ++x) {
+            if (depth[y * width + x] >= min_depth) {
+                return count(true);
+            }
+        }
+    }
+    return count(false);
+}
+
+OcclusionBuffer::OcclusionBuffer(const size_t width, const size_t height)
+    : width_{width}
+    , height_{height} {
+    for (size_t level = 0;; ++level) {
+        levels_.emplace_back(get_width(level) * get_height(level), 1.0f);
+        if (get_width(level) == 1 && get_height(level) == 1) {
+            break;
+        }
+    }
+}
+
+void OcclusionBuffer::add_triangle(const std::array<glm::vec4, 3> &clip) {
+    // Trivially reject triangles outside one side of the frustum.
+    for (int axis = 0; axis < 3; ++axis) {
+        const auto outside = [&](const float sign) {
+            return std::ranges::all_of(clip, [&](const glm::vec4 &v) { return sign * v[axis] > v.w; });
+        };
+        if (outside(1.0f) || outside(-1.0f)) {
+            return;
+        }
+    }
+
+    // Clip against the near plane `z + w >= 0`, which leaves a polygon of up to four vertices.
+    std::array<glm::vec4, 4> polygon;
+    size_t vertex_count = 0;
+    for (size_t i = 0; i < clip.size(); ++i) {
+        const auto &current = clip[i];
+        const auto &next = clip[(i + 1) % clip.size()];
+        const auto current_distance = current.z + current.w;
+        const auto next_distance = next.z + next.w;
+        if (current_distance >= 0.0f) {
+            polygon[vertex_count++] = current;
+        }
+        if ((current_distance >= 0.0f) != (next_distance >= 0.0f)) {
+            const auto t = current_distance / (current_distance - next_distance);
+            polygon[vertex_count++] = current + (next - current) * t;
+        }
+    }
+    if (vertex_count < 3) {
+        return;
+    }
+
+    std::array<glm::vec3, 4> window;
+    const auto size = glm::vec2{static_cast<float>(width_), static_cast<float>(height_)};
+    for (size_t i = 0; i < vertex_count; ++i) {
+        const auto ndc = glm::vec3{polygon[i]} / polygon[i].w;
+        window[i] = {(glm::vec2{ndc} * 0.5f + 0.5f) * size, ndc.z * 0.5f + 0.5f};
+    }
+    for (size_t i = 2; i < vertex_count; ++i) {
+        const auto &v0 = window[0];
+        const auto &v1 = window[i - 1];
+        const auto &v2 = window[i];
+        const auto area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (area <= MIN_TRIANGLE_AREA) {
+            continue;
+        }
+
+        // The pixel centers the triangle may cover, with the columns rounded out to whole blocks.
+        const auto min = glm::min(glm::min(v0, v1), v2);
+        const auto max = glm::max(glm::max(v0, v1), v2);
+        const auto first_center = [](const float v, const size_t size) {
+            return static_cast<uint32_t>(std::clamp(std::ceil(v - 0.5f), 0.0f, static_cast<float>(size)));
+        };
+        const auto end_center = [](const float v, const size_t size) {
+            return static_cast<uint32_t>(std::clamp(std::floor(v - 0.5f) + 1.0f, 0.0f, static_cast<float>(size)));
+        };
+        const auto x_begin = first_center(min.x, width_) / PIXEL_BLOCK_SIZE * PIXEL_BLOCK_SIZE;
+        const auto x_end = (end_center(max.x, width_) + PIXEL_BLOCK_SIZE - 1) / PIXEL_BLOCK_SIZE * PIXEL_BLOCK_SIZE;
+        const auto y_begin = first_center(min.y, height_);
+        const auto y_end = end_center(max.y, height_);
+        if (x_begin >= x_end || y_begin >= y_end) {
+            continue;
+        }
+
+        // Each edge function over the area is the barycentric coordinate of the opposite vertex.
+        const std::array edges{get_edge(v1, v2), get_edge(v2, v0), get_edge(v0, v1)};
+        triangles_.push_back({
+                .edges = edges,
+                .depth = (edges[0] * v0.z + edges[1] * v1.z + edges[2] * v2.z) / area,
+                .x_begin = static_cast<uint32_t>(x_begin),
+                .x_end = static_cast<uint32_t>(x_end),
+                .y_begin = y_begin,
+                .y_end = y_end,
+        });
+    }
+}
+
+void OcclusionBuffer::rasterize_rows(const size_t first, const size_t last) {
+    auto &depth = levels_.front();
+    for (const auto &triangle : triangles_) {
+        const auto y_begin = std::max<size_t>(triangle.y_begin, first);
+        const auto y_end = std::min<size_t>(triangle.y_end, last);
+        for (auto y = y_begin; y < y_end; ++y) {
+            rasterize_span(
+                    depth.data() + y * width_, triangle.x_begin, triangle.x_end, static_cast<float>(y) + 0.5f,
+                    triangle.edges, triangle.depth
+            );
+        }
+    }
+}
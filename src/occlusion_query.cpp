@@ -0,0 +1,207 @@
+#include "glex/occlusion_query.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <utility>
+#include <vector>
+#include "glex/buffer.h"
+#include "glex/common.h"
+#include "glex/gl_state_cache.h"
+#include "glex/mesh.h"
+#include "glex/program.h"
+#include "glex/shader.h"
+#include "glex/vertex_layout.h"
+
+namespace {
+
+    /// Transforms the proxy box to clip space. Nothing is written, so the fragment shader is empty.
+    constexpr auto PROXY_VERTEX_SHADER = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+uniform mat4 transform;
+void main() {
+    gl_Position = transform * vec4(aPos, 1.0);
+}
+)";
+    constexpr auto PROXY_FRAGMENT_SHADER = R"(#version 330 core
+void main() {}
+)";
+
+    /// The corners of the unit box, bit `0` of the index selecting `x`, bit `1` `y`, and bit `2` `z`.
+    constexpr std::array<glm::vec3, 8> PROXY_VERTICES{{
+            {0.0f, 0.0f, 0.0f},
+            {1.0f, 0.0f, 0.0f},
+            {0.0f, 1.0f, 0.0f},
+            {1.0f, 1.0f, 0.0f},
+            {0.0f, 0.0f, 1.0f},
+            {1.0f, 0.0f, 1.0f},
+            {0.0f, 1.0f, 1.0f},
+            {1.0f, 1.0f, 1.0f},
+    }};
+    /// The faces of the unit box, wound counterclockwise seen from outside.
+    constexpr std::array<uint32_t, 36> PROXY_INDICES{
+            0, 2, 3, 0, 3, 1, // -z
+            4, 5, 7, 4, 7, 6, // +z
+            0, 4, 6, 0, 6, 2, // -x
+            1, 3, 7, 1, 7, 5, // +x
+            0, 1, 5, 0, 5, 4, // -y
+            2, 6, 7, 2, 7, 3, // +y
+    };
+
+    /// @returns `true` if any corner of the box is on or behind the near plane.
+    bool crosses_near_plane(const BoundingBox &box, const glm::mat4 &model_view_projection) {
+        for (const auto &corner : PROXY_VERTICES) {
+            const auto clip = model_view_projection * glm::vec4{glm::mix(box.min, box.max, corner), 1.0f};
+            if (clip.z <= -clip.w) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace
+
+std::unique_ptr<OcclusionQueryPool> OcclusionQueryPool::create(const uint32_t retest_interval) {
+    if (retest_interval == 0) {
+        SPDLOG_ERROR("Failed to create occlusion query pool: the retest interval must be at least 1");
+        return nullptr;
+    }
+    std::shared_ptr<Shader> vertex_shader =
+            Shader::create_from_source(PROXY_VERTEX_SHADER, GL_VERTEX_SHADER, "<occlusion proxy>");
+    std::shared_ptr<Shader> fragment_shader =
+            Shader::create_from_source(PROXY_FRAGMENT_SHADER, GL_FRAGMENT_SHADER, "<occlusion proxy>");
+    if (!vertex_shader || !fragment_shader) {
+        SPDLOG_ERROR("Failed to create occlusion query pool");
+        return nullptr;
+    }
+    auto proxy_program = Program::create({vertex_shader, fragment_shader});
+    auto proxy_layout = VertexLayout::create();
+    if (!proxy_program || !proxy_layout) {
+        SPDLOG_ERROR("Failed to create occlusion query pool");
+        return nullptr;
+    }
+    proxy_layout->bind();
+    auto vertex_buffer = Buffer::create_with_data(
+            GL_ARRAY_BUFFER, GL_STATIC_DRAW, PROXY_VERTICES.data(), sizeof(glm::vec3), PROXY_VERTICES.size()
+    );
+    auto index_buffer = Buffer::create_with_data(
+            GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW, PROXY_INDICES.data(), sizeof(uint32_t), PROXY_INDICES.size()
+    );
+    if (!vertex_buffer || !index_buffer) {
+        SPDLOG_ERROR("Failed to create occlusion query pool");
+        return nullptr;
+    }
+    vertex_buffer->bind();
+    proxy_layout->set_attrib(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), 0);
+    SPDLOG_INFO("OcclusionQueryPool has been created: retest every {} frames", retest_interval);
+    return std::unique_ptr<OcclusionQueryPool>{new OcclusionQueryPool{
+            std::move(proxy_program), std::move(proxy_layout), std::move(vertex_buffer), std::move(index_buffer),
+            retest_interval
+    }};
+}
+
+OcclusionQueryPool::OcclusionQueryPool(
+        std::unique_ptr<Program> proxy_program, std::unique_ptr<VertexLayout> proxy_layout,
+        std::unique_ptr<Buffer> proxy_vertex_buffer, std::unique_ptr<Buffer> proxy_index_buffer,
+        const uint32_t retest_interval
+)
+    : proxy_program_{std::move(proxy_program)}
+    , proxy_layout_{std::move(proxy_layout)}
+    , proxy_vertex_buffer_{std::move(proxy_vertex_buffer)}
+    , proxy_index_buffer_{std::move(proxy_index_buffer)}
+    , retest_interval_{retest_interval} {}
+
+OcclusionQueryPool::~OcclusionQueryPool() {
+    for (const auto &pending : pending_) {
+        free_queries_.push_back(pending.query);
+    }
+    if (!free_queries_.empty()) {
+        glDeleteQueries(static_cast<GLsizei>(free_queries_.size()), free_queries_.data());
+    }
+}
+
+void OcclusionQueryPool::begin_frame(const glm::mat4 &view_projection, const size_t object_count) {
+    ++frame_;
+    view_projection_ = view_projection;
+    objects_.resize(object_count);
+    stats_ = {};
+
+    // Results arrive in about the order the queries were issued, but each is checked, so a slow one does not hold
+    // back the others.
+    size_t kept = 0;
+    for (const auto &pending : pending_) {
+        uint32_t available = GL_FALSE;
+        glGetQueryObjectuiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            pending_[kept++] = pending;
+            continue;
+        }
+        uint32_t any_samples = GL_FALSE;
+        glGetQueryObjectuiv(pending.query, GL_QUERY_RESULT, &any_samples);
+        free_queries_.push_back(pending.query);
+        if (pending.conditional && !any_samples) {
+            stats_.skipped_draws++;
+        }
+        if (pending.object >= objects_.size()) {
+            continue;
+        }
+        auto &object = objects_[pending.object];
+        if (pending.frame >= object.result_frame) {
+            object.visible = any_samples != GL_FALSE;
+            object.result_frame = pending.frame;
+        }
+    }
+    pending_.resize(kept);
+    stats_.pending_queries = kept;
+}
+
+void OcclusionQueryPool::begin_tests() {
+    proxy_program_->use();
+    proxy_layout_->bind();
+    saved_color_mask_ = GLStateCache::get_color_mask();
+    saved_depth_mask_ = GLStateCache::get_depth_mask();
+    GLStateCache::set_color_mask(false, false, false, false);
+    GLStateCache::set_depth_mask(false);
+}
+
+void OcclusionQueryPool::test(const uint32_t object, const BoundingBox &box, const glm::mat4 &transform) {
+    auto &state = objects_[object];
+    if (state.visible) {
+        return;
+    }
+    const auto model_view_projection = view_projection_ * transform;
+    if (crosses_near_plane(box, model_view_projection)) {
+        state.visible = true;
+        state.result_frame = frame_;
+        return;
+    }
+    const auto proxy_transform = model_view_projection * glm::translate(glm::mat4{1.0f}, box.min) *
+                                 glm::scale(glm::mat4{1.0f}, box.max - box.min);
+    proxy_program_->set_uniform("transform", proxy_transform);
+    begin_query(object, true);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(PROXY_INDICES.size()), GL_UNSIGNED_INT, nullptr);
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+}
+
+void OcclusionQueryPool::end_tests() {
+    GLStateCache::set_color_mask(saved_color_mask_);
+    GLStateCache::set_depth_mask(saved_depth_mask_);
+}
+
+uint32_t OcclusionQueryPool::begin_query(const uint32_t object, const bool conditional) {
+    uint32_t query;
+    if (free_queries_.empty()) {
+        glGenQueries(1, &query);
+    } else {
+        query = free_queries_.back();
+        free_queries_.pop_back();
+    }
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, query);
+    pending_.push_back({.query = query, .object = object, .frame = frame_, .conditional = conditional});
+    auto &state = objects_[object];
+    state.query = query;
+    state.query_frame = frame_;
+    stats_.queries_issued++;
+    return query;
+}
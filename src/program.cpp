@@ -1,11 +1,58 @@
 #include "glex/program.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <format>
 #include <glm/gtc/type_ptr.hpp>
 #include <memory>
 #include <spdlog/spdlog.h>
+#include <string>
 #include <vector>
 #include "glex/common.h"
+#include "glex/gl_state_cache.h"
+#include "glex/program_binary_cache.h"
+
+namespace {
+
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+    using MaxShaderCompilerThreadsProc = void(APIENTRYP)(GLuint count);
+
+    /// Enables `GL_KHR_parallel_shader_compile` (or its ARB equivalent) once.
+    ///
+    /// @returns `true` if the driver compiles shaders in parallel and `GL_COMPLETION_STATUS_KHR` can be queried.
+    bool init_parallel_shader_compile() {
+        static const bool supported = [] {
+            MaxShaderCompilerThreadsProc max_shader_compiler_threads = nullptr;
+            if (glfwExtensionSupported("GL_KHR_parallel_shader_compile")) {
+                max_shader_compiler_threads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+                        glfwGetProcAddress("glMaxShaderCompilerThreadsKHR")
+                );
+            } else if (glfwExtensionSupported("GL_ARB_parallel_shader_compile")) {
+                max_shader_compiler_threads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+                        glfwGetProcAddress("glMaxShaderCompilerThreadsARB")
+                );
+            }
+            if (!max_shader_compiler_threads) {
+                SPDLOG_INFO("Parallel shader compilation is not supported");
+                return false;
+            }
+            // Let the driver choose the number of compiler threads.
+            max_shader_compiler_threads(0xFFFFFFFF);
+            int thread_count = 0;
+            glGetIntegerv(GL_MAX_SHADER_COMPILER_THREADS_KHR, &thread_count);
+            SPDLOG_INFO("Parallel shader compilation is enabled: {} threads", thread_count);
+            return true;
+        }();
+        return supported;
+    }
+
+} // namespace
 
 std::unique_ptr<Program> Program::create(const std::vector<std::shared_ptr<Shader>> &shaders) {
     const auto program_id = glCreateProgram();
@@ -13,23 +60,65 @@ std::unique_ptr<Program> Program::create(const std::vector<std::shared_ptr<Shade
         SPDLOG_ERROR("Failed to create shader program.");
     }
     auto program = std::unique_ptr<Program>{new Program{program_id}};
-    if (!program->link(shaders)) {
+    program->submit_link(shaders);
+    if (!program->is_linked()) {
         SPDLOG_ERROR("Failed to create shader program");
         return nullptr;
     }
+    program->shaders_ = shaders;
+    program->load_uniforms();
     SPDLOG_INFO("Shader program has been created: {}", program->get());
     return std::move(program);
 }
 
-std::unique_ptr<Program>
-Program::create(const std::string &vertex_shader_filename, const std::string &frag_shader_filename) {
-    std::shared_ptr vertex = Shader::create_from_file(vertex_shader_filename, GL_VERTEX_SHADER);
-    std::shared_ptr fragment = Shader::create_from_file(frag_shader_filename, GL_FRAGMENT_SHADER);
-    if (!vertex || !fragment) {
+std::unique_ptr<Program> Program::create(
+        const std::string &vertex_shader_filename, const std::string &frag_shader_filename,
+        const ShaderDefines &defines
+) {
+    return create_async(vertex_shader_filename, frag_shader_filename, defines).get();
+}
+
+PendingProgram Program::create_async(
+        const std::string &vertex_shader_filename, const std::string &frag_shader_filename,
+        const ShaderDefines &defines
+) {
+    const auto vertex_source = Shader::load_source(vertex_shader_filename, defines);
+    const auto frag_source = Shader::load_source(frag_shader_filename, defines);
+    if (!vertex_source || !frag_source) {
         SPDLOG_ERROR("Failed to create shader program");
-        return nullptr;
+        return {};
+    }
+
+    // Try the program binary cache before compiling shaders.
+    const bool use_cache = ProgramBinaryCache::is_enabled();
+    const auto key = use_cache ? ProgramBinaryCache::make_key({
+                                         {GL_VERTEX_SHADER, *vertex_source},
+                                         {GL_FRAGMENT_SHADER, *frag_source},
+                                 })
+                               : 0;
+    if (use_cache) {
+        auto program = std::unique_ptr<Program>{new Program{glCreateProgram()}};
+        if (ProgramBinaryCache::load(program->get(), key)) {
+            SPDLOG_INFO("Shader program has been loaded from binary cache: {}", program->get());
+            return {std::move(program), {}, key, true};
+        }
+    }
+
+    init_parallel_shader_compile();
+    // Name variants by their permutation key in log messages.
+    const auto variant = defines.empty() ? std::string{} : std::format(" [{}]", defines.get_key());
+    const auto vertex = Shader::create_shared(*vertex_source, GL_VERTEX_SHADER, vertex_shader_filename + variant);
+    const auto fragment = Shader::create_shared(*frag_source, GL_FRAGMENT_SHADER, frag_shader_filename + variant);
+    const auto program_id = glCreateProgram();
+    if (!vertex || !fragment || program_id == 0) {
+        SPDLOG_ERROR("Failed to create shader program");
+        return {};
     }
-    return create({vertex, fragment});
+    // Linking does not wait for the compilation; the shader status is checked only if linking fails.
+    auto program = std::unique_ptr<Program>{new Program{program_id}};
+    std::vector<std::shared_ptr<Shader>> shaders{vertex, fragment};
+    program->submit_link(shaders);
+    return {std::move(program), std::move(shaders), key, false};
 }
 
 Program::Program(const uint32_t program)
@@ -39,17 +128,24 @@ Program::~Program() {
     if (program_) {
         SPDLOG_INFO("Delete shader program: {}", program_);
         glDeleteProgram(program_);
+        GLStateCache::forget_program(program_);
     }
 }
 
-bool Program::link(const std::vector<std::shared_ptr<Shader>> &shaders) const {
+void Program::submit_link(const std::vector<std::shared_ptr<Shader>> &shaders) const {
     // Attach shaders into program.
     for (auto &shader : shaders) {
         glAttachShader(program_, shader->get());
     }
+    // Allow the linked binary to be retrieved for the program binary cache.
+    if (ProgramBinaryCache::is_enabled()) {
+        glProgramParameteri(program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     // Link program.
     glLinkProgram(program_);
+}
 
+bool Program::is_linked() const {
     // Check if linking is successful.
     int success = 0;
     glGetProgramiv(program_, GL_LINK_STATUS, &success);
@@ -64,36 +160,159 @@ bool Program::link(const std::vector<std::shared_ptr<Shader>> &shaders) const {
     return true;
 }
 
+void Program::load_uniforms() {
+    int uniform_count = 0;
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &uniform_count);
+    int max_name_length = 0;
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+    std::vector<char> name_buffer(std::max(max_name_length, 1));
+    uniforms_.clear();
+    for (int i = 0; i < uniform_count; ++i) {
+        int length = 0;
+        int size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program_, i, max_name_length, &length, &size, &type, name_buffer.data());
+        std::string name{name_buffer.data(), static_cast<size_t>(length)};
+        const auto location = glGetUniformLocation(program_, name.c_str());
+        // Members of uniform blocks have no location.
+        if (location < 0) {
+            continue;
+        }
+        // Arrays of basic types are reported once as `name[0]`. Register the name without the subscript and every
+        // element so that all names accepted by `glGetUniformLocation` can be found in the table.
+        if (name.ends_with("[0]")) {
+            auto base_name = name.substr(0, name.size() - 3);
+            for (int element = 1; element < size; ++element) {
+                auto element_name = std::format("{}[{}]", base_name, element);
+                const auto element_location = glGetUniformLocation(program_, element_name.c_str());
+                uniforms_.emplace_back(std::move(element_name), element_location);
+            }
+            uniforms_.emplace_back(std::move(base_name), location);
+        }
+        uniforms_.emplace_back(std::move(name), location);
+    }
+    std::ranges::sort(uniforms_, {}, &UniformEntry::name);
+    SPDLOG_DEBUG("Program {} has {} uniform locations", program_, uniforms_.size());
+}
+
 void Program::use() const {
-    glUseProgram(program_);
+    GLStateCache::use_program(program_);
+}
+
+UniformHandle Program::get_uniform_handle(const std::string_view name) const {
+    const auto it = std::ranges::lower_bound(uniforms_, name, {}, [](const UniformEntry &entry) {
+        return std::string_view{entry.name};
+    });
+    if (it == uniforms_.end() || it->name != name) {
+        return {};
+    }
+    return {it->location};
 }
 
-void Program::set_uniform(const std::string &name, int value) const {
-    const auto loc = glGetUniformLocation(program_, name.c_str());
-    glUniform1i(loc, value);
+bool Program::bind_uniform_block(const std::string_view name, const uint32_t binding) const {
+    const auto block_index = glGetUniformBlockIndex(program_, std::string{name}.c_str());
+    if (block_index == GL_INVALID_INDEX) {
+        return false;
+    }
+    glUniformBlockBinding(program_, block_index, binding);
+    return true;
 }
 
-void Program::set_uniform(const std::string &name, float value) const {
-    const auto loc = glGetUniformLocation(program_, name.c_str());
-    glUniform1f(loc, value);
+void Program::set_uniform(const std::string_view name, const int value) const {
+    set_uniform(get_uniform_handle(name), value);
 }
 
-void Program::set_uniform(const std::string &name, const glm::vec2 &value) const {
-    const auto loc = glGetUniformLocation(program_, name.c_str());
-    glUniform2fv(loc, 1, glm::value_ptr(value));
+void Program::set_uniform(const std::string_view name, const float value) const {
+    set_uniform(get_uniform_handle(name), value);
 }
 
-void Program::set_uniform(const std::string &name, const glm::vec3 &value) const {
-    const auto loc = glGetUniformLocation(program_, name.c_str());
-    glUniform3fv(loc, 1, glm::value_ptr(value));
+void Program::set_uniform(const std::string_view name, const glm::vec2 &value) const {
+    set_uniform(get_uniform_handle(name), value);
 }
 
-void Program::set_uniform(const std::string &name, const glm::vec4 &value) const {
-    const auto loc = glGetUniformLocation(program_, name.c_str());
-    glUniform4fv(loc, 1, glm::value_ptr(value));
+void Program::set_uniform(const std::string_view name, const glm::vec3 &value) const {
+    set_uniform(get_uniform_handle(name), value);
 }
 
-void Program::set_uniform(const std::string &name, const glm::mat4 &value) const {
-    const auto loc = glGetUniformLocation(program_, name.c_str());
-    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+void Program::set_uniform(const std::string_view name, const glm::vec4 &value) const {
+    set_uniform(get_uniform_handle(name), value);
+}
+
+void Program::set_uniform(const std::string_view name, const glm::mat4 &value) const {
+    set_uniform(get_uniform_handle(name), value);
+}
+
+void Program::set_uniform(const UniformHandle handle, const int value) const {
+    glUniform1i(handle.location, value);
+}
+
+void Program::set_uniform(const UniformHandle handle, const float value) const {
+    glUniform1f(handle.location, value);
+}
+
+void Program::set_uniform(const UniformHandle handle, const glm::vec2 &value) const {
+    glUniform2fv(handle.location, 1, glm::value_ptr(value));
+}
+
+void Program::set_uniform(const UniformHandle handle, const glm::vec3 &value) const {
+    glUniform3fv(handle.location, 1, glm::value_ptr(value));
+}
+
+void Program::set_uniform(const UniformHandle handle, const glm::vec4 &value) const {
+    glUniform4fv(handle.location, 1, glm::value_ptr(value));
+}
+
+void Program::set_uniform(const UniformHandle handle, const glm::mat4 &value) const {
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Program::set_uniform(const UniformHandle handle, const std::span<const glm::vec3> values) const {
+    if (values.empty()) {
+        return;
+    }
+    glUniform3fv(handle.location, static_cast<int32_t>(values.size()), glm::value_ptr(values.front()));
+}
+
+PendingProgram::PendingProgram(
+        std::unique_ptr<Program> &&program, std::vector<std::shared_ptr<Shader>> &&shaders, const uint64_t cache_key,
+        const bool linked
+)
+    : program_{std::move(program)}
+    , shaders_{std::move(shaders)}
+    , cache_key_{cache_key}
+    , linked_{linked} {}
+
+bool PendingProgram::is_ready() const {
+    if (!program_ || linked_ || !init_parallel_shader_compile()) {
+        return true;
+    }
+    int completed = 0;
+    glGetProgramiv(program_->get(), GL_COMPLETION_STATUS_KHR, &completed);
+    return completed;
+}
+
+std::unique_ptr<Program> PendingProgram::get() {
+    if (!program_) {
+        return nullptr;
+    }
+    auto program = std::move(program_);
+    auto shaders = std::move(shaders_);
+    if (!linked_) {
+        if (!program->is_linked()) {
+            // Report compile errors of the shaders, which are not checked before linking.
+            for (const auto &shader : shaders) {
+                static_cast<void>(shader->is_compiled());
+            }
+            SPDLOG_ERROR("Failed to create shader program");
+            return nullptr;
+        }
+        if (ProgramBinaryCache::is_enabled()) {
+            ProgramBinaryCache::store(program->get(), cache_key_);
+        }
+        SPDLOG_INFO("Shader program has been created: {}", program->get());
+    }
+    program->shaders_ = std::move(shaders);
+    program->load_uniforms();
+    return std::move(program);
 }
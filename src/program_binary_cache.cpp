@@ -0,0 +1,100 @@
+#include "glex/program_binary_cache.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "glex/blob_cache.h"
+#include "glex/common.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    BlobCache cache{"Program binary cache", ".bin", 0x42584c47}; // "GLXB"
+
+    std::string_view get_gl_string(const GLenum name) {
+        const auto str = glGetString(name);
+        return str ? reinterpret_cast<const char *>(str) : "";
+    }
+
+} // namespace
+
+void ProgramBinaryCache::set_directory(const fs::path &directory) {
+    cache.disable();
+    // `glProgramBinary` is a core function since OpenGL 4.1.
+    if (!glGetProgramBinary || !glProgramBinary || !glProgramParameteri) {
+        SPDLOG_WARN("Program binary cache is disabled: glProgramBinary is not available");
+        return;
+    }
+    int format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (format_count <= 0) {
+        SPDLOG_WARN("Program binary cache is disabled: no program binary format is supported");
+        return;
+    }
+    cache.set_directory(directory);
+}
+
+bool ProgramBinaryCache::is_enabled() {
+    return cache.is_enabled();
+}
+
+uint64_t ProgramBinaryCache::make_key(const Sources &sources) {
+    auto hash = hash_bytes(get_gl_string(GL_VENDOR));
+    hash = hash_bytes(get_gl_string(GL_RENDERER), hash);
+    hash = hash_bytes(get_gl_string(GL_VERSION), hash);
+    for (const auto &[shader_type, source] : sources) {
+        hash = hash_bytes(std::format("#{}:{}#", shader_type, source.size()), hash);
+        hash = hash_bytes(source, hash);
+    }
+    return hash;
+}
+
+bool ProgramBinaryCache::load(const uint32_t program_id, const uint64_t key) {
+    const auto blob = cache.load(key);
+    if (!blob) {
+        return false;
+    }
+    const auto &[binary_format, binary] = *blob;
+    glProgramBinary(program_id, binary_format, binary.data(), static_cast<int32_t>(binary.size()));
+    int success = 0;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &success);
+    if (!success) {
+        // The driver was updated or the binary format is no longer accepted.
+        SPDLOG_INFO("Stale program binary, compile from source: \"{}\"", cache.get_path(key).string());
+        cache.add_miss();
+        return false;
+    }
+    cache.add_hit();
+    SPDLOG_DEBUG("Program binary has been loaded: \"{}\"", cache.get_path(key).string());
+    return true;
+}
+
+void ProgramBinaryCache::store(const uint32_t program_id, const uint64_t key) {
+    if (!cache.is_enabled()) {
+        return;
+    }
+    int binary_size = 0;
+    glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+    if (binary_size <= 0) {
+        return;
+    }
+    std::vector<char> binary(static_cast<size_t>(binary_size));
+    GLenum binary_format = 0;
+    glGetProgramBinary(program_id, binary_size, nullptr, &binary_format, binary.data());
+    if (const auto path = cache.store(key, binary_format, binary)) {
+        SPDLOG_DEBUG("Program binary has been stored: \"{}\", {} bytes", path->string(), binary.size());
+    }
+}
+
+size_t ProgramBinaryCache::get_hit_count() {
+    return cache.get_hit_count();
+}
+
+size_t ProgramBinaryCache::get_miss_count() {
+    return cache.get_miss_count();
+}
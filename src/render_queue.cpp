@@ -0,0 +1,144 @@
+#include "glex/render_queue.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "glex/common.h"
+#include "glex/mesh.h"
+#include "glex/model.h"
+#include "glex/program.h"
+
+namespace {
+
+    /// Bits of a digit of the radix sort.
+    constexpr uint32_t RADIX_BITS{8};
+    constexpr size_t RADIX_SIZE{size_t{1} << RADIX_BITS};
+    constexpr uint32_t DIGIT_COUNT{64 / RADIX_BITS};
+
+    /// @returns The id of the object, assigned in the order objects are first seen.
+    uint32_t get_id(std::unordered_map<const void *, uint32_t> &ids, const void *object) {
+        return ids.try_emplace(object, static_cast<uint32_t>(ids.size())).first->second;
+    }
+
+} // namespace
+
+void RenderQueue::begin(const glm::mat4 &view, const float depth_range) {
+    draws_.clear();
+    items_.clear();
+    program_ids_.clear();
+    material_ids_.clear();
+    mesh_ids_.clear();
+    view_ = view;
+    depth_range_ = std::max(depth_range, 1.0e-6f);
+    submitted_state_ = {};
+    submitted_stats_ = {};
+}
+
+void RenderQueue::submit(
+        const uint32_t pass, const Program &program, const Mesh &mesh, const Material *material,
+        const glm::mat4 &transform, const uint32_t lod
+) {
+    if (!material) {
+        material = mesh.get_material().get();
+    }
+    const Draw draw{.program = &program, .material = material, .mesh = &mesh, .transform = transform, .lod = lod};
+    const auto view_depth = -(view_ * transform[3]).z;
+    const auto depth = static_cast<uint32_t>(
+            std::clamp(view_depth / depth_range_, 0.0f, 1.0f) * static_cast<float>((1u << DEPTH_BITS) - 1)
+    );
+    const auto key = make_key(
+            pass, get_id(program_ids_, &program), get_id(material_ids_, material), get_id(mesh_ids_, &mesh), depth
+    );
+    items_.push_back({.key = key, .draw = static_cast<uint32_t>(draws_.size())});
+    draws_.push_back(draw);
+    count_changes(draw, submitted_state_, submitted_stats_);
+}
+
+void RenderQueue::submit(const uint32_t pass, const Program &program, const Model &model, const glm::mat4 &transform) {
+    for (size_t i = 0; i < model.get_mesh_count(); ++i) {
+        submit(pass, program, *model.get_mesh(i), nullptr, transform);
+    }
+}
+
+void RenderQueue::sort() {
+    // Count every digit in one pass over the keys.
+    std::array<std::array<uint32_t, RADIX_SIZE>, DIGIT_COUNT> histograms{};
+    for (const auto &item : items_) {
+        for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit) {
+            histograms[digit][(item.key >> (digit * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+        }
+    }
+    scratch_.resize(items_.size());
+    for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit) {
+        auto &histogram = histograms[digit];
+        // A digit shared by every key leaves the order as it is.
+        if (std::ranges::find(histogram, items_.size()) != histogram.end()) {
+            continue;
+        }
+        uint32_t offset = 0;
+        for (auto &count : histogram) {
+            const auto bucket_size = count;
+            count = offset;
+            offset += bucket_size;
+        }
+        for (const auto &item : items_) {
+            scratch_[histogram[(item.key >> (digit * RADIX_BITS)) & (RADIX_SIZE - 1)]++] = item;
+        }
+        items_.swap(scratch_);
+    }
+}
+
+void RenderQueue::execute() {
+    executed_stats_ = {};
+    State state{};
+    for (const auto &item : items_) {
+        const auto &draw = draws_[item.draw];
+        const auto previous = executed_stats_;
+        count_changes(draw, state, executed_stats_);
+        if (executed_stats_.program_changes != previous.program_changes) {
+            draw.program->use();
+        }
+        if (executed_stats_.material_changes != previous.material_changes) {
+            draw.material->set_to_program(*draw.program);
+        }
+        draw.program->set_uniform("modelTransform", draw.transform);
+        // The vertex array is bound through `GLStateCache`, which drops the binding if it is unchanged.
+        draw.mesh->draw_geometry(*draw.program, draw.lod);
+    }
+}
+
+uint64_t RenderQueue::make_key(
+        const uint32_t pass, const uint32_t program, const uint32_t material, const uint32_t mesh, const uint32_t depth
+) {
+    const auto field = [](uint64_t key, const uint32_t value, const uint32_t bits) {
+        return key << bits | (value & ((uint64_t{1} << bits) - 1));
+    };
+    uint64_t key = 0;
+    key = field(key, pass, PASS_BITS);
+    key = field(key, program, PROGRAM_BITS);
+    key = field(key, material, MATERIAL_BITS);
+    key = field(key, mesh, MESH_BITS);
+    key = field(key, depth, DEPTH_BITS);
+    return key;
+}
+
+void RenderQueue::count_changes(const Draw &draw, State &state, RenderQueueStats &stats) {
+    stats.draw_count++;
+    if (draw.program != state.program) {
+        state.program = draw.program;
+        // Material uniforms belong to the program, so a new program needs the material set again.
+        state.material = nullptr;
+        stats.program_changes++;
+    }
+    if (draw.material && draw.material != state.material) {
+        state.material = draw.material;
+        stats.material_changes++;
+    }
+    const auto vertex_array = draw.mesh->get_vertex_layout()->get();
+    if (vertex_array != state.vertex_array) {
+        state.vertex_array = vertex_array;
+        stats.vertex_array_changes++;
+    }
+}
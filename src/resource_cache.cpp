@@ -0,0 +1,212 @@
+#include "glex/resource_cache.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "glex/common.h"
+#include "glex/image.h"
+#include "glex/sampler.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    /// Weak references to cached resources of a single type.
+    template<typename T>
+    struct CacheTable {
+        std::unordered_map<std::string, std::weak_ptr<T>> entries;
+        ResourceCache::Stats stats;
+
+        /// Returns the cached resource for the key, or `nullptr` if it is not cached.
+        std::shared_ptr<T> find(const std::string &key) const {
+            const auto it = entries.find(key);
+            return it != entries.end() ? it->second.lock() : nullptr;
+        }
+
+        void insert(const std::string &key, const std::shared_ptr<T> &resource) {
+            // Drop entries whose resources have been released.
+            std::erase_if(entries, [](const auto &entry) { return entry.second.expired(); });
+            entries.insert_or_assign(key, resource);
+        }
+
+        /// Returns the cached resource for the key, or creates it with `create` and caches it.
+        template<typename F>
+        std::shared_ptr<T> get_or_create(const std::string &key, F &&create) {
+            if (auto resource = find(key)) {
+                ++stats.hits;
+                return resource;
+            }
+            ++stats.misses;
+            std::shared_ptr<T> resource = create();
+            if (resource) {
+                insert(key, resource);
+            }
+            return resource;
+        }
+    };
+
+    CacheTable<Texture> textures;
+    CacheTable<CubeTexture> cube_textures;
+    CacheTable<Shader> shaders;
+    CacheTable<Model> models;
+
+    /// Returns the canonical form of a path, so that different spellings of the same file share an entry.
+    std::string get_canonical_path(const std::string &filepath) {
+        std::error_code error;
+        const auto path = fs::weakly_canonical(filepath, error);
+        return error ? fs::path{filepath}.lexically_normal().string() : path.string();
+    }
+
+    std::string get_texture_key(const std::string &filepath, const bool flip_vertical) {
+        return std::format("{}:flip={}", get_canonical_path(filepath), flip_vertical);
+    }
+
+    std::string get_image_key(const Image &image) {
+        const auto size =
+                image.get_width() * image.get_height() * image.get_channels() * image.get_bytes_per_channel();
+        const auto hash = hash_bytes(image.get_data(), size);
+        return std::format(
+                "image:{}x{}x{}x{}:{:016x}", image.get_width(), image.get_height(), image.get_channels(),
+                image.get_bytes_per_channel(), hash
+        );
+    }
+
+    /// Textures loaded through the cache have immutable storage and share one sampler.
+    TextureOptions get_texture_options() {
+        return {.immutable = true, .sampler = Sampler::create_shared()};
+    }
+
+} // namespace
+
+std::shared_ptr<Texture> ResourceCache::get_texture(const std::string &filepath, const bool flip_vertical) {
+    return textures.get_or_create(get_texture_key(filepath, flip_vertical), [&]() -> std::shared_ptr<Texture> {
+        const auto image = Image::load(filepath, flip_vertical);
+        if (!image) {
+            return nullptr;
+        }
+        return Texture::create(*image, get_texture_options());
+    });
+}
+
+std::vector<std::shared_ptr<Texture>>
+ResourceCache::get_textures(const std::vector<std::string> &filepaths, const bool flip_vertical) {
+    std::vector<std::shared_ptr<Texture>> result(filepaths.size());
+
+    // Collect the files that are not cached yet. Each of them is decoded once even if it is requested several times.
+    std::vector<std::string> missing_paths;
+    std::vector<std::string> missing_keys;
+    std::vector<std::vector<size_t>> missing_indices;
+    std::unordered_map<std::string, size_t> missing_lookup;
+    for (size_t i = 0; i < filepaths.size(); ++i) {
+        auto key = get_texture_key(filepaths[i], flip_vertical);
+        if (auto texture = textures.find(key)) {
+            ++textures.stats.hits;
+            result[i] = std::move(texture);
+        } else if (const auto it = missing_lookup.find(key); it != missing_lookup.end()) {
+            ++textures.stats.hits;
+            missing_indices[it->second].push_back(i);
+        } else {
+            ++textures.stats.misses;
+            missing_lookup.emplace(key, missing_paths.size());
+            missing_paths.push_back(filepaths[i]);
+            missing_keys.push_back(std::move(key));
+            missing_indices.push_back({i});
+        }
+    }
+    if (missing_paths.empty()) {
+        return result;
+    }
+
+    // Decode on the thread pool and upload each image as soon as it is decoded.
+    const ImageLoadOptions options{.flip_vertical = flip_vertical};
+    const auto texture_options = get_texture_options();
+    const auto images = Image::load_many(missing_paths, options, [&](const size_t index, const Image &image) {
+        std::shared_ptr<Texture> texture = Texture::create(image, texture_options);
+        if (!texture) {
+            return;
+        }
+        textures.insert(missing_keys[index], texture);
+        for (const auto i : missing_indices[index]) {
+            result[i] = texture;
+        }
+    });
+    return result;
+}
+
+std::shared_ptr<Texture> ResourceCache::get_texture(const Image &image) {
+    return textures.get_or_create(get_image_key(image), [&]() -> std::shared_ptr<Texture> {
+        return Texture::create(image, get_texture_options());
+    });
+}
+
+std::shared_ptr<CubeTexture>
+ResourceCache::get_cube_texture(const std::vector<std::string> &filepaths, const bool flip_vertical) {
+    auto key = std::format("flip={}", flip_vertical);
+    for (const auto &filepath : filepaths) {
+        key += ';';
+        key += get_canonical_path(filepath);
+    }
+    return cube_textures.get_or_create(key, [&]() -> std::shared_ptr<CubeTexture> {
+        std::vector<std::unique_ptr<Image>> images;
+        std::vector<std::reference_wrapper<const Image>> image_refs;
+        for (const auto &filepath : filepaths) {
+            auto image = Image::load(filepath, flip_vertical);
+            if (!image) {
+                return nullptr;
+            }
+            image_refs.emplace_back(*image);
+            images.push_back(std::move(image));
+        }
+        return CubeTexture::create_from_images(image_refs, {.immutable = true});
+    });
+}
+
+std::shared_ptr<Shader>
+ResourceCache::get_shader(const std::string &filename, const GLenum shader_type, const ShaderDefines &defines) {
+    const auto key = std::format("{}:{}:{}", get_canonical_path(filename), shader_type, defines.get_key());
+    return shaders.get_or_create(key, [&]() -> std::shared_ptr<Shader> {
+        const auto source = Shader::load_source(filename, defines);
+        if (!source) {
+            return nullptr;
+        }
+        // Share the compiled shader with programs created from the same source.
+        auto shader = Shader::create_shared(*source, shader_type, filename);
+        if (!shader || !shader->is_compiled()) {
+            return nullptr;
+        }
+        return shader;
+    });
+}
+
+std::shared_ptr<Model> ResourceCache::get_model(const std::string &filepath, const MeshOptions &options) {
+    const auto key = std::format(
+            "{}:pooled={}:packed={}:split={}:lods={}:meshlets={}", get_canonical_path(filepath), options.pooled,
+            options.format == VertexFormat::Packed, options.split_positions, options.lod_count, options.meshlets
+    );
+    return models.get_or_create(key, [&]() -> std::shared_ptr<Model> { return Model::load(filepath, options); });
+}
+
+ResourceCache::Stats ResourceCache::get_stats(const ResourceType type) {
+    switch (type) {
+    case ResourceType::TEXTURE: return textures.stats;
+    case ResourceType::CUBE_TEXTURE: return cube_textures.stats;
+    case ResourceType::SHADER: return shaders.stats;
+    case ResourceType::MODEL: return models.stats;
+    }
+    return {};
+}
+
+void ResourceCache::log_stats() {
+    SPDLOG_INFO(
+            "Resource cache hits/misses: textures {}/{}, cube textures {}/{}, shaders {}/{}, models {}/{}",
+            textures.stats.hits, textures.stats.misses, cube_textures.stats.hits, cube_textures.stats.misses,
+            shaders.stats.hits, shaders.stats.misses, models.stats.hits, models.stats.misses
+    );
+}
@@ -0,0 +1,124 @@
+#include "glex/sampler.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <glm/gtc/type_ptr.hpp>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <unordered_map>
+#include "glex/common.h"
+#include "glex/gl_state_cache.h"
+
+namespace {
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+#endif
+
+    struct SamplerDescHash {
+        size_t operator()(const SamplerDesc &desc) const {
+            size_t hash = 0;
+            const auto combine = [&hash](const uint32_t value) {
+                hash ^= std::hash<uint32_t>{}(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            };
+            // `-0.0f` and `0.0f` compare equal, so they must hash the same.
+            const auto combine_float = [&combine](const float value) {
+                combine(std::bit_cast<uint32_t>(value == 0.0f ? 0.0f : value));
+            };
+            combine(desc.min_filter);
+            combine(desc.mag_filter);
+            combine(desc.wrap_s);
+            combine(desc.wrap_t);
+            combine(desc.wrap_r);
+            for (int i = 0; i < 4; ++i) {
+                combine_float(desc.border_color[i]);
+            }
+            combine_float(desc.max_anisotropy);
+            return hash;
+        }
+    };
+
+    /// Samplers are not owned by the cache, so they are deleted with the last texture using them.
+    std::unordered_map<SamplerDesc, std::weak_ptr<Sampler>, SamplerDescHash> shared_samplers;
+
+    /// @returns The maximum degree of anisotropic filtering, or `1.0` if it is not supported.
+    float get_max_anisotropy() {
+        static const float max_anisotropy = [] {
+            if (!glfwExtensionSupported("GL_EXT_texture_filter_anisotropic") &&
+                !glfwExtensionSupported("GL_ARB_texture_filter_anisotropic")) {
+                return 1.0f;
+            }
+            float value = 1.0f;
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &value);
+            return value;
+        }();
+        return max_anisotropy;
+    }
+
+} // namespace
+
+std::unique_ptr<Sampler> Sampler::create(const SamplerDesc &desc) {
+    uint32_t sampler_id;
+    glGenSamplers(1, &sampler_id);
+    if (const auto error = glGetError(); error != GL_NO_ERROR) {
+        SPDLOG_ERROR("Failed to create sampler: {}", error);
+        return nullptr;
+    }
+    auto sampler = std::unique_ptr<Sampler>{new Sampler{sampler_id, desc}};
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, desc.min_filter);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, desc.mag_filter);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, desc.wrap_s);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, desc.wrap_t);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_R, desc.wrap_r);
+    glSamplerParameterfv(sampler_id, GL_TEXTURE_BORDER_COLOR, glm::value_ptr(desc.border_color));
+    if (desc.max_anisotropy > 1.0f) {
+        if (const auto max_anisotropy = get_max_anisotropy(); max_anisotropy > 1.0f) {
+            glSamplerParameterf(
+                    sampler_id, GL_TEXTURE_MAX_ANISOTROPY, std::min(desc.max_anisotropy, max_anisotropy)
+            );
+        }
+    }
+    SPDLOG_INFO("Sampler has been created: {}", sampler_id);
+    return std::move(sampler);
+}
+
+std::shared_ptr<Sampler> Sampler::create_shared(const SamplerDesc &desc) {
+    if (const auto it = shared_samplers.find(desc); it != shared_samplers.end()) {
+        if (auto sampler = it->second.lock()) {
+            return sampler;
+        }
+    }
+
+    std::shared_ptr<Sampler> sampler = create(desc);
+    if (!sampler) {
+        return nullptr;
+    }
+    std::erase_if(shared_samplers, [](const auto &entry) { return entry.second.expired(); });
+    shared_samplers.insert_or_assign(desc, sampler);
+    return sampler;
+}
+
+size_t Sampler::get_shared_count() {
+    return std::ranges::count_if(shared_samplers, [](const auto &entry) { return !entry.second.expired(); });
+}
+
+Sampler::Sampler(const uint32_t sampler_id, const SamplerDesc &desc)
+    : sampler_{sampler_id}
+    , desc_{desc} {}
+
+Sampler::~Sampler() {
+    if (sampler_) {
+        SPDLOG_INFO("Delete sampler: {}", sampler_);
+        glDeleteSamplers(1, &sampler_);
+        GLStateCache::forget_sampler(sampler_);
+    }
+}
+
+void Sampler::bind_to_unit(const uint32_t texture_unit) const {
+    GLStateCache::bind_sampler(texture_unit, sampler_);
+}
@@ -0,0 +1,418 @@
+#include "glex/scene_bvh.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include "glex/common.h"
+#include "glex/frustum.h"
+#include "glex/mesh.h"
+
+namespace {
+
+    /// Depth below which nodes are split at the median instead, which bounds the depth by this plus the binary
+    /// logarithm of the object count.
+    constexpr size_t MAX_SAH_DEPTH{64};
+    /// Entries of the traversal stacks, which hold at most one entry per level.
+    constexpr size_t STACK_SIZE{128};
+    /// Plane mask of a node outside the frustum.
+    constexpr uint32_t OUTSIDE{std::numeric_limits<uint32_t>::max()};
+    /// Plane mask of a node not yet known to be inside any plane.
+    constexpr uint32_t ALL_PLANES{(1u << 6) - 1};
+
+    /// @returns A box that any merge replaces.
+    BoundingBox get_empty_box() {
+        return {
+                .min = glm::vec3{std::numeric_limits<float>::max()},
+                .max = glm::vec3{std::numeric_limits<float>::lowest()},
+        };
+    }
+
+    float get_surface_area(const BoundingBox &box) {
+        const auto extent = glm::max(box.max - box.min, glm::vec3{0.0f});
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
+    /// Tests a box against the planes of the mask.
+    ///
+    /// @returns The planes the box still crosses, or `OUTSIDE` if it is outside one of them.
+    uint32_t classify(const Frustum &frustum, const BoundingBox &box, const uint32_t mask) {
+        auto result = mask;
+        for (uint32_t i = 0; i < frustum.planes.size(); ++i) {
+            if (!(mask & (1u << i))) {
+                continue;
+            }
+            const auto &plane = frustum.planes[i];
+            const auto normal = glm::vec3{plane};
+            // The corners farthest along and against the normal.
+            const auto positive = glm::vec3{
+                    plane.x >= 0.0f ? box.max.x : box.min.x,
+                    plane.y >= 0.0f ? box.max.y : box.min.y,
+                    plane.z >= 0.0f ? box.max.z : box.min.z,
+            };
+            if (glm::dot(normal, positive) + plane.w < 0.0f) {
+                return OUTSIDE;
+            }
+            const auto negative = box.min + box.max - positive;
+            if (glm::dot(normal, negative) + plane.w >= 0.0f) {
+                result &= ~(1u << i);
+            }
+        }
+        return result;
+    }
+
+    /// @returns The distance at which the ray enters the box, or `std::nullopt` if it misses the box within
+    /// `[0, max_distance]`. A ray starting inside the box enters it at `0`.
+    std::optional<float> intersect_ray(
+            const glm::vec3 &origin, const glm::vec3 &direction, const BoundingBox &box, const float max_distance
+    ) {
+        float near = 0.0f;
+        float far = max_distance;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (direction[axis] == 0.0f) {
+                if (origin[axis] < box.min[axis] || origin[axis] > box.max[axis]) {
+                    return std::nullopt;
+                }
+                continue;
+            }
+            const auto inverse = 1.0f / direction[axis];
+            auto t0 = (box.min[axis] - origin[axis]) * inverse;
+            auto t1 = (box.max[axis] - origin[axis]) * inverse;
+            if (t0 > t1) {
+                std::swap(t0, t1);
+            }
+            near = std::max(near, t0);
+            far = std::min(far, t1);
+            if (near > far) {
+                return std::nullopt;
+            }
+        }
+        return near;
+    }
+
+    /// @returns `true` if the box, swept along the direction, reaches the target box. The swept box meets the target
+    /// where the ray from its center meets the target grown by its half extents.
+    bool sweep_hits(const BoundingBox &box, const glm::vec3 &direction, const BoundingBox &target) {
+        const auto half_extent = (box.max - box.min) * 0.5f;
+        const BoundingBox grown{.min = target.min - half_extent, .max = target.max + half_extent};
+        return intersect_ray(box.get_center(), direction, grown, std::numeric_limits<float>::max()).has_value();
+    }
+
+    /// Builds the nodes top-down in depth-first order.
+    ///
+    /// The builder partitions copies of the boxes rather than the object indices, so every pass over the objects of a
+    /// node reads memory in order.
+    class Builder {
+        struct Reference {
+            BoundingBox bounds;
+            glm::vec3 centroid;
+            uint32_t object;
+        };
+
+        std::vector<Reference> references_;
+        std::vector<SceneBVH::Node> &nodes_;
+        const SceneBVHOptions &options_;
+
+        struct Bin {
+            BoundingBox bounds;
+            size_t count;
+        };
+
+        std::vector<Bin> bins_;
+        std::vector<float> right_costs_;
+
+    public:
+        Builder(std::span<const BoundingBox> bounds, std::vector<SceneBVH::Node> &nodes, const SceneBVHOptions &options)
+            : nodes_{nodes}
+            , options_{options}
+            , bins_(std::max<size_t>(options.bin_count, 2) * 3)
+            , right_costs_(bins_.size() / 3) {
+            references_.reserve(bounds.size());
+            for (size_t i = 0; i < bounds.size(); ++i) {
+                references_.push_back({
+                        .bounds = bounds[i],
+                        .centroid = bounds[i].get_center(),
+                        .object = static_cast<uint32_t>(i),
+                });
+            }
+        }
+
+        /// Replaces the indices with the objects in leaf order.
+        void get_object_indices(std::vector<uint32_t> &indices) const {
+            indices.resize(references_.size());
+            for (size_t i = 0; i < references_.size(); ++i) {
+                indices[i] = references_[i].object;
+            }
+        }
+
+        void build(const size_t begin, const size_t end, const size_t depth) {
+            const auto node_index = nodes_.size();
+            nodes_.push_back({});
+            auto box = get_empty_box();
+            auto centroid_box = get_empty_box();
+            for (size_t i = begin; i < end; ++i) {
+                const auto &reference = references_[i];
+                box = box.merge(reference.bounds);
+                centroid_box = centroid_box.merge({.min = reference.centroid, .max = reference.centroid});
+            }
+            const auto count = end - begin;
+            if (count <= std::max<size_t>(options_.max_leaf_size, 1)) {
+                nodes_[node_index] = {
+                        .bounds = box,
+                        .offset = static_cast<uint32_t>(begin),
+                        .object_count = static_cast<uint32_t>(count),
+                };
+                return;
+            }
+            auto middle = depth < MAX_SAH_DEPTH ? split_sah(begin, end, centroid_box) : end;
+            if (middle == begin || middle == end) {
+                middle = split_median(begin, end, centroid_box);
+            }
+            build(begin, middle, depth + 1);
+            const auto right_index = nodes_.size();
+            build(middle, end, depth + 1);
+            nodes_[node_index] = {.bounds = box, .offset = static_cast<uint32_t>(right_index), .object_count = 0};
+        }
+
+    private:
+        /// Partitions the objects at the bin boundary of least cost over all axes.
+        ///
+        /// @returns The first object of the second child, or `end` if the centroids do not spread.
+        size_t split_sah(const size_t begin, const size_t end, const BoundingBox &centroid_box) {
+            const auto bin_count = bins_.size() / 3;
+            // Bin along every axis in one pass over the objects, the bins of each axis following the previous ones.
+            glm::vec3 scale{0.0f};
+            for (int axis = 0; axis < 3; ++axis) {
+                const auto extent = centroid_box.max[axis] - centroid_box.min[axis];
+                scale[axis] = extent > 0.0f ? static_cast<float>(bin_count) / extent : 0.0f;
+            }
+            std::ranges::fill(bins_, Bin{.bounds = get_empty_box(), .count = 0});
+            for (size_t i = begin; i < end; ++i) {
+                const auto &reference = references_[i];
+                for (int axis = 0; axis < 3; ++axis) {
+                    const auto index = get_bin(reference.centroid[axis], centroid_box.min[axis], scale[axis]);
+                    auto &bin = bins_[axis * bin_count + index];
+                    bin.bounds = bin.bounds.merge(reference.bounds);
+                    ++bin.count;
+                }
+            }
+            float best_cost = std::numeric_limits<float>::max();
+            int best_axis = -1;
+            size_t best_split = 0;
+            for (int axis = 0; axis < 3; ++axis) {
+                if (scale[axis] == 0.0f) {
+                    continue;
+                }
+                const auto bins = std::span{bins_}.subspan(axis * bin_count, bin_count);
+                // Sweep from the right for the cost of the objects after each boundary, then from the left.
+                auto right = get_empty_box();
+                size_t right_count = 0;
+                for (size_t split = bin_count - 1; split > 0; --split) {
+                    right = right.merge(bins[split].bounds);
+                    right_count += bins[split].count;
+                    right_costs_[split] = right_count == 0 ? 0.0f : get_surface_area(right) * right_count;
+                }
+                auto left = get_empty_box();
+                size_t left_count = 0;
+                for (size_t split = 1; split < bin_count; ++split) {
+                    left = left.merge(bins[split - 1].bounds);
+                    left_count += bins[split - 1].count;
+                    if (left_count == 0 || left_count == end - begin) {
+                        continue;
+                    }
+                    const auto cost = get_surface_area(left) * left_count + right_costs_[split];
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_split = split;
+                    }
+                }
+            }
+            if (best_axis < 0) {
+                return end;
+            }
+            const auto min = centroid_box.min[best_axis];
+            const auto axis_scale = scale[best_axis];
+            const auto middle = std::partition(
+                    references_.begin() + begin, references_.begin() + end,
+                    [&](const Reference &reference) {
+                        return get_bin(reference.centroid[best_axis], min, axis_scale) < best_split;
+                    }
+            );
+            return static_cast<size_t>(middle - references_.begin());
+        }
+
+        /// Partitions the objects in half along the longest axis of the centroids.
+        ///
+        /// @returns The first object of the second child.
+        size_t split_median(const size_t begin, const size_t end, const BoundingBox &centroid_box) {
+            const auto extent = centroid_box.max - centroid_box.min;
+            const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+            const auto middle = begin + (end - begin) / 2;
+            std::nth_element(
+                    references_.begin() + begin, references_.begin() + middle, references_.begin() + end,
+                    [&](const Reference &a, const Reference &b) { return a.centroid[axis] < b.centroid[axis]; }
+            );
+            return middle;
+        }
+
+        [[nodiscard]]
+        size_t get_bin(const float value, const float min, const float scale) const {
+            const auto bin = static_cast<size_t>(std::max((value - min) * scale, 0.0f));
+            return std::min(bin, bins_.size() / 3 - 1);
+        }
+    };
+
+} // namespace
+
+void SceneBVH::build(const std::span<const BoundingBox> bounds, const SceneBVHOptions &options) {
+    nodes_.clear();
+    object_indices_.clear();
+    object_bounds_.assign(bounds.begin(), bounds.end());
+    if (bounds.empty()) {
+        return;
+    }
+    // A binary tree with leaves of at least one object has fewer than twice as many nodes as objects.
+    nodes_.reserve(bounds.size() * 2);
+    Builder builder{bounds, nodes_, options};
+    builder.build(0, bounds.size(), 0);
+    builder.get_object_indices(object_indices_);
+    nodes_.shrink_to_fit();
+}
+
+void SceneBVH::refit() {
+    // Children follow their parents, so a reverse pass visits them first.
+    for (auto i = nodes_.size(); i-- > 0;) {
+        auto &node = nodes_[i];
+        if (node.object_count > 0) {
+            node.bounds = object_bounds_[object_indices_[node.offset]];
+            for (uint32_t j = 1; j < node.object_count; ++j) {
+                node.bounds = node.bounds.merge(object_bounds_[object_indices_[node.offset + j]]);
+            }
+        } else {
+            node.bounds = nodes_[i + 1].bounds.merge(nodes_[node.offset].bounds);
+        }
+    }
+}
+
+void SceneBVH::query(const Frustum &frustum, std::vector<uint32_t> &objects, SceneBVHQueryStats *stats) const {
+    query_shadow_casters(frustum, glm::vec3{0.0f}, {}, objects, stats);
+}
+
+void SceneBVH::query_shadow_casters(
+        const Frustum &light_frustum, const glm::vec3 &light_direction, const BoundingBox &receivers,
+        std::vector<uint32_t> &objects, SceneBVHQueryStats *stats
+) const {
+    objects.clear();
+    if (nodes_.empty()) {
+        return;
+    }
+    // A zero direction skips the sweep test, which is how `SceneBVH::query` culls by the frustum alone.
+    const auto sweep = light_direction != glm::vec3{0.0f};
+    const auto passes = [&](const BoundingBox &box, uint32_t &mask) {
+        mask = mask == 0 ? 0 : classify(light_frustum, box, mask);
+        return mask != OUTSIDE && (!sweep || sweep_hits(box, light_direction, receivers));
+    };
+    struct Entry {
+        uint32_t node;
+        uint32_t mask;
+    };
+    std::array<Entry, STACK_SIZE> stack;
+    size_t stack_size = 0;
+    size_t node_count = 0;
+    stack[stack_size++] = {0, ALL_PLANES};
+    while (stack_size > 0) {
+        auto [node_index, mask] = stack[--stack_size];
+        const auto &node = nodes_[node_index];
+        ++node_count;
+        if (!passes(node.bounds, mask)) {
+            continue;
+        }
+        if (node.object_count == 0) {
+            stack[stack_size++] = {node.offset, mask};
+            stack[stack_size++] = {node_index + 1, mask};
+            continue;
+        }
+        for (uint32_t i = 0; i < node.object_count; ++i) {
+            const auto object = object_indices_[node.offset + i];
+            auto object_mask = mask;
+            // The box of a leaf with one object is the box of the object, which already passed.
+            if (node.object_count == 1 || passes(object_bounds_[object], object_mask)) {
+                objects.push_back(object);
+            }
+        }
+    }
+    if (stats) {
+        stats->node_count += node_count;
+        stats->object_count += objects.size();
+    }
+}
+
+std::optional<SceneBVHHit> SceneBVH::raycast(
+        const glm::vec3 &origin, const glm::vec3 &direction, const float max_distance,
+        const std::function<std::optional<float>(uint32_t object)> &intersect, SceneBVHQueryStats *stats
+) const {
+    if (nodes_.empty()) {
+        return std::nullopt;
+    }
+    std::optional<SceneBVHHit> hit;
+    auto nearest = max_distance;
+    struct Entry {
+        uint32_t node;
+        float distance;
+    };
+    std::array<Entry, STACK_SIZE> stack;
+    size_t stack_size = 0;
+    size_t node_count = 0;
+    if (const auto distance = intersect_ray(origin, direction, nodes_.front().bounds, nearest)) {
+        stack[stack_size++] = {0, *distance};
+    }
+    while (stack_size > 0) {
+        const auto [node_index, node_distance] = stack[--stack_size];
+        if (node_distance > nearest) {
+            continue;
+        }
+        const auto &node = nodes_[node_index];
+        ++node_count;
+        if (node.object_count == 0) {
+            const auto first = intersect_ray(origin, direction, nodes_[node_index + 1].bounds, nearest);
+            const auto second = intersect_ray(origin, direction, nodes_[node.offset].bounds, nearest);
+            // Push the farther child first, so the nearer one is visited first and tightens `nearest`.
+            Entry near_entry{node_index + 1, first.value_or(0.0f)};
+            Entry far_entry{node.offset, second.value_or(0.0f)};
+            if (first && second && *second < *first) {
+                std::swap(near_entry, far_entry);
+            }
+            if (first && second) {
+                stack[stack_size++] = far_entry;
+                stack[stack_size++] = near_entry;
+            } else if (first) {
+                stack[stack_size++] = near_entry;
+            } else if (second) {
+                stack[stack_size++] = far_entry;
+            }
+            continue;
+        }
+        for (uint32_t i = 0; i < node.object_count; ++i) {
+            const auto object = object_indices_[node.offset + i];
+            auto distance = intersect_ray(origin, direction, object_bounds_[object], nearest);
+            if (distance && intersect) {
+                distance = intersect(object);
+            }
+            if (distance && *distance >= 0.0f && *distance <= nearest) {
+                nearest = *distance;
+                hit = SceneBVHHit{.object = object, .distance = *distance};
+            }
+        }
+    }
+    if (stats) {
+        stats->node_count += node_count;
+        stats->object_count += hit ? 1 : 0;
+    }
+    return hit;
+}
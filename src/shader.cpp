@@ -1,38 +1,251 @@
 #include "glex/shader.h"
+#include <algorithm>
+#include <cctype>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <format>
 #include <memory>
 #include <spdlog/spdlog.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "glex/common.h"
 
-std::unique_ptr<Shader> Shader::create_from_file(const std::string &filename, const GLenum shader_type) {
-    const auto shader_id = glCreateShader(shader_type);
-    if (shader_id == 0) {
+namespace fs = std::filesystem;
+
+namespace {
+
+    /// Returns the line without leading whitespace if it is a preprocessor directive, or an empty string otherwise.
+    std::string_view get_directive(const std::string_view line) {
+        const auto begin = line.find_first_not_of(" \t");
+        if (begin == std::string_view::npos || line[begin] != '#') {
+            return {};
+        }
+        return line.substr(begin);
+    }
+
+    /// Parses the file name of an `#include "path"` directive.
+    std::optional<std::string_view> parse_include_name(const std::string_view directive) {
+        const auto begin = directive.find('"');
+        const auto end = directive.rfind('"');
+        if (begin == std::string_view::npos || end == begin) {
+            return std::nullopt;
+        }
+        return directive.substr(begin + 1, end - begin - 1);
+    }
+
+    /// Appends the source code of a file to the output with its `#include` directives expanded.
+    ///
+    /// @param path: The path of the file.
+    /// @param files: The files included so far. The index of a file is its source string number.
+    /// @param output: The expanded source code.
+    bool expand_includes(const fs::path &path, std::vector<fs::path> &files, std::string &output) {
+        const auto source = load_text_file(path.string());
+        if (!source) {
+            return false;
+        }
+        const bool is_main_file = files.empty();
+        const auto source_index = files.size();
+        files.push_back(path);
+        if (!is_main_file) {
+            output += std::format("#line 1 {}\n", source_index);
+        }
+
+        std::istringstream is{*source};
+        std::string line;
+        size_t line_number = 0;
+        while (std::getline(is, line)) {
+            ++line_number;
+            const auto directive = get_directive(line);
+            if (directive.starts_with("#include")) {
+                const auto name = parse_include_name(directive);
+                if (!name) {
+                    SPDLOG_ERROR("Invalid include directive: \"{}\":{}", path.string(), line_number);
+                    return false;
+                }
+                const auto include_path = (path.parent_path() / *name).lexically_normal();
+                if (std::ranges::find(files, include_path) != files.end()) {
+                    // Already included. Keep the line to preserve line numbers.
+                    output += '\n';
+                    continue;
+                }
+                if (!expand_includes(include_path, files, output)) {
+                    SPDLOG_ERROR("Included from: \"{}\":{}", path.string(), line_number);
+                    return false;
+                }
+                output += std::format("#line {} {}\n", line_number + 1, source_index);
+                continue;
+            }
+            output += line;
+            output += '\n';
+        }
+        return true;
+    }
+
+    /// Checks whether an identifier occurs in source code as a whole word.
+    bool contains_identifier(const std::string_view source, const std::string_view name) {
+        const auto is_identifier_char = [](const char ch) {
+            return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+        };
+        for (auto pos = source.find(name); pos != std::string_view::npos; pos = source.find(name, pos + 1)) {
+            const auto end = pos + name.size();
+            if ((pos == 0 || !is_identifier_char(source[pos - 1])) &&
+                (end == source.size() || !is_identifier_char(source[end]))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace
+
+ShaderDefines::ShaderDefines(const std::initializer_list<std::pair<std::string, std::string>> defines) {
+    for (const auto &[name, value] : defines) {
+        set(name, value);
+    }
+}
+
+ShaderDefines &ShaderDefines::set(const std::string_view name, const std::string_view value) {
+    const auto it = std::ranges::lower_bound(defines_, name, {}, [](const auto &define) {
+        return std::string_view{define.first};
+    });
+    if (it != defines_.end() && it->first == name) {
+        it->second = value;
+    } else {
+        defines_.emplace(it, name, value);
+    }
+    return *this;
+}
+
+ShaderDefines &ShaderDefines::set(const std::string_view name, const int value) {
+    return set(name, std::to_string(value));
+}
+
+std::string ShaderDefines::get_key() const {
+    std::string key;
+    for (const auto &[name, value] : defines_) {
+        if (!key.empty()) {
+            key += ';';
+        }
+        key += value.empty() ? name : std::format("{}={}", name, value);
+    }
+    return key;
+}
+
+std::string ShaderDefines::to_source() const {
+    std::string source;
+    for (const auto &[name, value] : defines_) {
+        source += std::format("#define {} {}\n", name, value);
+    }
+    return source;
+}
+
+std::unique_ptr<Shader>
+Shader::create_from_file(const std::string &filename, const GLenum shader_type, const ShaderDefines &defines) {
+    const auto code = load_source(filename, defines);
+    if (!code) {
         SPDLOG_ERROR("Failed to create shader");
         return nullptr;
     }
-    auto shader = std::unique_ptr<Shader>{new Shader{shader_id}};
-    if (!shader->load_file(filename)) {
+    return create_from_source(*code, shader_type, filename);
+}
+
+std::unique_ptr<Shader>
+Shader::create_from_source(const std::string &source, const GLenum shader_type, const std::string &name) {
+    auto shader = create_pending(source, shader_type, name);
+    if (!shader || !shader->is_compiled()) {
         SPDLOG_ERROR("Failed to create shader");
         return nullptr;
     }
-    SPDLOG_INFO("Shader has been created: \"{}\", id: {}", filename, shader->get());
+    SPDLOG_INFO("Shader has been created: \"{}\", id: {}", name, shader->get());
     return std::move(shader);
 }
 
-bool Shader::load_file(const std::string &filename) const {
-    const auto code = load_text_file(filename);
-    if (!code) {
-        return false;
+std::unique_ptr<Shader>
+Shader::create_pending(const std::string &source, const GLenum shader_type, const std::string &name) {
+    const auto shader_id = glCreateShader(shader_type);
+    if (shader_id == 0) {
+        SPDLOG_ERROR("Failed to create shader");
+        return nullptr;
+    }
+    auto shader = std::unique_ptr<Shader>{new Shader{shader_id, name}};
+    shader->submit(source);
+    return std::move(shader);
+}
+
+std::shared_ptr<Shader>
+Shader::create_shared(const std::string &source, const GLenum shader_type, const std::string &name) {
+    // Shaders are not owned by the cache, so they are deleted with the last program using them.
+    static std::unordered_map<std::string, std::weak_ptr<Shader>> cache;
+
+    auto key = std::format("{}:", shader_type);
+    key += source;
+    if (const auto it = cache.find(key); it != cache.end()) {
+        if (auto shader = it->second.lock()) {
+            SPDLOG_DEBUG("Reuse compiled shader: \"{}\", id: {}", name, shader->get());
+            return shader;
+        }
+    }
+
+    std::shared_ptr<Shader> shader = create_pending(source, shader_type, name);
+    if (!shader) {
+        return nullptr;
+    }
+    std::erase_if(cache, [](const auto &entry) { return entry.second.expired(); });
+    cache.insert_or_assign(std::move(key), shader);
+    return shader;
+}
+
+std::optional<std::string> Shader::load_source(const std::string &filename, const ShaderDefines &defines) {
+    std::vector<fs::path> files;
+    std::string source;
+    if (!expand_includes(fs::path{filename}.lexically_normal(), files, source)) {
+        SPDLOG_ERROR("Failed to load shader source: \"{}\"", filename);
+        return std::nullopt;
     }
 
-    const char *code_ptr = code->c_str();
-    const auto code_length = static_cast<int32_t>(code->length());
+    // Inject only the definitions the shader refers to, so that stages unaffected by a permutation stay identical
+    // and are shared through `Shader::create_shared`.
+    ShaderDefines used_defines;
+    for (const auto &[name, value] : defines.get_all()) {
+        if (contains_identifier(source, name)) {
+            used_defines.set(name, value);
+        }
+    }
+    if (used_defines.empty()) {
+        return source;
+    }
+
+    // Definitions must follow the `#version` directive if there is one.
+    size_t insert_pos = 0;
+    size_t next_line = 1;
+    for (size_t pos = 0, line = 1; pos < source.size(); ++line) {
+        const auto end = std::min(source.find('\n', pos), source.size());
+        if (get_directive(std::string_view{source}.substr(pos, end - pos)).starts_with("#version")) {
+            insert_pos = std::min(end + 1, source.size());
+            next_line = line + 1;
+            break;
+        }
+        pos = end + 1;
+    }
+    source.insert(insert_pos, std::format("{}#line {} 0\n", used_defines.to_source(), next_line));
+    return source;
+}
+
+void Shader::submit(const std::string &source) const {
+    const char *code_ptr = source.c_str();
+    const auto code_length = static_cast<int32_t>(source.length());
 
     // Compile shader.
     glShaderSource(shader_, 1, &code_ptr, &code_length);
     glCompileShader(shader_);
+}
 
+bool Shader::is_compiled() const {
     // Check if compilation is successful.
     int success = 0;
     glGetShaderiv(shader_, GL_COMPILE_STATUS, &success);
@@ -40,7 +253,7 @@ bool Shader::load_file(const std::string &filename) const {
         constexpr size_t LOG_SIZE = 1024;
         char info_log[LOG_SIZE];
         glad_glGetShaderInfoLog(shader_, LOG_SIZE, nullptr, info_log);
-        SPDLOG_ERROR("Failed to compile shader: \"{}\"", filename);
+        SPDLOG_ERROR("Failed to compile shader: \"{}\"", name_);
         SPDLOG_ERROR("reason: {}", info_log);
         return false;
     }
@@ -48,8 +261,9 @@ bool Shader::load_file(const std::string &filename) const {
     return true;
 }
 
-Shader::Shader(const uint32_t shader)
-    : shader_{shader} {}
+Shader::Shader(const uint32_t shader, std::string name)
+    : shader_{shader}
+    , name_{std::move(name)} {}
 
 Shader::~Shader() {
     if (shader_) {
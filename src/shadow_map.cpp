@@ -1,18 +1,22 @@
 #include "glex/shadow_map.h"
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <spdlog/spdlog.h>
 #include "glex/common.h"
+#include "glex/gl_state_cache.h"
+#include "glex/mesh.h"
 
 std::unique_ptr<ShadowMap> ShadowMap::create(int width, int height) {
     uint32_t framebuffer_id;
     glGenFramebuffers(1, &framebuffer_id);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+    GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, framebuffer_id);
 
     const std::shared_ptr shadow_map = Texture::create(width, height, GL_DEPTH_COMPONENT, GL_FLOAT);
     if (!shadow_map) {
         SPDLOG_ERROR("Failed to complete creating shadow map framebuffer, shadow_map creation failed");
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, 0);
         return nullptr;
     }
     shadow_map->set_filter(GL_LINEAR, GL_LINEAR);
@@ -25,11 +29,11 @@ std::unique_ptr<ShadowMap> ShadowMap::create(int width, int height) {
 
     if (auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER); status != GL_FRAMEBUFFER_COMPLETE) {
         SPDLOG_ERROR("Failed to complete creating shadow map framebuffer: {}", status);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, 0);
         return nullptr;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, 0);
     SPDLOG_INFO("Shadow map has been created, framebuffer id: {}", framebuffer_id);
     return std::unique_ptr<ShadowMap>{new ShadowMap{framebuffer_id, shadow_map}};
 }
@@ -38,11 +42,23 @@ ShadowMap::~ShadowMap() {
     if (framebuffer_) {
         SPDLOG_INFO("Delete shadow map, framebuffer id: {}", framebuffer_);
         glDeleteFramebuffers(1, &framebuffer_);
+        GLStateCache::forget_framebuffer(framebuffer_);
     }
 }
 
 void ShadowMap::bind() const {
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    GLStateCache::bind_framebuffer(GL_FRAMEBUFFER, framebuffer_);
+}
+
+glm::mat4 ShadowMap::get_light_transform(const glm::vec3 &direction, const BoundingSphere &bounds) {
+    const auto forward = glm::normalize(direction);
+    // Any up vector not parallel to the light works for a directional light.
+    const auto up = std::abs(forward.y) > 0.99f ? glm::vec3{0.0f, 0.0f, 1.0f} : glm::vec3{0.0f, 1.0f, 0.0f};
+    const auto radius = std::max(bounds.radius, 0.001f);
+    const auto eye = bounds.center - forward * radius;
+    const auto view = glm::lookAt(eye, bounds.center, up);
+    const auto projection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+    return projection * view;
 }
 
 ShadowMap::ShadowMap(const uint32_t framebuffer_id, const std::shared_ptr<Texture> shadow_map)
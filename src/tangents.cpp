@@ -0,0 +1,269 @@
+#include "glex/tangents.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <span>
+#include <vector>
+#include "glex/common.h"
+#include "glex/thread_pool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TANGENTS_USE_SSE2
+#endif
+
+namespace {
+
+    /// Triangles and vertices below which a chunk is not worth a task of its own.
+    constexpr size_t MIN_TRIANGLES_PER_TASK{16384};
+    constexpr size_t MIN_VERTICES_PER_TASK{16384};
+    /// Squared length below which a tangent is considered degenerate.
+    constexpr float MIN_TANGENT_LENGTH2{1.0e-20f};
+
+    /// Four floats computed in lockstep, with SSE2 if available.
+    struct Float4 {
+#ifdef TANGENTS_USE_SSE2
+        __m128 v;
+
+        static Float4 load(const float *p) {
+            return {_mm_loadu_ps(p)};
+        }
+
+        static Float4 splat(const float x) {
+            return {_mm_set1_ps(x)};
+        }
+
+        void store(float *p) const {
+            _mm_storeu_ps(p, v);
+        }
+
+        friend Float4 operator+(const Float4 a, const Float4 b) {
+            return {_mm_add_ps(a.v, b.v)};
+        }
+
+        friend Float4 operator-(const Float4 a, const Float4 b) {
+            return {_mm_sub_ps(a.v, b.v)};
+        }
+
+        friend Float4 operator*(const Float4 a, const Float4 b) {
+            return {_mm_mul_ps(a.v, b.v)};
+        }
+
+        /// @returns `a / b`, or `0` where `b` is `0`.
+        friend Float4 div_or_zero(const Float4 a, const Float4 b) {
+            const auto nonzero = _mm_cmpneq_ps(b.v, _mm_setzero_ps());
+            return {_mm_and_ps(nonzero, _mm_div_ps(a.v, b.v))};
+        }
+
+        friend Float4 sqrt(const Float4 a) {
+            return {_mm_sqrt_ps(a.v)};
+        }
+#else
+        std::array<float, 4> v;
+
+        static Float4 load(const float *p) {
+            return {{p[0], p[1], p[2], p[3]}};
+        }
+
+        static Float4 splat(const float x) {
+            return {{x, x, x, x}};
+        }
+
+        void store(float *p) const {
+            std::copy(v.begin(), v.end(), p);
+        }
+
+        friend Float4 operator+(const Float4 a, const Float4 b) {
+            return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+        }
+
+        friend Float4 operator-(const Float4 a, const Float4 b) {
+            return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+        }
+
+        friend Float4 operator*(const Float4 a, const Float4 b) {
+            return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+        }
+
+        /// @returns `a / b`, or `0` where `b` is `0`.
+        friend Float4 div_or_zero(const Float4 a, const Float4 b) {
+            Float4 result{};
+            for (size_t i = 0; i < 4; ++i) {
+                result.v[i] = b.v[i] != 0.0f ? a.v[i] / b.v[i] : 0.0f;
+            }
+            return result;
+        }
+
+        friend Float4 sqrt(const Float4 a) {
+            return {{std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3])}};
+        }
+#endif
+    };
+
+    /// Four 3D vectors in structure-of-arrays form.
+    struct Vec3x4 {
+        Float4 x, y, z;
+
+        friend Vec3x4 operator-(const Vec3x4 &a, const Vec3x4 &b) {
+            return {a.x - b.x, a.y - b.y, a.z - b.z};
+        }
+
+        friend Vec3x4 operator*(const Vec3x4 &a, const Float4 s) {
+            return {a.x * s, a.y * s, a.z * s};
+        }
+
+        friend Float4 dot(const Vec3x4 &a, const Vec3x4 &b) {
+            return a.x * b.x + a.y * b.y + a.z * b.z;
+        }
+    };
+
+    /// Transposes four vectors into lanes. Missing vectors are zero.
+    Vec3x4 gather(const std::array<glm::vec3, 4> &vectors) {
+        alignas(16) float x[4], y[4], z[4];
+        for (size_t i = 0; i < 4; ++i) {
+            x[i] = vectors[i].x;
+            y[i] = vectors[i].y;
+            z[i] = vectors[i].z;
+        }
+        return {Float4::load(x), Float4::load(y), Float4::load(z)};
+    }
+
+    /// Transposes lanes back into four vectors.
+    std::array<glm::vec3, 4> scatter(const Vec3x4 &lanes) {
+        alignas(16) float x[4], y[4], z[4];
+        lanes.x.store(x);
+        lanes.y.store(y);
+        lanes.z.store(z);
+        return {glm::vec3{x[0], y[0], z[0]}, {x[1], y[1], z[1]}, {x[2], y[2], z[2]}, {x[3], y[3], z[3]}};
+    }
+
+    /// Adds the tangents of the triangles in `[first, last)` to the vertices of each triangle in `sums`.
+    void accumulate_tangents(
+            const std::span<const Vertex> vertices, const std::span<const uint32_t> indices, const size_t first,
+            const size_t last, std::vector<glm::vec3> &sums
+    ) {
+        for (size_t triangle = first; triangle < last; triangle += 4) {
+            const auto count = std::min<size_t>(4, last - triangle);
+            std::array<glm::vec3, 4> p0{}, p1{}, p2{}, uv0{}, uv1{}, uv2{};
+            for (size_t i = 0; i < count; ++i) {
+                const auto index = indices.data() + (triangle + i) * 3;
+                const auto &v0 = vertices[index[0]];
+                const auto &v1 = vertices[index[1]];
+                const auto &v2 = vertices[index[2]];
+                p0[i] = v0.position;
+                p1[i] = v1.position;
+                p2[i] = v2.position;
+                uv0[i] = glm::vec3{v0.tex_coord, 0.0f};
+                uv1[i] = glm::vec3{v1.tex_coord, 0.0f};
+                uv2[i] = glm::vec3{v2.tex_coord, 0.0f};
+            }
+            // Solve `edge = delta_u * T + delta_v * B` for the tangent of four triangles at once. Padding lanes have a
+            // zero determinant and get a zero tangent.
+            const auto base = gather(p0);
+            const auto edge1 = gather(p1) - base;
+            const auto edge2 = gather(p2) - base;
+            const auto base_uv = gather(uv0);
+            const auto delta_uv1 = gather(uv1) - base_uv;
+            const auto delta_uv2 = gather(uv2) - base_uv;
+            const auto det = delta_uv1.x * delta_uv2.y - delta_uv1.y * delta_uv2.x;
+            const auto numerator = edge1 * delta_uv2.y - edge2 * delta_uv1.y;
+            const auto tangents = scatter(
+                    {div_or_zero(numerator.x, det), div_or_zero(numerator.y, det), div_or_zero(numerator.z, det)}
+            );
+            for (size_t i = 0; i < count; ++i) {
+                const auto index = indices.data() + (triangle + i) * 3;
+                sums[index[0]] += tangents[i];
+                sums[index[1]] += tangents[i];
+                sums[index[2]] += tangents[i];
+            }
+        }
+    }
+
+    /// @returns A unit vector perpendicular to the normal.
+    glm::vec3 get_any_tangent(const glm::vec3 &normal) {
+        const auto axis = std::abs(normal.x) < 0.9f ? glm::vec3{1.0f, 0.0f, 0.0f} : glm::vec3{0.0f, 1.0f, 0.0f};
+        const auto tangent = axis - normal * glm::dot(normal, axis);
+        const auto length2 = glm::dot(tangent, tangent);
+        return length2 > MIN_TANGENT_LENGTH2 ? tangent / std::sqrt(length2) : axis;
+    }
+
+    /// Sums the tangents of the vertices in `[first, last)` over `sums`, orthogonalizes them against the normals with
+    /// Gram-Schmidt, and normalizes them.
+    void resolve_tangents(
+            const std::span<Vertex> vertices, const std::span<const std::vector<glm::vec3>> sums, const size_t first,
+            const size_t last
+    ) {
+        for (size_t vertex = first; vertex < last; vertex += 4) {
+            const auto count = std::min<size_t>(4, last - vertex);
+            std::array<glm::vec3, 4> tangents{}, normals{};
+            for (size_t i = 0; i < count; ++i) {
+                for (const auto &thread_sums : sums) {
+                    tangents[i] += thread_sums[vertex + i];
+                }
+                normals[i] = vertices[vertex + i].normal;
+            }
+            const auto normal = gather(normals);
+            auto tangent = gather(tangents);
+            tangent = tangent - normal * dot(normal, tangent);
+            const auto length2 = dot(tangent, tangent);
+            const auto inv_length = div_or_zero(Float4::splat(1.0f), sqrt(length2));
+            const auto results = scatter(tangent * inv_length);
+            alignas(16) float lengths2[4];
+            length2.store(lengths2);
+            for (size_t i = 0; i < count; ++i) {
+                vertices[vertex + i].tangent =
+                        lengths2[i] > MIN_TANGENT_LENGTH2 ? results[i] : get_any_tangent(normals[i]);
+            }
+        }
+    }
+
+    /// Runs `task(i, first, last)` for `task_count` equal chunks of `[0, size)`, the first on the calling thread and
+    /// the others on the pool, and waits for all of them.
+    template<typename F>
+    void run_chunks(ThreadPool &pool, const size_t task_count, const size_t size, const F &task) {
+        const auto chunk_size = (size + task_count - 1) / task_count;
+        std::vector<std::future<void>> futures;
+        futures.reserve(task_count - 1);
+        for (size_t i = 1; i < task_count; ++i) {
+            const auto first = std::min(i * chunk_size, size);
+            const auto last = std::min(first + chunk_size, size);
+            futures.push_back(pool.submit([&task, i, first, last] { task(i, first, last); }));
+        }
+        task(0, 0, std::min(chunk_size, size));
+        for (auto &future : futures) {
+            future.get();
+        }
+    }
+
+} // namespace
+
+void generate_tangents(
+        const std::span<Vertex> vertices, const std::span<const uint32_t> indices, const TangentOptions &options
+) {
+    const auto triangle_count = indices.size() / 3;
+    auto &pool = options.pool ? *options.pool : ThreadPool::get_default();
+    const auto thread_count = options.max_threads ? options.max_threads : pool.get_thread_count() + 1;
+    const auto task_count = std::clamp<size_t>(
+            std::min(triangle_count / MIN_TRIANGLES_PER_TASK, vertices.size() / MIN_VERTICES_PER_TASK), 1,
+            thread_count
+    );
+
+    // Each task accumulates into its own array, so the scattered additions need no synchronization.
+    std::vector<std::vector<glm::vec3>> sums(task_count);
+    if (task_count == 1) {
+        sums.front().assign(vertices.size(), glm::vec3{0.0f});
+        accumulate_tangents(vertices, indices, 0, triangle_count, sums.front());
+        resolve_tangents(vertices, sums, 0, vertices.size());
+        return;
+    }
+    run_chunks(pool, task_count, triangle_count, [&](const size_t i, const size_t first, const size_t last) {
+        sums[i].assign(vertices.size(), glm::vec3{0.0f});
+        accumulate_tangents(vertices, indices, first, last, sums[i]);
+    });
+    run_chunks(pool, task_count, vertices.size(), [&](size_t, const size_t first, const size_t last) {
+        resolve_tangents(vertices, sums, first, last);
+    });
+}
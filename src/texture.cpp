@@ -1,4 +1,6 @@
 #include "glex/texture.h"
+#include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -6,6 +8,8 @@
 #include <memory>
 #include <spdlog/spdlog.h>
 #include "glex/common.h"
+#include "glex/gl_state_cache.h"
+#include "glex/sampler.h"
 
 namespace {
 
@@ -30,9 +34,70 @@ namespace {
         return GL_RGBA;
     }
 
+    /// `glTexStorage2D` requires sized internal formats.
+    constexpr GLenum get_sized_format(const GLenum format, const GLenum type) {
+        switch (format) {
+        case GL_DEPTH_COMPONENT: return type == GL_FLOAT ? GL_DEPTH_COMPONENT32F : GL_DEPTH_COMPONENT24;
+        case GL_RED: return GL_R8;
+        case GL_RG: return GL_RG8;
+        case GL_RGB: return GL_RGB8;
+        case GL_RGBA: return GL_RGBA8;
+        default: return format;
+        }
+    }
+
+    /// @returns The number of levels of the full mip chain down to 1x1.
+    uint32_t get_full_mip_levels(const size_t width, const size_t height) {
+        return static_cast<uint32_t>(std::bit_width(std::max<size_t>({width, height, 1})));
+    }
+
+    using TexStorage2DProc =
+            void(APIENTRYP)(GLenum target, GLsizei levels, GLenum internal_format, GLsizei width, GLsizei height);
+
+    /// @returns `glTexStorage2D` from OpenGL 4.2 or `GL_ARB_texture_storage`, or `nullptr` if neither is supported.
+    TexStorage2DProc get_tex_storage_2d() {
+        static const auto tex_storage_2d = []() -> TexStorage2DProc {
+            if (glTexStorage2D) {
+                return glTexStorage2D;
+            }
+            if (glfwExtensionSupported("GL_ARB_texture_storage")) {
+                return reinterpret_cast<TexStorage2DProc>(glfwGetProcAddress("glTexStorage2D"));
+            }
+            SPDLOG_INFO("Immutable texture storage is not supported, mutable storage is used instead");
+            return nullptr;
+        }();
+        return tex_storage_2d;
+    }
+
+    /// Allocates every level of the texture bound to `target`, which is `GL_TEXTURE_2D` or `GL_TEXTURE_CUBE_MAP`.
+    void allocate_storage(
+            const GLenum target, const bool immutable, const uint32_t levels, const GLenum format, const GLenum type,
+            const size_t width, const size_t height
+    ) {
+        if (const auto tex_storage_2d = get_tex_storage_2d(); immutable && tex_storage_2d) {
+            tex_storage_2d(target, levels, get_sized_format(format, type), width, height);
+            return;
+        }
+        const auto image_format = get_image_format(format);
+        const auto face_count = target == GL_TEXTURE_CUBE_MAP ? 6u : 1u;
+        for (uint32_t level = 0; level < levels; ++level) {
+            const auto level_width = std::max<size_t>(width >> level, 1);
+            const auto level_height = std::max<size_t>(height >> level, 1);
+            for (uint32_t face = 0; face < face_count; ++face) {
+                const auto face_target = target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : target;
+                glTexImage2D(
+                        face_target, static_cast<GLint>(level), format, level_width, level_height, 0, image_format,
+                        type, nullptr
+                );
+            }
+        }
+        // Keep mutable textures complete with exactly the allocated levels.
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels - 1));
+    }
+
 } // namespace
 
-std::unique_ptr<Texture> Texture::create(const Image &image) {
+std::unique_ptr<Texture> Texture::create(const Image &image, const TextureOptions &options) {
     uint32_t texture_id;
     glGenTextures(1, &texture_id);
     if (const auto error = glGetError(); error != GL_NO_ERROR) {
@@ -50,9 +115,22 @@ std::unique_ptr<Texture> Texture::create(const Image &image) {
     // GL_LINEAR_MIPMAP_LINEAR: Trilinear interpolation
     texture->set_filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
     texture->set_wrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-    glTexImage2D(
-            GL_TEXTURE_2D, 0, texture_format, image.get_width(), image.get_height(), 0, format, type, image.get_data()
-    );
+    texture->sampler_ = options.sampler;
+    if (options.immutable || options.mip_levels > 0) {
+        const auto levels = options.mip_levels > 0 ? options.mip_levels
+                                                   : get_full_mip_levels(image.get_width(), image.get_height());
+        allocate_storage(
+                GL_TEXTURE_2D, options.immutable, levels, texture_format, type, image.get_width(), image.get_height()
+        );
+        glTexSubImage2D(
+                GL_TEXTURE_2D, 0, 0, 0, image.get_width(), image.get_height(), format, type, image.get_data()
+        );
+    } else {
+        glTexImage2D(
+                GL_TEXTURE_2D, 0, texture_format, image.get_width(), image.get_height(), 0, format, type,
+                image.get_data()
+        );
+    }
     glGenerateMipmap(GL_TEXTURE_2D);
     SPDLOG_INFO(
             "Texture image has been set: {}x{}, {} channels", image.get_width(), image.get_height(),
@@ -62,7 +140,10 @@ std::unique_ptr<Texture> Texture::create(const Image &image) {
     return std::move(texture);
 }
 
-std::unique_ptr<Texture> Texture::create(size_t width, size_t height, uint32_t format, uint32_t type) {
+std::unique_ptr<Texture> Texture::create(
+        const size_t width, const size_t height, const uint32_t format, const uint32_t type,
+        const TextureOptions &options
+) {
     uint32_t texture_id;
     glGenTextures(1, &texture_id);
     if (const auto error = glGetError(); error != GL_NO_ERROR) {
@@ -73,12 +154,35 @@ std::unique_ptr<Texture> Texture::create(size_t width, size_t height, uint32_t f
     texture->bind();
     texture->set_filter(GL_LINEAR, GL_LINEAR);
     texture->set_wrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-    GLenum image_format = get_image_format(format);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, image_format, type, nullptr);
+    texture->sampler_ = options.sampler;
+    if (options.immutable || options.mip_levels > 0) {
+        allocate_storage(
+                GL_TEXTURE_2D, options.immutable, std::max(options.mip_levels, 1u), format, type, width, height
+        );
+    } else {
+        GLenum image_format = get_image_format(format);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, image_format, type, nullptr);
+    }
     SPDLOG_INFO("Texture has been created: {}", texture_id);
     return texture;
 }
 
+std::unique_ptr<Texture> Texture::create_storage(const Image &image, const TextureOptions &options) {
+    const auto texture_format = channels_to_format(image.get_channels(), image.get_bytes_per_channel() == 4);
+    const uint32_t type = image.get_bytes_per_channel() == 4 ? GL_FLOAT : GL_UNSIGNED_BYTE;
+    // Allocate the whole mip chain up front, which is filled later by `glGenerateMipmap`.
+    auto storage_options = options;
+    if (storage_options.mip_levels == 0) {
+        storage_options.mip_levels = get_full_mip_levels(image.get_width(), image.get_height());
+    }
+    auto texture = create(image.get_width(), image.get_height(), texture_format, type, storage_options);
+    if (!texture) {
+        return nullptr;
+    }
+    texture->set_filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+    return std::move(texture);
+}
+
 Texture::Texture(uint32_t texture_id, size_t width, size_t height, uint32_t format, uint32_t type)
     : texture_{texture_id}
     , width_{width}
@@ -90,11 +194,16 @@ Texture::~Texture() {
     if (texture_) {
         SPDLOG_INFO("Delete texture: {}", texture_);
         glDeleteTextures(1, &texture_);
+        GLStateCache::forget_texture(texture_);
     }
 }
 
+uint32_t Texture::get_pixel_format() const {
+    return get_image_format(format_);
+}
+
 void Texture::bind() const {
-    glBindTexture(GL_TEXTURE_2D, texture_);
+    GLStateCache::bind_texture(GL_TEXTURE_2D, placeholder_ ? placeholder_->texture_ : texture_);
 }
 
 void Texture::bind_to_unit(uint32_t texture_unit) const {
@@ -102,26 +211,32 @@ void Texture::bind_to_unit(uint32_t texture_unit) const {
         SPDLOG_ERROR("Texture unit id to bind must be between 0 and 31, got: {}", texture_unit);
         return;
     }
-    glActiveTexture(GL_TEXTURE0 + texture_unit);
-    bind();
+    GLStateCache::bind_texture_to_unit(texture_unit, GL_TEXTURE_2D, placeholder_ ? placeholder_->texture_ : texture_);
+    GLStateCache::bind_sampler(texture_unit, sampler_ ? sampler_->get() : 0);
 }
 
 void Texture::set_filter(const int32_t min_filter, const int32_t mag_filter) const {
+    // Bind the texture itself, not its placeholder.
+    GLStateCache::bind_texture(GL_TEXTURE_2D, texture_);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
 }
 
 void Texture::set_wrap(const int32_t s_wrap, const int32_t t_wrap) const {
+    GLStateCache::bind_texture(GL_TEXTURE_2D, texture_);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, s_wrap);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, t_wrap);
 }
 
 void Texture::set_border_color(const glm::vec4 &color) const {
+    GLStateCache::bind_texture(GL_TEXTURE_2D, texture_);
     glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, glm::value_ptr(color));
 }
 
 std::unique_ptr<CubeTexture>
-CubeTexture::create_from_images(const std::vector<std::reference_wrapper<const Image>> &images) {
+CubeTexture::create_from_images(
+        const std::vector<std::reference_wrapper<const Image>> &images, const TextureOptions &options
+) {
     uint32_t texture_id;
     glGenTextures(1, &texture_id);
     if (const auto error = glGetError(); error != GL_NO_ERROR) {
@@ -142,19 +257,38 @@ CubeTexture::create_from_images(const std::vector<std::reference_wrapper<const I
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    cube_texture->sampler_ = options.sampler;
     // Apply each images to cube map texture.
-    for (size_t i = 0; i < images.size(); ++i) {
-        const auto &image = images[i].get();
-        glTexImage2D(
-                GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<uint32_t>(i), 0, internal_format, image.get_width(),
-                image.get_height(), 0, format, type, image.get_data()
+    if (options.immutable || options.mip_levels > 0) {
+        const auto width = images[0].get().get_width();
+        const auto height = images[0].get().get_height();
+        allocate_storage(
+                GL_TEXTURE_CUBE_MAP, options.immutable, std::max(options.mip_levels, 1u), internal_format, type, width,
+                height
         );
+        for (size_t i = 0; i < images.size(); ++i) {
+            glTexSubImage2D(
+                    GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<uint32_t>(i), 0, 0, 0, width, height, format, type,
+                    images[i].get().get_data()
+            );
+        }
+    } else {
+        for (size_t i = 0; i < images.size(); ++i) {
+            const auto &image = images[i].get();
+            glTexImage2D(
+                    GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<uint32_t>(i), 0, internal_format, image.get_width(),
+                    image.get_height(), 0, format, type, image.get_data()
+            );
+        }
     }
     SPDLOG_INFO("Cube texture has been created: {}", texture_id);
     return std::move(cube_texture);
 }
 
-std::unique_ptr<CubeTexture> CubeTexture::create(size_t width, size_t height, uint32_t format, uint32_t type) {
+std::unique_ptr<CubeTexture> CubeTexture::create(
+        const size_t width, const size_t height, const uint32_t format, const uint32_t type,
+        const TextureOptions &options
+) {
     uint32_t texture_id;
     glGenTextures(1, &texture_id);
     if (const auto error = glGetError(); error != GL_NO_ERROR) {
@@ -169,12 +303,19 @@ std::unique_ptr<CubeTexture> CubeTexture::create(size_t width, size_t height, ui
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    const auto image_format = get_image_format(format);
-    for (size_t i = 0; i < 6; ++i) {
-        glTexImage2D(
-                GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<uint32_t>(i), 0, format, width, height, 0, image_format,
-                type, nullptr
+    cube_texture->sampler_ = options.sampler;
+    if (options.immutable || options.mip_levels > 0) {
+        allocate_storage(
+                GL_TEXTURE_CUBE_MAP, options.immutable, std::max(options.mip_levels, 1u), format, type, width, height
         );
+    } else {
+        const auto image_format = get_image_format(format);
+        for (size_t i = 0; i < 6; ++i) {
+            glTexImage2D(
+                    GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<uint32_t>(i), 0, format, width, height, 0,
+                    image_format, type, nullptr
+            );
+        }
     }
 
     return std::move(cube_texture);
@@ -183,11 +324,17 @@ std::unique_ptr<CubeTexture> CubeTexture::create(size_t width, size_t height, ui
 CubeTexture::~CubeTexture() {
     if (cube_texture_) {
         glDeleteTextures(1, &cube_texture_);
+        GLStateCache::forget_texture(cube_texture_);
     }
 }
 
 void CubeTexture::bind() const {
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cube_texture_);
+    GLStateCache::bind_texture(GL_TEXTURE_CUBE_MAP, cube_texture_);
+}
+
+void CubeTexture::bind_to_unit(const uint32_t texture_unit) const {
+    GLStateCache::bind_texture_to_unit(texture_unit, GL_TEXTURE_CUBE_MAP, cube_texture_);
+    GLStateCache::bind_sampler(texture_unit, sampler_ ? sampler_->get() : 0);
 }
 
 void CubeTexture::generate_mipmap() const {
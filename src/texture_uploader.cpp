@@ -0,0 +1,226 @@
+#include "glex/texture_uploader.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <utility>
+#include "glex/buffer.h"
+#include "glex/common.h"
+#include "glex/gl_state_cache.h"
+#include "glex/image.h"
+#include "glex/texture.h"
+
+namespace {
+
+    size_t get_row_size(const Image &image) {
+        return image.get_width() * image.get_channels() * image.get_bytes_per_channel();
+    }
+
+} // namespace
+
+std::unique_ptr<TextureUploader> TextureUploader::create(const size_t ring_size, const size_t budget_per_frame) {
+    auto ring = Buffer::create_with_data(GL_PIXEL_UNPACK_BUFFER, GL_STREAM_DRAW, nullptr, 1, ring_size);
+    // A bound unpack buffer turns the data pointers of later `glTexImage2D` calls into offsets, so unbind it.
+    GLStateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!ring) {
+        SPDLOG_ERROR("Failed to create texture uploader: ring buffer");
+        return nullptr;
+    }
+
+    const auto placeholder_image = Image::create(1, 1, 4);
+    if (!placeholder_image) {
+        SPDLOG_ERROR("Failed to create texture uploader: placeholder image");
+        return nullptr;
+    }
+    placeholder_image->set_single_color_image(glm::vec4{0.5f, 0.5f, 0.5f, 1.0f});
+    std::shared_ptr<Texture> placeholder = Texture::create(*placeholder_image);
+    if (!placeholder) {
+        SPDLOG_ERROR("Failed to create texture uploader: placeholder texture");
+        return nullptr;
+    }
+
+    auto uploader = std::unique_ptr<TextureUploader>{
+            new TextureUploader{std::move(ring), ring_size, budget_per_frame, std::move(placeholder)}
+    };
+    SPDLOG_INFO(
+            "Texture uploader has been created: {} MB ring, {} KB per frame", ring_size / (1024 * 1024),
+            budget_per_frame / 1024
+    );
+    return std::move(uploader);
+}
+
+TextureUploader::TextureUploader(
+        std::unique_ptr<Buffer> ring, const size_t ring_size, const size_t budget_per_frame,
+        std::shared_ptr<Texture> placeholder
+)
+    : ring_{std::move(ring)}
+    , ring_size_{ring_size}
+    , budget_per_frame_{budget_per_frame}
+    , placeholder_{std::move(placeholder)} {}
+
+TextureUploader::~TextureUploader() {
+    for (const auto &fence : fences_) {
+        glDeleteSync(fence.sync);
+    }
+    if (!jobs_.empty()) {
+        SPDLOG_WARN("Texture uploader is deleted with {} pending textures", jobs_.size());
+    }
+}
+
+std::shared_ptr<Texture> TextureUploader::upload(std::unique_ptr<Image> image, const TextureOptions &options) {
+    if (!image) {
+        SPDLOG_ERROR("Failed to upload texture: no image");
+        return nullptr;
+    }
+    if (get_row_size(*image) == 0 || image->get_height() == 0) {
+        SPDLOG_ERROR("Failed to upload texture: empty image {}x{}", image->get_width(), image->get_height());
+        return nullptr;
+    }
+    if (get_row_size(*image) > ring_size_) {
+        SPDLOG_WARN(
+                "Image row is larger than the upload ring, upload synchronously: {}x{}", image->get_width(),
+                image->get_height()
+        );
+        return Texture::create(*image, options);
+    }
+    std::shared_ptr<Texture> texture = Texture::create_storage(*image, options);
+    if (!texture) {
+        SPDLOG_ERROR("Failed to upload texture");
+        return nullptr;
+    }
+    texture->placeholder_ = placeholder_;
+    jobs_.push_back(Job{texture, std::move(image)});
+    ++stats_.pending_textures;
+    return texture;
+}
+
+void TextureUploader::update() {
+    retire_fences();
+
+    stats_.bytes_last_frame = 0;
+    bool ring_bound = false;
+    while (!jobs_.empty()) {
+        auto &job = jobs_.front();
+        const auto texture = job.texture.lock();
+        if (!texture) {
+            // Nobody is going to sample it anymore.
+            jobs_.pop_front();
+            continue;
+        }
+
+        const auto &image = *job.image;
+        const auto row_size = get_row_size(image);
+        const auto budget = budget_per_frame_ - std::min(budget_per_frame_, stats_.bytes_last_frame);
+        // Copy at least one row per frame, so that an image with rows larger than the budget still makes progress.
+        auto row_count = std::min(image.get_height() - job.next_row, budget / row_size);
+        if (row_count == 0 && stats_.bytes_last_frame == 0) {
+            row_count = 1;
+        }
+        std::optional<size_t> offset;
+        for (; row_count > 0; row_count /= 2) {
+            if ((offset = allocate(row_count * row_size))) {
+                break;
+            }
+        }
+        if (!offset) {
+            // Out of budget, or the ring is full until older copies complete.
+            break;
+        }
+
+        if (!ring_bound) {
+            ring_->bind();
+            // Rows of the staged images are tightly packed.
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            ring_bound = true;
+        }
+        const auto size = row_count * row_size;
+        // The fences guarantee that no pending copy reads this region, so mapping does not need to synchronize.
+        const auto mapped = glMapBufferRange(
+                GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(*offset), static_cast<GLsizeiptr>(size),
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+        );
+        if (!mapped) {
+            SPDLOG_ERROR("Failed to map texture upload ring: {}", glGetError());
+            break;
+        }
+        std::memcpy(mapped, image.get_data() + job.next_row * row_size, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        GLStateCache::bind_texture(GL_TEXTURE_2D, texture->get());
+        glTexSubImage2D(
+                GL_TEXTURE_2D, 0, 0, static_cast<GLint>(job.next_row), static_cast<GLsizei>(image.get_width()),
+                static_cast<GLsizei>(row_count), texture->get_pixel_format(), texture->get_type(),
+                reinterpret_cast<const void *>(*offset)
+        );
+        job.next_row += row_count;
+        ring_head_ = *offset + size;
+        stats_.bytes_last_frame += size;
+        stats_.bytes_total += size;
+
+        Fence fence{nullptr, *offset, size, {}};
+        if (job.next_row == image.get_height()) {
+            // Queued behind the copies, so the mipmaps are also complete when the fence signals.
+            glGenerateMipmap(GL_TEXTURE_2D);
+            fence.completed = texture;
+            jobs_.pop_front();
+        }
+        fence.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        fences_.push_back(std::move(fence));
+    }
+
+    if (ring_bound) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        GLStateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    const auto completing = std::ranges::count_if(fences_, [](const Fence &fence) {
+        return !fence.completed.expired();
+    });
+    stats_.pending_textures = jobs_.size() + static_cast<size_t>(completing);
+}
+
+void TextureUploader::retire_fences() {
+    while (!fences_.empty()) {
+        const auto &fence = fences_.front();
+        // A zero timeout only polls the fence.
+        const auto status = glClientWaitSync(fence.sync, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        glDeleteSync(fence.sync);
+        if (const auto texture = fence.completed.lock()) {
+            texture->placeholder_.reset();
+            ++stats_.resident_textures;
+            SPDLOG_DEBUG("Texture has become resident: {}", texture->get());
+        }
+        fences_.pop_front();
+    }
+    if (fences_.empty()) {
+        ring_head_ = 0;
+    }
+}
+
+std::optional<size_t> TextureUploader::allocate(const size_t size) {
+    if (fences_.empty()) {
+        return size <= ring_size_ ? std::optional<size_t>{0} : std::nullopt;
+    }
+    // The regions in use span from the oldest fence to the head, possibly wrapping around the end of the ring.
+    const auto tail = fences_.front().offset;
+    if (ring_head_ > tail) {
+        if (ring_head_ + size <= ring_size_) {
+            return ring_head_;
+        }
+        if (size <= tail) {
+            return 0;
+        }
+        return std::nullopt;
+    }
+    if (ring_head_ + size <= tail) {
+        return ring_head_;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,58 @@
+#include "glex/thread_pool.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <utility>
+
+std::unique_ptr<ThreadPool> ThreadPool::create(size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    auto pool = std::unique_ptr<ThreadPool>{new ThreadPool{thread_count}};
+    SPDLOG_INFO("Thread pool has been created: {} threads", thread_count);
+    return std::move(pool);
+}
+
+ThreadPool &ThreadPool::get_default() {
+    static const auto pool = create();
+    return *pool;
+}
+
+ThreadPool::ThreadPool(const size_t thread_count) {
+    workers_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers_.emplace_back([this] { run_worker(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    condition_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run_worker() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{mutex_};
+            condition_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                // Stopping and nothing left to run.
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
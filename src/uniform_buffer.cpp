@@ -0,0 +1,73 @@
+#include "glex/uniform_buffer.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <vector>
+#include "glex/common.h"
+
+namespace {
+
+    /// Binding points currently used by uniform buffers.
+    std::vector<bool> used_bindings;
+
+} // namespace
+
+std::unique_ptr<UniformBuffer> UniformBuffer::create(const size_t size, const uint32_t usage) {
+    const auto binding = acquire_binding();
+    if (!binding) {
+        SPDLOG_ERROR("Failed to create uniform buffer: no free binding point");
+        return nullptr;
+    }
+    auto buffer = Buffer::create_with_data(GL_UNIFORM_BUFFER, usage, nullptr, 1, size);
+    if (!buffer) {
+        SPDLOG_ERROR("Failed to create uniform buffer");
+        release_binding(*binding);
+        return nullptr;
+    }
+    auto uniform_buffer = std::unique_ptr<UniformBuffer>{new UniformBuffer{std::move(buffer), *binding, size}};
+    uniform_buffer->bind();
+    SPDLOG_INFO("Uniform buffer has been created: {} bytes, binding: {}", size, *binding);
+    return std::move(uniform_buffer);
+}
+
+UniformBuffer::~UniformBuffer() {
+    release_binding(binding_);
+}
+
+void UniformBuffer::upload(const size_t size) const {
+    buffer_->set_data(data_.data(), std::min(size, data_.size()));
+    bind();
+}
+
+void UniformBuffer::bind() const {
+    buffer_->bind_base(binding_);
+}
+
+std::optional<uint32_t> UniformBuffer::acquire_binding() {
+    if (used_bindings.empty()) {
+        int max_bindings = 0;
+        glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &max_bindings);
+        used_bindings.resize(static_cast<size_t>(max_bindings), false);
+    }
+    for (size_t i = 0; i < used_bindings.size(); ++i) {
+        if (!used_bindings[i]) {
+            used_bindings[i] = true;
+            return static_cast<uint32_t>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+void UniformBuffer::release_binding(const uint32_t binding) {
+    if (binding < used_bindings.size()) {
+        used_bindings[binding] = false;
+    }
+}
+
+UniformBuffer::UniformBuffer(std::unique_ptr<Buffer> &&buffer, const uint32_t binding, const size_t size)
+    : buffer_{std::move(buffer)}
+    , binding_{binding}
+    , data_(size, 0) {}
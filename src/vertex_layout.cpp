@@ -2,6 +2,7 @@
 #include <memory>
 #include <spdlog/spdlog.h>
 #include "glex/common.h"
+#include "glex/gl_state_cache.h"
 
 std::unique_ptr<VertexLayout> VertexLayout::create() {
     uint32_t vertex_array_object_id;
@@ -23,11 +24,12 @@ VertexLayout::~VertexLayout() {
     if (vertex_array_object_) {
         SPDLOG_INFO("Delete vertex array object: {}", vertex_array_object_);
         glDeleteVertexArrays(1, &vertex_array_object_);
+        GLStateCache::forget_vertex_array(vertex_array_object_);
     }
 }
 
 void VertexLayout::bind() const {
-    glBindVertexArray(vertex_array_object_);
+    GLStateCache::bind_vertex_array(vertex_array_object_);
 }
 
 void VertexLayout::set_attrib(
@@ -41,3 +43,7 @@ void VertexLayout::set_attrib(
 void VertexLayout::disable_attrib(const int attrib_index) const {
     glDisableVertexAttribArray(attrib_index);
 }
+
+void VertexLayout::set_attrib_divisor(const uint32_t attrib_index, const uint32_t divisor) const {
+    glVertexAttribDivisor(attrib_index, divisor);
+}